@@ -0,0 +1,298 @@
+/*
+    echo_bench.c
+
+    Closed-loop load generator for the echo server
+
+    - T client threads, each with its own epoll and C connections
+    - every connection keeps exactly one message outstanding
+    - round-trip time of every echo is recorded
+    - prints echo messages/sec and p50 / p99 / p99.9 latency
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 -pthread echo_bench.c -o echo_bench
+
+    Run:
+        ./echo_bench 127.0.0.1 3490 -t 4 -c 16 -s 64 -d 5
+        ./echo_bench 127.0.0.1 3490 -t 4 -P 4      ( pin client threads to cores 4..7 )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define MAX_SAMPLES_PER_THREAD ( 1 << 21 )
+
+
+typedef struct {
+
+    int fd;
+    size_t got;                 // bytes of the current echo received
+    struct timespec sent;       // when the current message went out
+
+} bconn_t;
+
+typedef struct {
+
+    int id;
+    pthread_t thread;
+
+    unsigned long long msgs;    // completed round trips
+    double *samples;            // RTT in microseconds
+    long nsamples;
+
+} worker_t;
+
+const char *host, *port;
+int conns_per_thread = 16;
+size_t msg_size = 64;
+int duration = 5;
+int pin_base = -1;
+
+volatile int running = 1;
+
+
+
+/* ================= HELPERS ================= */
+
+double elapsed_us( struct timespec *a, struct timespec *b ) {
+
+    return ( b -> tv_sec - a -> tv_sec ) * 1e6 + ( b -> tv_nsec - a -> tv_nsec ) / 1e3;
+}
+
+
+int connect_to( void ) {
+
+    struct addrinfo hints, *res, *p;
+    int fd = -1;
+
+    memset( &hints, 0, sizeof hints );
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    if( getaddrinfo( host, port, &hints, &res ) != 0 ) {
+        return -1;
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        fd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( fd == -1 ) {
+            continue;
+        }
+
+        if( connect( fd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( fd );
+            fd = -1;
+            continue;
+        }
+
+        break;
+    }
+
+    freeaddrinfo( res );
+
+    if( fd != -1 ) {
+
+        int one = 1;
+        setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one );
+    }
+
+    return fd;
+}
+
+
+int cmp_double( const void *a, const void *b ) {
+
+    double x = *( const double * ) a, y = *( const double * ) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+
+
+/* ================= WORKER ================= */
+
+void *worker_main( void *arg ) {
+
+    worker_t *w = arg;
+
+    if( pin_base >= 0 ) {
+
+        cpu_set_t set;
+        CPU_ZERO( &set );
+        CPU_SET( pin_base + w -> id, &set );
+        pthread_setaffinity_np( pthread_self(), sizeof set, &set );
+    }
+
+    char *msg = malloc( msg_size );
+    char *buf = malloc( msg_size );
+    memset( msg, 'e', msg_size );
+
+    int ep = epoll_create1( 0 );
+    bconn_t *conns = calloc( conns_per_thread, sizeof *conns );
+
+    for( int i = 0; i < conns_per_thread; i++ ) {
+
+        conns[ i ].fd = connect_to();
+
+        if( conns[ i ].fd == -1 ) {
+            fprintf( stderr, "worker %d: connect failed\n", w -> id );
+            exit( 1 );
+        }
+
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &conns[ i ] };
+        epoll_ctl( ep, EPOLL_CTL_ADD, conns[ i ].fd, &ev );
+
+        // first message : the loop below keeps one outstanding per connection
+        clock_gettime( CLOCK_MONOTONIC, &conns[ i ].sent );
+        send( conns[ i ].fd, msg, msg_size, MSG_NOSIGNAL );
+    }
+
+    struct epoll_event events[ 64 ];
+
+    while( running ) {
+
+        int n = epoll_wait( ep, events, 64, 100 );
+
+        for( int i = 0; i < n; i++ ) {
+
+            bconn_t *c = events[ i ].data.ptr;
+
+            ssize_t got = recv( c -> fd, buf, msg_size - c -> got, MSG_DONTWAIT );
+
+            if( got <= 0 ) {
+
+                if( got < 0 && errno == EAGAIN ) {
+                    continue;
+                }
+
+                fprintf( stderr, "worker %d: server closed connection\n", w -> id );
+                exit( 1 );
+            }
+
+            c -> got += got;
+
+            if( c -> got < msg_size ) {
+                continue;   // partial echo, wait for the rest
+            }
+
+            struct timespec now;
+            clock_gettime( CLOCK_MONOTONIC, &now );
+
+            if( w -> nsamples < MAX_SAMPLES_PER_THREAD ) {
+                w -> samples[ w -> nsamples++ ] = elapsed_us( &c -> sent, &now );
+            }
+
+            w -> msgs++;
+
+            c -> got = 0;
+            c -> sent = now;
+            send( c -> fd, msg, msg_size, MSG_NOSIGNAL );
+        }
+    }
+
+    for( int i = 0; i < conns_per_thread; i++ ) {
+        close( conns[ i ].fd );
+    }
+
+    free( conns );
+    free( msg );
+    free( buf );
+    close( ep );
+
+    return NULL;
+}
+
+
+
+/* ================= MAIN ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int nthreads = 1;
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "t:c:s:d:P:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 't': nthreads = atoi( optarg ); break;
+            case 'c': conns_per_thread = atoi( optarg ); break;
+            case 's': msg_size = strtoul( optarg, NULL, 10 ); break;
+            case 'd': duration = atoi( optarg ); break;
+            case 'P': pin_base = atoi( optarg ); break;
+            default: goto usage;
+        }
+    }
+
+    if( argc - optind != 2 || nthreads < 1 || conns_per_thread < 1 || msg_size == 0 ) {
+usage:
+        fprintf( stderr, "usage: %s host port [-t threads] [-c conns/thread] [-s size] [-d seconds] [-P first-core]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+    host = argv[ optind ];
+    port = argv[ optind + 1 ];
+
+    worker_t *workers = calloc( nthreads, sizeof *workers );
+
+    for( int i = 0; i < nthreads; i++ ) {
+
+        workers[ i ].id = i;
+        workers[ i ].samples = malloc( sizeof( double ) * MAX_SAMPLES_PER_THREAD );
+
+        pthread_create( &workers[ i ].thread, NULL, worker_main, &workers[ i ] );
+    }
+
+    sleep( duration );
+    running = 0;
+
+    unsigned long long total = 0;
+    long nsamples = 0;
+
+    for( int i = 0; i < nthreads; i++ ) {
+
+        pthread_join( workers[ i ].thread, NULL );
+
+        total += workers[ i ].msgs;
+        nsamples += workers[ i ].nsamples;
+    }
+
+    // merge all samples, sort, read percentiles
+    double *all = malloc( sizeof( double ) * ( nsamples ? nsamples : 1 ) );
+    long k = 0;
+
+    for( int i = 0; i < nthreads; i++ ) {
+
+        memcpy( all + k, workers[ i ].samples, sizeof( double ) * workers[ i ].nsamples );
+        k += workers[ i ].nsamples;
+        free( workers[ i ].samples );
+    }
+
+    qsort( all, nsamples, sizeof( double ), cmp_double );
+
+    double p50 = nsamples ? all[ ( long ) ( nsamples * 0.50 ) ] : 0;
+    double p99 = nsamples ? all[ ( long ) ( nsamples * 0.99 ) ] : 0;
+    double p999 = nsamples ? all[ ( long ) ( nsamples * 0.999 ) ] : 0;
+
+    printf( "threads=%d conns=%d size=%zu  %.0f msg/s  p50=%.1fus  p99=%.1fus  p99.9=%.1fus\n",
+            nthreads, nthreads * conns_per_thread, msg_size,
+            ( double ) total / duration, p50, p99, p999 );
+
+    free( all );
+    free( workers );
+
+    return 0;
+}
@@ -0,0 +1,46 @@
+#!/bin/sh
+#
+#   scale.sh
+#
+#   Echo throughput + p99 latency from 1 to N reactor cores on loopback
+#
+#   Server reactors are pinned to cores 0..n-1,
+#   client threads are pinned to the cores after them ( if the machine has them )
+#
+#   Usage:
+#       ./scale.sh [max-cores] [conns-per-thread] [msg-size] [seconds]
+#
+#   Example:
+#       ./scale.sh 8 16 64 5
+
+CORES=$( nproc )
+MAX=${1:-$(( CORES / 2 > 0 ? CORES / 2 : 1 ))}
+CONNS=${2:-16}
+SIZE=${3:-64}
+SECS=${4:-5}
+PORT=3490
+
+echo "cores  result"
+
+n=1
+while [ "$n" -le "$MAX" ]; do
+
+    ./server -t "$n" -p "$PORT" > /dev/null &
+    SERVER=$!
+    sleep 0.3
+
+    # keep client threads off the server cores when there are enough cores
+    if [ $(( n * 2 )) -le "$CORES" ]; then
+        PIN="-P $n"
+    else
+        PIN=""
+    fi
+
+    printf "%-6s " "$n"
+    ./echo_bench 127.0.0.1 "$PORT" -t "$n" -c "$CONNS" -s "$SIZE" -d "$SECS" $PIN
+
+    kill "$SERVER"
+    wait "$SERVER" 2> /dev/null
+
+    n=$(( n + 1 ))
+done
@@ -0,0 +1,385 @@
+/*
+    server.c
+
+    Thread-per-core TCP echo server
+    ( built on Chapter-5/4-TCP-send-recv/server.c )
+
+    Every reactor thread owns, and shares with nobody:
+        - a CPU core                 ( pthread_setaffinity_np )
+        - its own listening socket   ( SO_REUSEPORT : kernel spreads connections )
+        - its own epoll instance
+        - its own buffers            ( per-thread bufpool free lists )
+        - its own stats counters     ( one cache line each )
+
+    No locks, no queues between threads, no accept() hand-off.
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 -pthread -I../../Chapter-7/16-buffer-pool \
+            server.c ../../Chapter-7/16-buffer-pool/bufpool.c -o server
+
+    Run:
+        ./server                    ( one reactor per online core )
+        ./server -t 4 -p 3490 -v    ( 4 reactors, print per-thread stats every second )
+
+    Linux only ( epoll, SO_REUSEPORT load balancing, CPU affinity )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "bufpool.h"
+
+#define PORT "3490"
+#define BACKLOG 1024
+#define MAX_EVENTS 256
+#define MAX_THREADS 256
+
+
+// per-thread counters, padded so two reactors never share a cache line
+typedef struct {
+
+    unsigned long long msgs;        // recv() calls that returned data
+    unsigned long long bytes;       // bytes echoed
+    unsigned long long accepted;    // connections accepted
+    unsigned long long closed;      // connections closed
+
+} __attribute__( ( aligned( 64 ) ) ) reactor_stats_t;
+
+// per-connection state, owned by exactly one reactor
+typedef struct {
+
+    int fd;
+    int writing;        // 1 while registered for EPOLLOUT
+    char *buf;          // pooled buffer while an echo is pending
+    size_t cap;
+    size_t len;
+    size_t off;
+
+} conn_t;
+
+typedef struct {
+
+    int id;                     // reactor number = core number
+    const char *port;
+    pthread_t thread;
+    reactor_stats_t stats;
+
+} reactor_t;
+
+reactor_t reactors[ MAX_THREADS ];
+
+
+
+/* ================= LISTENER ================= */
+
+// each reactor binds its own socket to the same port
+int reuseport_listener( const char *port ) {
+
+    struct addrinfo hints, *res, *p;
+    int sockfd = -1;
+    int yes = 1;
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_UNSPEC;     // IPv4 or IPv6
+    hints.ai_socktype = SOCK_STREAM;   // TCP
+    hints.ai_flags    = AI_PASSIVE;    // Use my IP
+
+    int status = getaddrinfo( NULL, port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo error: %s\n", gai_strerror( status ) );
+        return -1;
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype | SOCK_NONBLOCK, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            continue;
+        }
+
+        setsockopt( sockfd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes );
+
+        // several sockets on one port : kernel hashes each new connection to one of them
+        setsockopt( sockfd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof yes );
+
+        if( bind( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            continue;
+        }
+
+        break;   // Successfully bound
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        return -1;
+    }
+
+    if( listen( sockfd, BACKLOG ) == -1 ) {
+        close( sockfd );
+        return -1;
+    }
+
+    return sockfd;
+}
+
+
+
+/* ================= REACTOR ================= */
+
+// returns -1 on error, 0 if the socket is full, 1 when the echo is complete
+int flush_conn( int fd, conn_t *c, reactor_stats_t *st ) {
+
+    while( c -> off < c -> len ) {
+
+        ssize_t n = send( fd, c -> buf + c -> off, c -> len - c -> off, MSG_NOSIGNAL );
+
+        if( n < 0 ) {
+            return ( errno == EAGAIN || errno == EWOULDBLOCK ) ? 0 : -1;
+        }
+
+        c -> off += n;
+        st -> bytes += n;
+    }
+
+    bp_put( c -> buf, c -> cap );
+    c -> buf = NULL;
+
+    return 1;
+}
+
+
+void close_conn( int ep, conn_t *c, reactor_stats_t *st ) {
+
+    int fd = c -> fd;
+
+    if( c -> buf ) {
+        bp_put( c -> buf, c -> cap );
+    }
+
+    epoll_ctl( ep, EPOLL_CTL_DEL, fd, NULL );
+    close( fd );
+    free( c );
+
+    st -> closed++;
+}
+
+
+void *reactor_main( void *arg ) {
+
+    reactor_t *r = arg;
+    reactor_stats_t *st = &r -> stats;
+
+    // pin this reactor to its core
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    CPU_SET( r -> id, &set );
+
+    if( pthread_setaffinity_np( pthread_self(), sizeof set, &set ) != 0 ) {
+        fprintf( stderr, "reactor %d: could not pin to core %d\n", r -> id, r -> id );
+    }
+
+    int listener = reuseport_listener( r -> port );
+
+    if( listener == -1 ) {
+        fprintf( stderr, "reactor %d: failed to bind\n", r -> id );
+        exit( 1 );
+    }
+
+    int ep = epoll_create1( 0 );
+
+    struct epoll_event ev, events[ MAX_EVENTS ];
+
+    // listener is tagged with a NULL pointer, connections with their conn_t
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    epoll_ctl( ep, EPOLL_CTL_ADD, listener, &ev );
+
+    while( 1 ) {
+
+        int n = epoll_wait( ep, events, MAX_EVENTS, -1 );
+
+        for( int i = 0; i < n; i++ ) {
+
+            /* NEW CONNECTIONS */
+            if( events[ i ].data.ptr == NULL ) {
+
+                while( 1 ) {
+
+                    int fd = accept4( listener, NULL, NULL, SOCK_NONBLOCK );
+
+                    if( fd == -1 ) {
+                        break;
+                    }
+
+                    int one = 1;
+                    setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one );
+
+                    conn_t *c = calloc( 1, sizeof *c );
+
+                    if( c == NULL ) {
+                        close( fd );            // out of memory : refuse this one
+                        continue;
+                    }
+
+                    c -> fd = fd;
+
+                    ev.events = EPOLLIN;
+                    ev.data.ptr = c;
+                    epoll_ctl( ep, EPOLL_CTL_ADD, fd, &ev );
+
+                    st -> accepted++;
+                }
+
+                continue;
+            }
+
+            conn_t *c = events[ i ].data.ptr;
+            int fd = c -> fd;
+            int rc;
+
+            /* PENDING ECHO */
+            if( c -> buf ) {
+                rc = flush_conn( fd, c, st );
+            }
+
+            /* READ + ECHO */
+            else {
+
+                c -> buf = bp_get( BP_MEDIUM, &c -> cap );
+
+                if( c -> buf == NULL ) {
+                    close_conn( ep, c, st );    // pool exhausted : drop the connection
+                    continue;
+                }
+
+                ssize_t got = recv( fd, c -> buf, c -> cap, 0 );
+
+                if( got <= 0 ) {
+
+                    if( got < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ) ) {
+                        bp_put( c -> buf, c -> cap );
+                        c -> buf = NULL;
+                        continue;
+                    }
+
+                    close_conn( ep, c, st );
+                    continue;
+                }
+
+                // relaxed store : plain write, but the stats thread may read it
+                __atomic_store_n( &st -> msgs, st -> msgs + 1, __ATOMIC_RELAXED );
+
+                c -> len = got;
+                c -> off = 0;
+
+                rc = flush_conn( fd, c, st );
+            }
+
+            if( rc < 0 ) {
+                close_conn( ep, c, st );
+                continue;
+            }
+
+            // pending bytes : wait for EPOLLOUT, otherwise back to reading
+            // epoll_ctl() only when the interest actually changes
+            int writing = c -> buf != NULL;
+
+            if( writing != c -> writing ) {
+
+                ev.events = writing ? EPOLLOUT : EPOLLIN;
+                ev.data.ptr = c;
+                epoll_ctl( ep, EPOLL_CTL_MOD, fd, &ev );
+
+                c -> writing = writing;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+
+/* ================= MAIN ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int nthreads = ( int ) sysconf( _SC_NPROCESSORS_ONLN );
+    const char *port = PORT;
+    int verbose = 0;
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "t:p:v" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 't': nthreads = atoi( optarg ); break;
+            case 'p': port = optarg; break;
+            case 'v': verbose = 1; break;
+            default:
+                fprintf( stderr, "usage: %s [-t threads] [-p port] [-v]\n", argv[ 0 ] );
+                exit( 1 );
+        }
+    }
+
+    if( nthreads < 1 || nthreads > MAX_THREADS ) {
+        fprintf( stderr, "threads must be 1..%d\n", MAX_THREADS );
+        exit( 1 );
+    }
+
+    for( int i = 0; i < nthreads; i++ ) {
+
+        reactors[ i ].id = i;
+        reactors[ i ].port = port;
+
+        pthread_create( &reactors[ i ].thread, NULL, reactor_main, &reactors[ i ] );
+    }
+
+    printf( "Server is listening on %s with %d reactor(s)...\n", port, nthreads );
+    fflush( stdout );
+
+    // main thread only watches : it reads counters, never writes them
+    unsigned long long last[ MAX_THREADS ] = { 0 };
+
+    while( 1 ) {
+
+        sleep( 1 );
+
+        if( !verbose ) {
+            continue;
+        }
+
+        unsigned long long total = 0;
+
+        for( int i = 0; i < nthreads; i++ ) {
+
+            unsigned long long m = __atomic_load_n( &reactors[ i ].stats.msgs, __ATOMIC_RELAXED );
+
+            printf( "core %d: %llu msg/s  ", i, m - last[ i ] );
+
+            total += m - last[ i ];
+            last[ i ] = m;
+        }
+
+        printf( "| total %llu msg/s\n", total );
+        fflush( stdout );
+    }
+
+    return 0;
+}
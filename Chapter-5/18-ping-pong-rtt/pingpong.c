@@ -0,0 +1,447 @@
+/*
+    pingpong.c
+
+    TCP ping-pong round-trip latency benchmark
+    ( the measuring version of 4-TCP-send-recv/client.c + server.c )
+
+    - fixed-size messages, exactly one outstanding at a time
+    - every round trip timed with CLOCK_MONOTONIC_RAW
+    - client and server threads can be pinned to chosen cores
+    - optional SO_BUSY_POLL ( kernel spins in recv for N microseconds )
+    - optional spin-on-EAGAIN ( non-blocking socket, user space never sleeps )
+    - prints the full latency distribution, optionally dumps every sample
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 pingpong.c -o pingpong
+
+    Run:
+        ./pingpong -S -C 2                          ( server on core 2 )
+        ./pingpong 127.0.0.1 3490 -C 3 -n 100000    ( client on core 3 )
+        ./pingpong 127.0.0.1 3490 -C 3 -y -b 50 -o rtt.txt
+
+    Linux only ( CPU affinity, SO_BUSY_POLL, CLOCK_MONOTONIC_RAW )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <netdb.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+
+#define PORT "3490"
+#define MAX_MSG 65536
+
+
+typedef struct {
+
+    int server;         // -S : run as server
+    const char *port;   // -p : server port
+    int core;           // -C : pin to this core ( -1 = no pinning )
+    int busy_poll;      // -b : SO_BUSY_POLL microseconds
+    int spin;           // -y : spin on EAGAIN
+    long iters;         // -n : measured round trips
+    long warmup;        // -w : round trips thrown away first
+    size_t size;        // -s : message size
+    const char *out;    // -o : dump every sample ( ns ) to this file
+
+} config_t;
+
+config_t cfg = { 0, PORT, -1, 0, 0, 100000, 10000, 64, NULL };
+
+
+
+/* ================= SETUP HELPERS ================= */
+
+void pin_to_core( int core ) {
+
+    if( core < 0 ) {
+        return;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    CPU_SET( core, &set );
+
+    if( sched_setaffinity( 0, sizeof set, &set ) == -1 ) {
+        perror( "sched_setaffinity" );
+        exit( 1 );
+    }
+}
+
+
+// latency options shared by both ends
+void tune_socket( int fd ) {
+
+    int one = 1;
+
+    // never let Nagle hold back a small message
+    setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one );
+
+    if( cfg.busy_poll > 0 ) {
+
+        // raising it above net.core.busy_read needs CAP_NET_ADMIN
+        if( setsockopt( fd, SOL_SOCKET, SO_BUSY_POLL, &cfg.busy_poll, sizeof cfg.busy_poll ) == -1 ) {
+            perror( "setsockopt SO_BUSY_POLL" );
+        }
+    }
+}
+
+
+// read exactly len bytes, sleeping in recv() or spinning on EAGAIN
+int recv_all( int fd, char *buf, size_t len ) {
+
+    size_t got = 0;
+    int flags = cfg.spin ? MSG_DONTWAIT : 0;
+
+    while( got < len ) {
+
+        ssize_t n = recv( fd, buf + got, len - got, flags );
+
+        if( n > 0 ) {
+            got += n;
+            continue;
+        }
+
+        if( n == 0 ) {
+            return 0;       // peer closed
+        }
+
+        if( errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ) {
+            continue;       // spin : try again immediately
+        }
+
+        return -1;
+    }
+
+    return 1;
+}
+
+
+int send_all( int fd, const char *buf, size_t len ) {
+
+    size_t sent = 0;
+
+    while( sent < len ) {
+
+        ssize_t n = send( fd, buf + sent, len - sent, MSG_NOSIGNAL );
+
+        if( n == -1 ) {
+
+            if( errno == EAGAIN || errno == EINTR ) {
+                continue;
+            }
+
+            return -1;
+        }
+
+        sent += n;
+    }
+
+    return 0;
+}
+
+
+int cmp_ll( const void *a, const void *b ) {
+
+    long long x = *( const long long * ) a, y = *( const long long * ) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+
+
+/* ================= SERVER ================= */
+
+void run_server( void ) {
+
+    struct addrinfo hints, *res, *p;
+    int sockfd = -1, yes = 1;
+    char *buffer = malloc( MAX_MSG );
+
+    memset( &hints, 0, sizeof hints );
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags    = AI_PASSIVE;
+
+    int status = getaddrinfo( NULL, cfg.port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo error: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            continue;
+        }
+
+        setsockopt( sockfd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes );
+
+        if( bind( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            continue;
+        }
+
+        break;
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL || listen( sockfd, 10 ) == -1 ) {
+        printf( "Failed to bind socket\n" );
+        exit( 1 );
+    }
+
+    printf( "pingpong server on %s ( core %d, busy_poll %d us, %s )\n",
+            cfg.port, cfg.core, cfg.busy_poll, cfg.spin ? "spin" : "blocking" );
+
+    // one client at a time : nothing else competes for this core
+    while( 1 ) {
+
+        int fd = accept( sockfd, NULL, NULL );
+
+        if( fd == -1 ) {
+            perror( "accept" );
+            continue;
+        }
+
+        tune_socket( fd );
+
+        while( 1 ) {
+
+            // echo whatever arrives, the client knows the message size
+            ssize_t n = recv( fd, buffer, MAX_MSG, cfg.spin ? MSG_DONTWAIT : 0 );
+
+            if( n < 0 && ( errno == EAGAIN || errno == EINTR ) ) {
+                continue;
+            }
+
+            if( n <= 0 || send_all( fd, buffer, n ) == -1 ) {
+                break;
+            }
+        }
+
+        close( fd );
+    }
+}
+
+
+
+/* ================= CLIENT ================= */
+
+void print_distribution( long long *ns, long n ) {
+
+    qsort( ns, n, sizeof *ns, cmp_ll );
+
+    double sum = 0;
+
+    for( long i = 0; i < n; i++ ) {
+        sum += ns[ i ];
+    }
+
+    static const double pct[] = { 50, 90, 99, 99.9, 99.99, 99.999 };
+
+    printf( "\nround trips : %ld x %zu bytes\n", n, cfg.size );
+    printf( "min         : %8.2f us\n", ns[ 0 ] / 1e3 );
+    printf( "mean        : %8.2f us\n", sum / n / 1e3 );
+
+    for( size_t i = 0; i < sizeof pct / sizeof pct[ 0 ]; i++ ) {
+
+        long idx = ( long ) ( n * pct[ i ] / 100.0 );
+
+        if( idx >= n ) {
+            idx = n - 1;
+        }
+
+        printf( "p%-10g : %8.2f us\n", pct[ i ], ns[ idx ] / 1e3 );
+    }
+
+    printf( "max         : %8.2f us\n", ns[ n - 1 ] / 1e3 );
+
+    // log2 buckets : the whole shape, including the tail
+    printf( "\n%-22s %10s\n", "bucket", "count" );
+
+    long i = 0;
+
+    while( i < n ) {
+
+        long long lo = 1;
+
+        while( lo * 2 <= ns[ i ] ) {
+            lo *= 2;
+        }
+
+        long count = 0;
+
+        while( i < n && ns[ i ] < lo * 2 ) {
+            count++;
+            i++;
+        }
+
+        int bar = ( int ) ( 50.0 * count / n ) + ( count > 0 );
+
+        printf( "[%7.2f, %7.2f) us %10ld %.*s\n", lo / 1e3, lo * 2 / 1e3, count, bar,
+                "##################################################" );
+    }
+}
+
+
+void run_client( const char *host ) {
+
+    struct addrinfo hints, *res, *p;
+    int fd = -1;
+
+    memset( &hints, 0, sizeof hints );
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    int status = getaddrinfo( host, cfg.port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo error: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        fd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( fd == -1 ) {
+            continue;
+        }
+
+        if( connect( fd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( fd );
+            continue;
+        }
+
+        break;
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        printf( "Failed to connect\n" );
+        exit( 1 );
+    }
+
+    tune_socket( fd );
+
+    char *msg = malloc( cfg.size );
+    char *buf = malloc( cfg.size );
+    long long *ns = malloc( sizeof *ns * cfg.iters );
+
+    memset( msg, 'p', cfg.size );
+
+    for( long i = -cfg.warmup; i < cfg.iters; i++ ) {
+
+        struct timespec t0, t1;
+
+        clock_gettime( CLOCK_MONOTONIC_RAW, &t0 );
+
+        if( send_all( fd, msg, cfg.size ) == -1 || recv_all( fd, buf, cfg.size ) != 1 ) {
+            fprintf( stderr, "connection lost after %ld round trips\n", i + cfg.warmup );
+            exit( 1 );
+        }
+
+        clock_gettime( CLOCK_MONOTONIC_RAW, &t1 );
+
+        if( i >= 0 ) {
+            ns[ i ] = ( t1.tv_sec - t0.tv_sec ) * 1000000000LL + ( t1.tv_nsec - t0.tv_nsec );
+        }
+    }
+
+    close( fd );
+
+    // raw samples in send order, before sorting
+    if( cfg.out ) {
+
+        FILE *f = fopen( cfg.out, "w" );
+
+        if( f == NULL ) {
+            perror( cfg.out );
+        } else {
+
+            for( long i = 0; i < cfg.iters; i++ ) {
+                fprintf( f, "%lld\n", ns[ i ] );
+            }
+
+            fclose( f );
+        }
+    }
+
+    printf( "client core %d, busy_poll %d us, %s\n", cfg.core, cfg.busy_poll, cfg.spin ? "spin" : "blocking" );
+
+    print_distribution( ns, cfg.iters );
+
+    free( msg );
+    free( buf );
+    free( ns );
+}
+
+
+
+/* ================= MAIN ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "Sp:C:b:yn:w:s:o:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'S': cfg.server = 1; break;
+            case 'p': cfg.port = optarg; break;
+            case 'C': cfg.core = atoi( optarg ); break;
+            case 'b': cfg.busy_poll = atoi( optarg ); break;
+            case 'y': cfg.spin = 1; break;
+            case 'n': cfg.iters = atol( optarg ); break;
+            case 'w': cfg.warmup = atol( optarg ); break;
+            case 's': cfg.size = strtoul( optarg, NULL, 10 ); break;
+            case 'o': cfg.out = optarg; break;
+            default: goto usage;
+        }
+    }
+
+    if( cfg.server ? optind != argc : argc - optind != 2 ) {
+        goto usage;
+    }
+
+    if( cfg.iters < 1 || cfg.size == 0 || cfg.size > MAX_MSG ) {
+        fprintf( stderr, "need -n >= 1 and 1 <= -s <= %d\n", MAX_MSG );
+        exit( 1 );
+    }
+
+    pin_to_core( cfg.core );
+
+    if( cfg.server ) {
+        run_server();
+    } else {
+        cfg.port = argv[ optind + 1 ];
+        run_client( argv[ optind ] );
+    }
+
+    return 0;
+
+usage:
+    fprintf( stderr,
+             "usage: %s -S [-p port] [-C core] [-b busy_poll_us] [-y]\n"
+             "       %s host port [-n iters] [-w warmup] [-s size] [-C core] [-b busy_poll_us] [-y] [-o samples.txt]\n",
+             argv[ 0 ], argv[ 0 ] );
+    exit( 1 );
+}
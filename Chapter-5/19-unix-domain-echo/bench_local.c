@@ -0,0 +1,370 @@
+/*
+    bench_local.c
+
+    Same-host transport comparison :
+        TCP loopback | Unix stream | Unix seqpacket | socketpair | pipe
+
+    For each transport, a child process echoes and the parent measures:
+        - latency    : ping-pong round trips, one message in flight
+        - throughput : one-way bulk stream, child acknowledges the end
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 bench_local.c endpoint.c -o bench_local
+
+    Run:
+        ./bench_local                         ( 64 B ping-pong, 64 KiB chunks, 1 GiB )
+        ./bench_local -n 200000 -s 256 -c 16384 -m 512
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include "endpoint.h"
+
+
+// one side of a transport : pipes need two fds, sockets use the same fd twice
+typedef struct {
+    int rfd;
+    int wfd;
+} duplex_t;
+
+typedef struct {
+
+    const char *name;
+    const char *addr;           // endpoint address, NULL = socketpair / pipe
+
+} transport_t;
+
+transport_t transports[] = {
+    { "tcp loopback",   "127.0.0.1:34901" },
+    { "unix stream",    "unix:@bench-local-stream" },
+    { "unix seqpacket", "unix-seq:@bench-local-seq" },
+    { "socketpair",     NULL },
+    { "pipe",           NULL },
+};
+
+long iters = 100000;        // -n : ping-pong round trips
+size_t msg_size = 64;       // -s : ping-pong message size
+size_t chunk = 65536;       // -c : bulk write size
+long total_mb = 1024;       // -m : bulk MiB
+
+
+
+/* ================= HELPERS ================= */
+
+double now_s( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+int read_full( int fd, char *buf, size_t len ) {
+
+    size_t got = 0;
+
+    while( got < len ) {
+
+        ssize_t n = read( fd, buf + got, len - got );
+
+        if( n <= 0 ) {
+
+            if( n < 0 && errno == EINTR ) {
+                continue;
+            }
+
+            return -1;
+        }
+
+        got += n;
+    }
+
+    return 0;
+}
+
+
+int write_full( int fd, const char *buf, size_t len ) {
+
+    size_t sent = 0;
+
+    while( sent < len ) {
+
+        ssize_t n = write( fd, buf + sent, len - sent );
+
+        if( n < 0 ) {
+
+            if( errno == EINTR ) {
+                continue;
+            }
+
+            return -1;
+        }
+
+        sent += n;
+    }
+
+    return 0;
+}
+
+
+int cmp_double( const void *a, const void *b ) {
+
+    double x = *( const double * ) a, y = *( const double * ) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+
+// build a connected pair ( parent side, child side ) for one transport
+int make_pair( transport_t *t, duplex_t *parent, duplex_t *child ) {
+
+    int sv[ 2 ];
+
+    if( t -> addr ) {
+
+        endpoint_t ep;
+        endpoint_parse( t -> addr, &ep );
+
+        int lfd = endpoint_listen( &ep, 1 );
+
+        if( lfd == -1 ) {
+            return -1;
+        }
+
+        // connect completes against the backlog before accept() runs
+        int cfd = endpoint_connect( &ep );
+        int sfd = accept( lfd, NULL, NULL );
+
+        close( lfd );
+
+        if( cfd == -1 || sfd == -1 ) {
+            return -1;
+        }
+
+        *parent = ( duplex_t ) { cfd, cfd };
+        *child  = ( duplex_t ) { sfd, sfd };
+
+        return 0;
+    }
+
+    if( strcmp( t -> name, "socketpair" ) == 0 ) {
+
+        if( socketpair( AF_UNIX, SOCK_STREAM, 0, sv ) == -1 ) {
+            return -1;
+        }
+
+        *parent = ( duplex_t ) { sv[ 0 ], sv[ 0 ] };
+        *child  = ( duplex_t ) { sv[ 1 ], sv[ 1 ] };
+
+        return 0;
+    }
+
+    // pipes are one-way : one for each direction
+    int up[ 2 ], down[ 2 ];
+
+    if( pipe( up ) == -1 || pipe( down ) == -1 ) {
+        return -1;
+    }
+
+    *parent = ( duplex_t ) { up[ 0 ], down[ 1 ] };
+    *child  = ( duplex_t ) { down[ 0 ], up[ 1 ] };
+
+    return 0;
+}
+
+
+void close_duplex( duplex_t *d ) {
+
+    close( d -> rfd );
+
+    if( d -> wfd != d -> rfd ) {
+        close( d -> wfd );
+    }
+}
+
+
+
+/* ================= CHILD SIDE ================= */
+
+// echo fixed-size messages until the parent goes away
+void child_echo( duplex_t *d ) {
+
+    char *buf = malloc( msg_size );
+
+    while( read_full( d -> rfd, buf, msg_size ) == 0 ) {
+
+        if( write_full( d -> wfd, buf, msg_size ) == -1 ) {
+            break;
+        }
+    }
+
+    _exit( 0 );
+}
+
+
+// swallow the bulk stream, answer with one byte at the end
+void child_sink( duplex_t *d ) {
+
+    char *buf = malloc( chunk );
+    long long want = total_mb * 1024LL * 1024LL;
+    long long got = 0;
+
+    while( got < want ) {
+
+        ssize_t n = read( d -> rfd, buf, chunk );
+
+        if( n <= 0 ) {
+            _exit( 1 );
+        }
+
+        got += n;
+    }
+
+    write_full( d -> wfd, "k", 1 );
+
+    _exit( 0 );
+}
+
+
+
+/* ================= PARENT SIDE ================= */
+
+void run_one( transport_t *t ) {
+
+    duplex_t parent, child;
+
+    /* LATENCY */
+
+    if( make_pair( t, &parent, &child ) == -1 ) {
+        printf( "%-16s setup failed: %s\n", t -> name, strerror( errno ) );
+        return;
+    }
+
+    pid_t pid = fork();
+
+    if( pid == 0 ) {
+        close_duplex( &parent );
+        child_echo( &child );
+    }
+
+    close_duplex( &child );
+
+    char *msg = calloc( 1, msg_size );
+    double *rtt = malloc( sizeof *rtt * iters );
+
+    for( long i = 0; i < iters; i++ ) {
+
+        double t0 = now_s();
+
+        if( write_full( parent.wfd, msg, msg_size ) == -1 || read_full( parent.rfd, msg, msg_size ) == -1 ) {
+            printf( "%-16s echo failed\n", t -> name );
+            exit( 1 );
+        }
+
+        rtt[ i ] = ( now_s() - t0 ) * 1e6;
+    }
+
+    close_duplex( &parent );
+    waitpid( pid, NULL, 0 );
+
+    qsort( rtt, iters, sizeof *rtt, cmp_double );
+
+    double p50 = rtt[ iters / 2 ];
+    double p99 = rtt[ ( long ) ( iters * 0.99 ) ];
+
+    /* THROUGHPUT */
+
+    if( make_pair( t, &parent, &child ) == -1 ) {
+        printf( "%-16s setup failed: %s\n", t -> name, strerror( errno ) );
+        return;
+    }
+
+    pid = fork();
+
+    if( pid == 0 ) {
+        close_duplex( &parent );
+        child_sink( &child );
+    }
+
+    close_duplex( &child );
+
+    char *bulk = calloc( 1, chunk );
+    long long want = total_mb * 1024LL * 1024LL;
+    char ack;
+
+    double t0 = now_s();
+
+    for( long long sent = 0; sent < want; sent += chunk ) {
+
+        size_t n = want - sent < ( long long ) chunk ? ( size_t ) ( want - sent ) : chunk;
+
+        if( write_full( parent.wfd, bulk, n ) == -1 ) {
+            printf( "%-16s bulk write failed\n", t -> name );
+            exit( 1 );
+        }
+    }
+
+    read_full( parent.rfd, &ack, 1 );
+
+    double secs = now_s() - t0;
+
+    close_duplex( &parent );
+    waitpid( pid, NULL, 0 );
+
+    printf( "%-16s %9.2f %9.2f %12.0f %10.2f\n",
+            t -> name, p50, p99, 1e6 / p50, total_mb / 1024.0 * 8 / secs );
+
+    free( msg );
+    free( rtt );
+    free( bulk );
+}
+
+
+
+/* ================= MAIN ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:s:c:m:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'n': iters = atol( optarg ); break;
+            case 's': msg_size = strtoul( optarg, NULL, 10 ); break;
+            case 'c': chunk = strtoul( optarg, NULL, 10 ); break;
+            case 'm': total_mb = atol( optarg ); break;
+            default:
+                fprintf( stderr, "usage: %s [-n round-trips] [-s msg-size] [-c chunk] [-m MiB]\n", argv[ 0 ] );
+                exit( 1 );
+        }
+    }
+
+    if( iters < 1 || msg_size == 0 || chunk == 0 || total_mb < 1 ) {
+        fprintf( stderr, "all values must be positive\n" );
+        exit( 1 );
+    }
+
+    signal( SIGPIPE, SIG_IGN );
+
+    printf( "ping-pong: %ld x %zu B | bulk: %ld MiB in %zu B writes\n\n", iters, msg_size, total_mb, chunk );
+    printf( "%-16s %9s %9s %12s %10s\n", "transport", "p50 us", "p99 us", "round trip/s", "Gbit/s" );
+
+    for( size_t i = 0; i < sizeof transports / sizeof transports[ 0 ]; i++ ) {
+        fflush( stdout );
+        run_one( &transports[ i ] );
+    }
+
+    return 0;
+}
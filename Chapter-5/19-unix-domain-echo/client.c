@@ -0,0 +1,97 @@
+/*
+    TCP / Unix Domain Echo Client
+    ( 4-TCP-send-recv/client.c with the transport picked by address syntax )
+
+    Compile:
+        gcc -Wall -Wextra -pedantic client.c endpoint.c -o client
+
+    Run:
+        ./client localhost 3490           TCP ( same as the original )
+        ./client localhost:3490           TCP
+        ./client unix:/tmp/echo.sock      Unix stream socket
+        ./client unix-seq:/tmp/echo.sock  Unix seqpacket socket
+        ./client unix:@echo               Linux abstract socket
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "endpoint.h"
+
+int main( int argc, char *argv[] ) {
+
+    endpoint_t ep;
+    char addr[ 300 ];
+    char msg[ 1024 ], buffer[ 1024 ];
+
+    if( argc == 3 ) {
+
+        // old "host port" form
+        snprintf( addr, sizeof addr, "%s:%s", argv[ 1 ], argv[ 2 ] );
+
+    } else if( argc == 2 ) {
+
+        snprintf( addr, sizeof addr, "%s", argv[ 1 ] );
+
+    } else {
+        printf( "Usage : %s host port | %s address\n", argv[ 0 ], argv[ 0 ] );
+        exit( 1 );
+    }
+
+    if( endpoint_parse( addr, &ep ) == -1 ) {
+        fprintf( stderr, "bad address: %s\n", addr );
+        exit( 1 );
+    }
+
+    int sockfd = endpoint_connect( &ep );
+
+    if( sockfd == -1 ) {
+        printf( "Failed to connect\n" );
+        exit( 1 );
+    }
+
+    // Chat loop
+    while( 1 ) {
+
+        printf( "Enter message ( type exit to quit ): " );
+
+        if( fgets( msg, sizeof msg, stdin ) == NULL ) {
+            break;
+        }
+
+        // Exit condition
+        if( strncmp( msg, "exit", 4 ) == 0 ) {
+            break;
+        }
+
+        // Send message
+        if( send( sockfd, msg, strlen( msg ), 0 ) == -1 ) {
+            perror( "send" );
+            break;
+        }
+
+        // Receive echo
+        int bytes = recv( sockfd, buffer, sizeof buffer - 1, 0 );
+
+        if( bytes == -1 ) {
+            perror( "recv" );
+            break;
+        }
+
+        if( bytes == 0 ) {
+            printf( "Server closed connection\n" );
+            break;
+        }
+
+        buffer[ bytes ] = '\0';
+
+        printf( "Server replied : %s\n", buffer );
+    }
+
+    close( sockfd );
+
+    return 0;
+}
@@ -0,0 +1,265 @@
+/*
+    endpoint.c
+
+    Address parsing + listen / connect for AF_UNIX and TCP ( see endpoint.h )
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <errno.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "endpoint.h"
+
+
+/* ================= PARSING ================= */
+
+int endpoint_parse( const char *text, endpoint_t *ep ) {
+
+    memset( ep, 0, sizeof *ep );
+
+    ep -> socktype = SOCK_STREAM;
+
+    const char *path = NULL;
+
+    if( strncmp( text, "unix-seq:", 9 ) == 0 ) {
+        ep -> socktype = SOCK_SEQPACKET;
+        path = text + 9;
+    } else if( strncmp( text, "unix:", 5 ) == 0 ) {
+        path = text + 5;
+    }
+
+    /* AF_UNIX */
+    if( path ) {
+
+        if( *path == '\0' || strlen( path ) >= sizeof ep -> path ) {
+            return -1;
+        }
+
+        ep -> family = AF_UNIX;
+        strcpy( ep -> path, path );
+
+        return 0;
+    }
+
+    /* TCP */
+    ep -> family = AF_UNSPEC;
+
+    const char *colon = strrchr( text, ':' );
+
+    // port only
+    if( colon == NULL ) {
+
+        if( strlen( text ) >= sizeof ep -> port ) {
+            return -1;
+        }
+
+        strcpy( ep -> port, text );
+
+        return 0;
+    }
+
+    size_t hlen = colon - text;
+
+    // [v6]:port → strip the brackets
+    if( hlen >= 2 && text[ 0 ] == '[' && text[ hlen - 1 ] == ']' ) {
+        text++;
+        hlen -= 2;
+    }
+
+    if( hlen >= sizeof ep -> host || strlen( colon + 1 ) >= sizeof ep -> port || colon[ 1 ] == '\0' ) {
+        return -1;
+    }
+
+    memcpy( ep -> host, text, hlen );
+    ep -> host[ hlen ] = '\0';
+    strcpy( ep -> port, colon + 1 );
+
+    return 0;
+}
+
+
+const char *endpoint_name( const endpoint_t *ep, char *buf, size_t len ) {
+
+    if( ep -> family == AF_UNIX ) {
+        snprintf( buf, len, "%s:%s", ep -> socktype == SOCK_SEQPACKET ? "unix-seq" : "unix", ep -> path );
+    } else {
+        snprintf( buf, len, "tcp:%s:%s", ep -> host[ 0 ] ? ep -> host : "*", ep -> port );
+    }
+
+    return buf;
+}
+
+
+
+/* ================= AF_UNIX ================= */
+
+// fill sockaddr_un, '@name' becomes an abstract address ( leading NUL byte )
+static socklen_t unix_addr( const endpoint_t *ep, struct sockaddr_un *sun ) {
+
+    memset( sun, 0, sizeof *sun );
+    sun -> sun_family = AF_UNIX;
+
+    size_t n = strlen( ep -> path );
+
+    memcpy( sun -> sun_path, ep -> path, n );
+
+    if( ep -> path[ 0 ] == '@' ) {
+
+        sun -> sun_path[ 0 ] = '\0';
+
+        // abstract names are not NUL terminated : length is the name
+        return offsetof( struct sockaddr_un, sun_path ) + n;
+    }
+
+    return offsetof( struct sockaddr_un, sun_path ) + n + 1;
+}
+
+
+static int unix_listen( const endpoint_t *ep, int backlog ) {
+
+    struct sockaddr_un sun;
+    socklen_t len = unix_addr( ep, &sun );
+
+    int fd = socket( AF_UNIX, ep -> socktype, 0 );
+
+    if( fd == -1 ) {
+        return -1;
+    }
+
+    // a socket file left by a previous run would make bind() fail;
+    // anything else at that path is not ours to delete
+    struct stat st;
+
+    if( ep -> path[ 0 ] != '@' && lstat( ep -> path, &st ) == 0 ) {
+
+        if( !S_ISSOCK( st.st_mode ) ) {
+            close( fd );
+            errno = EADDRINUSE;
+            return -1;
+        }
+
+        unlink( ep -> path );
+    }
+
+    if( bind( fd, ( struct sockaddr * ) &sun, len ) == -1 || listen( fd, backlog ) == -1 ) {
+        close( fd );
+        return -1;
+    }
+
+    return fd;
+}
+
+
+static int unix_connect( const endpoint_t *ep ) {
+
+    struct sockaddr_un sun;
+    socklen_t len = unix_addr( ep, &sun );
+
+    int fd = socket( AF_UNIX, ep -> socktype, 0 );
+
+    if( fd == -1 ) {
+        return -1;
+    }
+
+    if( connect( fd, ( struct sockaddr * ) &sun, len ) == -1 ) {
+        close( fd );
+        return -1;
+    }
+
+    return fd;
+}
+
+
+
+/* ================= TCP ================= */
+
+static int tcp_open( const endpoint_t *ep, int backlog, int passive ) {
+
+    struct addrinfo hints, *res, *p;
+    int fd = -1;
+    int yes = 1;
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_UNSPEC;     // IPv4 or IPv6
+    hints.ai_socktype = SOCK_STREAM;   // TCP
+    hints.ai_flags    = passive ? AI_PASSIVE : 0;
+
+    const char *host = ep -> host[ 0 ] ? ep -> host : NULL;
+
+    int status = getaddrinfo( host, ep -> port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo error: %s\n", gai_strerror( status ) );
+        return -1;
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        fd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( fd == -1 ) {
+            continue;
+        }
+
+        if( passive ) {
+
+            setsockopt( fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes );
+
+            if( bind( fd, p -> ai_addr, p -> ai_addrlen ) == -1 || listen( fd, backlog ) == -1 ) {
+                close( fd );
+                fd = -1;
+                continue;
+            }
+
+        } else if( connect( fd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+
+            close( fd );
+            fd = -1;
+            continue;
+        }
+
+        break;
+    }
+
+    freeaddrinfo( res );
+
+    // small request / response messages : no Nagle delay
+    if( fd != -1 && !passive ) {
+        setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes );
+    }
+
+    return fd;
+}
+
+
+
+/* ================= API ================= */
+
+int endpoint_listen( const endpoint_t *ep, int backlog ) {
+
+    if( ep -> family == AF_UNIX ) {
+        return unix_listen( ep, backlog );
+    }
+
+    return tcp_open( ep, backlog, 1 );
+}
+
+
+int endpoint_connect( const endpoint_t *ep ) {
+
+    if( ep -> family == AF_UNIX ) {
+        return unix_connect( ep );
+    }
+
+    return tcp_open( ep, 0, 0 );
+}
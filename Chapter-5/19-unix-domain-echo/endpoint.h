@@ -0,0 +1,43 @@
+/*
+    endpoint.h
+
+    One address string → the right socket family and type
+
+    Syntax:
+        unix:/tmp/echo.sock       AF_UNIX  SOCK_STREAM     ( filesystem path )
+        unix:@echo                AF_UNIX  SOCK_STREAM     ( Linux abstract name )
+        unix-seq:/tmp/echo.sock   AF_UNIX  SOCK_SEQPACKET  ( message boundaries kept )
+        localhost:3490            TCP, IPv4 or IPv6 via getaddrinfo()
+        [::1]:3490                TCP, bracketed IPv6 literal
+        3490                      TCP, port only ( server : all interfaces )
+*/
+
+#ifndef ENDPOINT_H
+#define ENDPOINT_H
+
+#include <sys/socket.h>
+
+typedef struct {
+
+    int family;                 // AF_UNIX or AF_UNSPEC ( let getaddrinfo pick )
+    int socktype;               // SOCK_STREAM or SOCK_SEQPACKET
+    char host[ 256 ];           // TCP host ( empty = wildcard / localhost )
+    char port[ 16 ];            // TCP port
+    char path[ 108 ];           // AF_UNIX path, '@' prefix = abstract
+
+} endpoint_t;
+
+// parse an address string, returns 0 on success, -1 on bad syntax
+int endpoint_parse( const char *text, endpoint_t *ep );
+
+// bound + listening socket, -1 on failure ( errno set )
+// a stale AF_UNIX socket file at the same path is removed first
+int endpoint_listen( const endpoint_t *ep, int backlog );
+
+// connected socket, -1 on failure
+int endpoint_connect( const endpoint_t *ep );
+
+// human readable form, e.g. "unix-seq:/tmp/echo.sock" or "tcp:localhost:3490"
+const char *endpoint_name( const endpoint_t *ep, char *buf, size_t len );
+
+#endif
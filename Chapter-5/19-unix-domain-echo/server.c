@@ -0,0 +1,98 @@
+/*
+    TCP / Unix Domain Echo Server
+    ( 4-TCP-send-recv/server.c with the transport picked by address syntax )
+
+    It receives data from a client and sends the same data back
+
+    Compile:
+        gcc -Wall -Wextra -pedantic server.c endpoint.c -o server
+
+    Run:
+        ./server                          TCP port 3490 ( like the original )
+        ./server unix:/tmp/echo.sock      Unix stream socket
+        ./server unix-seq:/tmp/echo.sock  Unix seqpacket socket
+        ./server unix:@echo               Linux abstract socket ( no file )
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "endpoint.h"
+
+#define DEFAULT_ADDR "3490"
+#define BACKLOG 10
+
+int main( int argc, char *argv[] ) {
+
+    endpoint_t ep;
+    char name[ 300 ];
+    char buffer[ 1024 ];
+
+    if( argc > 2 ) {
+        printf( "Usage : %s [address]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+    // Parse the address : its prefix picks the socket family and type
+    if( endpoint_parse( argc == 2 ? argv[ 1 ] : DEFAULT_ADDR, &ep ) == -1 ) {
+        fprintf( stderr, "bad address: %s\n", argv[ 1 ] );
+        exit( 1 );
+    }
+
+    int sockfd = endpoint_listen( &ep, BACKLOG );
+
+    if( sockfd == -1 ) {
+        perror( "listen" );
+        exit( 1 );
+    }
+
+    printf( "Server is listening on %s...\n", endpoint_name( &ep, name, sizeof name ) );
+
+    // Serve clients one after another
+    while( 1 ) {
+
+        int new_fd = accept( sockfd, NULL, NULL );
+
+        if( new_fd == -1 ) {
+            perror( "accept" );
+            continue;
+        }
+
+        // Communication loop
+        while( 1 ) {
+
+            // SOCK_SEQPACKET : one recv() = one whole message
+            // SOCK_STREAM    : one recv() = whatever bytes are there
+            int bytes = recv( new_fd, buffer, sizeof buffer - 1, 0 );
+
+            if( bytes == -1 ) {
+                perror( "recv" );
+                break;
+            }
+
+            if( bytes == 0 ) {
+                printf( "Client disconnected\n" );
+                break;
+            }
+
+            buffer[ bytes ] = '\0';
+
+            printf( "Client says: %s\n", buffer );
+
+            // Echo back
+            if( send( new_fd, buffer, bytes, 0 ) == -1 ) {
+                perror( "send" );
+                break;
+            }
+        }
+
+        close( new_fd );
+    }
+
+    close( sockfd );
+
+    return 0;
+}
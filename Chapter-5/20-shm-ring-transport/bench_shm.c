@@ -0,0 +1,355 @@
+/*
+    bench_shm.c
+
+    Shared-memory rings versus sockets for same-host request / response
+
+    Transports ( child process echoes, parent measures ):
+        shm spin      : ring pair, reader spins before sleeping
+        shm sleep     : ring pair, reader sleeps on eventfd at once ( -s 0 )
+        unix socket   : AF_UNIX stream socketpair
+        tcp loopback  : 127.0.0.1
+
+    Measurements:
+        latency    : ping-pong, one request outstanding, p50 / p99
+        throughput : requests pipelined in windows of W, responses/sec
+        syscalls   : eventfd wakeups per request on the shm path
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 bench_shm.c shmring.c -o bench_shm
+
+    Run:
+        ./bench_shm
+        ./bench_shm -n 200000 -s 256 -w 64
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "shmring.h"
+
+long iters = 100000;        // -n
+size_t msg_size = 64;       // -s
+int window = 32;            // -w : pipelined requests in flight
+
+// one transport = how to send / receive one message on an endpoint
+typedef struct {
+    int fd;
+    shm_chan_t *ch;
+} link_t;
+
+
+
+/* ================= HELPERS ================= */
+
+double now_us( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+
+int cmp_double( const void *a, const void *b ) {
+
+    double x = *( const double * ) a, y = *( const double * ) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+
+int link_send( link_t *l, const char *buf, size_t len ) {
+
+    if( l -> ch ) {
+        return shm_send( l -> ch, buf, len );
+    }
+
+    size_t sent = 0;
+
+    while( sent < len ) {
+
+        ssize_t n = send( l -> fd, buf + sent, len - sent, MSG_NOSIGNAL );
+
+        if( n <= 0 ) {
+            return -1;
+        }
+
+        sent += n;
+    }
+
+    return 0;
+}
+
+
+int link_recv( link_t *l, char *buf, size_t len ) {
+
+    if( l -> ch ) {
+        return shm_recv( l -> ch, buf, len ) == ( long ) len ? 0 : -1;
+    }
+
+    size_t got = 0;
+
+    while( got < len ) {
+
+        ssize_t n = recv( l -> fd, buf + got, len - got, 0 );
+
+        if( n <= 0 ) {
+            return -1;
+        }
+
+        got += n;
+    }
+
+    return 0;
+}
+
+
+// connected TCP pair over loopback
+int tcp_pair( int sv[ 2 ] ) {
+
+    struct sockaddr_in addr;
+    socklen_t len = sizeof addr;
+    int one = 1;
+
+    memset( &addr, 0, sizeof addr );
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+    int lfd = socket( AF_INET, SOCK_STREAM, 0 );
+
+    // port 0 : kernel picks a free port
+    if( bind( lfd, ( struct sockaddr * ) &addr, sizeof addr ) == -1 || listen( lfd, 1 ) == -1 ) {
+        return -1;
+    }
+
+    getsockname( lfd, ( struct sockaddr * ) &addr, &len );
+
+    sv[ 0 ] = socket( AF_INET, SOCK_STREAM, 0 );
+
+    if( connect( sv[ 0 ], ( struct sockaddr * ) &addr, sizeof addr ) == -1 ) {
+        return -1;
+    }
+
+    sv[ 1 ] = accept( lfd, NULL, NULL );
+    close( lfd );
+
+    setsockopt( sv[ 0 ], IPPROTO_TCP, TCP_NODELAY, &one, sizeof one );
+    setsockopt( sv[ 1 ], IPPROTO_TCP, TCP_NODELAY, &one, sizeof one );
+
+    return sv[ 1 ] == -1 ? -1 : 0;
+}
+
+
+
+/* ================= ONE RUN ================= */
+
+typedef enum { T_SHM_SPIN, T_SHM_SLEEP, T_UNIX, T_TCP } kind_t;
+
+const char *kind_name[] = { "shm spin", "shm sleep", "unix socket", "tcp loopback" };
+
+
+// fork an echo child for this transport, parent gets its end in *l
+pid_t start_echo( kind_t kind, link_t *l, shm_chan_t *ch ) {
+
+    int sv[ 2 ];
+
+    if( kind == T_TCP ) {
+
+        if( tcp_pair( sv ) == -1 ) {
+            return -1;
+        }
+
+    } else if( socketpair( AF_UNIX, SOCK_STREAM, 0, sv ) == -1 ) {
+        return -1;
+    }
+
+    int is_shm = kind == T_SHM_SPIN || kind == T_SHM_SLEEP;
+    int spin = kind == T_SHM_SPIN ? SHM_DEFAULT_SPIN : 0;
+
+    pid_t pid = fork();
+
+    if( pid == 0 ) {
+
+        close( sv[ 0 ] );
+
+        shm_chan_t cch;
+        link_t cl = { sv[ 1 ], NULL };
+
+        if( is_shm ) {
+
+            // fds arrive over the socket, exactly like server.c
+            if( shm_chan_accept( &cch, sv[ 1 ] ) == -1 ) {
+                _exit( 1 );
+            }
+
+            cch.spin = spin;
+            cl.ch = &cch;
+        }
+
+        char *buf = malloc( msg_size );
+
+        while( link_recv( &cl, buf, msg_size ) == 0 && link_send( &cl, buf, msg_size ) == 0 ) {
+        }
+
+        _exit( 0 );
+    }
+
+    close( sv[ 1 ] );
+
+    l -> fd = sv[ 0 ];
+    l -> ch = NULL;
+
+    if( is_shm ) {
+
+        if( shm_chan_create( ch, SHM_DEFAULT_RING ) == -1 || shm_chan_send( ch, sv[ 0 ] ) == -1 ) {
+            return -1;
+        }
+
+        ch -> spin = spin;
+        l -> ch = ch;
+    }
+
+    return pid;
+}
+
+
+void stop_echo( pid_t pid, link_t *l ) {
+
+    if( l -> ch ) {
+        shm_chan_close( l -> ch );      // closes the socket too
+    } else {
+        close( l -> fd );
+    }
+
+    waitpid( pid, NULL, 0 );
+}
+
+
+void run_one( kind_t kind ) {
+
+    link_t l;
+    shm_chan_t ch;
+    char *buf = calloc( 1, msg_size );
+    double *rtt = malloc( sizeof *rtt * iters );
+
+    /* LATENCY */
+
+    pid_t pid = start_echo( kind, &l, &ch );
+
+    if( pid == -1 ) {
+        printf( "%-13s setup failed: %s\n", kind_name[ kind ], strerror( errno ) );
+        return;
+    }
+
+    for( long i = 0; i < iters; i++ ) {
+
+        double t0 = now_us();
+
+        if( link_send( &l, buf, msg_size ) == -1 || link_recv( &l, buf, msg_size ) == -1 ) {
+            printf( "%-13s echo failed\n", kind_name[ kind ] );
+            exit( 1 );
+        }
+
+        rtt[ i ] = now_us() - t0;
+    }
+
+    unsigned long long wakeups = l.ch ? l.ch -> wakeups_sent : 0;
+
+    stop_echo( pid, &l );
+
+    qsort( rtt, iters, sizeof *rtt, cmp_double );
+
+    /* THROUGHPUT : keep 'window' requests in flight */
+
+    pid = start_echo( kind, &l, &ch );
+
+    if( pid == -1 ) {
+        printf( "%-13s setup failed: %s\n", kind_name[ kind ], strerror( errno ) );
+        return;
+    }
+
+    double t0 = now_us();
+    long sent = 0, done = 0;
+
+    while( done < iters ) {
+
+        while( sent < iters && sent - done < window ) {
+            link_send( &l, buf, msg_size );
+            sent++;
+        }
+
+        if( link_recv( &l, buf, msg_size ) == -1 ) {
+            printf( "%-13s echo failed\n", kind_name[ kind ] );
+            exit( 1 );
+        }
+
+        done++;
+    }
+
+    double secs = ( now_us() - t0 ) / 1e6;
+
+    stop_echo( pid, &l );
+
+    printf( "%-13s %9.2f %9.2f %12.0f %14.0f",
+            kind_name[ kind ], rtt[ iters / 2 ], rtt[ ( long ) ( iters * 0.99 ) ],
+            1e6 / rtt[ iters / 2 ], iters / secs );
+
+    if( kind == T_SHM_SPIN || kind == T_SHM_SLEEP ) {
+        printf( " %10.3f", ( double ) wakeups / iters );
+    }
+
+    printf( "\n" );
+
+    free( buf );
+    free( rtt );
+}
+
+
+
+/* ================= MAIN ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:s:w:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'n': iters = atol( optarg ); break;
+            case 's': msg_size = strtoul( optarg, NULL, 10 ); break;
+            case 'w': window = atoi( optarg ); break;
+            default:
+                fprintf( stderr, "usage: %s [-n requests] [-s size] [-w window]\n", argv[ 0 ] );
+                exit( 1 );
+        }
+    }
+
+    if( iters < 1 || msg_size == 0 || msg_size > SHM_DEFAULT_RING / 4 || window < 1 ) {
+        fprintf( stderr, "bad arguments\n" );
+        exit( 1 );
+    }
+
+    signal( SIGPIPE, SIG_IGN );
+
+    printf( "%ld requests x %zu B, pipelined window %d\n\n", iters, msg_size, window );
+    printf( "%-13s %9s %9s %12s %14s %10s\n", "transport", "p50 us", "p99 us", "round trip/s", "pipelined/s", "wakeups/rq" );
+
+    for( int k = T_SHM_SPIN; k <= T_TCP; k++ ) {
+        fflush( stdout );
+        run_one( k );
+    }
+
+    return 0;
+}
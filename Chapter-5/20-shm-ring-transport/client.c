@@ -0,0 +1,90 @@
+/*
+    Shared-Memory Echo Client
+    ( 4-TCP-send-recv/client.c over a shared-memory ring pair )
+
+    - connects to the server's Unix socket
+    - creates the memfd rings + eventfds and passes them with SCM_RIGHTS
+    - every message afterwards goes through shared memory
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 client.c shmring.c -o client
+
+    Run:
+        ./client                      ( /tmp/shm-echo.sock )
+        ./client /tmp/other.sock
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "shmring.h"
+
+#define SOCK_PATH "/tmp/shm-echo.sock"
+
+int main( int argc, char *argv[] ) {
+
+    const char *path = argc > 1 ? argv[ 1 ] : SOCK_PATH;
+    char msg[ 1024 ], buffer[ 1024 ];
+
+    struct sockaddr_un addr;
+
+    memset( &addr, 0, sizeof addr );
+    addr.sun_family = AF_UNIX;
+    strncpy( addr.sun_path, path, sizeof addr.sun_path - 1 );
+
+    int sockfd = socket( AF_UNIX, SOCK_STREAM, 0 );
+
+    if( sockfd == -1 || connect( sockfd, ( struct sockaddr * ) &addr, sizeof addr ) == -1 ) {
+        printf( "Failed to connect\n" );
+        exit( 1 );
+    }
+
+    // Build the rings and hand them to the server
+    shm_chan_t ch;
+
+    if( shm_chan_create( &ch, SHM_DEFAULT_RING ) == -1 || shm_chan_send( &ch, sockfd ) == -1 ) {
+        perror( "shm channel" );
+        exit( 1 );
+    }
+
+    // Chat loop
+    while( 1 ) {
+
+        printf( "Enter message ( type exit to quit ): " );
+
+        if( fgets( msg, sizeof msg, stdin ) == NULL ) {
+            break;
+        }
+
+        // Exit condition
+        if( strncmp( msg, "exit", 4 ) == 0 ) {
+            break;
+        }
+
+        // Send message
+        if( shm_send( &ch, msg, strlen( msg ) ) == -1 ) {
+            perror( "shm_send" );
+            break;
+        }
+
+        // Receive echo
+        long bytes = shm_recv( &ch, buffer, sizeof buffer - 1 );
+
+        if( bytes == -1 ) {
+            printf( "Server closed connection\n" );
+            break;
+        }
+
+        buffer[ bytes ] = '\0';
+
+        printf( "Server replied : %s\n", buffer );
+    }
+
+    shm_chan_close( &ch );      // closing the socket tells the server we left
+
+    return 0;
+}
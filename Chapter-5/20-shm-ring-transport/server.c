@@ -0,0 +1,144 @@
+/*
+    Shared-Memory Echo Server
+    ( 4-TCP-send-recv/server.c with the data path moved into shared memory )
+
+    - listens on a Unix socket only to receive the ring fds
+    - echoes every message back through the shared-memory ring pair
+    - no send() / recv() per message : just memcpy + index updates
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 server.c shmring.c -o server
+
+    Run:
+        ./server                      ( /tmp/shm-echo.sock )
+        ./server /tmp/other.sock
+        ./server -s 0                 ( never spin : sleep on eventfd at once )
+
+    Linux only ( memfd_create, eventfd )
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "shmring.h"
+
+#define SOCK_PATH "/tmp/shm-echo.sock"
+#define MAX_MSG 65536
+
+int main( int argc, char *argv[] ) {
+
+    const char *path = SOCK_PATH;
+    int spin = -1;      // -1 : library default
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "s:" ) ) != -1 ) {
+
+        if( opt == 's' ) {
+            spin = atoi( optarg );
+        } else {
+            fprintf( stderr, "usage: %s [-s spin] [socket-path]\n", argv[ 0 ] );
+            exit( 1 );
+        }
+    }
+
+    if( optind < argc ) {
+        path = argv[ optind ];
+    }
+
+    // Unix socket : only used to pass fds and to notice when a client dies
+    struct sockaddr_un addr;
+
+    memset( &addr, 0, sizeof addr );
+    addr.sun_family = AF_UNIX;
+    strncpy( addr.sun_path, path, sizeof addr.sun_path - 1 );
+
+    int sockfd = socket( AF_UNIX, SOCK_STREAM, 0 );
+
+    // remove a socket file left by a previous run, but nothing else
+    struct stat st;
+
+    if( lstat( path, &st ) == 0 ) {
+
+        if( !S_ISSOCK( st.st_mode ) ) {
+            fprintf( stderr, "%s exists and is not a socket\n", path );
+            exit( 1 );
+        }
+
+        unlink( path );
+    }
+
+    if( sockfd == -1 || bind( sockfd, ( struct sockaddr * ) &addr, sizeof addr ) == -1 ) {
+        perror( "bind" );
+        exit( 1 );
+    }
+
+    if( listen( sockfd, 10 ) == -1 ) {
+        perror( "listen" );
+        exit( 1 );
+    }
+
+    printf( "Server is listening on %s...\n", path );
+
+    char *buffer = malloc( MAX_MSG + 1 );
+
+    while( 1 ) {
+
+        int new_fd = accept( sockfd, NULL, NULL );
+
+        if( new_fd == -1 ) {
+            perror( "accept" );
+            continue;
+        }
+
+        shm_chan_t ch;
+
+        // client sends memfd + eventfds right after connecting
+        if( shm_chan_accept( &ch, new_fd ) == -1 ) {
+            perror( "shm_chan_accept" );
+            close( new_fd );
+            continue;
+        }
+
+        if( spin >= 0 ) {
+            ch.spin = spin;
+        }
+
+        printf( "Client attached ( ring %llu bytes per direction )\n",
+                ( unsigned long long ) ch.rx.hdr -> size );
+
+        unsigned long long msgs = 0;
+
+        // Communication loop
+        while( 1 ) {
+
+            long bytes = shm_recv( &ch, buffer, MAX_MSG );
+
+            if( bytes == -1 ) {
+                printf( "Client disconnected\n" );
+                break;
+            }
+
+            msgs++;
+
+            // Echo back
+            if( shm_send( &ch, buffer, bytes ) == -1 ) {
+                perror( "shm_send" );
+                break;
+            }
+        }
+
+        printf( "messages: %llu | eventfd wakeups sent: %llu | sleeps: %llu\n",
+                msgs, ch.wakeups_sent, ch.sleeps );
+
+        shm_chan_close( &ch );      // also closes new_fd
+    }
+
+    close( sockfd );
+
+    return 0;
+}
@@ -0,0 +1,413 @@
+/*
+    shmring.c
+
+    memfd-backed SPSC ring pair with elided eventfd wakeups ( see shmring.h )
+
+    Linux only : memfd_create(), eventfd()
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+
+#include "shmring.h"
+
+#define HDR_BYTES 4096                  // ring header gets its own page
+#define REC_HDR 8                       // uint32 length + 4 bytes padding
+#define WRAP_MARK 0xFFFFFFFFu           // "skip to the start of the ring"
+
+// tell the CPU we are in a spin loop ( saves power, helps the sibling hyperthread )
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define cpu_relax() __builtin_ia32_pause()
+#elif defined( __aarch64__ )
+#define cpu_relax() __asm__ __volatile__( "yield" )
+#else
+#define cpu_relax() do { } while( 0 )
+#endif
+
+
+/* ================= SETUP ================= */
+
+// spinning only helps when the peer runs on another core at the same time
+static int default_spin( void ) {
+
+    return sysconf( _SC_NPROCESSORS_ONLN ) > 1 ? SHM_DEFAULT_SPIN : 0;
+}
+
+
+static size_t round_pow2( size_t n ) {
+
+    size_t p = 4096;
+
+    while( p < n ) {
+        p <<= 1;
+    }
+
+    return p;
+}
+
+
+// point both rings into the mapping, 'flip' swaps directions for the peer
+static int map_rings( shm_chan_t *ch, size_t ring_bytes, int flip ) {
+
+    ch -> map_len = 2 * ( HDR_BYTES + ring_bytes );
+    ch -> map = mmap( NULL, ch -> map_len, PROT_READ | PROT_WRITE, MAP_SHARED, ch -> memfd, 0 );
+
+    if( ch -> map == MAP_FAILED ) {
+        return -1;
+    }
+
+    shm_ring_t r[ 2 ];
+
+    for( int i = 0; i < 2; i++ ) {
+
+        char *base = ( char * ) ch -> map + i * ( HDR_BYTES + ring_bytes );
+
+        r[ i ].hdr = ( shm_ring_hdr_t * ) base;
+        r[ i ].data = base + HDR_BYTES;
+        r[ i ].data_efd = ch -> efd[ 2 * i ];
+        r[ i ].space_efd = ch -> efd[ 2 * i + 1 ];
+    }
+
+    ch -> tx = r[ flip ];
+    ch -> rx = r[ !flip ];
+
+    return 0;
+}
+
+
+int shm_chan_create( shm_chan_t *ch, size_t ring_bytes ) {
+
+    memset( ch, 0, sizeof *ch );
+
+    ch -> ctl = -1;
+    ch -> spin = default_spin();
+
+    ring_bytes = round_pow2( ring_bytes );
+
+    ch -> memfd = memfd_create( "shmring", MFD_CLOEXEC );
+
+    if( ch -> memfd == -1 ) {
+        return -1;
+    }
+
+    // fresh memfd pages are zero : indexes and flags start at 0
+    if( ftruncate( ch -> memfd, 2 * ( HDR_BYTES + ring_bytes ) ) == -1 ) {
+        return -1;
+    }
+
+    for( int i = 0; i < 4; i++ ) {
+
+        ch -> efd[ i ] = eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK );
+
+        if( ch -> efd[ i ] == -1 ) {
+            return -1;
+        }
+    }
+
+    if( map_rings( ch, ring_bytes, 0 ) == -1 ) {
+        return -1;
+    }
+
+    ch -> tx.hdr -> size = ring_bytes;
+    ch -> rx.hdr -> size = ring_bytes;
+
+    return 0;
+}
+
+
+int shm_chan_send( shm_chan_t *ch, int unix_sock ) {
+
+    uint64_t ring_bytes = ch -> tx.hdr -> size;
+    int fds[ 5 ] = { ch -> memfd, ch -> efd[ 0 ], ch -> efd[ 1 ], ch -> efd[ 2 ], ch -> efd[ 3 ] };
+
+    // control message buffer, aligned for struct cmsghdr
+    union {
+        char buf[ CMSG_SPACE( sizeof fds ) ];
+        struct cmsghdr align;
+    } u;
+
+    struct iovec iov = { &ring_bytes, sizeof ring_bytes };
+    struct msghdr msg = { 0 };
+
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = u.buf;
+    msg.msg_controllen = sizeof u.buf;
+
+    struct cmsghdr *cm = CMSG_FIRSTHDR( &msg );
+
+    cm -> cmsg_level = SOL_SOCKET;
+    cm -> cmsg_type = SCM_RIGHTS;
+    cm -> cmsg_len = CMSG_LEN( sizeof fds );
+    memcpy( CMSG_DATA( cm ), fds, sizeof fds );
+
+    if( sendmsg( unix_sock, &msg, 0 ) == -1 ) {
+        return -1;
+    }
+
+    ch -> ctl = unix_sock;
+
+    return 0;
+}
+
+
+int shm_chan_accept( shm_chan_t *ch, int unix_sock ) {
+
+    memset( ch, 0, sizeof *ch );
+
+    ch -> ctl = -1;
+    ch -> spin = default_spin();
+
+    uint64_t ring_bytes;
+    int fds[ 5 ];
+
+    union {
+        char buf[ CMSG_SPACE( sizeof fds ) ];
+        struct cmsghdr align;
+    } u;
+
+    struct iovec iov = { &ring_bytes, sizeof ring_bytes };
+    struct msghdr msg = { 0 };
+
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = u.buf;
+    msg.msg_controllen = sizeof u.buf;
+
+    if( recvmsg( unix_sock, &msg, MSG_CMSG_CLOEXEC ) != sizeof ring_bytes ) {
+        return -1;
+    }
+
+    struct cmsghdr *cm = CMSG_FIRSTHDR( &msg );
+
+    if( cm == NULL || cm -> cmsg_type != SCM_RIGHTS || cm -> cmsg_len != CMSG_LEN( sizeof fds ) ) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    memcpy( fds, CMSG_DATA( cm ), sizeof fds );
+
+    ch -> memfd = fds[ 0 ];
+    memcpy( ch -> efd, fds + 1, sizeof ch -> efd );
+
+    if( map_rings( ch, ring_bytes, 1 ) == -1 ) {
+        return -1;
+    }
+
+    ch -> ctl = unix_sock;
+
+    return 0;
+}
+
+
+void shm_chan_close( shm_chan_t *ch ) {
+
+    if( ch -> map && ch -> map != MAP_FAILED ) {
+        munmap( ch -> map, ch -> map_len );
+    }
+
+    close( ch -> memfd );
+
+    for( int i = 0; i < 4; i++ ) {
+        close( ch -> efd[ i ] );
+    }
+
+    if( ch -> ctl != -1 ) {
+        close( ch -> ctl );
+    }
+
+    ch -> map = NULL;
+}
+
+
+
+/* ================= WAKEUPS ================= */
+
+// peer wrote 'flag = 1' before sleeping : only then pay for the syscall
+static void wake( shm_chan_t *ch, uint32_t *flag, int efd ) {
+
+    // pairs with the fence in sleep_on() : one of the two sides sees the other
+    __atomic_thread_fence( __ATOMIC_SEQ_CST );
+
+    if( __atomic_load_n( flag, __ATOMIC_RELAXED ) ) {
+
+        uint64_t one = 1;
+
+        if( write( efd, &one, sizeof one ) == sizeof one ) {
+            ch -> wakeups_sent++;
+        }
+    }
+}
+
+
+// spin, then sleep until ready( ring ) is true, -1 if the peer went away
+static int sleep_on( shm_chan_t *ch, shm_ring_t *r, uint32_t *flag, int efd,
+                     int ( *ready )( shm_ring_t *, uint64_t ), uint64_t arg ) {
+
+    // phase 1 : spin ( no syscalls, no wakeup needed from the peer )
+    for( int i = 0; i < ch -> spin; i++ ) {
+
+        if( ready( r, arg ) ) {
+            return 0;
+        }
+
+        cpu_relax();
+    }
+
+    // phase 2 : announce we are sleeping, re-check, block
+    while( 1 ) {
+
+        __atomic_store_n( flag, 1, __ATOMIC_RELAXED );
+        __atomic_thread_fence( __ATOMIC_SEQ_CST );
+
+        if( ready( r, arg ) ) {
+            __atomic_store_n( flag, 0, __ATOMIC_RELAXED );
+            return 0;
+        }
+
+        struct pollfd pfd[ 2 ] = {
+            { efd, POLLIN, 0 },
+            { ch -> ctl, POLLIN, 0 },       // EOF here = peer process is gone
+        };
+
+        ch -> sleeps++;
+
+        int n = poll( pfd, ch -> ctl == -1 ? 1 : 2, -1 );
+
+        __atomic_store_n( flag, 0, __ATOMIC_RELAXED );
+
+        if( n == -1 && errno != EINTR ) {
+            return -1;
+        }
+
+        if( pfd[ 0 ].revents & POLLIN ) {
+
+            uint64_t v;
+
+            // drain the counter ( non-blocking eventfd )
+            if( read( efd, &v, sizeof v ) == -1 && errno != EAGAIN ) {
+                return -1;
+            }
+        }
+
+        if( ready( r, arg ) ) {
+            return 0;
+        }
+
+        if( pfd[ 1 ].revents & ( POLLIN | POLLHUP | POLLERR ) ) {
+            errno = EPIPE;
+            return -1;
+        }
+    }
+}
+
+
+static int has_data( shm_ring_t *r, uint64_t tail ) {
+
+    return __atomic_load_n( &r -> hdr -> head, __ATOMIC_ACQUIRE ) != tail;
+}
+
+
+static int has_space( shm_ring_t *r, uint64_t need ) {
+
+    uint64_t used = r -> hdr -> head - __atomic_load_n( &r -> hdr -> tail, __ATOMIC_ACQUIRE );
+
+    return r -> hdr -> size - used >= need;
+}
+
+
+
+/* ================= SEND / RECEIVE ================= */
+
+int shm_send( shm_chan_t *ch, const void *msg, uint32_t len ) {
+
+    shm_ring_t *r = &ch -> tx;
+    uint64_t size = r -> hdr -> size;
+
+    if( len > size / 4 ) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    uint64_t rec = REC_HDR + ( ( len + 7 ) & ~7u );
+    uint64_t head = r -> hdr -> head;       // only we write head
+    uint64_t off = head & ( size - 1 );
+    uint64_t room = size - off;
+
+    // record would cross the end : also pay for the skipped bytes
+    uint64_t need = rec > room ? rec + room : rec;
+
+    if( !has_space( r, need ) ) {
+
+        if( sleep_on( ch, r, &r -> hdr -> writer_sleeping, r -> space_efd, has_space, need ) == -1 ) {
+            return -1;
+        }
+    }
+
+    if( rec > room ) {
+
+        *( uint32_t * ) ( r -> data + off ) = WRAP_MARK;
+        head += room;
+        off = 0;
+    }
+
+    *( uint32_t * ) ( r -> data + off ) = len;
+    memcpy( r -> data + off + REC_HDR, msg, len );
+
+    // publish : the consumer sees the bytes before it sees the new head
+    __atomic_store_n( &r -> hdr -> head, head + rec, __ATOMIC_RELEASE );
+
+    wake( ch, &r -> hdr -> reader_sleeping, r -> data_efd );
+
+    return 0;
+}
+
+
+long shm_recv( shm_chan_t *ch, void *buf, uint32_t cap ) {
+
+    shm_ring_t *r = &ch -> rx;
+    uint64_t size = r -> hdr -> size;
+
+    while( 1 ) {
+
+        uint64_t tail = r -> hdr -> tail;   // only we write tail
+
+        if( !has_data( r, tail ) ) {
+
+            if( sleep_on( ch, r, &r -> hdr -> reader_sleeping, r -> data_efd, has_data, tail ) == -1 ) {
+                return -1;
+            }
+        }
+
+        uint64_t off = tail & ( size - 1 );
+        uint32_t len = *( uint32_t * ) ( r -> data + off );
+
+        if( len == WRAP_MARK ) {
+            __atomic_store_n( &r -> hdr -> tail, tail + ( size - off ), __ATOMIC_RELEASE );
+            continue;
+        }
+
+        if( len > cap ) {
+            errno = EMSGSIZE;
+            return -1;
+        }
+
+        memcpy( buf, r -> data + off + REC_HDR, len );
+
+        // free the slot : the producer may reuse it after this store
+        __atomic_store_n( &r -> hdr -> tail, tail + REC_HDR + ( ( len + 7 ) & ~7u ), __ATOMIC_RELEASE );
+
+        wake( ch, &r -> hdr -> writer_sleeping, r -> space_efd );
+
+        return len;
+    }
+}
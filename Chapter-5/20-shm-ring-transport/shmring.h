@@ -0,0 +1,88 @@
+/*
+    shmring.h
+
+    Shared-memory request / response channel for two processes on one host
+
+    - one memfd holds two single-producer / single-consumer byte rings
+        ring 0 : creator → peer
+        ring 1 : peer    → creator
+    - messages are length-prefixed records, copied once into the ring
+    - wakeups use eventfds, but only when the other side is really asleep :
+      a reader first spins, then sets a "sleeping" flag, and the writer
+      only calls write() on the eventfd if it sees that flag
+    - the memfd and the 4 eventfds travel to the peer over a Unix socket
+      ( SCM_RIGHTS ), which also tells each side when the other one dies
+
+    Flow:
+        creator : shm_chan_create()  → shm_chan_send( unix_sock )
+        peer    : shm_chan_accept( unix_sock )
+        both    : shm_send() / shm_recv()  → shm_chan_close()
+*/
+
+#ifndef SHMRING_H
+#define SHMRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHM_DEFAULT_RING ( 1 << 20 )     // 1 MiB per direction
+#define SHM_DEFAULT_SPIN 2000            // polls before going to sleep ( 0 on one-core hosts )
+
+
+// ring indexes live on their own cache lines : producer and consumer never false-share
+typedef struct {
+
+    _Alignas( 64 ) uint64_t head;       // bytes ever written   ( producer )
+    _Alignas( 64 ) uint64_t tail;       // bytes ever consumed  ( consumer )
+    _Alignas( 64 ) uint32_t reader_sleeping;
+    _Alignas( 64 ) uint32_t writer_sleeping;
+    _Alignas( 64 ) uint64_t size;       // data bytes, power of two
+
+} shm_ring_hdr_t;
+
+typedef struct {
+
+    shm_ring_hdr_t *hdr;
+    char *data;
+    int data_efd;       // producer → consumer : "there is data"
+    int space_efd;      // consumer → producer : "there is room"
+
+} shm_ring_t;
+
+typedef struct {
+
+    void *map;
+    size_t map_len;
+    int memfd;
+    int efd[ 4 ];       // data0, space0, data1, space1
+    int ctl;            // Unix socket to the peer ( -1 if not connected )
+    int spin;           // polls before sleeping, 0 = sleep at once
+
+    shm_ring_t tx;      // we produce
+    shm_ring_t rx;      // we consume
+
+    unsigned long long wakeups_sent;    // eventfd writes we had to do
+    unsigned long long sleeps;          // times we really blocked
+
+} shm_chan_t;
+
+
+// creator side : memfd + eventfds, ring_bytes rounded up to a power of two
+int shm_chan_create( shm_chan_t *ch, size_t ring_bytes );
+
+// creator side : hand memfd + eventfds to the peer over a connected Unix socket
+int shm_chan_send( shm_chan_t *ch, int unix_sock );
+
+// peer side : receive the fds, map the rings ( directions swapped )
+int shm_chan_accept( shm_chan_t *ch, int unix_sock );
+
+// blocking send of one message ( len <= ring size / 4 ), 0 or -1 if the peer is gone
+int shm_send( shm_chan_t *ch, const void *msg, uint32_t len );
+
+// blocking receive of one message, returns its length, -1 if the peer is gone
+// or the message does not fit into cap
+long shm_recv( shm_chan_t *ch, void *buf, uint32_t cap );
+
+void shm_chan_close( shm_chan_t *ch );
+
+#endif
@@ -0,0 +1,32 @@
+#!/bin/sh
+#
+#   bench.sh
+#
+#   Echo packets/sec for recvmmsg batch sizes 1 .. 64
+#
+#   Usage:
+#       ./bench.sh [seconds] [sockets] [window] [size]
+#
+#   Example:
+#       ./bench.sh 5 16 64 64
+
+SECS=${1:-5}
+SOCKS=${2:-16}
+WINDOW=${3:-64}
+SIZE=${4:-64}
+PORT=34910
+
+echo "batch  result"
+
+for b in 1 2 4 8 16 32 64; do
+
+    ./server -b "$b" -p "$PORT" > /dev/null &
+    SERVER=$!
+    sleep 0.3
+
+    printf "%-6s " "$b"
+    ./udp_blast 127.0.0.1 "$PORT" -S "$SOCKS" -w "$WINDOW" -z "$SIZE" -d "$SECS"
+
+    kill "$SERVER"
+    wait "$SERVER" 2> /dev/null
+done
@@ -0,0 +1,43 @@
+/*
+    sendbatch.c
+
+    sendmmsg() over a whole batch ( see sendbatch.h )
+
+    Compile together with the program that uses it:
+        gcc -Wall -Wextra -pedantic -O2 sendbatch.c your_program.c -o your_program
+*/
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <sys/socket.h>
+
+#include "sendbatch.h"
+
+
+int send_batch( int fd, struct mmsghdr *msgs, int n, unsigned long long *errors ) {
+
+    int next = 0, sent = 0;
+
+    while( next < n ) {
+
+        int r = sendmmsg( fd, msgs + next, n - next, 0 );
+
+        if( r == -1 ) {
+
+            if( errno == EINTR ) {
+                continue;
+            }
+
+            // msgs[ next ] is the one that failed : skip it, keep the rest
+            ( *errors )++;
+            next++;
+            continue;
+        }
+
+        next += r;
+        sent += r;
+    }
+
+    return sent;
+}
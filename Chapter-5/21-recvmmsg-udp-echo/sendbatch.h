@@ -0,0 +1,33 @@
+/*
+    sendbatch.h
+
+    Sending a whole sendmmsg() batch, even when one message fails
+
+    sendmmsg() stops at the first message it cannot send : it returns
+    how many went out before it, or -1 if the very first one failed.
+
+        msgs   [ 0 ] [ 1 ] [ 2 ] [ 3 ] [ 4 ]
+                 ok    ok   fail
+        sendmmsg()          → 2
+        sendmmsg( msgs + 2 ) → -1    ( the bad one is now first )
+
+    Breaking out of the loop there drops every reply after the bad one,
+    for example all replies in the batch behind one client whose route
+    just went away. send_batch() skips the failing message, counts it,
+    and goes on with the rest.
+
+    Usage:
+        unsigned long long send_errors = 0;
+        int sent = send_batch( sockfd, msgs, n, &send_errors );
+*/
+
+#ifndef SENDBATCH_H
+#define SENDBATCH_H
+
+#include <sys/socket.h>
+
+// sends msgs[ 0 .. n ), skipping the ones that fail ( *errors += 1 each )
+// returns the number of messages actually sent
+int send_batch( int fd, struct mmsghdr *msgs, int n, unsigned long long *errors );
+
+#endif
@@ -0,0 +1,195 @@
+/*
+    server.c
+
+    Batched UDP echo server using recvmmsg() and sendmmsg()
+    ( 5-UDP-sendto-recvfrom/server.c without one syscall per datagram )
+
+    What it does :
+        - pulls up to N datagrams per recvmmsg() into preallocated buffers
+        - echoes them in place : sender address stays in each msg_name
+        - replies to the whole batch with a single sendmmsg()
+        - prints packets/sec and average batch fill once per second
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 server.c sendbatch.c -o server
+
+    Run:
+        ./server                  ( batch 32, port 3490 )
+        ./server -b 64 -p 3490
+        ./server -b 1 -v          ( print every message, like the original )
+
+    Linux only ( recvmmsg / sendmmsg )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+#include "sendbatch.h"
+
+#define PORT "3490"         // Port number as string
+#define MAX_BATCH 1024
+#define DGRAM_SIZE 2048     // Buffer per datagram
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = PORT;
+    int batch = 32;
+    int verbose = 0;
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "b:p:v" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'b': batch = atoi( optarg ); break;
+            case 'p': port = optarg; break;
+            case 'v': verbose = 1; break;
+            default:
+                fprintf( stderr, "usage: %s [-b batch] [-p port] [-v]\n", argv[ 0 ] );
+                exit( 1 );
+        }
+    }
+
+    if( batch < 1 || batch > MAX_BATCH ) {
+        fprintf( stderr, "batch must be 1..%d\n", MAX_BATCH );
+        exit( 1 );
+    }
+
+    struct addrinfo hints, *res, *p;
+    int sockfd;
+
+    // Clear garbage values of hints structure
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_UNSPEC;     // IPv4 or IPv6
+    hints.ai_socktype = SOCK_DGRAM;    // UDP socket
+    hints.ai_flags    = AI_PASSIVE;    // Use my IP
+
+    int status = getaddrinfo( NULL, port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    // Loop through all results and bind
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            continue;
+        }
+
+        if( bind( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            continue;
+        }
+
+        break;   // Successfully bound
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        printf( "Failed to bind\n" );
+        exit( 1 );
+    }
+
+    /* ================= PREALLOCATED BATCH ================= */
+
+    /*
+        One slot per datagram:
+            msgs[ i ]  → header the kernel fills ( length, sender address )
+            iov[ i ]   → points at bufs[ i ]
+            addrs[ i ] → sender address, reused as reply destination
+
+        Allocated once, reused for every batch : no per-packet malloc
+    */
+
+    struct mmsghdr *msgs = calloc( batch, sizeof *msgs );
+    struct iovec *iov = calloc( batch, sizeof *iov );
+    struct sockaddr_storage *addrs = calloc( batch, sizeof *addrs );
+    char *bufs = malloc( ( size_t ) batch * DGRAM_SIZE );
+
+    for( int i = 0; i < batch; i++ ) {
+
+        iov[ i ].iov_base = bufs + ( size_t ) i * DGRAM_SIZE;
+
+        msgs[ i ].msg_hdr.msg_iov = &iov[ i ];
+        msgs[ i ].msg_hdr.msg_iovlen = 1;
+        msgs[ i ].msg_hdr.msg_name = &addrs[ i ];
+    }
+
+    printf( "UDP Server listening on %s ( batch %d )...\n", port, batch );
+    fflush( stdout );
+
+    unsigned long long packets = 0, received = 0, calls = 0, send_errors = 0;
+    time_t last = time( NULL );
+
+    // Main communication loop
+    while( 1 ) {
+
+        // recvmmsg() overwrites lengths : reset them before every batch
+        for( int i = 0; i < batch; i++ ) {
+            iov[ i ].iov_len = DGRAM_SIZE;
+            msgs[ i ].msg_hdr.msg_namelen = sizeof addrs[ i ];
+        }
+
+        // block for the first datagram, then take whatever else is queued
+        int n = recvmmsg( sockfd, msgs, batch, MSG_WAITFORONE, NULL );
+
+        if( n == -1 ) {
+
+            if( errno != EINTR ) {
+                perror( "recvmmsg" );
+            }
+
+            continue;
+        }
+
+        // Process in place : reply length = received length, address already set
+        for( int i = 0; i < n; i++ ) {
+
+            iov[ i ].iov_len = msgs[ i ].msg_len;
+
+            if( verbose ) {
+                printf( "Client says: %.*s\n", ( int ) msgs[ i ].msg_len, ( char * ) iov[ i ].iov_base );
+            }
+        }
+
+        // Send the whole batch back, one syscall unless a reply fails
+        packets += send_batch( sockfd, msgs, n, &send_errors );
+        received += n;
+        calls++;
+
+        time_t now = time( NULL );
+
+        if( now != last ) {
+
+            printf( "%llu pkt/s | %.1f pkts per recvmmsg", packets / ( now - last ), ( double ) received / calls );
+
+            if( send_errors ) {
+                printf( " | %llu send errors", send_errors );
+            }
+
+            printf( "\n" );
+            fflush( stdout );
+
+            packets = received = calls = send_errors = 0;
+            last = now;
+        }
+    }
+
+    close( sockfd );   // Close socket
+
+    return 0;
+}
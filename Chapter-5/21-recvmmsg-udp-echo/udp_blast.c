@@ -0,0 +1,200 @@
+/*
+    udp_blast.c
+
+    UDP echo load generator
+
+    - S client sockets, each with its own source port
+    - every socket keeps up to W datagrams in flight ( sendmmsg )
+    - replies are drained with recvmmsg
+    - a window that stalls for 50 ms is written off as lost
+    - prints sent/s, replies/s and loss at the end
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 udp_blast.c -o udp_blast
+
+    Run:
+        ./udp_blast 127.0.0.1 3490                     ( 8 sockets, window 32, 5 s )
+        ./udp_blast 127.0.0.1 3490 -S 256 -w 16 -z 200 -d 10
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+
+#define MAX_WINDOW 1024
+#define STALL_MS 50
+
+
+double now_s( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+int main( int argc, char *argv[] ) {
+
+    int nsocks = 8;         // -S
+    int window = 32;        // -w
+    size_t size = 64;       // -z
+    int duration = 5;       // -d
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "S:w:z:d:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'S': nsocks = atoi( optarg ); break;
+            case 'w': window = atoi( optarg ); break;
+            case 'z': size = strtoul( optarg, NULL, 10 ); break;
+            case 'd': duration = atoi( optarg ); break;
+            default: goto usage;
+        }
+    }
+
+    if( argc - optind != 2 || nsocks < 1 || window < 1 || window > MAX_WINDOW || size == 0 || size > 65507 ) {
+usage:
+        fprintf( stderr, "usage: %s host port [-S sockets] [-w window] [-z size] [-d seconds]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+    // many sockets need many fds
+    struct rlimit rl;
+    getrlimit( RLIMIT_NOFILE, &rl );
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit( RLIMIT_NOFILE, &rl );
+
+    struct addrinfo hints, *res;
+
+    memset( &hints, 0, sizeof hints );
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    int status = getaddrinfo( argv[ optind ], argv[ optind + 1 ], &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    struct pollfd *pfds = calloc( nsocks, sizeof *pfds );
+    int *outstanding = calloc( nsocks, sizeof *outstanding );
+    double *last_reply = calloc( nsocks, sizeof *last_reply );
+
+    // connected UDP sockets : each gets its own ephemeral source port
+    for( int i = 0; i < nsocks; i++ ) {
+
+        pfds[ i ].fd = socket( res -> ai_family, res -> ai_socktype, res -> ai_protocol );
+        pfds[ i ].events = POLLIN;
+
+        if( pfds[ i ].fd == -1 || connect( pfds[ i ].fd, res -> ai_addr, res -> ai_addrlen ) == -1 ) {
+            perror( "socket/connect" );
+            exit( 1 );
+        }
+    }
+
+    freeaddrinfo( res );
+
+    // one payload, referenced by every send slot
+    char *payload = calloc( 1, size );
+    char *rbufs = malloc( ( size_t ) MAX_WINDOW * 2048 );
+
+    struct mmsghdr smsgs[ MAX_WINDOW ], rmsgs[ MAX_WINDOW ];
+    struct iovec siov = { payload, size }, riov[ MAX_WINDOW ];
+
+    memset( smsgs, 0, sizeof smsgs );
+    memset( rmsgs, 0, sizeof rmsgs );
+
+    for( int i = 0; i < MAX_WINDOW; i++ ) {
+
+        smsgs[ i ].msg_hdr.msg_iov = &siov;
+        smsgs[ i ].msg_hdr.msg_iovlen = 1;
+
+        riov[ i ].iov_base = rbufs + ( size_t ) i * 2048;
+        riov[ i ].iov_len = 2048;
+        rmsgs[ i ].msg_hdr.msg_iov = &riov[ i ];
+        rmsgs[ i ].msg_hdr.msg_iovlen = 1;
+    }
+
+    unsigned long long sent = 0, received = 0, lost = 0;
+
+    double start = now_s(), end = start + duration;
+
+    for( int i = 0; i < nsocks; i++ ) {
+        last_reply[ i ] = start;
+    }
+
+    while( now_s() < end ) {
+
+        /* FILL WINDOWS */
+        for( int i = 0; i < nsocks; i++ ) {
+
+            int room = window - outstanding[ i ];
+
+            if( room > 0 ) {
+
+                int n = sendmmsg( pfds[ i ].fd, smsgs, room, MSG_DONTWAIT );
+
+                if( n > 0 ) {
+                    outstanding[ i ] += n;
+                    sent += n;
+                }
+            }
+        }
+
+        /* COLLECT REPLIES */
+        poll( pfds, nsocks, 1 );
+
+        double now = now_s();
+
+        for( int i = 0; i < nsocks; i++ ) {
+
+            if( pfds[ i ].revents & POLLIN ) {
+
+                int n = recvmmsg( pfds[ i ].fd, rmsgs, MAX_WINDOW, MSG_DONTWAIT, NULL );
+
+                if( n > 0 ) {
+
+                    received += n;
+                    outstanding[ i ] -= n;
+
+                    if( outstanding[ i ] < 0 ) {
+                        outstanding[ i ] = 0;
+                    }
+
+                    last_reply[ i ] = now;
+                }
+            }
+
+            // nothing back for a while : the rest of the window was dropped
+            if( outstanding[ i ] > 0 && now - last_reply[ i ] > STALL_MS / 1000.0 ) {
+
+                lost += outstanding[ i ];
+                outstanding[ i ] = 0;
+                last_reply[ i ] = now;
+            }
+        }
+    }
+
+    double secs = now_s() - start;
+
+    printf( "sockets=%d window=%d size=%zu  sent %.0f pkt/s  replies %.0f pkt/s  lost %.2f%%\n",
+            nsocks, window, size, sent / secs, received / secs,
+            sent ? 100.0 * lost / sent : 0.0 );
+
+    for( int i = 0; i < nsocks; i++ ) {
+        close( pfds[ i ].fd );
+    }
+
+    return 0;
+}
@@ -0,0 +1,46 @@
+#!/bin/sh
+#
+#   scale.sh
+#
+#   UDP echo packets/sec and drops from 1 to N SO_REUSEPORT workers
+#
+#   Load comes from ../21-recvmmsg-udp-echo/udp_blast : many client sockets,
+#   so many source ports, so the kernel hash has many flows to spread
+#
+#   Usage:
+#       ./scale.sh [max-workers] [sockets] [window] [size] [seconds]
+#
+#   Example:
+#       ./scale.sh 8 256 32 64 5
+
+MAX=${1:-$( nproc )}
+SOCKS=${2:-256}
+WINDOW=${3:-32}
+SIZE=${4:-64}
+SECS=${5:-5}
+PORT=34930
+BLAST=${BLAST:-../21-recvmmsg-udp-echo/udp_blast}
+OUT=/tmp/reuseport-udp.$$
+
+echo "workers  client                                                                       server"
+
+n=1
+while [ "$n" -le "$MAX" ]; do
+
+    ./server -t "$n" -p "$PORT" > "$OUT" &
+    SERVER=$!
+    sleep 0.3
+
+    printf "%-8s " "$n"
+    "$BLAST" 127.0.0.1 "$PORT" -S "$SOCKS" -w "$WINDOW" -z "$SIZE" -d "$SECS" | tr -d '\n'
+
+    kill "$SERVER"
+    wait "$SERVER" 2> /dev/null
+
+    # last line of the summary : total packets and socket drops
+    tail -n 1 "$OUT" | awk '{ printf "  rx %s  dropped %s\n", $2, $3 }'
+
+    n=$(( n + 1 ))
+done
+
+rm -f "$OUT"
@@ -0,0 +1,374 @@
+/*
+    server.c
+
+    Multi-core UDP echo server sharded with SO_REUSEPORT
+    ( 5-UDP-sendto-recvfrom/server.c, one worker per core )
+
+    Every worker thread owns:
+        - a CPU core                 ( pthread_setaffinity_np )
+        - its own UDP socket         ( SO_REUSEPORT : kernel hashes each flow to one socket )
+        - its own receive queue      ( a full queue drops only that worker's packets )
+        - its own batch buffers      ( recvmmsg / sendmmsg, like 21-recvmmsg-udp-echo )
+        - its own counters           ( one cache line each )
+
+    Drops are read per socket from the SO_RXQ_OVFL cmsg :
+    the kernel's count of datagrams discarded because the receive queue was full.
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 -pthread -I../21-recvmmsg-udp-echo \
+            server.c ../21-recvmmsg-udp-echo/sendbatch.c -o server
+
+    Run:
+        ./server                    ( one worker per online core, port 3490 )
+        ./server -t 4 -p 3490 -v    ( 4 workers, per-worker pkt/s and drops every second )
+
+    Ctrl+C prints per-worker totals.
+
+    Linux only ( SO_REUSEPORT load balancing, SO_RXQ_OVFL, CPU affinity )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "sendbatch.h"
+
+#define PORT "3490"
+#define MAX_THREADS 256
+#define BATCH 64
+#define DGRAM_SIZE 2048
+#define RCVBUF ( 4 << 20 )
+
+
+// per-worker counters, padded so two workers never share a cache line
+typedef struct {
+
+    unsigned long long packets;     // datagrams received
+    unsigned long long bytes;
+    unsigned long long calls;       // recvmmsg() calls
+    unsigned long long drops;       // SO_RXQ_OVFL : dropped on this socket's queue
+    unsigned long long send_errors; // replies sendmmsg() could not send
+
+} __attribute__( ( aligned( 64 ) ) ) worker_stats_t;
+
+typedef struct {
+
+    int id;
+    int core;
+    const char *port;
+    pthread_t thread;
+    worker_stats_t stats;
+
+} worker_t;
+
+worker_t workers[ MAX_THREADS ];
+
+volatile sig_atomic_t stop = 0;
+
+
+
+/* ================= SOCKET ================= */
+
+// each worker binds its own socket to the same port
+int reuseport_udp_socket( const char *port ) {
+
+    struct addrinfo hints, *res, *p;
+    int sockfd = -1;
+    int yes = 1;
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_UNSPEC;     // IPv4 or IPv6
+    hints.ai_socktype = SOCK_DGRAM;    // UDP
+    hints.ai_flags    = AI_PASSIVE;    // Use my IP
+
+    int status = getaddrinfo( NULL, port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo error: %s\n", gai_strerror( status ) );
+        return -1;
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            continue;
+        }
+
+        // several sockets on one port : kernel hashes ( src ip, src port ) to one of them
+        setsockopt( sockfd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof yes );
+
+        // attach the per-socket drop counter to every received datagram
+        setsockopt( sockfd, SOL_SOCKET, SO_RXQ_OVFL, &yes, sizeof yes );
+
+        int rcvbuf = RCVBUF;
+        setsockopt( sockfd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof rcvbuf );
+
+        if( bind( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            continue;
+        }
+
+        break;   // Successfully bound
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        return -1;
+    }
+
+    return sockfd;
+}
+
+
+
+/* ================= WORKER ================= */
+
+void *worker_main( void *arg ) {
+
+    worker_t *w = arg;
+    worker_stats_t *st = &w -> stats;
+
+    // pin this worker to its core
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    CPU_SET( w -> core, &set );
+
+    if( pthread_setaffinity_np( pthread_self(), sizeof set, &set ) != 0 ) {
+        fprintf( stderr, "worker %d: could not pin to core %d\n", w -> id, w -> core );
+    }
+
+    int sockfd = reuseport_udp_socket( w -> port );
+
+    if( sockfd == -1 ) {
+        fprintf( stderr, "worker %d: failed to bind\n", w -> id );
+        exit( 1 );
+    }
+
+    // batch slots, allocated by this thread : first touch keeps them on its NUMA node
+    struct mmsghdr *msgs = calloc( BATCH, sizeof *msgs );
+    struct iovec *iov = calloc( BATCH, sizeof *iov );
+    struct sockaddr_storage *addrs = calloc( BATCH, sizeof *addrs );
+    char *bufs = malloc( ( size_t ) BATCH * DGRAM_SIZE );
+
+    // one control buffer per slot : room for the uint32_t drop counter
+    size_t cspace = CMSG_SPACE( sizeof( uint32_t ) );
+    char *cbufs = calloc( BATCH, cspace );
+
+    for( int i = 0; i < BATCH; i++ ) {
+
+        iov[ i ].iov_base = bufs + ( size_t ) i * DGRAM_SIZE;
+
+        msgs[ i ].msg_hdr.msg_iov = &iov[ i ];
+        msgs[ i ].msg_hdr.msg_iovlen = 1;
+        msgs[ i ].msg_hdr.msg_name = &addrs[ i ];
+    }
+
+    while( 1 ) {
+
+        // recvmmsg() overwrites lengths : reset them before every batch
+        for( int i = 0; i < BATCH; i++ ) {
+
+            iov[ i ].iov_len = DGRAM_SIZE;
+            msgs[ i ].msg_hdr.msg_namelen = sizeof addrs[ i ];
+            msgs[ i ].msg_hdr.msg_control = cbufs + i * cspace;
+            msgs[ i ].msg_hdr.msg_controllen = cspace;
+        }
+
+        int n = recvmmsg( sockfd, msgs, BATCH, MSG_WAITFORONE, NULL );
+
+        if( n == -1 ) {
+
+            if( errno != EINTR ) {
+                perror( "recvmmsg" );
+            }
+
+            continue;
+        }
+
+        unsigned long long bytes = 0;
+        uint32_t drops = 0;
+        int have_drops = 0;
+
+        for( int i = 0; i < n; i++ ) {
+
+            struct msghdr *mh = &msgs[ i ].msg_hdr;
+
+            // the cmsg carries the socket's running total, the newest value wins
+            for( struct cmsghdr *cm = CMSG_FIRSTHDR( mh ); cm; cm = CMSG_NXTHDR( mh, cm ) ) {
+
+                if( cm -> cmsg_level == SOL_SOCKET && cm -> cmsg_type == SO_RXQ_OVFL ) {
+                    memcpy( &drops, CMSG_DATA( cm ), sizeof drops );
+                    have_drops = 1;
+                }
+            }
+
+            // echo in place : reply length = received length, address already set
+            iov[ i ].iov_len = msgs[ i ].msg_len;
+            mh -> msg_control = NULL;
+            mh -> msg_controllen = 0;
+
+            bytes += msgs[ i ].msg_len;
+        }
+
+        // a reply that fails is skipped and counted, the rest still go out
+        unsigned long long send_errors = st -> send_errors;
+
+        send_batch( sockfd, msgs, n, &send_errors );
+
+        // relaxed stores : plain writes, but the stats thread may read them
+        __atomic_store_n( &st -> packets, st -> packets + n, __ATOMIC_RELAXED );
+        __atomic_store_n( &st -> bytes, st -> bytes + bytes, __ATOMIC_RELAXED );
+        __atomic_store_n( &st -> calls, st -> calls + 1, __ATOMIC_RELAXED );
+        __atomic_store_n( &st -> send_errors, send_errors, __ATOMIC_RELAXED );
+
+        if( have_drops ) {
+            __atomic_store_n( &st -> drops, drops, __ATOMIC_RELAXED );
+        }
+    }
+
+    return NULL;
+}
+
+
+
+/* ================= MAIN ================= */
+
+void on_signal( int sig ) {
+
+    ( void ) sig;
+    stop = 1;
+}
+
+
+int main( int argc, char *argv[] ) {
+
+    int ncores = ( int ) sysconf( _SC_NPROCESSORS_ONLN );
+    int nthreads = ncores;
+    const char *port = PORT;
+    int verbose = 0;
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "t:p:v" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 't': nthreads = atoi( optarg ); break;
+            case 'p': port = optarg; break;
+            case 'v': verbose = 1; break;
+            default:
+                fprintf( stderr, "usage: %s [-t workers] [-p port] [-v]\n", argv[ 0 ] );
+                exit( 1 );
+        }
+    }
+
+    if( nthreads < 1 || nthreads > MAX_THREADS ) {
+        fprintf( stderr, "workers must be 1..%d\n", MAX_THREADS );
+        exit( 1 );
+    }
+
+    // no sigaction flags : sleep() below must be interrupted
+    struct sigaction sa;
+    memset( &sa, 0, sizeof sa );
+    sa.sa_handler = on_signal;
+    sigaction( SIGINT, &sa, NULL );
+    sigaction( SIGTERM, &sa, NULL );
+
+    // workers inherit this mask : only the main thread handles the signals
+    sigset_t block, old;
+    sigemptyset( &block );
+    sigaddset( &block, SIGINT );
+    sigaddset( &block, SIGTERM );
+    pthread_sigmask( SIG_BLOCK, &block, &old );
+
+    for( int i = 0; i < nthreads; i++ ) {
+
+        workers[ i ].id = i;
+        workers[ i ].core = i % ncores;     // more workers than cores : wrap around
+        workers[ i ].port = port;
+
+        pthread_create( &workers[ i ].thread, NULL, worker_main, &workers[ i ] );
+    }
+
+    pthread_sigmask( SIG_SETMASK, &old, NULL );
+
+    printf( "UDP Server listening on %s with %d worker(s)...\n", port, nthreads );
+    fflush( stdout );
+
+    // main thread only watches : it reads counters, never writes them
+    unsigned long long last_pkts[ MAX_THREADS ] = { 0 };
+    unsigned long long last_drops[ MAX_THREADS ] = { 0 };
+
+    while( !stop ) {
+
+        sleep( 1 );
+
+        if( !verbose || stop ) {
+            continue;
+        }
+
+        unsigned long long total = 0, total_drops = 0;
+
+        for( int i = 0; i < nthreads; i++ ) {
+
+            unsigned long long p = __atomic_load_n( &workers[ i ].stats.packets, __ATOMIC_RELAXED );
+            unsigned long long d = __atomic_load_n( &workers[ i ].stats.drops, __ATOMIC_RELAXED );
+
+            printf( "w%d: %llu pkt/s %llu drop/s  ", i, p - last_pkts[ i ], d - last_drops[ i ] );
+
+            total += p - last_pkts[ i ];
+            total_drops += d - last_drops[ i ];
+            last_pkts[ i ] = p;
+            last_drops[ i ] = d;
+        }
+
+        printf( "| total %llu pkt/s %llu drop/s\n", total, total_drops );
+        fflush( stdout );
+    }
+
+
+    /* ================= SUMMARY ================= */
+
+    unsigned long long all = 0, all_drops = 0, all_errors = 0;
+
+    printf( "\nworker  core  packets      drops        pkts/call\n" );
+
+    for( int i = 0; i < nthreads; i++ ) {
+
+        worker_stats_t *st = &workers[ i ].stats;
+
+        unsigned long long p = __atomic_load_n( &st -> packets, __ATOMIC_RELAXED );
+        unsigned long long d = __atomic_load_n( &st -> drops, __ATOMIC_RELAXED );
+        unsigned long long c = __atomic_load_n( &st -> calls, __ATOMIC_RELAXED );
+
+        printf( "%-7d %-5d %-12llu %-12llu %.1f\n", i, workers[ i ].core, p, d, c ? ( double ) p / c : 0.0 );
+
+        all += p;
+        all_drops += d;
+        all_errors += __atomic_load_n( &st -> send_errors, __ATOMIC_RELAXED );
+    }
+
+    printf( "total         %-12llu %-12llu", all, all_drops );
+
+    // kept on the total line : scale.sh reads the last line
+    if( all_errors ) {
+        printf( " %llu send errors", all_errors );
+    }
+
+    printf( "\n" );
+
+    return 0;
+}
@@ -0,0 +1,476 @@
+/*
+    udp_loadgen.c
+
+    UDP echo traffic generator
+    ( 5-UDP-sendto-recvfrom/client.c without the blocking recvfrom() )
+
+    Every datagram starts with a header :
+        magic | sequence number | send timestamp ( CLOCK_MONOTONIC ns )
+
+    The echo server sends the bytes back untouched, so each reply tells us
+    which datagram it was and when it left. From that we get :
+
+        - loss        : sent but never came back
+        - duplicates  : same sequence number seen twice
+        - reordering  : arrived after a higher sequence number
+        - RTT         : receive time - send timestamp
+        - jitter      : | RTT( n ) - RTT( n - 1 ) | for consecutive replies ( RFC 3550 )
+
+    Sending is paced on an absolute schedule ( start + i / rate ),
+    so a slow iteration is caught up instead of lowering the rate.
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 udp_loadgen.c -o udp_loadgen
+
+    Run:
+        ./udp_loadgen 127.0.0.1 3490                          ( 10000 pkt/s, 64 B, 5 s )
+        ./udp_loadgen 127.0.0.1 3490 -r 50000 -z 64-1400 -d 10
+        ./udp_loadgen 127.0.0.1 3490 -r 0 -z imix -S 16       ( as fast as possible )
+
+    Linux only ( ppoll )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <stdint.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+#define MAGIC 0x55444c47u       // "UDLG"
+#define MAX_SIZE 65507          // largest UDP payload over IPv4
+#define MAX_SOCKS 1024
+
+
+// carried at the start of every datagram, echoed back unchanged
+typedef struct {
+
+    uint32_t magic;
+    uint32_t seq;
+    uint64_t sent_ns;
+
+} probe_t;
+
+// size distribution ( -z )
+typedef struct {
+
+    enum { SIZE_FIXED, SIZE_UNIFORM, SIZE_IMIX } kind;
+    size_t lo, hi;
+
+} size_dist_t;
+
+
+// growable array of nanosecond samples
+typedef struct {
+
+    long long *v;
+    long n, cap;
+
+} samples_t;
+
+
+
+/* ================= HELPERS ================= */
+
+uint64_t now_ns( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+void samples_add( samples_t *s, long long x ) {
+
+    if( s -> n == s -> cap ) {
+
+        s -> cap = s -> cap ? s -> cap * 2 : 65536;
+        s -> v = realloc( s -> v, s -> cap * sizeof *s -> v );
+
+        if( s -> v == NULL ) {
+            perror( "realloc" );
+            exit( 1 );
+        }
+    }
+
+    s -> v[ s -> n++ ] = x;
+}
+
+
+int cmp_ll( const void *a, const void *b ) {
+
+    long long x = *( const long long * ) a, y = *( const long long * ) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+
+// xorshift : cheap, good enough to pick packet sizes
+uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+uint64_t rng( void ) {
+
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+
+    return rng_state;
+}
+
+
+/*
+    -z 64         every datagram 64 bytes
+    -z 64-1400    uniform between 64 and 1400
+    -z imix       7 : 4 : 1 mix of 64, 576 and 1400 bytes ( simple IMIX )
+*/
+int parse_sizes( const char *s, size_dist_t *d ) {
+
+    char *end;
+
+    if( strcmp( s, "imix" ) == 0 ) {
+        d -> kind = SIZE_IMIX;
+        d -> lo = 64;
+        d -> hi = 1400;
+        return 0;
+    }
+
+    d -> lo = strtoul( s, &end, 10 );
+    d -> hi = d -> lo;
+    d -> kind = SIZE_FIXED;
+
+    if( *end == '-' ) {
+        d -> hi = strtoul( end + 1, &end, 10 );
+        d -> kind = SIZE_UNIFORM;
+    }
+
+    if( *end != '\0' || d -> lo < sizeof( probe_t ) || d -> hi < d -> lo || d -> hi > MAX_SIZE ) {
+        return -1;
+    }
+
+    return 0;
+}
+
+
+size_t pick_size( const size_dist_t *d ) {
+
+    switch( d -> kind ) {
+
+        case SIZE_UNIFORM:
+            return d -> lo + rng() % ( d -> hi - d -> lo + 1 );
+
+        case SIZE_IMIX: {
+            int r = rng() % 12;
+            return r < 7 ? 64 : r < 11 ? 576 : 1400;
+        }
+
+        default:
+            return d -> lo;
+    }
+}
+
+
+void print_percentiles( const char *name, samples_t *s ) {
+
+    static const double pct[] = { 50, 90, 99, 99.9 };
+
+    if( s -> n == 0 ) {
+        printf( "%-10s: no samples\n", name );
+        return;
+    }
+
+    qsort( s -> v, s -> n, sizeof *s -> v, cmp_ll );
+
+    double sum = 0;
+
+    for( long i = 0; i < s -> n; i++ ) {
+        sum += s -> v[ i ];
+    }
+
+    printf( "%-10s: min %.1f  mean %.1f", name, s -> v[ 0 ] / 1e3, sum / s -> n / 1e3 );
+
+    for( size_t i = 0; i < sizeof pct / sizeof pct[ 0 ]; i++ ) {
+
+        long idx = ( long ) ( s -> n * pct[ i ] / 100.0 );
+
+        if( idx >= s -> n ) {
+            idx = s -> n - 1;
+        }
+
+        printf( "  p%g %.1f", pct[ i ], s -> v[ idx ] / 1e3 );
+    }
+
+    printf( "  max %.1f us\n", s -> v[ s -> n - 1 ] / 1e3 );
+}
+
+
+
+/* ================= MAIN ================= */
+
+int main( int argc, char *argv[] ) {
+
+    double rate = 10000;        // -r : datagrams per second, 0 = unpaced
+    double duration = 5;        // -d : seconds of sending
+    double drain = 1;           // -w : seconds to wait for stragglers
+    int nsocks = 1;             // -S : client sockets ( source ports )
+    size_dist_t sizes = { SIZE_FIXED, 64, 64 };
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "r:d:w:z:S:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'r': rate = atof( optarg ); break;
+            case 'd': duration = atof( optarg ); break;
+            case 'w': drain = atof( optarg ); break;
+            case 'S': nsocks = atoi( optarg ); break;
+            case 'z':
+                if( parse_sizes( optarg, &sizes ) == -1 ) {
+                    goto usage;
+                }
+                break;
+            default: goto usage;
+        }
+    }
+
+    if( argc - optind != 2 || rate < 0 || duration <= 0 || nsocks < 1 || nsocks > MAX_SOCKS ) {
+usage:
+        fprintf( stderr, "usage: %s host port [-r pkt/s] [-d seconds] [-z size|lo-hi|imix] [-S sockets] [-w drain-seconds]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+    struct addrinfo hints, *res;
+
+    memset( &hints, 0, sizeof hints );
+    hints.ai_family   = AF_UNSPEC;     // IPv4 or IPv6
+    hints.ai_socktype = SOCK_DGRAM;    // UDP socket
+
+    int status = getaddrinfo( argv[ optind ], argv[ optind + 1 ], &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    // connected sockets : only the server's replies reach us, send() needs no address
+    struct pollfd pfds[ MAX_SOCKS ];
+
+    for( int i = 0; i < nsocks; i++ ) {
+
+        pfds[ i ].fd = socket( res -> ai_family, res -> ai_socktype | SOCK_NONBLOCK, res -> ai_protocol );
+        pfds[ i ].events = POLLIN;
+
+        if( pfds[ i ].fd == -1 || connect( pfds[ i ].fd, res -> ai_addr, res -> ai_addrlen ) == -1 ) {
+            perror( "socket/connect" );
+            exit( 1 );
+        }
+
+        int rcvbuf = 4 << 20;
+        setsockopt( pfds[ i ].fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof rcvbuf );
+    }
+
+    freeaddrinfo( res );
+
+    // reordering is judged per socket : each socket is its own flow, and
+    // nothing keeps different flows in order relative to each other
+    long long highest[ MAX_SOCKS ];
+
+    for( int i = 0; i < nsocks; i++ ) {
+        highest[ i ] = -1;
+    }
+
+    char *sbuf = calloc( 1, MAX_SIZE );
+    char *rbuf = malloc( MAX_SIZE );
+
+    // one byte per sequence number : 1 once its reply has been seen
+    size_t seen_cap = 1 << 20;
+    unsigned char *seen = calloc( seen_cap, 1 );
+
+    if( sbuf == NULL || rbuf == NULL || seen == NULL ) {
+        perror( "malloc" );
+        exit( 1 );
+    }
+
+    samples_t rtt = { 0 }, jitter = { 0 };
+
+    unsigned long long sent = 0, received = 0, dups = 0, reordered = 0, send_errors = 0, bad = 0;
+    unsigned long long bytes_sent = 0;
+    long long last_rtt = -1;
+    double rfc_jitter = 0;          // RFC 3550 smoothed estimate : J += ( |D| - J ) / 16
+
+    uint64_t start = now_ns();
+    uint64_t stop_send = start + ( uint64_t ) ( duration * 1e9 );
+    uint64_t stop_all = stop_send + ( uint64_t ) ( drain * 1e9 );
+    uint64_t interval = rate > 0 ? ( uint64_t ) ( 1e9 / rate ) : 0;
+
+    while( 1 ) {
+
+        uint64_t now = now_ns();
+
+        if( now >= stop_all || ( now >= stop_send && received >= sent - send_errors ) ) {
+            break;
+        }
+
+
+        /* ---------- SEND : every datagram that is due ---------- */
+
+        // absolute schedule : datagram i is due at start + i * interval
+        while( now < stop_send && ( interval == 0 || start + sent * interval <= now ) ) {
+
+            if( sent >= seen_cap ) {
+
+                seen = realloc( seen, seen_cap * 2 );
+
+                if( seen == NULL ) {
+                    perror( "realloc" );
+                    exit( 1 );
+                }
+
+                memset( seen + seen_cap, 0, seen_cap );
+                seen_cap *= 2;
+            }
+
+            size_t len = pick_size( &sizes );
+
+            probe_t pr = { MAGIC, ( uint32_t ) sent, now_ns() };
+            memcpy( sbuf, &pr, sizeof pr );
+
+            if( send( pfds[ sent % nsocks ].fd, sbuf, len, 0 ) == -1 ) {
+
+                // a full send queue counts as a failed send, the slot is still used up
+                send_errors++;
+
+            } else {
+                bytes_sent += len;
+            }
+
+            sent++;
+
+            // unpaced : one datagram per round, then look for replies
+            if( interval == 0 ) {
+                break;
+            }
+        }
+
+
+        /* ---------- WAIT : until the next send is due or a reply arrives ---------- */
+
+        now = now_ns();
+
+        uint64_t wake = interval && now < stop_send ? start + sent * interval : now;
+
+        if( now >= stop_send ) {
+            wake = now + 10000000;       // draining : 10 ms slices
+        }
+
+        struct timespec ts = { 0, 0 };
+
+        if( wake > now ) {
+            ts.tv_sec = ( wake - now ) / 1000000000ull;
+            ts.tv_nsec = ( wake - now ) % 1000000000ull;
+        }
+
+        int ready = ppoll( pfds, nsocks, &ts, NULL );
+
+        if( ready <= 0 ) {
+            continue;
+        }
+
+
+        /* ---------- RECEIVE : match replies to probes ---------- */
+
+        for( int i = 0; i < nsocks; i++ ) {
+
+            if( !( pfds[ i ].revents & POLLIN ) ) {
+                continue;
+            }
+
+            while( 1 ) {
+
+                ssize_t n = recv( pfds[ i ].fd, rbuf, MAX_SIZE, 0 );
+
+                if( n == -1 ) {
+                    break;      // EAGAIN : socket drained ( or ICMP error : nobody listening )
+                }
+
+                uint64_t t = now_ns();
+                probe_t pr;
+
+                if( ( size_t ) n < sizeof pr ) {
+                    bad++;
+                    continue;
+                }
+
+                memcpy( &pr, rbuf, sizeof pr );
+
+                if( pr.magic != MAGIC || pr.seq >= sent ) {
+                    bad++;
+                    continue;
+                }
+
+                if( seen[ pr.seq ] ) {
+                    dups++;
+                    continue;
+                }
+
+                seen[ pr.seq ] = 1;
+
+                received++;
+
+                if( ( long long ) pr.seq < highest[ i ] ) {
+                    reordered++;
+                } else {
+                    highest[ i ] = pr.seq;
+                }
+
+                long long r = ( long long ) ( t - pr.sent_ns );
+                samples_add( &rtt, r );
+
+                if( last_rtt >= 0 ) {
+
+                    long long d = r > last_rtt ? r - last_rtt : last_rtt - r;
+
+                    samples_add( &jitter, d );
+                    rfc_jitter += ( d - rfc_jitter ) / 16.0;
+                }
+
+                last_rtt = r;
+            }
+        }
+    }
+
+    double secs = ( stop_send - start ) / 1e9;
+    // a failed send() never reached the path : it is not a loss
+    unsigned long long delivered = sent - send_errors;
+    unsigned long long lost = delivered > received ? delivered - received : 0;
+
+
+    /* ================= REPORT ================= */
+
+    printf( "sent      : %llu datagrams ( %.0f pkt/s, %.2f Mbit/s )\n",
+            sent, sent / secs, bytes_sent * 8 / secs / 1e6 );
+    printf( "send err  : %llu ( never left this host, not counted as lost )\n", send_errors );
+    printf( "received  : %llu unique replies\n", received );
+    printf( "lost      : %llu ( %.3f%% )\n", lost, delivered ? 100.0 * lost / delivered : 0.0 );
+    printf( "duplicate : %llu\n", dups );
+    printf( "reordered : %llu ( %.3f%% )\n", reordered, received ? 100.0 * reordered / received : 0.0 );
+
+    if( bad ) {
+        printf( "foreign   : %llu ( short, wrong magic or unknown sequence )\n", bad );
+    }
+
+    print_percentiles( "rtt", &rtt );
+    print_percentiles( "jitter", &jitter );
+    printf( "rfc3550   : %.1f us smoothed jitter\n", rfc_jitter / 1e3 );
+
+    for( int i = 0; i < nsocks; i++ ) {
+        close( pfds[ i ].fd );
+    }
+
+    return 0;
+}
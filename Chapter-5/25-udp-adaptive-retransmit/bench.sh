@@ -0,0 +1,35 @@
+#!/bin/sh
+#
+#   bench.sh
+#
+#   Completion latency under loss : adaptive RTO vs fixed timeouts
+#
+#   Usage:
+#       ./bench.sh [loss-percent] [requests] [in-flight]
+#
+#   Example:
+#       ./bench.sh 5 10000 8
+
+LOSS=${1:-5}
+COUNT=${2:-10000}
+INFLIGHT=${3:-8}
+PORT=34950
+
+./lossy_server -p "$PORT" -l "$LOSS" -D 200 -J 300 > /dev/null &
+SERVER=$!
+sleep 0.3
+
+for T in 0 1000 50 5 1; do
+
+    if [ "$T" -eq 0 ]; then
+        echo "== adaptive"
+    else
+        echo "== fixed $T ms"
+    fi
+
+    ./client 127.0.0.1 "$PORT" -n "$COUNT" -c "$INFLIGHT" -T "$T" | grep -v "^mode"
+    echo
+done
+
+kill "$SERVER"
+wait "$SERVER" 2> /dev/null
@@ -0,0 +1,395 @@
+/*
+    client.c
+
+    UDP request / response client with adaptive timeouts
+    ( 5-UDP-sendto-recvfrom/client.c without the infinite recvfrom() wait )
+
+    - every request has an ID, a slot and an attempt number
+    - up to C requests in flight, replies matched in any order
+    - per-request deadline, retransmit when it passes
+    - retransmission timeout ( RTO ) from smoothed RTT + variance, TCP style ( RFC 6298 )
+    - exponential backoff per request : RTO, 2 RTO, 4 RTO ...
+    - the reply echoes the send timestamp of the copy it answers,
+      so RTT samples stay exact even for retransmitted requests
+
+    At the end : completion latency percentiles, retransmits, spurious
+    retransmits, failures and the final RTO estimate.
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 client.c -o client
+
+    Run:
+        ./client 127.0.0.1 3490                     ( adaptive RTO, 8 in flight, 10000 requests )
+        ./client 127.0.0.1 3490 -c 32 -n 50000
+        ./client 127.0.0.1 3490 -T 200              ( fixed 200 ms timeout, for comparison )
+
+    Linux only ( ppoll )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <stdint.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+#define MAGIC 0x52455154u           // "REQT"
+#define MAX_INFLIGHT 1024
+#define MAX_SIZE 1400
+#define INITIAL_RTO_NS 100000000ll  // 100 ms until the first RTT sample
+
+
+// request header, echoed back by the server
+typedef struct {
+
+    uint32_t magic;
+    uint32_t id;            // request number
+    uint16_t slot;          // index into the in-flight table
+    uint16_t attempt;       // 0 = first copy, 1 = first retransmit ...
+    uint64_t sent_ns;       // when THIS copy was sent
+
+} req_hdr_t;
+
+// one outstanding request
+typedef struct {
+
+    int active;
+    uint32_t id;
+    int attempts;           // copies sent so far
+    long long first_ns;     // first transmission : start of the user-visible latency
+    long long deadline_ns;  // retransmit ( or give up ) at this time
+
+} slot_t;
+
+// RFC 6298 estimator
+typedef struct {
+
+    long long srtt, rttvar, rto;
+    long long min_rto, max_rto;
+    int have_sample;
+
+} rto_t;
+
+
+
+/* ================= HELPERS ================= */
+
+long long now_ns( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( long long ) ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+
+int cmp_ll( const void *a, const void *b ) {
+
+    long long x = *( const long long * ) a, y = *( const long long * ) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+
+/*
+    First sample R :   SRTT = R,  RTTVAR = R / 2
+    Later samples  :   RTTVAR = 3/4 RTTVAR + 1/4 | SRTT - R |
+                       SRTT   = 7/8 SRTT   + 1/8 R
+    Always         :   RTO = SRTT + 4 RTTVAR, clamped to [ min, max ]
+*/
+void rto_sample( rto_t *e, long long r ) {
+
+    if( !e -> have_sample ) {
+
+        e -> srtt = r;
+        e -> rttvar = r / 2;
+        e -> have_sample = 1;
+
+    } else {
+
+        long long err = e -> srtt > r ? e -> srtt - r : r - e -> srtt;
+
+        e -> rttvar = ( 3 * e -> rttvar + err ) / 4;
+        e -> srtt = ( 7 * e -> srtt + r ) / 8;
+    }
+
+    e -> rto = e -> srtt + 4 * e -> rttvar;
+
+    if( e -> rto < e -> min_rto ) e -> rto = e -> min_rto;
+    if( e -> rto > e -> max_rto ) e -> rto = e -> max_rto;
+}
+
+
+// timeout for a request that has already been sent `attempts` times
+long long backoff( const rto_t *e, int attempts ) {
+
+    long long t = e -> rto;
+
+    for( int i = 1; i < attempts && t < e -> max_rto; i++ ) {
+        t *= 2;
+    }
+
+    return t < e -> max_rto ? t : e -> max_rto;
+}
+
+
+void send_copy( int fd, char *buf, size_t size, slot_t *s, int slot ) {
+
+    req_hdr_t h = { MAGIC, s -> id, ( uint16_t ) slot, ( uint16_t ) s -> attempts, ( uint64_t ) now_ns() };
+
+    memcpy( buf, &h, sizeof h );
+
+    // a failed send is just another lost datagram : the deadline will retry it
+    send( fd, buf, size, 0 );
+
+    s -> attempts++;
+}
+
+
+
+/* ================= MAIN ================= */
+
+int main( int argc, char *argv[] ) {
+
+    long total = 10000;         // -n : requests
+    int inflight = 8;           // -c : requests in flight
+    long long fixed_ms = 0;     // -T : fixed timeout in ms, 0 = adaptive
+    int max_attempts = 8;       // -R : copies before giving up
+    size_t size = 64;           // -z : request size
+
+    rto_t est = { 0, 0, INITIAL_RTO_NS, 1000000, 1000000000, 0 };  // min 1 ms, max 1 s
+
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:c:T:R:z:m:M:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'n': total = atol( optarg ); break;
+            case 'c': inflight = atoi( optarg ); break;
+            case 'T': fixed_ms = atoll( optarg ); break;
+            case 'R': max_attempts = atoi( optarg ); break;
+            case 'z': size = strtoul( optarg, NULL, 10 ); break;
+            case 'm': est.min_rto = atof( optarg ) * 1e6; break;
+            case 'M': est.max_rto = atof( optarg ) * 1e6; break;
+            default: goto usage;
+        }
+    }
+
+    if( argc - optind != 2 || total < 1 || inflight < 1 || inflight > MAX_INFLIGHT || max_attempts < 1
+        || size < sizeof( req_hdr_t ) || size > MAX_SIZE || est.min_rto <= 0 || est.max_rto < est.min_rto ) {
+usage:
+        fprintf( stderr, "usage: %s host port [-n requests] [-c in-flight] [-T fixed-timeout-ms] [-R max-attempts]\n"
+                         "          [-z size] [-m min-rto-ms] [-M max-rto-ms]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+    // fixed mode : every timeout is the same, no backoff, no estimator
+    if( fixed_ms > 0 ) {
+        est.rto = est.min_rto = est.max_rto = fixed_ms * 1000000ll;
+    }
+
+    struct addrinfo hints, *res;
+
+    memset( &hints, 0, sizeof hints );
+    hints.ai_family   = AF_UNSPEC;     // IPv4 or IPv6
+    hints.ai_socktype = SOCK_DGRAM;    // UDP socket
+
+    int status = getaddrinfo( argv[ optind ], argv[ optind + 1 ], &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    int sockfd = socket( res -> ai_family, res -> ai_socktype | SOCK_NONBLOCK, res -> ai_protocol );
+
+    if( sockfd == -1 || connect( sockfd, res -> ai_addr, res -> ai_addrlen ) == -1 ) {
+        perror( "socket/connect" );
+        exit( 1 );
+    }
+
+    freeaddrinfo( res );
+
+    slot_t slots[ MAX_INFLIGHT ] = { { 0 } };
+    int free_slots[ MAX_INFLIGHT ], nfree = 0;
+
+    for( int i = inflight - 1; i >= 0; i-- ) {
+        free_slots[ nfree++ ] = i;
+    }
+
+    char sbuf[ MAX_SIZE ] = { 0 }, rbuf[ MAX_SIZE ];
+    long long *latency = malloc( total * sizeof *latency );
+
+    if( latency == NULL ) {
+        perror( "malloc" );
+        exit( 1 );
+    }
+
+    long issued = 0, done = 0, failed = 0;
+    long retransmits = 0, spurious = 0, stale = 0;
+
+    long long start = now_ns();
+
+    while( done + failed < total ) {
+
+        /* ---------- ISSUE : fill the window ---------- */
+
+        while( nfree > 0 && issued < total ) {
+
+            int k = free_slots[ --nfree ];
+            slot_t *s = &slots[ k ];
+
+            s -> active = 1;
+            s -> id = ( uint32_t ) issued++;
+            s -> attempts = 0;
+            s -> first_ns = now_ns();
+
+            send_copy( sockfd, sbuf, size, s, k );
+
+            s -> deadline_ns = s -> first_ns + backoff( &est, s -> attempts );
+        }
+
+
+        /* ---------- WAIT : until a reply or the earliest deadline ---------- */
+
+        long long now = now_ns(), next = now + est.max_rto;
+
+        for( int k = 0; k < inflight; k++ ) {
+
+            if( slots[ k ].active && slots[ k ].deadline_ns < next ) {
+                next = slots[ k ].deadline_ns;
+            }
+        }
+
+        struct pollfd pfd = { sockfd, POLLIN, 0 };
+        struct timespec ts = { 0, 0 };
+
+        if( next > now ) {
+            ts.tv_sec = ( next - now ) / 1000000000ll;
+            ts.tv_nsec = ( next - now ) % 1000000000ll;
+        }
+
+        ppoll( &pfd, 1, &ts, NULL );
+
+
+        /* ---------- REPLIES : match by slot + id, any order ---------- */
+
+        while( 1 ) {
+
+            ssize_t n = recv( sockfd, rbuf, sizeof rbuf, 0 );
+
+            if( n == -1 ) {
+                break;      // EAGAIN : drained
+            }
+
+            long long t = now_ns();
+            req_hdr_t h;
+
+            if( ( size_t ) n < sizeof h ) {
+                continue;
+            }
+
+            memcpy( &h, rbuf, sizeof h );
+
+            if( h.magic != MAGIC || h.slot >= inflight ) {
+                continue;
+            }
+
+            slot_t *s = &slots[ h.slot ];
+
+            // already answered ( duplicate or late copy ) : slot free or reused
+            if( !s -> active || s -> id != h.id ) {
+                stale++;
+                continue;
+            }
+
+            // RTT of the exact copy being answered : no retransmission ambiguity
+            if( fixed_ms == 0 ) {
+                rto_sample( &est, t - ( long long ) h.sent_ns );
+            }
+
+            // answer to an older copy : the retransmit after it was not needed
+            if( h.attempt + 1 < s -> attempts ) {
+                spurious++;
+            }
+
+            latency[ done++ ] = t - s -> first_ns;
+
+            s -> active = 0;
+            free_slots[ nfree++ ] = h.slot;
+        }
+
+
+        /* ---------- TIMEOUTS : retransmit with backoff, or give up ---------- */
+
+        now = now_ns();
+
+        for( int k = 0; k < inflight; k++ ) {
+
+            slot_t *s = &slots[ k ];
+
+            if( !s -> active || now < s -> deadline_ns ) {
+                continue;
+            }
+
+            if( s -> attempts >= max_attempts ) {
+
+                failed++;
+                s -> active = 0;
+                free_slots[ nfree++ ] = k;
+                continue;
+            }
+
+            send_copy( sockfd, sbuf, size, s, k );
+            retransmits++;
+
+            s -> deadline_ns = now + ( fixed_ms ? est.rto : backoff( &est, s -> attempts ) );
+        }
+    }
+
+    double secs = ( now_ns() - start ) / 1e9;
+
+
+    /* ================= REPORT ================= */
+
+    printf( "mode        : %s\n", fixed_ms ? "fixed timeout" : "adaptive RTO ( RFC 6298 )" );
+    printf( "requests    : %ld done, %ld failed, %.0f req/s\n", done, failed, done / secs );
+    printf( "retransmits : %ld ( %ld spurious ), %ld stale replies\n", retransmits, spurious, stale );
+
+    if( fixed_ms == 0 ) {
+        printf( "estimator   : srtt %.1f us  rttvar %.1f us  rto %.1f us\n",
+                est.srtt / 1e3, est.rttvar / 1e3, est.rto / 1e3 );
+    }
+
+    if( done > 0 ) {
+
+        static const double pct[] = { 50, 90, 99, 99.9, 99.99 };
+
+        qsort( latency, done, sizeof *latency, cmp_ll );
+
+        printf( "latency     :" );
+
+        for( size_t i = 0; i < sizeof pct / sizeof pct[ 0 ]; i++ ) {
+
+            long idx = ( long ) ( done * pct[ i ] / 100.0 );
+
+            if( idx >= done ) {
+                idx = done - 1;
+            }
+
+            printf( "  p%g %.2f ms", pct[ i ], latency[ idx ] / 1e6 );
+        }
+
+        printf( "  max %.2f ms\n", latency[ done - 1 ] / 1e6 );
+    }
+
+    close( sockfd );
+
+    return 0;
+}
@@ -0,0 +1,241 @@
+/*
+    lossy_server.c
+
+    UDP echo server with simulated loss and delay
+    ( 5-UDP-sendto-recvfrom/server.c on a bad network )
+
+    - drops each incoming request with probability -l percent
+    - holds each reply for -D microseconds plus a random 0 .. -J extra
+      ( the random part reorders replies )
+    - replies wait in a min-heap ordered by release time
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 lossy_server.c -o lossy_server
+
+    Run:
+        ./lossy_server                        ( port 3490, no loss, no delay )
+        ./lossy_server -l 5 -D 200 -J 300     ( 5% loss, 200 - 500 us delay )
+
+    Linux only ( ppoll )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+#define PORT "3490"
+#define MAX_SIZE 1500
+#define MAX_HELD 65536          // replies waiting for their release time
+
+
+typedef struct {
+
+    long long due_ns;
+    struct sockaddr_storage addr;
+    socklen_t addrlen;
+    size_t len;
+    char data[ MAX_SIZE ];
+
+} held_t;
+
+// min-heap of pointers, earliest release on top
+held_t *heap[ MAX_HELD ];
+int nheld = 0;
+
+
+long long now_ns( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( long long ) ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+
+void heap_push( held_t *h ) {
+
+    int i = nheld++;
+
+    while( i > 0 && heap[ ( i - 1 ) / 2 ] -> due_ns > h -> due_ns ) {
+        heap[ i ] = heap[ ( i - 1 ) / 2 ];
+        i = ( i - 1 ) / 2;
+    }
+
+    heap[ i ] = h;
+}
+
+
+held_t *heap_pop( void ) {
+
+    held_t *top = heap[ 0 ], *last = heap[ --nheld ];
+    int i = 0;
+
+    while( 2 * i + 1 < nheld ) {
+
+        int c = 2 * i + 1;
+
+        if( c + 1 < nheld && heap[ c + 1 ] -> due_ns < heap[ c ] -> due_ns ) {
+            c++;
+        }
+
+        if( last -> due_ns <= heap[ c ] -> due_ns ) {
+            break;
+        }
+
+        heap[ i ] = heap[ c ];
+        i = c;
+    }
+
+    heap[ i ] = last;
+
+    return top;
+}
+
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = PORT;
+    double loss = 0;            // -l : percent of requests dropped
+    long delay_us = 0;          // -D : fixed reply delay
+    long jitter_us = 0;         // -J : random extra delay
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "p:l:D:J:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'p': port = optarg; break;
+            case 'l': loss = atof( optarg ); break;
+            case 'D': delay_us = atol( optarg ); break;
+            case 'J': jitter_us = atol( optarg ); break;
+            default:
+                fprintf( stderr, "usage: %s [-p port] [-l loss-percent] [-D delay-us] [-J jitter-us]\n", argv[ 0 ] );
+                exit( 1 );
+        }
+    }
+
+    struct addrinfo hints, *res, *p;
+    int sockfd;
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_UNSPEC;     // IPv4 or IPv6
+    hints.ai_socktype = SOCK_DGRAM;    // UDP socket
+    hints.ai_flags    = AI_PASSIVE;    // Use my IP
+
+    int status = getaddrinfo( NULL, port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype | SOCK_NONBLOCK, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            continue;
+        }
+
+        if( bind( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            continue;
+        }
+
+        break;   // Successfully bound
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        printf( "Failed to bind\n" );
+        exit( 1 );
+    }
+
+    printf( "Lossy UDP Server on %s ( loss %.1f%%, delay %ld + 0..%ld us )...\n", port, loss, delay_us, jitter_us );
+    fflush( stdout );
+
+    srand( ( unsigned ) now_ns() );
+
+    while( 1 ) {
+
+        /* ---------- WAIT : new request or next reply due ---------- */
+
+        struct pollfd pfd = { sockfd, POLLIN, 0 };
+        struct timespec ts, *tsp = NULL;
+
+        if( nheld > 0 ) {
+
+            long long wait = heap[ 0 ] -> due_ns - now_ns();
+
+            if( wait < 0 ) {
+                wait = 0;
+            }
+
+            ts.tv_sec = wait / 1000000000ll;
+            ts.tv_nsec = wait % 1000000000ll;
+            tsp = &ts;
+        }
+
+        ppoll( &pfd, 1, tsp, NULL );
+
+
+        /* ---------- RECEIVE : drop or schedule ---------- */
+
+        while( nheld < MAX_HELD ) {
+
+            held_t *h = malloc( sizeof *h );
+
+            if( h == NULL ) {
+                perror( "malloc" );
+                exit( 1 );
+            }
+
+            h -> addrlen = sizeof h -> addr;
+
+            ssize_t n = recvfrom( sockfd, h -> data, MAX_SIZE, 0, ( struct sockaddr * ) &h -> addr, &h -> addrlen );
+
+            if( n == -1 ) {
+                free( h );
+                break;
+            }
+
+            if( rand() < loss / 100.0 * RAND_MAX ) {
+                free( h );
+                continue;
+            }
+
+            long extra = jitter_us > 0 ? rand() % ( jitter_us + 1 ) : 0;
+
+            h -> len = n;
+            h -> due_ns = now_ns() + ( delay_us + extra ) * 1000ll;
+
+            heap_push( h );
+        }
+
+
+        /* ---------- SEND : every reply whose time has come ---------- */
+
+        long long now = now_ns();
+
+        while( nheld > 0 && heap[ 0 ] -> due_ns <= now ) {
+
+            held_t *h = heap_pop();
+
+            sendto( sockfd, h -> data, h -> len, 0, ( struct sockaddr * ) &h -> addr, h -> addrlen );
+            free( h );
+        }
+    }
+
+    close( sockfd );   // Close socket
+
+    return 0;
+}
@@ -0,0 +1,231 @@
+/*
+    bench_sessions.c
+
+    Session table throughput at N active peers ( default 1,000,000 )
+
+    Phases:
+        insert   N new peers ( half IPv4, half IPv6 )
+        uniform  lookups spread evenly over all N peers   ( cache-hostile )
+        hot      90% of lookups on 1% of the peers        ( realistic skew )
+        churn    lookups of never-seen peers at full table ( every one evicts )
+        expire   all sessions go idle, one sess_expire() removes them
+
+    Addresses are generated up front, so only table work is timed.
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 bench_sessions.c session.c -o bench_sessions
+
+    Run:
+        ./bench_sessions                   ( 1M peers, 10M lookups per phase )
+        ./bench_sessions -n 100000 -l 50000000
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <netinet/in.h>
+
+#include "session.h"
+
+
+uint64_t now_ns( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+uint64_t rng_state = 0x2545f4914f6cdd1dull;
+
+uint64_t rng( void ) {
+
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+
+    return rng_state;
+}
+
+
+// random client : even i → IPv4, odd i → IPv6
+void make_peer( struct sockaddr_storage *ss, long i ) {
+
+    memset( ss, 0, sizeof *ss );
+
+    uint64_t r = rng();
+
+    if( i % 2 == 0 ) {
+
+        struct sockaddr_in *in = ( struct sockaddr_in * ) ss;
+
+        in -> sin_family = AF_INET;
+        in -> sin_addr.s_addr = ( uint32_t ) r;
+        in -> sin_port = ( uint16_t ) ( r >> 32 ) | 1;
+
+    } else {
+
+        struct sockaddr_in6 *in6 = ( struct sockaddr_in6 * ) ss;
+        uint64_t r2 = rng();
+
+        in6 -> sin6_family = AF_INET6;
+        in6 -> sin6_addr.s6_addr[ 0 ] = 0x20;   // 2000::/3 global unicast
+        memcpy( in6 -> sin6_addr.s6_addr + 8, &r2, 8 );
+        memcpy( in6 -> sin6_addr.s6_addr + 2, &r, 4 );
+        in6 -> sin6_port = ( uint16_t ) ( r >> 48 ) | 1;
+    }
+}
+
+
+void report( const char *name, long ops, uint64_t ns ) {
+
+    printf( "%-8s %10ld ops  %8.2f M ops/s  %7.1f ns/op\n", name, ops, ops / ( ns / 1e3 ), ( double ) ns / ops );
+}
+
+
+int main( int argc, char *argv[] ) {
+
+    long npeers = 1000000;      // -n
+    long nlookups = 10000000;   // -l
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:l:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'n': npeers = atol( optarg ); break;
+            case 'l': nlookups = atol( optarg ); break;
+            default:
+                fprintf( stderr, "usage: %s [-n peers] [-l lookups]\n", argv[ 0 ] );
+                exit( 1 );
+        }
+    }
+
+    if( npeers < 100 || nlookups < 1 ) {
+        fprintf( stderr, "need at least 100 peers and 1 lookup\n" );
+        exit( 1 );
+    }
+
+    // twice the peers : the second half are strangers for the churn phase
+    struct sockaddr_storage *peers = malloc( 2 * npeers * sizeof *peers );
+
+    for( long i = 0; i < 2 * npeers; i++ ) {
+        make_peer( &peers[ i ], i );
+    }
+
+    // lookup order precomputed too : rng() cost stays out of the timings
+    long *order = malloc( nlookups * sizeof *order );
+
+    sess_table_t *t = sess_create( npeers, 60 * 1000000000ull );
+
+    if( t == NULL ) {
+        fprintf( stderr, "session table: out of memory\n" );
+        exit( 1 );
+    }
+
+    // fake time : 1 us per lookup, as if the server handled 1M packets per second
+    uint64_t clock = 1000000000ull;
+    uint64_t t0, sink = 0;
+
+    printf( "peers %ld, sessions %zu B each\n\n", npeers, sizeof( session_t ) );
+
+
+    /* ---------- INSERT ---------- */
+
+    t0 = now_ns();
+
+    for( long i = 0; i < npeers; i++ ) {
+        sess_lookup( t, ( struct sockaddr * ) &peers[ i ], clock += 1000 ) -> packets++;
+    }
+
+    report( "insert", npeers, now_ns() - t0 );
+
+
+    /* ---------- UNIFORM ---------- */
+
+    for( long i = 0; i < nlookups; i++ ) {
+        order[ i ] = rng() % npeers;
+    }
+
+    sess_stats_t before, after;
+    sess_stats( t, &before );
+
+    t0 = now_ns();
+
+    for( long i = 0; i < nlookups; i++ ) {
+        sink += ++sess_lookup( t, ( struct sockaddr * ) &peers[ order[ i ] ], clock += 1000 ) -> packets;
+    }
+
+    report( "uniform", nlookups, now_ns() - t0 );
+
+    sess_stats( t, &after );
+
+
+    /* ---------- HOT SET ---------- */
+
+    long hot = npeers / 100;
+
+    for( long i = 0; i < nlookups; i++ ) {
+        order[ i ] = rng() % 10 < 9 ? ( long ) ( rng() % hot ) : ( long ) ( rng() % npeers );
+    }
+
+    t0 = now_ns();
+
+    for( long i = 0; i < nlookups; i++ ) {
+        sink += ++sess_lookup( t, ( struct sockaddr * ) &peers[ order[ i ] ], clock += 1000 ) -> packets;
+    }
+
+    report( "hot", nlookups, now_ns() - t0 );
+
+
+    /* ---------- CHURN ---------- */
+
+    sess_stats_t st;
+    sess_stats( t, &st );
+
+    // every uniform / hot lookup must have hit an existing session
+    if( st.created != ( uint64_t ) npeers || st.active != ( size_t ) npeers ) {
+        fprintf( stderr, "table inconsistent : %llu created, %zu active\n", ( unsigned long long ) st.created, st.active );
+        exit( 1 );
+    }
+
+    uint64_t evicted0 = st.evicted;
+
+    t0 = now_ns();
+
+    for( long i = npeers; i < 2 * npeers; i++ ) {
+        sess_lookup( t, ( struct sockaddr * ) &peers[ i ], clock += 1000 ) -> packets++;
+    }
+
+    report( "churn", npeers, now_ns() - t0 );
+
+    sess_stats( t, &st );
+
+
+    /* ---------- EXPIRE ---------- */
+
+    clock += 3600 * 1000000000ull;
+
+    t0 = now_ns();
+    size_t expired = sess_expire( t, clock );
+
+    report( "expire", ( long ) expired, now_ns() - t0 );
+
+    printf( "\nprobes per lookup ( uniform ) : %.3f\n",
+            ( double ) ( after.probes - before.probes ) / ( after.lookups - before.lookups ) );
+    printf( "evicted during churn          : %llu\n", ( unsigned long long ) ( st.evicted - evicted0 ) );
+    printf( "table memory                  : %.1f MiB ( %zu index slots )\n", st.memory / 1048576.0, st.slots );
+
+    // keeps the compiler from dropping the lookup loops
+    if( sink == 42 ) {
+        printf( "\n" );
+    }
+
+    sess_destroy( t );
+
+    return 0;
+}
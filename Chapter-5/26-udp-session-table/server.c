@@ -0,0 +1,335 @@
+/*
+    server.c
+
+    UDP echo server with per-client sessions
+    ( 5-UDP-sendto-recvfrom/server.c, no longer anonymous )
+
+    What it does :
+        - receives in batches ( recvmmsg, like 21-recvmmsg-udp-echo )
+        - looks up every sender in the session table ( session.c )
+        - counts packets and bytes per client
+        - optional per-client rate limit : over the limit, no echo
+        - a timerfd ticks once a second and expires idle sessions
+        - Ctrl+C prints table stats and the top talkers
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 -I../21-recvmmsg-udp-echo \
+            server.c session.c ../21-recvmmsg-udp-echo/sendbatch.c -o server
+
+    Run:
+        ./server                          ( port 3490, 1M sessions, 30 s idle )
+        ./server -r 1000 -i 10 -v         ( 1000 pkt/s per client, stats every second )
+
+    Linux only ( recvmmsg / sendmmsg, timerfd )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <signal.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+
+#include "session.h"
+#include "sendbatch.h"
+
+#define PORT "3490"
+#define MAX_BATCH 1024
+#define DGRAM_SIZE 2048
+#define TOP 10
+
+volatile sig_atomic_t stop = 0;
+
+
+void on_signal( int sig ) {
+
+    ( void ) sig;
+    stop = 1;
+}
+
+
+uint64_t now_ns( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+void print_summary( sess_table_t *t ) {
+
+    sess_stats_t st;
+    sess_stats( t, &st );
+
+    printf( "\nsessions : %zu active / %zu max, %llu created, %llu expired, %llu evicted\n",
+            st.active, st.capacity, ( unsigned long long ) st.created,
+            ( unsigned long long ) st.expired, ( unsigned long long ) st.evicted );
+    printf( "table    : %.1f MiB, %.2f probes per lookup\n",
+            st.memory / 1048576.0, st.lookups ? ( double ) st.probes / st.lookups : 0.0 );
+
+    // top talkers : keep the TOP biggest, insertion sorted
+    session_t *top[ TOP ] = { 0 };
+
+    for( session_t *s = sess_next( t, NULL ); s; s = sess_next( t, s ) ) {
+
+        if( top[ TOP - 1 ] && s -> packets <= top[ TOP - 1 ] -> packets ) {
+            continue;
+        }
+
+        int i = TOP - 1;
+
+        while( i > 0 && ( top[ i - 1 ] == NULL || top[ i - 1 ] -> packets < s -> packets ) ) {
+            top[ i ] = top[ i - 1 ];
+            i--;
+        }
+
+        top[ i ] = s;
+    }
+
+    printf( "\n%-48s %12s %14s\n", "client", "packets", "bytes" );
+
+    for( int i = 0; i < TOP && top[ i ]; i++ ) {
+
+        char name[ 80 ];
+
+        printf( "%-48s %12llu %14llu\n", sess_name( top[ i ], name, sizeof name ),
+                ( unsigned long long ) top[ i ] -> packets, ( unsigned long long ) top[ i ] -> bytes );
+    }
+}
+
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = PORT;
+    int batch = 32;                 // -b
+    long max_sessions = 1000000;    // -m
+    int idle = 30;                  // -i : seconds
+    unsigned rate = 0;              // -r : packets per second per client, 0 = no limit
+    int verbose = 0;                // -v
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "p:b:m:i:r:v" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'p': port = optarg; break;
+            case 'b': batch = atoi( optarg ); break;
+            case 'm': max_sessions = atol( optarg ); break;
+            case 'i': idle = atoi( optarg ); break;
+            case 'r': rate = strtoul( optarg, NULL, 10 ); break;
+            case 'v': verbose = 1; break;
+            default: goto usage;
+        }
+    }
+
+    if( batch < 1 || batch > MAX_BATCH || max_sessions < 1 || idle < 1 ) {
+usage:
+        fprintf( stderr, "usage: %s [-p port] [-b batch] [-m max-sessions] [-i idle-seconds] [-r pkt/s-per-client] [-v]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+    sess_table_t *table = sess_create( max_sessions, idle * 1000000000ull );
+
+    if( table == NULL ) {
+        fprintf( stderr, "session table: out of memory\n" );
+        exit( 1 );
+    }
+
+    struct addrinfo hints, *res, *p;
+    int sockfd;
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_UNSPEC;     // IPv4 or IPv6
+    hints.ai_socktype = SOCK_DGRAM;    // UDP socket
+    hints.ai_flags    = AI_PASSIVE;    // Use my IP
+
+    int status = getaddrinfo( NULL, port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype | SOCK_NONBLOCK, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            continue;
+        }
+
+        if( bind( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            continue;
+        }
+
+        break;   // Successfully bound
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        printf( "Failed to bind\n" );
+        exit( 1 );
+    }
+
+
+    /* ================= EXPIRY TIMER ================= */
+
+    // one tick per second : expiry work is spread out instead of piling up
+    int tfd = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK );
+
+    struct itimerspec its = { { 1, 0 }, { 1, 0 } };
+    timerfd_settime( tfd, 0, &its, NULL );
+
+    struct sigaction sa;
+    memset( &sa, 0, sizeof sa );
+    sa.sa_handler = on_signal;
+    sigaction( SIGINT, &sa, NULL );
+    sigaction( SIGTERM, &sa, NULL );
+
+
+    /* ================= PREALLOCATED BATCH ================= */
+
+    struct mmsghdr *msgs = calloc( batch, sizeof *msgs );
+    struct mmsghdr *out = calloc( batch, sizeof *out );
+    struct iovec *iov = calloc( batch, sizeof *iov );
+    struct sockaddr_storage *addrs = calloc( batch, sizeof *addrs );
+    char *bufs = malloc( ( size_t ) batch * DGRAM_SIZE );
+
+    for( int i = 0; i < batch; i++ ) {
+
+        iov[ i ].iov_base = bufs + ( size_t ) i * DGRAM_SIZE;
+
+        msgs[ i ].msg_hdr.msg_iov = &iov[ i ];
+        msgs[ i ].msg_hdr.msg_iovlen = 1;
+        msgs[ i ].msg_hdr.msg_name = &addrs[ i ];
+    }
+
+    printf( "UDP Server listening on %s ( %ld sessions max, %d s idle",
+            port, max_sessions, idle );
+
+    if( rate ) {
+        printf( ", %u pkt/s per client", rate );
+    }
+
+    printf( " )...\n" );
+    fflush( stdout );
+
+    struct pollfd pfds[ 2 ] = { { sockfd, POLLIN, 0 }, { tfd, POLLIN, 0 } };
+
+    unsigned long long packets = 0, limited = 0, send_errors = 0;
+
+    while( !stop ) {
+
+        if( poll( pfds, 2, -1 ) == -1 ) {
+            continue;   // EINTR : the loop condition sees the signal
+        }
+
+
+        /* ---------- TIMER : expire idle sessions ---------- */
+
+        if( pfds[ 1 ].revents & POLLIN ) {
+
+            uint64_t ticks;
+            read( tfd, &ticks, sizeof ticks );
+
+            size_t expired = sess_expire( table, now_ns() );
+
+            if( verbose ) {
+
+                sess_stats_t st;
+                sess_stats( table, &st );
+
+                printf( "%llu pkt/s | %zu sessions | %zu expired | %llu rate-limited",
+                        packets, st.active, expired, limited );
+
+                if( send_errors ) {
+                    printf( " | %llu send errors", send_errors );
+                }
+
+                printf( "\n" );
+                fflush( stdout );
+            }
+
+            packets = limited = send_errors = 0;
+        }
+
+        if( !( pfds[ 0 ].revents & POLLIN ) ) {
+            continue;
+        }
+
+
+        /* ---------- DATAGRAMS : drain the socket in batches ---------- */
+
+        int n;
+
+        do {
+
+            for( int i = 0; i < batch; i++ ) {
+                iov[ i ].iov_len = DGRAM_SIZE;
+                msgs[ i ].msg_hdr.msg_namelen = sizeof addrs[ i ];
+            }
+
+            n = recvmmsg( sockfd, msgs, batch, 0, NULL );
+
+            if( n <= 0 ) {
+                break;
+            }
+
+            // one clock read per batch is precise enough for idle timeouts
+            uint64_t now = now_ns();
+            uint16_t sec = ( uint16_t ) ( now / 1000000000ull );
+            int m = 0;
+
+            for( int i = 0; i < n; i++ ) {
+
+                session_t *s = sess_lookup( table, ( struct sockaddr * ) &addrs[ i ], now );
+
+                if( s == NULL ) {
+                    continue;
+                }
+
+                s -> packets++;
+                s -> bytes += msgs[ i ].msg_len;
+
+                // fixed one-second window per client
+                if( s -> window_sec != sec ) {
+                    s -> window_sec = sec;
+                    s -> window_pkts = 0;
+                }
+
+                if( rate && ++s -> window_pkts > rate ) {
+                    limited++;
+                    continue;
+                }
+
+                // echo : same buffer and address, reply length = received length
+                iov[ i ].iov_len = msgs[ i ].msg_len;
+                out[ m++ ] = msgs[ i ];
+            }
+
+            packets += n;
+
+            // a reply that fails is skipped and counted, the rest still go out
+            send_batch( sockfd, out, m, &send_errors );
+
+        } while( n == batch && !stop );
+    }
+
+    print_summary( table );
+
+    sess_destroy( table );
+    close( tfd );
+    close( sockfd );
+
+    return 0;
+}
@@ -0,0 +1,434 @@
+/*
+    session.c
+
+    Open-addressing session table with LRU expiry ( see session.h )
+
+    Compile together with the program that uses it:
+        gcc -Wall -Wextra -pedantic -O2 session.c your_server.c -o your_server
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/random.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "session.h"
+
+
+/* ================= LAYOUT ================= */
+
+// index slot : 8 bytes, 8 per cache line
+typedef struct {
+
+    uint32_t hash;
+    uint32_t entry;         // 0 = empty slot
+
+} slot_t;
+
+struct sess_table {
+
+    slot_t *index;
+    session_t *entries;     // entries[ 0 ] unused : 0 means "none" everywhere
+
+    size_t mask;            // index slots - 1
+    size_t capacity;
+    size_t active;
+
+    uint32_t free_head;     // unused entries, linked through .next
+    uint32_t lru_head;      // most recently used
+    uint32_t lru_tail;      // least recently used : next to expire
+
+    uint64_t idle_ns;
+    uint64_t seed;          // random per table : clients cannot aim at one bucket
+
+    size_t index_bytes, entry_bytes;
+    sess_stats_t st;
+};
+
+
+
+/* ================= HELPERS ================= */
+
+// big zeroed allocation, backed by huge pages when the kernel allows it
+static void *big_alloc( size_t bytes ) {
+
+    void *p = mmap( NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+    if( p == MAP_FAILED ) {
+        return NULL;
+    }
+
+    madvise( p, bytes, MADV_HUGEPAGE );
+
+    return p;
+}
+
+
+// murmur3 finalizer : every input bit affects every output bit
+static uint64_t mix64( uint64_t x ) {
+
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+
+    return x;
+}
+
+
+static uint32_t key_hash( const sess_table_t *t, const sess_key_t *k ) {
+
+    uint64_t a, b;
+
+    memcpy( &a, k -> addr, 8 );
+    memcpy( &b, k -> addr + 8, 8 );
+
+    uint64_t h = mix64( a ^ t -> seed );
+    h = mix64( h ^ b );
+    h = mix64( h ^ k -> port );
+
+    return ( uint32_t ) ( h ^ ( h >> 32 ) );
+}
+
+
+static void lru_unlink( sess_table_t *t, uint32_t e ) {
+
+    session_t *s = &t -> entries[ e ];
+
+    if( s -> prev ) {
+        t -> entries[ s -> prev ].next = s -> next;
+    } else {
+        t -> lru_head = s -> next;
+    }
+
+    if( s -> next ) {
+        t -> entries[ s -> next ].prev = s -> prev;
+    } else {
+        t -> lru_tail = s -> prev;
+    }
+}
+
+
+static void lru_push_front( sess_table_t *t, uint32_t e ) {
+
+    session_t *s = &t -> entries[ e ];
+
+    s -> prev = 0;
+    s -> next = t -> lru_head;
+
+    if( t -> lru_head ) {
+        t -> entries[ t -> lru_head ].prev = e;
+    } else {
+        t -> lru_tail = e;
+    }
+
+    t -> lru_head = e;
+}
+
+
+/*
+    Delete without tombstones ( backward shift ) :
+    after emptying slot i, later slots of the same probe run are moved
+    back into the hole when their home slot allows it,
+    so lookups never have to skip over deleted markers
+*/
+static void remove_entry( sess_table_t *t, uint32_t e ) {
+
+    size_t mask = t -> mask;
+    size_t i = t -> entries[ e ].hash & mask;
+
+    while( t -> index[ i ].entry != e ) {
+        i = ( i + 1 ) & mask;
+    }
+
+    size_t j = i;
+
+    while( 1 ) {
+
+        j = ( j + 1 ) & mask;
+
+        if( t -> index[ j ].entry == 0 ) {
+            break;
+        }
+
+        size_t home = t -> index[ j ].hash & mask;
+
+        // slot j may move to i only if i lies between its home and j
+        if( ( ( j - home ) & mask ) >= ( ( j - i ) & mask ) ) {
+            t -> index[ i ] = t -> index[ j ];
+            i = j;
+        }
+    }
+
+    t -> index[ i ].entry = 0;
+
+    lru_unlink( t, e );
+
+    t -> entries[ e ].next = t -> free_head;
+    t -> free_head = e;
+    t -> active--;
+}
+
+
+
+/* ================= API ================= */
+
+sess_table_t *sess_create( size_t max_sessions, uint64_t idle_ns ) {
+
+    if( max_sessions == 0 || max_sessions >= UINT32_MAX / 2 ) {
+        return NULL;
+    }
+
+    sess_table_t *t = calloc( 1, sizeof *t );
+
+    if( t == NULL ) {
+        return NULL;
+    }
+
+    // load factor <= 0.5 keeps probe runs short
+    size_t slots = 16;
+
+    while( slots < 2 * max_sessions ) {
+        slots *= 2;
+    }
+
+    t -> index_bytes = slots * sizeof( slot_t );
+    t -> entry_bytes = ( max_sessions + 1 ) * sizeof( session_t );
+
+    t -> index = big_alloc( t -> index_bytes );
+    t -> entries = big_alloc( t -> entry_bytes );
+
+    if( t -> index == NULL || t -> entries == NULL ) {
+        sess_destroy( t );
+        return NULL;
+    }
+
+    t -> mask = slots - 1;
+    t -> capacity = max_sessions;
+    t -> idle_ns = idle_ns;
+
+    if( getrandom( &t -> seed, sizeof t -> seed, 0 ) != sizeof t -> seed ) {
+        t -> seed = ( uintptr_t ) t;
+    }
+
+    // free list in ascending order : entries are handed out front to back
+    for( size_t e = max_sessions; e >= 1; e-- ) {
+        t -> entries[ e ].next = t -> free_head;
+        t -> free_head = ( uint32_t ) e;
+    }
+
+    return t;
+}
+
+
+void sess_destroy( sess_table_t *t ) {
+
+    if( t == NULL ) {
+        return;
+    }
+
+    if( t -> index ) {
+        munmap( t -> index, t -> index_bytes );
+    }
+
+    if( t -> entries ) {
+        munmap( t -> entries, t -> entry_bytes );
+    }
+
+    free( t );
+}
+
+
+int sess_key( const struct sockaddr *sa, sess_key_t *key ) {
+
+    memset( key, 0, sizeof *key );
+
+    if( sa -> sa_family == AF_INET ) {
+
+        const struct sockaddr_in *in = ( const struct sockaddr_in * ) sa;
+
+        key -> addr[ 10 ] = 0xff;
+        key -> addr[ 11 ] = 0xff;
+        memcpy( key -> addr + 12, &in -> sin_addr, 4 );
+        key -> port = in -> sin_port;
+        key -> family = AF_INET;
+
+        return 0;
+    }
+
+    if( sa -> sa_family == AF_INET6 ) {
+
+        const struct sockaddr_in6 *in6 = ( const struct sockaddr_in6 * ) sa;
+
+        memcpy( key -> addr, &in6 -> sin6_addr, 16 );
+        key -> port = in6 -> sin6_port;
+
+        // ::ffff:a.b.c.d from a dual-stack socket is the same client as a.b.c.d
+        key -> family = IN6_IS_ADDR_V4MAPPED( &in6 -> sin6_addr ) ? AF_INET : AF_INET6;
+
+        return 0;
+    }
+
+    return -1;
+}
+
+
+session_t *sess_lookup( sess_table_t *t, const struct sockaddr *sa, uint64_t now_ns ) {
+
+    sess_key_t key;
+
+    if( sess_key( sa, &key ) == -1 ) {
+        return NULL;
+    }
+
+    return sess_lookup_key( t, &key, now_ns );
+}
+
+
+session_t *sess_lookup_key( sess_table_t *t, const sess_key_t *key, uint64_t now_ns ) {
+
+    uint32_t h = key_hash( t, key );
+    size_t i = h & t -> mask;
+
+    t -> st.lookups++;
+
+    /* ---------- FIND ---------- */
+
+    while( 1 ) {
+
+        slot_t sl = t -> index[ i ];
+
+        t -> st.probes++;
+
+        if( sl.entry == 0 ) {
+            break;      // end of the probe run : not in the table
+        }
+
+        // hash first : the session's cache line is only read on a likely match
+        if( sl.hash == h && memcmp( &t -> entries[ sl.entry ].key, key, sizeof *key ) == 0 ) {
+
+            session_t *s = &t -> entries[ sl.entry ];
+            uint16_t sec = ( uint16_t ) ( now_ns / 1000000000ull );
+
+            // relinking touches two neighbour sessions : do it once per second at most
+            if( s -> lru_sec != sec ) {
+
+                s -> lru_sec = sec;
+
+                if( t -> lru_head != sl.entry ) {
+                    lru_unlink( t, sl.entry );
+                    lru_push_front( t, sl.entry );
+                }
+            }
+
+            s -> last_ns = now_ns;
+
+            return s;
+        }
+
+        i = ( i + 1 ) & t -> mask;
+    }
+
+    /* ---------- INSERT ---------- */
+
+    if( t -> active == t -> capacity ) {
+
+        remove_entry( t, t -> lru_tail );
+        t -> st.evicted++;
+
+        // the backward shift may have moved slots : find the hole again
+        i = h & t -> mask;
+
+        while( t -> index[ i ].entry != 0 ) {
+            i = ( i + 1 ) & t -> mask;
+        }
+    }
+
+    uint32_t e = t -> free_head;
+    session_t *s = &t -> entries[ e ];
+
+    t -> free_head = s -> next;
+
+    memset( s, 0, sizeof *s );
+    s -> key = *key;
+    s -> hash = h;
+    s -> last_ns = now_ns;
+    s -> lru_sec = ( uint16_t ) ( now_ns / 1000000000ull );
+
+    lru_push_front( t, e );
+
+    t -> index[ i ].hash = h;
+    t -> index[ i ].entry = e;
+
+    t -> active++;
+    t -> st.created++;
+
+    return s;
+}
+
+
+size_t sess_expire( sess_table_t *t, uint64_t now_ns ) {
+
+    size_t n = 0;
+
+    // the tail is the oldest : stop at the first session that is still fresh
+    while( t -> lru_tail ) {
+
+        uint64_t last = t -> entries[ t -> lru_tail ].last_ns;
+
+        if( last >= now_ns || now_ns - last <= t -> idle_ns ) {
+            break;
+        }
+
+        remove_entry( t, t -> lru_tail );
+        n++;
+    }
+
+    t -> st.expired += n;
+
+    return n;
+}
+
+
+session_t *sess_next( sess_table_t *t, session_t *s ) {
+
+    uint32_t e = s ? s -> next : t -> lru_head;
+
+    return e ? &t -> entries[ e ] : NULL;
+}
+
+
+void sess_stats( sess_table_t *t, sess_stats_t *out ) {
+
+    *out = t -> st;
+
+    out -> active = t -> active;
+    out -> capacity = t -> capacity;
+    out -> slots = t -> mask + 1;
+    out -> memory = t -> index_bytes + t -> entry_bytes;
+}
+
+
+const char *sess_name( const session_t *s, char *buf, size_t len ) {
+
+    char ip[ INET6_ADDRSTRLEN ];
+
+    if( s -> key.family == AF_INET ) {
+
+        inet_ntop( AF_INET, s -> key.addr + 12, ip, sizeof ip );
+        snprintf( buf, len, "%s:%u", ip, ntohs( s -> key.port ) );
+
+    } else {
+
+        inet_ntop( AF_INET6, s -> key.addr, ip, sizeof ip );
+        snprintf( buf, len, "[%s]:%u", ip, ntohs( s -> key.port ) );
+    }
+
+    return buf;
+}
@@ -0,0 +1,113 @@
+/*
+    session.h
+
+    Per-client session table for UDP servers, keyed by source address
+
+    Key:
+        IPv4 and IPv6 addresses normalized to 16 bytes
+        ( IPv4 stored as ::ffff:a.b.c.d ) plus the port
+
+    Design:
+        - open addressing with linear probing, load factor <= 0.5
+        - index slot = 8 bytes : 32-bit hash + entry number,
+          so a probe compares hashes inside one cache line and touches
+          the 64-byte session only when the hash matches
+        - sessions live in one preallocated array, no malloc per client
+        - a hit moves the session to the front of an LRU list, at most
+          once per second : busy clients do not rewrite list links on
+          every packet
+        - sess_expire() drops idle sessions from the back of the list
+          ( call it from a timer ), accurate to about one second
+        - when the table is full the least recently used session is evicted
+
+    Usage:
+        sess_table_t *t = sess_create( 1000000, 30 * 1000000000ull );
+        session_t *s = sess_lookup( t, ( struct sockaddr * ) &from, now_ns );
+        s -> packets++;
+        ...
+        sess_expire( t, now_ns );     // once a second
+*/
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/socket.h>
+
+
+// normalized address : 20 bytes, compared with memcmp()
+typedef struct {
+
+    uint8_t addr[ 16 ];     // IPv6, or IPv4-mapped IPv6
+    uint16_t port;          // network byte order
+    uint16_t family;        // original family, for printing
+
+} sess_key_t;
+
+// one client, exactly one cache line
+typedef struct {
+
+    sess_key_t key;
+    uint32_t hash;
+    uint32_t prev, next;            // LRU links ( entry numbers, 0 = none )
+
+    uint64_t last_ns;               // last packet, drives expiry
+    uint64_t packets;
+    uint64_t bytes;
+
+    uint16_t lru_sec;               // second of the last move to the LRU front
+
+    // application state : packets in the current one-second window
+    uint16_t window_sec;
+    uint32_t window_pkts;
+
+} __attribute__( ( aligned( 64 ) ) ) session_t;
+
+typedef struct {
+
+    size_t active;          // sessions in the table
+    size_t capacity;        // max sessions
+    size_t slots;           // index slots ( power of two )
+    size_t memory;          // bytes for index + sessions
+
+    uint64_t lookups;
+    uint64_t probes;        // index slots inspected by all lookups
+    uint64_t created;
+    uint64_t expired;       // removed by sess_expire()
+    uint64_t evicted;       // removed to make room ( table full )
+
+} sess_stats_t;
+
+typedef struct sess_table sess_table_t;
+
+
+// table for up to max_sessions clients, idle sessions expire after idle_ns
+// returns NULL if memory cannot be allocated
+sess_table_t *sess_create( size_t max_sessions, uint64_t idle_ns );
+
+void sess_destroy( sess_table_t *t );
+
+// normalize a sockaddr ( AF_INET or AF_INET6 ), returns -1 for other families
+int sess_key( const struct sockaddr *sa, sess_key_t *key );
+
+// find the client's session, creating it if new ( evicts the LRU one if full )
+// sets last_ns = now_ns, moves it to the LRU front once per second
+// returns NULL only for unsupported address families
+session_t *sess_lookup( sess_table_t *t, const struct sockaddr *sa, uint64_t now_ns );
+
+// same, with a key that is already normalized
+session_t *sess_lookup_key( sess_table_t *t, const sess_key_t *key, uint64_t now_ns );
+
+// remove every session idle for longer than idle_ns, returns how many
+size_t sess_expire( sess_table_t *t, uint64_t now_ns );
+
+// walk sessions from most to least recently used ( NULL = start / end )
+session_t *sess_next( sess_table_t *t, session_t *s );
+
+void sess_stats( sess_table_t *t, sess_stats_t *out );
+
+// "[2001:db8::1]:3490" or "192.0.2.1:3490"
+const char *sess_name( const session_t *s, char *buf, size_t len );
+
+#endif
@@ -0,0 +1,66 @@
+#!/bin/sh
+#
+#   bench.sh
+#
+#   io_uring server vs recvmmsg server ( 21-recvmmsg-udp-echo ) under the same load
+#
+#   Reports for each server:
+#       replies/s seen by the client, server CPU per packet, syscalls per packet
+#
+#   Usage:
+#       ./bench.sh [seconds] [sockets] [window] [size]
+#
+#   Example:
+#       ./bench.sh 5 16 64 64
+
+SECS=${1:-5}
+SOCKS=${2:-16}
+WINDOW=${3:-64}
+SIZE=${4:-64}
+PORT=34970
+MMSG=${MMSG:-../21-recvmmsg-udp-echo/server}
+BLAST=${BLAST:-../21-recvmmsg-udp-echo/udp_blast}
+HZ=$( getconf CLK_TCK )
+OUT=/tmp/io-uring-bench.$$
+
+# utime + stime of a process, in clock ticks
+cpu_ticks() {
+    awk '{ print $14 + $15 }' "/proc/$1/stat"
+}
+
+run() {
+
+    NAME=$1
+    shift
+
+    "$@" -p "$PORT" > "$OUT" &
+    SERVER=$!
+    sleep 0.3
+
+    T0=$( cpu_ticks "$SERVER" )
+    RESULT=$( "$BLAST" 127.0.0.1 "$PORT" -S "$SOCKS" -w "$WINDOW" -z "$SIZE" -d "$SECS" )
+    T1=$( cpu_ticks "$SERVER" )
+
+    kill "$SERVER"
+    wait "$SERVER" 2> /dev/null
+
+    REPLIES=$( echo "$RESULT" | awk '{ for( i = 1; i < NF; i++ ) if( $i == "replies" ) print $( i + 1 ) }' )
+
+    # recvmmsg server prints "pkts per recvmmsg" : one recvmmsg + one sendmmsg per batch
+    # io_uring server prints "syscalls per packet" directly
+    SYSCALLS=$( tail -n 2 "$OUT" | head -n 1 | awk '
+        /per recvmmsg/        { printf "%.3f", 2 / $4 }
+        /syscalls per packet/ { printf "%.3f", $4 }' )
+
+    echo "$NAME $REPLIES $T0 $T1 $SYSCALLS" | awk -v hz="$HZ" -v secs="$SECS" '{
+        us = ( $4 - $3 ) / hz * 1e6 / ( $2 * secs )
+        printf "%-10s %12.0f %14.2f %16s\n", $1, $2, us, $5
+    }'
+}
+
+printf "%-10s %12s %14s %16s\n" "server" "replies/s" "cpu us/pkt" "syscalls/pkt"
+
+run recvmmsg "$MMSG" -b 64
+run io_uring ./server -v
+
+rm -f "$OUT"
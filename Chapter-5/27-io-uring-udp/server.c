@@ -0,0 +1,335 @@
+/*
+    server.c
+
+    UDP echo server on io_uring
+    ( 5-UDP-sendto-recvfrom/server.c, receive path without recvfrom() )
+
+    Receive:
+        ONE multishot IORING_OP_RECVMSG submission stays armed forever.
+        Each datagram becomes a completion ( CQE ); the kernel picks a free
+        buffer from a provided buffer ring and writes into it :
+
+            [ io_uring_recvmsg_out | sender address | payload ]
+
+    Reply:
+        one IORING_OP_SENDMSG per datagram, pointing straight into that
+        buffer ( no copy ). All replies for a round of completions are
+        submitted together with the next wait : ONE io_uring_enter()
+        both sends the batch and collects the next one.
+
+    A buffer goes back to the ring when its reply completes.
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 server.c uring.c -o server
+
+    Run:
+        ./server                    ( port 3490, 1024 buffers )
+        ./server -p 3490 -n 4096 -v
+
+    Linux only ( 6.0+ : multishot recvmsg, provided buffer rings )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+#include "uring.h"
+
+#define PORT "3490"
+#define BUF_SIZE 2048           // header + address + payload per datagram
+#define BGID 1                  // buffer group id
+#define SQ_ENTRIES 256
+
+// user_data : what a completion belongs to
+#define TAG_RECV ( 1ull << 32 )
+#define TAG_SEND ( 2ull << 32 )
+
+
+// per-buffer reply state : must live until the send completes
+typedef struct {
+
+    struct msghdr mh;
+    struct iovec iov;
+
+} reply_t;
+
+
+uring_t ring;
+uring_bufring_t bufring;
+
+char *buffers;
+reply_t *replies;
+
+struct msghdr recv_tmpl;        // tells multishot recvmsg how much room the name gets
+
+
+// next free SQE, submitting what is queued if the SQ is full
+struct io_uring_sqe *get_sqe( void ) {
+
+    struct io_uring_sqe *sqe;
+
+    while( ( sqe = uring_get_sqe( &ring ) ) == NULL ) {
+
+        int err = uring_enter( &ring, 0 );
+
+        if( err < 0 ) {
+            fprintf( stderr, "io_uring_enter: %s\n", strerror( -err ) );
+            exit( 1 );
+        }
+    }
+
+    return sqe;
+}
+
+
+void arm_recv( int sockfd ) {
+
+    struct io_uring_sqe *sqe = get_sqe();
+
+    sqe -> opcode = IORING_OP_RECVMSG;
+    sqe -> fd = sockfd;
+    sqe -> addr = ( unsigned long ) &recv_tmpl;
+    sqe -> len = 1;
+    sqe -> ioprio = IORING_RECV_MULTISHOT;     // stay armed : one CQE per datagram
+    sqe -> flags = IOSQE_BUFFER_SELECT;        // kernel picks the buffer ...
+    sqe -> buf_group = BGID;                   // ... from this group
+    sqe -> user_data = TAG_RECV;
+}
+
+
+void give_back( unsigned short bid ) {
+
+    uring_buf_add( &bufring, buffers + ( size_t ) bid * BUF_SIZE, BUF_SIZE, bid );
+}
+
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = PORT;
+    unsigned nbufs = 1024;      // -n : buffers in the ring ( power of two )
+    int verbose = 0;
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "p:n:v" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'p': port = optarg; break;
+            case 'n': nbufs = strtoul( optarg, NULL, 10 ); break;
+            case 'v': verbose = 1; break;
+            default:
+                fprintf( stderr, "usage: %s [-p port] [-n buffers] [-v]\n", argv[ 0 ] );
+                exit( 1 );
+        }
+    }
+
+    if( nbufs < 8 || nbufs > 32768 || ( nbufs & ( nbufs - 1 ) ) ) {
+        fprintf( stderr, "buffers must be a power of two, 8..32768\n" );
+        exit( 1 );
+    }
+
+
+    /* ================= SOCKET ================= */
+
+    struct addrinfo hints, *res, *p;
+    int sockfd;
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_UNSPEC;     // IPv4 or IPv6
+    hints.ai_socktype = SOCK_DGRAM;    // UDP socket
+    hints.ai_flags    = AI_PASSIVE;    // Use my IP
+
+    int status = getaddrinfo( NULL, port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            continue;
+        }
+
+        if( bind( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            continue;
+        }
+
+        break;   // Successfully bound
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        printf( "Failed to bind\n" );
+        exit( 1 );
+    }
+
+
+    /* ================= RING + BUFFERS ================= */
+
+    // CQ : room for one receive and one send completion per buffer
+    int err = uring_init( &ring, SQ_ENTRIES, 2 * nbufs + SQ_ENTRIES );
+
+    if( err < 0 ) {
+        fprintf( stderr, "io_uring_setup: %s\n", strerror( -err ) );
+        exit( 1 );
+    }
+
+    err = uring_bufring_setup( &ring, &bufring, nbufs, BGID );
+
+    if( err < 0 ) {
+        fprintf( stderr, "buffer ring: %s ( needs Linux 5.19+ )\n", strerror( -err ) );
+        exit( 1 );
+    }
+
+    buffers = malloc( ( size_t ) nbufs * BUF_SIZE );
+    replies = calloc( nbufs, sizeof *replies );
+
+    if( buffers == NULL || replies == NULL ) {
+        perror( "malloc" );
+        exit( 1 );
+    }
+
+    for( unsigned i = 0; i < nbufs; i++ ) {
+        give_back( i );
+    }
+
+    uring_buf_publish( &bufring );
+
+    // only the name length matters : no control data, payload goes after the name
+    memset( &recv_tmpl, 0, sizeof recv_tmpl );
+    recv_tmpl.msg_namelen = sizeof( struct sockaddr_storage );
+
+    arm_recv( sockfd );
+
+    printf( "UDP Server listening on %s ( io_uring, %u buffers )...\n", port, nbufs );
+    fflush( stdout );
+
+
+    /* ================= EVENT LOOP ================= */
+
+    unsigned long long packets = 0, rearms = 0, last_enters = 0, no_buffers = 0;
+    time_t last = time( NULL );
+
+    while( 1 ) {
+
+        // submit queued replies AND wait for more completions : one syscall
+        err = uring_enter( &ring, 1 );
+
+        if( err < 0 ) {
+            fprintf( stderr, "io_uring_enter: %s\n", strerror( -err ) );
+            exit( 1 );
+        }
+
+        struct io_uring_cqe *cqe;
+        int returned = 0;
+
+        while( ( cqe = uring_peek_cqe( &ring ) ) != NULL ) {
+
+            // copy out first : after uring_cqe_seen() the kernel may reuse the slot
+            unsigned long long data = cqe -> user_data;
+            int result = cqe -> res;
+            unsigned flags = cqe -> flags;
+
+            uring_cqe_seen( &ring );
+
+
+            /* ---------- SEND DONE : buffer goes back to the ring ---------- */
+
+            if( ( data & ~0xffffffffull ) == TAG_SEND ) {
+
+                give_back( ( unsigned short ) ( data & 0xffff ) );
+                returned++;
+                continue;
+            }
+
+
+            /* ---------- DATAGRAM ---------- */
+
+            // multishot ended ( e.g. ENOBUFS : every buffer was in use ) : re-arm
+            if( !( flags & IORING_CQE_F_MORE ) ) {
+
+                rearms++;
+
+                if( result == -ENOBUFS ) {
+                    no_buffers++;
+                }
+
+                arm_recv( sockfd );
+            }
+
+            if( result < 0 || !( flags & IORING_CQE_F_BUFFER ) ) {
+                continue;
+            }
+
+            unsigned short bid = flags >> IORING_CQE_BUFFER_SHIFT;
+            char *buf = buffers + ( size_t ) bid * BUF_SIZE;
+
+            // buffer layout : [ out header | name ( msg_namelen bytes ) | payload ]
+            struct io_uring_recvmsg_out *out = ( struct io_uring_recvmsg_out * ) buf;
+            char *name = buf + sizeof *out;
+            char *payload = name + recv_tmpl.msg_namelen;
+
+            reply_t *r = &replies[ bid ];
+
+            memset( &r -> mh, 0, sizeof r -> mh );
+            r -> iov.iov_base = payload;
+            r -> iov.iov_len = out -> payloadlen;
+            r -> mh.msg_name = name;
+            r -> mh.msg_namelen = out -> namelen;
+            r -> mh.msg_iov = &r -> iov;
+            r -> mh.msg_iovlen = 1;
+
+            // echo : queued now, submitted with the next io_uring_enter()
+            struct io_uring_sqe *sqe = get_sqe();
+
+            sqe -> opcode = IORING_OP_SENDMSG;
+            sqe -> fd = sockfd;
+            sqe -> addr = ( unsigned long ) &r -> mh;
+            sqe -> len = 1;
+            sqe -> user_data = TAG_SEND | bid;
+
+            packets++;
+        }
+
+        if( returned ) {
+            uring_buf_publish( &bufring );
+        }
+
+        if( !verbose ) {
+            continue;
+        }
+
+        time_t now = time( NULL );
+
+        if( now != last ) {
+
+            unsigned long long enters = ring.enters - last_enters;
+
+            printf( "%llu pkt/s | %.3f syscalls per packet | %llu re-arms ( %llu out of buffers )\n",
+                    packets / ( now - last ), packets ? ( double ) enters / packets : 0.0, rearms, no_buffers );
+            fflush( stdout );
+
+            packets = rearms = no_buffers = 0;
+            last_enters = ring.enters;
+            last = now;
+        }
+    }
+
+    uring_exit( &ring );
+    close( sockfd );   // Close socket
+
+    return 0;
+}
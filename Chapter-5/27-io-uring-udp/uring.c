@@ -0,0 +1,289 @@
+/*
+    uring.c
+
+    Minimal io_uring wrapper on raw syscalls ( see uring.h )
+
+    Compile together with the program that uses it:
+        gcc -Wall -Wextra -pedantic -O2 uring.c your_server.c -o your_server
+*/
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "uring.h"
+
+
+/* ================= SYSCALLS ================= */
+
+static int sys_setup( unsigned entries, struct io_uring_params *p ) {
+
+    return ( int ) syscall( __NR_io_uring_setup, entries, p );
+}
+
+
+static int sys_enter( int fd, unsigned to_submit, unsigned min_complete, unsigned flags ) {
+
+    return ( int ) syscall( __NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0 );
+}
+
+
+static int sys_register( int fd, unsigned op, void *arg, unsigned nr ) {
+
+    return ( int ) syscall( __NR_io_uring_register, fd, op, arg, nr );
+}
+
+
+
+/* ================= RING ================= */
+
+int uring_init( uring_t *r, unsigned sq_entries, unsigned cq_entries ) {
+
+    struct io_uring_params p;
+
+    memset( r, 0, sizeof *r );
+    memset( &p, 0, sizeof p );
+
+    // CQSIZE : multishot receives produce many CQEs per SQE, so the CQ is bigger
+    // SINGLE_ISSUER + DEFER_TASKRUN : only this thread submits, and completions
+    // are posted when it calls io_uring_enter() to wait : they arrive in batches
+    p.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+    p.cq_entries = cq_entries;
+
+    r -> fd = sys_setup( sq_entries, &p );
+
+    // 5.19 - 6.0 : no DEFER_TASKRUN, at least avoid the IPIs
+    if( r -> fd < 0 && errno == EINVAL ) {
+        p.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN;
+        r -> fd = sys_setup( sq_entries, &p );
+    }
+
+    // older kernel : retry with the flags every version understands
+    if( r -> fd < 0 && errno == EINVAL ) {
+        p.flags = IORING_SETUP_CQSIZE;
+        r -> fd = sys_setup( sq_entries, &p );
+    }
+
+    if( r -> fd < 0 ) {
+        return -errno;
+    }
+
+    r -> sq_ring_size = p.sq_off.array + p.sq_entries * sizeof( unsigned );
+    r -> cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof( struct io_uring_cqe );
+    r -> sqes_size = p.sq_entries * sizeof( struct io_uring_sqe );
+
+    // SINGLE_MMAP : SQ and CQ rings share one mapping
+    if( p.features & IORING_FEAT_SINGLE_MMAP ) {
+
+        if( r -> cq_ring_size > r -> sq_ring_size ) {
+            r -> sq_ring_size = r -> cq_ring_size;
+        }
+
+        r -> cq_ring_size = r -> sq_ring_size;
+    }
+
+    r -> sq_ring = mmap( NULL, r -> sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         r -> fd, IORING_OFF_SQ_RING );
+
+    if( r -> sq_ring == MAP_FAILED ) {
+        goto fail;
+    }
+
+    if( p.features & IORING_FEAT_SINGLE_MMAP ) {
+
+        r -> cq_ring = r -> sq_ring;
+
+    } else {
+
+        r -> cq_ring = mmap( NULL, r -> cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             r -> fd, IORING_OFF_CQ_RING );
+
+        if( r -> cq_ring == MAP_FAILED ) {
+            goto fail;
+        }
+    }
+
+    r -> sqes = mmap( NULL, r -> sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      r -> fd, IORING_OFF_SQES );
+
+    if( r -> sqes == MAP_FAILED ) {
+        goto fail;
+    }
+
+    char *sq = r -> sq_ring, *cq = r -> cq_ring;
+
+    r -> sq_head  = ( unsigned * ) ( sq + p.sq_off.head );
+    r -> sq_tail  = ( unsigned * ) ( sq + p.sq_off.tail );
+    r -> sq_mask  = ( unsigned * ) ( sq + p.sq_off.ring_mask );
+    r -> sq_array = ( unsigned * ) ( sq + p.sq_off.array );
+    r -> sq_entries = p.sq_entries;
+    r -> sq_local_tail = r -> sq_submitted = *r -> sq_tail;
+
+    r -> cq_head = ( unsigned * ) ( cq + p.cq_off.head );
+    r -> cq_tail = ( unsigned * ) ( cq + p.cq_off.tail );
+    r -> cq_mask = ( unsigned * ) ( cq + p.cq_off.ring_mask );
+    r -> cqes    = ( struct io_uring_cqe * ) ( cq + p.cq_off.cqes );
+
+    return 0;
+
+fail:
+    {
+        int err = errno;
+        uring_exit( r );
+        return -err;
+    }
+}
+
+
+void uring_exit( uring_t *r ) {
+
+    if( r -> sqes && r -> sqes != MAP_FAILED ) {
+        munmap( r -> sqes, r -> sqes_size );
+    }
+
+    if( r -> cq_ring && r -> cq_ring != MAP_FAILED && r -> cq_ring != r -> sq_ring ) {
+        munmap( r -> cq_ring, r -> cq_ring_size );
+    }
+
+    if( r -> sq_ring && r -> sq_ring != MAP_FAILED ) {
+        munmap( r -> sq_ring, r -> sq_ring_size );
+    }
+
+    if( r -> fd >= 0 ) {
+        close( r -> fd );
+    }
+
+    r -> fd = -1;
+}
+
+
+struct io_uring_sqe *uring_get_sqe( uring_t *r ) {
+
+    unsigned head = __atomic_load_n( r -> sq_head, __ATOMIC_ACQUIRE );
+
+    if( r -> sq_local_tail - head >= r -> sq_entries ) {
+        return NULL;
+    }
+
+    unsigned idx = r -> sq_local_tail & *r -> sq_mask;
+    struct io_uring_sqe *sqe = &r -> sqes[ idx ];
+
+    memset( sqe, 0, sizeof *sqe );
+
+    // identity mapping : slot i of the array names SQE i
+    r -> sq_array[ idx ] = idx;
+    r -> sq_local_tail++;
+
+    return sqe;
+}
+
+
+int uring_enter( uring_t *r, unsigned wait_nr ) {
+
+    unsigned to_submit = r -> sq_local_tail - r -> sq_submitted;
+
+    // publish the new SQEs : the kernel must see their contents before the tail
+    __atomic_store_n( r -> sq_tail, r -> sq_local_tail, __ATOMIC_RELEASE );
+
+    if( to_submit == 0 && wait_nr == 0 ) {
+        return 0;
+    }
+
+    int ret;
+
+    do {
+
+        r -> enters++;
+        ret = sys_enter( r -> fd, to_submit, wait_nr, wait_nr ? IORING_ENTER_GETEVENTS : 0 );
+
+    } while( ret < 0 && errno == EINTR );
+
+    if( ret < 0 ) {
+        return -errno;
+    }
+
+    r -> sq_submitted += ret;
+
+    return ret;
+}
+
+
+struct io_uring_cqe *uring_peek_cqe( uring_t *r ) {
+
+    unsigned head = *r -> cq_head;
+
+    if( head == __atomic_load_n( r -> cq_tail, __ATOMIC_ACQUIRE ) ) {
+        return NULL;
+    }
+
+    return &r -> cqes[ head & *r -> cq_mask ];
+}
+
+
+void uring_cqe_seen( uring_t *r ) {
+
+    // release : we are done reading the CQE before the kernel may reuse the slot
+    __atomic_store_n( r -> cq_head, *r -> cq_head + 1, __ATOMIC_RELEASE );
+}
+
+
+
+/* ================= PROVIDED BUFFER RING ================= */
+
+int uring_bufring_setup( uring_t *r, uring_bufring_t *br, unsigned entries, unsigned short bgid ) {
+
+    memset( br, 0, sizeof *br );
+
+    if( entries == 0 || entries > 32768 || ( entries & ( entries - 1 ) ) ) {
+        return -EINVAL;
+    }
+
+    // the ring must be page aligned : mmap gives us that
+    br -> ring_size = entries * sizeof( struct io_uring_buf );
+    br -> ring = mmap( NULL, br -> ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+    if( br -> ring == MAP_FAILED ) {
+        return -errno;
+    }
+
+    struct io_uring_buf_reg reg;
+
+    memset( &reg, 0, sizeof reg );
+    reg.ring_addr = ( unsigned long ) br -> ring;
+    reg.ring_entries = entries;
+    reg.bgid = bgid;
+
+    if( sys_register( r -> fd, IORING_REGISTER_PBUF_RING, &reg, 1 ) < 0 ) {
+
+        int err = errno;
+        munmap( br -> ring, br -> ring_size );
+        return -err;
+    }
+
+    br -> entries = entries;
+    br -> bgid = bgid;
+
+    return 0;
+}
+
+
+void uring_buf_add( uring_bufring_t *br, void *addr, unsigned len, unsigned short bid ) {
+
+    struct io_uring_buf *b = &br -> ring -> bufs[ br -> tail & ( br -> entries - 1 ) ];
+
+    b -> addr = ( unsigned long ) addr;
+    b -> len = len;
+    b -> bid = bid;
+
+    br -> tail++;
+}
+
+
+void uring_buf_publish( uring_bufring_t *br ) {
+
+    __atomic_store_n( &br -> ring -> tail, br -> tail, __ATOMIC_RELEASE );
+}
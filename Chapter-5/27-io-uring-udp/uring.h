@@ -0,0 +1,95 @@
+/*
+    uring.h
+
+    Minimal io_uring wrapper on raw syscalls ( no liburing needed )
+
+    Only what a UDP server needs:
+        - one ring : submission queue ( SQ ) + completion queue ( CQ )
+        - get an SQE, fill it, submit + wait with one io_uring_enter()
+        - walk completed CQEs
+        - a provided buffer ring : the kernel picks a free buffer
+          for each received datagram, we hand buffers back when done
+
+    Memory ordering:
+        the kernel reads SQ tail / buffer ring tail and writes CQ tail,
+        so those are accessed with acquire / release atomics
+
+    Usage:
+        uring_t r;
+        uring_init( &r, 256, 4096 );
+        struct io_uring_sqe *sqe = uring_get_sqe( &r );
+        ...
+        uring_enter( &r, 1 );                       // submit all, wait for 1 CQE
+        struct io_uring_cqe *cqe;
+        while( ( cqe = uring_peek_cqe( &r ) ) ) { ...; uring_cqe_seen( &r ); }
+*/
+
+#ifndef URING_H
+#define URING_H
+
+#include <stddef.h>
+#include <linux/io_uring.h>
+
+
+typedef struct {
+
+    int fd;
+
+    // submission queue ( shared with the kernel )
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned sq_entries;
+    unsigned sq_local_tail;     // SQEs handed out, not yet published
+    unsigned sq_submitted;      // SQEs already passed to io_uring_enter()
+
+    // completion queue ( shared with the kernel )
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+
+    unsigned long long enters;  // io_uring_enter() calls : the syscall count
+
+} uring_t;
+
+// provided buffer ring : one group of equal-sized buffers
+typedef struct {
+
+    struct io_uring_buf_ring *ring;
+    unsigned entries;
+    unsigned short tail;        // local tail, published with uring_buf_publish()
+    unsigned short bgid;        // buffer group id used in SQEs
+    size_t ring_size;
+
+} uring_bufring_t;
+
+
+// returns 0, or -errno ( e.g. -ENOSYS, -EPERM when io_uring is disabled )
+int uring_init( uring_t *r, unsigned sq_entries, unsigned cq_entries );
+
+void uring_exit( uring_t *r );
+
+// next free SQE, zeroed, or NULL when the SQ is full ( submit first )
+struct io_uring_sqe *uring_get_sqe( uring_t *r );
+
+// submit everything queued and wait until at least wait_nr CQEs are ready
+// returns SQEs submitted or -errno
+int uring_enter( uring_t *r, unsigned wait_nr );
+
+// oldest unseen completion, or NULL
+struct io_uring_cqe *uring_peek_cqe( uring_t *r );
+
+// mark the CQE returned by uring_peek_cqe() as consumed
+void uring_cqe_seen( uring_t *r );
+
+// register a buffer ring with 'entries' slots ( power of two ) as group bgid
+int uring_bufring_setup( uring_t *r, uring_bufring_t *br, unsigned entries, unsigned short bgid );
+
+// queue a buffer for the kernel to use ( visible after uring_buf_publish() )
+void uring_buf_add( uring_bufring_t *br, void *addr, unsigned len, unsigned short bid );
+
+// make all added buffers visible to the kernel
+void uring_buf_publish( uring_bufring_t *br );
+
+#endif
@@ -0,0 +1,483 @@
+/*
+    client.c
+
+    UDP echo client that splits every round trip into stages
+    ( 5-UDP-sendto-recvfrom/client.c + SO_TIMESTAMPING )
+
+    One request / reply, and where the time goes :
+
+        client app ─▶ qdisc ─▶ driver ═══▶ server stack ─▶ app ─▶ qdisc ─▶ driver ═══▶ client stack ─▶ app
+                   1        2         w               3      4       5         6   w               7
+
+        1  client app→qdisc     SCHED stamp  - before sendto()
+        2  client qdisc→wire    SND stamp    - SCHED stamp
+        3  server wire→app      recvmsg()    - RX stamp             ( server clock )
+        4  server app           sendto()     - recvmsg()            ( server clock )
+        5  server app→qdisc     SCHED stamp  - sendto()             ( server clock )
+        6  server qdisc→wire    SND stamp    - SCHED stamp          ( server clock )
+        7  client wire→app      recvmsg()    - RX stamp
+        w  wire, both ways      round trip   - all of the above
+
+    Every stage is a difference of two stamps taken on the same host, so
+    the two clocks never need to agree.
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 client.c tstamp.c -o client
+
+    Run:
+        ./client 127.0.0.1
+        ./client 127.0.0.1 -n 100000 -s 1000 -i 100
+
+    Linux only ( SO_TIMESTAMPING )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <netdb.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+#include <linux/errqueue.h>
+
+#include "tstamp.h"
+
+#define PORT "3490"     // Port number as string
+#define MAXMSG 65536
+
+
+// everything known about one request, on both hosts
+typedef struct {
+
+    uint64_t app_send, cli_sched, cli_snd, cli_rx, app_recv;        // client clock
+    uint64_t srv_rx, srv_recv, srv_send, srv_sched, srv_snd;        // server clock
+
+} rec_t;
+
+
+enum { CLI_SCHED, CLI_SND, SRV_IN, SRV_APP, SRV_SCHED, SRV_SND, CLI_IN, WIRE, RTT, STAGES };
+
+static const char *stage_name[ STAGES ] = {
+    "cli app>qdisc", "cli qdisc>wire", "srv wire>app", "srv app",
+    "srv app>qdisc", "srv qdisc>wire", "cli wire>app", "wire x2", "round trip"
+};
+
+// histogram column headers : the numbers in the diagram above
+static const char *stage_tag[ STAGES ] = { "1", "2", "3", "4", "5", "6", "7", "w", "rtt" };
+
+
+int cmp_ll( const void *a, const void *b ) {
+
+    long long x = *( const long long * ) a, y = *( const long long * ) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+
+// b - a, or -1 when either stamp is missing
+long long span( uint64_t a, uint64_t b ) {
+
+    if( a == TS_NONE || b == TS_NONE || b < a ) {
+        return -1;
+    }
+
+    return ( long long ) ( b - a );
+}
+
+
+
+/* ================= TX STAMPS ================= */
+
+// our n-th sendto() is request n, so the OPT_ID counter is the seq
+void collect_tx( int sockfd, rec_t *rec, long n ) {
+
+    uint32_t id;
+    int type;
+    uint64_t ns;
+
+    while( ts_tx( sockfd, &id, &type, &ns ) == 0 ) {
+
+        if( id >= n ) {
+            continue;
+        }
+
+        if( type == SCM_TSTAMP_SCHED ) {
+            rec[ id ].cli_sched = ns;
+        } else if( type == SCM_TSTAMP_SND ) {
+            rec[ id ].cli_snd = ns;
+        }
+    }
+}
+
+
+
+/* ================= REPORT ================= */
+
+void print_report( rec_t *rec, long n, size_t size ) {
+
+    long long *ns[ STAGES ];
+    long cnt[ STAGES ] = { 0 };
+
+    for( int s = 0; s < STAGES; s++ ) {
+        ns[ s ] = malloc( n * sizeof( long long ) );
+    }
+
+    long answered = 0;
+
+    for( long i = 0; i < n; i++ ) {
+
+        rec_t *r = &rec[ i ];
+
+        if( r -> app_recv == TS_NONE ) {
+            continue;
+        }
+
+        answered++;
+
+        long long v[ STAGES ];
+
+        v[ CLI_SCHED ] = span( r -> app_send, r -> cli_sched );
+        v[ CLI_SND ]   = span( r -> cli_sched, r -> cli_snd );
+        v[ SRV_IN ]    = span( r -> srv_rx, r -> srv_recv );
+        v[ SRV_APP ]   = span( r -> srv_recv, r -> srv_send );
+        v[ SRV_SCHED ] = span( r -> srv_send, r -> srv_sched );
+        v[ SRV_SND ]   = span( r -> srv_sched, r -> srv_snd );
+        v[ CLI_IN ]    = span( r -> cli_rx, r -> app_recv );
+        v[ RTT ]       = span( r -> app_send, r -> app_recv );
+
+        // what is left once every measured stage is taken out
+        v[ WIRE ] = v[ RTT ];
+
+        for( int s = 0; s < WIRE && v[ WIRE ] >= 0; s++ ) {
+            v[ WIRE ] = v[ s ] < 0 ? -1 : v[ WIRE ] - v[ s ];
+        }
+
+        for( int s = 0; s < STAGES; s++ ) {
+            if( v[ s ] >= 0 ) {
+                ns[ s ][ cnt[ s ]++ ] = v[ s ];
+            }
+        }
+    }
+
+    printf( "\n%ld requests x %zu bytes, %ld answered\n\n", n, size, answered );
+
+    if( answered == 0 ) {
+        return;
+    }
+
+
+    /* ---------- percentiles per stage ---------- */
+
+    static const double pct[] = { 50, 90, 99, 99.9 };
+
+    printf( "%-15s %8s %9s %9s", "stage ( us )", "samples", "min", "mean" );
+
+    for( size_t p = 0; p < sizeof pct / sizeof pct[ 0 ]; p++ ) {
+        char label[ 16 ];
+        snprintf( label, sizeof label, "p%g", pct[ p ] );
+        printf( " %9s", label );
+    }
+
+    printf( " %9s\n", "max" );
+
+    for( int s = 0; s < STAGES; s++ ) {
+
+        long c = cnt[ s ];
+
+        printf( "%-15s %8ld", stage_name[ s ], c );
+
+        if( c == 0 ) {
+            printf( "   ( no stamps )\n" );
+            continue;
+        }
+
+        qsort( ns[ s ], c, sizeof( long long ), cmp_ll );
+
+        double sum = 0;
+
+        for( long i = 0; i < c; i++ ) {
+            sum += ns[ s ][ i ];
+        }
+
+        printf( " %9.2f %9.2f", ns[ s ][ 0 ] / 1e3, sum / c / 1e3 );
+
+        for( size_t p = 0; p < sizeof pct / sizeof pct[ 0 ]; p++ ) {
+
+            long idx = ( long ) ( c * pct[ p ] / 100.0 );
+
+            if( idx >= c ) {
+                idx = c - 1;
+            }
+
+            printf( " %9.2f", ns[ s ][ idx ] / 1e3 );
+        }
+
+        printf( " %9.2f\n", ns[ s ][ c - 1 ] / 1e3 );
+    }
+
+
+    /* ---------- log2 histogram, one column per stage ---------- */
+
+    long long top = 1;
+
+    for( int s = 0; s < STAGES; s++ ) {
+        while( cnt[ s ] && top <= ns[ s ][ cnt[ s ] - 1 ] ) {
+            top *= 2;
+        }
+    }
+
+    printf( "\n%-18s", "bucket ( us )" );
+
+    for( int s = 0; s < STAGES; s++ ) {
+        printf( " %6s", stage_tag[ s ] );
+    }
+
+    printf( "\n" );
+
+    long at[ STAGES ] = { 0 };
+
+    for( long long lo = 0, hi = 1; hi <= top; lo = hi, hi *= 2 ) {
+
+        long row[ STAGES ], any = 0;
+
+        for( int s = 0; s < STAGES; s++ ) {
+
+            row[ s ] = 0;
+
+            while( at[ s ] < cnt[ s ] && ns[ s ][ at[ s ] ] < hi ) {
+                row[ s ]++;
+                at[ s ]++;
+            }
+
+            any += row[ s ];
+        }
+
+        // rows nobody falls in are left out
+        if( !any ) {
+            continue;
+        }
+
+        printf( "[%7.2f, %7.2f)", lo / 1e3, hi / 1e3 );
+
+        for( int s = 0; s < STAGES; s++ ) {
+
+            if( row[ s ] ) {
+                printf( " %6ld", row[ s ] );
+            } else {
+                printf( " %6s", "." );
+            }
+        }
+
+        printf( "\n" );
+    }
+
+    for( int s = 0; s < STAGES; s++ ) {
+        free( ns[ s ] );
+    }
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = PORT;
+    long count = 10000;
+    size_t size = 64;
+    long interval = 1000;
+    int opt;
+
+    if( argc < 2 ) {
+        goto usage;
+    }
+
+    optind = 2;
+
+    while( ( opt = getopt( argc, argv, "p:n:s:i:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'p': port = optarg; break;
+            case 'n': count = atol( optarg ); break;
+            case 's': size = strtoul( optarg, NULL, 10 ); break;
+            case 'i': interval = atol( optarg ); break;
+            default: goto usage;
+        }
+    }
+
+    if( optind != argc || count < 1 || size < sizeof( ts_msg_t ) || size > MAXMSG || interval < 0 ) {
+    usage:
+        fprintf( stderr, "usage: %s host [-p port] [-n requests] [-s size] [-i interval_us]\n", argv[ 0 ] );
+        fprintf( stderr, "       size >= %zu\n", sizeof( ts_msg_t ) );
+        exit( 1 );
+    }
+
+
+    /* STEP 1: socket to the server */
+
+    struct addrinfo hints, *res, *p;
+    int sockfd = -1;
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_UNSPEC;     // IPv4 or IPv6
+    hints.ai_socktype = SOCK_DGRAM;    // UDP socket
+
+    int status = getaddrinfo( argv[ 1 ], port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            continue;
+        }
+
+        // connected : replies from anyone else are dropped by the kernel
+        if( connect( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            continue;
+        }
+
+        break;
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        printf( "Failed to create socket\n" );
+        exit( 1 );
+    }
+
+
+    /* STEP 2: timestamps on, and a receive timeout for lost datagrams */
+
+    if( ts_enable( sockfd ) == -1 ) {
+        perror( "SO_TIMESTAMPING" );
+        exit( 1 );
+    }
+
+    struct timeval tv = { 1, 0 };
+    setsockopt( sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv );
+
+
+    /* STEP 3: request / reply loop */
+
+    rec_t *rec = malloc( count * sizeof( rec_t ) );
+    char *out = calloc( 1, size );
+    char *in = malloc( MAXMSG );
+    char ctrl[ TS_CMSG_SPACE ];
+
+    if( !rec || !out || !in ) {
+        perror( "malloc" );
+        exit( 1 );
+    }
+
+    // every field starts as "no stamp"
+    memset( rec, 0xff, count * sizeof( rec_t ) );
+
+    for( long i = 0; i < count; i++ ) {
+
+        ts_msg_t m;
+        memset( &m, 0, sizeof m );
+        m.seq = i;
+        memcpy( out, &m, sizeof m );
+
+        rec[ i ].app_send = ts_now();
+
+        if( send( sockfd, out, size, 0 ) == -1 ) {
+            perror( "send" );
+            exit( 1 );
+        }
+
+        // wait for reply i; older ( late ) replies are still used
+        while( 1 ) {
+
+            struct iovec iov = { in, MAXMSG };
+            struct msghdr msg;
+
+            memset( &msg, 0, sizeof msg );
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = ctrl;
+            msg.msg_controllen = sizeof ctrl;
+
+            ssize_t bytes = recvmsg( sockfd, &msg, 0 );
+            uint64_t recv_at = ts_now();
+
+            if( bytes == -1 ) {
+
+                if( errno == EINTR ) {
+                    continue;
+                }
+
+                // ECONNREFUSED : ICMP port unreachable, no server there
+                if( errno != EAGAIN && errno != EWOULDBLOCK ) {
+                    perror( "recvmsg" );
+                    exit( 1 );
+                }
+
+                break;      // lost : move on
+            }
+
+            if( bytes < ( ssize_t ) sizeof m ) {
+                continue;
+            }
+
+            memcpy( &m, in, sizeof m );
+
+            if( m.seq >= ( uint64_t ) count ) {
+                continue;
+            }
+
+            rec_t *r = &rec[ m.seq ];
+
+            r -> cli_rx = ts_rx( &msg );
+            r -> app_recv = recv_at;
+            r -> srv_rx = m.srv_rx;
+            r -> srv_recv = m.srv_recv;
+            r -> srv_send = m.srv_send;
+
+            // TX stamps of an earlier reply, sent along with this one
+            if( m.tx_seq < ( uint64_t ) count ) {
+                rec[ m.tx_seq ].srv_sched = m.tx_sched;
+                rec[ m.tx_seq ].srv_snd = m.tx_snd;
+            }
+
+            if( m.seq == ( uint64_t ) i ) {
+                break;
+            }
+        }
+
+        collect_tx( sockfd, rec, count );
+
+        if( interval > 0 ) {
+            struct timespec ts = { interval / 1000000, ( interval % 1000000 ) * 1000 };
+            nanosleep( &ts, NULL );
+        }
+    }
+
+    collect_tx( sockfd, rec, count );
+
+
+    /* STEP 4: per-stage distributions */
+
+    print_report( rec, count, size );
+
+    free( rec );
+    free( out );
+    free( in );
+    close( sockfd );
+
+    return 0;
+}
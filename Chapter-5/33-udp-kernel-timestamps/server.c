@@ -0,0 +1,331 @@
+/*
+    server.c
+
+    UDP echo server with kernel timestamps
+    ( 5-UDP-sendto-recvfrom/server.c + SO_TIMESTAMPING )
+
+    For every request it fills in, inside the echoed payload ( tstamp.h ):
+        - when the kernel received the request ( RX software stamp )
+        - when recvmsg() gave it to us
+        - when we called sendto() with the reply
+        - the TX stamps ( qdisc, driver ) of an earlier reply to the same
+          client : a reply's own TX stamps only exist after it was sent
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 server.c tstamp.c -o server
+
+    Run:
+        ./server
+        ./server -p 5000
+
+    Linux only ( SO_TIMESTAMPING )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <linux/errqueue.h>
+
+#include "tstamp.h"
+
+#define PORT "3490"     // Port number as string
+#define MAXMSG 65536
+#define PENDING 1024    // replies whose TX stamps we are still collecting
+
+
+// one reply sent, waiting for / holding its TX stamps
+typedef struct {
+
+    uint64_t seq;                       // request it answered
+    struct sockaddr_storage to;
+    socklen_t tolen;
+    uint64_t send_at, sent_at;          // sendto() called / returned
+    uint64_t sched, snd;
+    int reported;
+
+} sent_t;
+
+
+// kernel OPT_ID → our reply number
+typedef struct {
+
+    uint32_t skew;                      // reply = id + skew
+    unsigned long long resyncs;         // times the skew had to move
+    unsigned long long unmatched;       // SCHED stamps that fit no reply
+
+} txmap_t;
+
+
+
+/* ================= TX STAMP BOOKKEEPING ================= */
+
+// SCHED is stamped inside sendto() : it must fall within reply r's call
+int fits( sent_t *sent, uint32_t replies, uint32_t r, uint64_t ns ) {
+
+    // r must be sent ( r < replies ) and still in the ring
+    if( replies - r - 1 >= PENDING ) {
+        return 0;
+    }
+
+    sent_t *s = &sent[ r % PENDING ];
+
+    return s -> send_at <= ns && ns <= s -> sent_at;
+}
+
+
+// the error queue says "datagram number id" : OPT_ID counts the datagrams
+// the kernel built. A failed sendto() usually took no number ( no route,
+// EMSGSIZE : it failed before there was a datagram ), but one that failed
+// later did. So replies are numbered only when sendto() succeeds, and each
+// SCHED stamp is checked against its reply's sendto() call; if it does not
+// fit, the neighbours are tried and the skew follows the one that does
+void collect_tx( int sockfd, sent_t *sent, uint32_t replies, txmap_t *map ) {
+
+    uint32_t id;
+    int type;
+    uint64_t ns;
+
+    while( ts_tx( sockfd, &id, &type, &ns ) == 0 ) {
+
+        uint32_t r = id + map -> skew;
+
+        if( type == SCM_TSTAMP_SCHED ) {
+
+            if( !fits( sent, replies, r, ns ) ) {
+
+                int d = -2;
+
+                while( d <= 2 && !fits( sent, replies, r + d, ns ) ) {
+                    d++;
+                }
+
+                if( d > 2 ) {
+                    map -> unmatched++;
+                    continue;
+                }
+
+                map -> skew += d;
+                map -> resyncs++;
+                r += d;
+            }
+
+            sent[ r % PENDING ].sched = ns;
+
+        } else if( type == SCM_TSTAMP_SND ) {
+
+            // comes after its SCHED : kept only if that one was matched
+            if( replies - r - 1 < PENDING && sent[ r % PENDING ].sched != TS_NONE ) {
+                sent[ r % PENDING ].snd = ns;
+            }
+        }
+    }
+}
+
+
+// newest reply to this client with both TX stamps, not reported yet
+sent_t *ready_for( sent_t *sent, uint32_t replies, struct sockaddr_storage *to, socklen_t tolen ) {
+
+    for( uint32_t back = 1; back <= 64 && back <= replies; back++ ) {
+
+        sent_t *s = &sent[ ( replies - back ) % PENDING ];
+
+        if( !s -> reported && s -> sched != TS_NONE && s -> snd != TS_NONE
+            && s -> tolen == tolen && !memcmp( &s -> to, to, tolen ) ) {
+            return s;
+        }
+    }
+
+    return NULL;
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    struct addrinfo hints, *res, *p = NULL;
+    int sockfd;
+    const char *port = PORT;
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "p:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'p': port = optarg; break;
+            default:
+                fprintf( stderr, "usage: %s [-p port]\n", argv[ 0 ] );
+                exit( 1 );
+        }
+    }
+
+    // Setup hints
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_UNSPEC;     // IPv4 or IPv6
+    hints.ai_socktype = SOCK_DGRAM;    // UDP socket
+    hints.ai_flags    = AI_PASSIVE;    // Use my IP
+
+    int status = getaddrinfo( NULL, port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    // Loop through all results and bind : IPv6 first, since a socket on
+    // :: also takes IPv4 clients ( as ::ffff:a.b.c.d )
+    for( int pass = 0; pass < 2 && p == NULL; pass++ ) {
+
+        for( p = res; p != NULL; p = p -> ai_next ) {
+
+            if( ( p -> ai_family == AF_INET6 ) != ( pass == 0 ) ) {
+                continue;
+            }
+
+            sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+            if( sockfd == -1 ) {
+                continue;
+            }
+
+            if( bind( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+                close( sockfd );
+                continue;
+            }
+
+            break;   // Successfully bound
+        }
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        printf( "Failed to bind\n" );
+        exit( 1 );
+    }
+
+    if( ts_enable( sockfd ) == -1 ) {
+        perror( "SO_TIMESTAMPING" );
+        exit( 1 );
+    }
+
+    printf( "UDP timestamping echo server listening on %s...\n", port );
+    fflush( stdout );
+
+
+    /* ---------- ECHO LOOP ---------- */
+
+    static char buffer[ MAXMSG ];
+    static sent_t sent[ PENDING ];
+    char ctrl[ TS_CMSG_SPACE ];
+    uint32_t replies = 0;               // sendto() calls that succeeded
+    txmap_t map = { 0, 0, 0 };
+
+    while( 1 ) {
+
+        struct sockaddr_storage client_addr;
+        struct iovec iov = { buffer, sizeof buffer };
+        struct msghdr msg;
+
+        memset( &msg, 0, sizeof msg );
+        msg.msg_name = &client_addr;
+        msg.msg_namelen = sizeof client_addr;
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = ctrl;
+        msg.msg_controllen = sizeof ctrl;
+
+        ssize_t bytes = recvmsg( sockfd, &msg, 0 );
+        uint64_t recv_at = ts_now();
+
+        if( bytes == -1 ) {
+
+            if( errno != EINTR ) {
+                perror( "recvmsg" );
+            }
+
+            continue;
+        }
+
+        // not one of our requests : plain echo, numbered all the same
+        if( bytes < ( ssize_t ) sizeof( ts_msg_t ) ) {
+
+            sent_t *s = &sent[ replies % PENDING ];
+
+            s -> tolen = 0;
+            s -> sched = s -> snd = TS_NONE;
+            s -> reported = 1;
+            s -> send_at = ts_now();
+
+            if( sendto( sockfd, buffer, bytes, 0, ( struct sockaddr * ) &client_addr, msg.msg_namelen ) != -1 ) {
+                s -> sent_at = ts_now();
+                replies++;
+            }
+
+            continue;
+        }
+
+        ts_msg_t m;
+        memcpy( &m, buffer, sizeof m );
+
+        m.srv_rx = ts_rx( &msg );
+        m.srv_recv = recv_at;
+
+
+        /* ---------- PIGGYBACK AN EARLIER REPLY'S TX STAMPS ---------- */
+
+        unsigned long long resyncs = map.resyncs, unmatched = map.unmatched;
+
+        collect_tx( sockfd, sent, replies, &map );
+
+        if( map.resyncs != resyncs || map.unmatched != unmatched ) {
+            fprintf( stderr, "server: TX stamps resynced %llu times, %llu unmatched\n",
+                     map.resyncs, map.unmatched );
+        }
+
+        sent_t *done = ready_for( sent, replies, &client_addr, msg.msg_namelen );
+
+        m.tx_seq = TS_NONE;
+
+        if( done ) {
+            m.tx_seq = done -> seq;
+            m.tx_sched = done -> sched;
+            m.tx_snd = done -> snd;
+            done -> reported = 1;
+        }
+
+
+        /* ---------- REPLY ---------- */
+
+        sent_t *s = &sent[ replies % PENDING ];
+
+        s -> seq = m.seq;
+        memcpy( &s -> to, &client_addr, msg.msg_namelen );
+        s -> tolen = msg.msg_namelen;
+        s -> sched = s -> snd = TS_NONE;
+        s -> reported = 0;
+
+        m.srv_send = s -> send_at = ts_now();
+        memcpy( buffer, &m, sizeof m );
+
+        if( sendto( sockfd, buffer, bytes, 0, ( struct sockaddr * ) &client_addr, msg.msg_namelen ) == -1 ) {
+            perror( "sendto" );
+            continue;           // no number : the slot is reused by the next reply
+        }
+
+        s -> sent_at = ts_now();
+        replies++;
+    }
+
+    close( sockfd );
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*
+    tstamp.c
+
+    SO_TIMESTAMPING helpers ( see tstamp.h )
+
+    Compile together with the program that uses it:
+        gcc -Wall -Wextra -pedantic -O2 tstamp.c your_program.c -o your_program
+*/
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+
+#include "tstamp.h"
+
+
+static uint64_t to_ns( const struct timespec *ts ) {
+
+    return ( uint64_t ) ts -> tv_sec * 1000000000ull + ts -> tv_nsec;
+}
+
+
+uint64_t ts_now( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_REALTIME, &ts );
+
+    return to_ns( &ts );
+}
+
+
+int ts_enable( int fd ) {
+
+    // TX_SCHED    : stamp when the packet enters the qdisc layer
+    // TX_SOFTWARE : stamp when the driver takes it ( skb_tx_timestamp )
+    // RX_SOFTWARE : stamp when the stack receives it
+    // SOFTWARE    : report software stamps ( ts[ 0 ] )
+    // OPT_ID      : tag TX stamps with a counter, one per datagram sent
+    // OPT_TSONLY  : error queue entries without a copy of the packet
+    int flags = SOF_TIMESTAMPING_TX_SCHED | SOF_TIMESTAMPING_TX_SOFTWARE
+              | SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE
+              | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+
+    return setsockopt( fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof flags );
+}
+
+
+uint64_t ts_rx( struct msghdr *msg ) {
+
+    for( struct cmsghdr *cm = CMSG_FIRSTHDR( msg ); cm; cm = CMSG_NXTHDR( msg, cm ) ) {
+
+        if( cm -> cmsg_level == SOL_SOCKET && cm -> cmsg_type == SCM_TIMESTAMPING ) {
+
+            struct scm_timestamping tss;
+            memcpy( &tss, CMSG_DATA( cm ), sizeof tss );
+
+            if( tss.ts[ 0 ].tv_sec || tss.ts[ 0 ].tv_nsec ) {
+                return to_ns( &tss.ts[ 0 ] );
+            }
+        }
+    }
+
+    return TS_NONE;
+}
+
+
+int ts_tx( int fd, uint32_t *id, int *type, uint64_t *ns ) {
+
+    char ctrl[ 256 ];
+
+    while( 1 ) {
+
+        struct msghdr msg;
+        memset( &msg, 0, sizeof msg );
+        msg.msg_control = ctrl;
+        msg.msg_controllen = sizeof ctrl;
+
+        if( recvmsg( fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT ) == -1 ) {
+            return -1;
+        }
+
+        struct scm_timestamping tss;
+        struct sock_extended_err ee;
+        int have_ts = 0, have_ee = 0;
+
+        for( struct cmsghdr *cm = CMSG_FIRSTHDR( &msg ); cm; cm = CMSG_NXTHDR( &msg, cm ) ) {
+
+            if( cm -> cmsg_level == SOL_SOCKET && cm -> cmsg_type == SCM_TIMESTAMPING ) {
+                memcpy( &tss, CMSG_DATA( cm ), sizeof tss );
+                have_ts = 1;
+            } else if( ( cm -> cmsg_level == SOL_IP && cm -> cmsg_type == IP_RECVERR )
+                    || ( cm -> cmsg_level == SOL_IPV6 && cm -> cmsg_type == IPV6_RECVERR ) ) {
+                memcpy( &ee, CMSG_DATA( cm ), sizeof ee );
+                have_ee = 1;
+            }
+        }
+
+        // anything else on the error queue ( ICMP errors ... ) is skipped
+        if( have_ts && have_ee && ee.ee_origin == SO_EE_ORIGIN_TIMESTAMPING ) {
+
+            *id = ee.ee_data;
+            *type = ee.ee_info;
+            *ns = to_ns( &tss.ts[ 0 ] );
+
+            return 0;
+        }
+    }
+}
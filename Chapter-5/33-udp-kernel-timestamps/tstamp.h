@@ -0,0 +1,73 @@
+/*
+    tstamp.h
+
+    Kernel software timestamps for UDP ( SO_TIMESTAMPING )
+
+    Where a datagram gets stamped, on each side:
+
+        app ──sendmsg──▶ [ qdisc ] ──▶ driver ═══ wire ═══▶ stack ──▶ socket queue ──recvmsg──▶ app
+        │                │             │                     │                                 │
+        clock_gettime    SCHED         SND                   RX                                clock_gettime
+        ( before send )  error queue   error queue           cmsg with the data                ( after recv )
+
+    - TX stamps come back on the socket's error queue ( MSG_ERRQUEUE ),
+      tagged with a per-socket counter ( OPT_ID ) : 0 for the first
+      datagram sent, 1 for the second ...
+    - the RX stamp comes as a cmsg with the datagram itself
+    - software stamps are CLOCK_REALTIME, like clock_gettime( CLOCK_REALTIME )
+
+    The echo message carries the server's stamps back to the client, so
+    one round trip can be cut into stages ( see client.c ).
+
+    Usage:
+        ts_enable( fd );
+        ssize_t n = recvmsg( fd, &msg, 0 );   uint64_t rx = ts_rx( &msg );
+        while( ts_tx( fd, &id, &type, &ns ) == 0 ) ...
+*/
+
+#ifndef TSTAMP_H
+#define TSTAMP_H
+
+#include <stdint.h>
+#include <sys/socket.h>
+
+#define TS_NONE     UINT64_MAX      // no stamp ( yet )
+
+// control buffer big enough for the RX timestamp cmsg
+#define TS_CMSG_SPACE   CMSG_SPACE( 3 * sizeof( struct timespec ) )
+
+
+// echo request / reply, at the start of the payload
+typedef struct {
+
+    uint64_t seq;                   // client's request number
+
+    // filled in by the server for this request
+    uint64_t srv_rx;                // kernel RX stamp of the request
+    uint64_t srv_recv;              // after recvmsg() returned
+    uint64_t srv_send;              // just before sendto() of this reply
+
+    // TX stamps of an earlier reply to this client ( they only exist after sending )
+    uint64_t tx_seq;                // which request it answered, TS_NONE if none
+    uint64_t tx_sched;              // reply entered the qdisc
+    uint64_t tx_snd;                // reply handed to the driver
+
+} ts_msg_t;
+
+
+// CLOCK_REALTIME in ns : the clock software timestamps use
+uint64_t ts_now( void );
+
+// turn on RX + TX ( SCHED, SND ) software timestamps with OPT_ID
+// returns 0, or -1 with errno set
+int ts_enable( int fd );
+
+// RX stamp from the cmsgs of a received datagram, TS_NONE if missing
+uint64_t ts_rx( struct msghdr *msg );
+
+// one TX stamp from the error queue, without blocking
+// type : SCM_TSTAMP_SCHED or SCM_TSTAMP_SND, id : OPT_ID counter
+// returns 0, or -1 when the queue is empty
+int ts_tx( int fd, uint32_t *id, int *type, uint64_t *ns );
+
+#endif
@@ -0,0 +1,69 @@
+#!/bin/sh
+#
+#   bench.sh
+#
+#   The four close paths of server.c under connection churn
+#
+#   Reports for each response size and close path:
+#       connections per second, responses complete / truncated,
+#       TIME_WAIT sockets on each side, how the server's closes ended
+#
+#   The last row, "client -k", is a client that never closes first :
+#   every close waits for the deadline ( 200 ms ).
+#
+#   Needs root : every run gets a fresh network namespace, so TIME_WAIT
+#   from one run does not spill into the next.
+#
+#   Usage:
+#       ./bench.sh [seconds] [unread body bytes] [response sizes ...]
+#
+#   Example:
+#       ./bench.sh 5 4096 1024 262144
+
+SECS=${1:-5}
+BODY=${2:-4096}
+[ $# -ge 2 ] && shift 2 || set --
+SIZES=${*:-1024 262144}
+NS=lclose-bench
+OUT=/tmp/lclose-bench.$$
+
+echo "$SECS s per run, 32 connections in parallel, $BODY B of every request left unread"
+echo
+printf "%8s  %-9s %8s %9s %9s   %-17s  %s\n" "response" "close" "conn/s" "complete" "truncated" "TIME_WAIT srv/cli" "server closes"
+
+for S in $SIZES; do
+    for M in naive linger client abort client-k; do
+
+        case $M in
+            client-k) MODE=client; KEEP=-k; DEADLINE=200 ;;
+            *)        MODE=$M;     KEEP=;   DEADLINE=2000 ;;
+        esac
+
+        ip netns add $NS
+        ip -n $NS link set lo up
+
+        ip netns exec $NS ./server -c "$MODE" -t "$DEADLINE" > "$OUT.srv" &
+        SRV=$!
+        sleep 0.3
+        ip netns exec $NS ./churn 127.0.0.1 -T "$SECS" -s "$S" -b "$BODY" $KEEP > "$OUT.cli"
+        kill -INT $SRV
+        wait $SRV
+
+        RATE=$( awk '/connections in/ { print $8 }' "$OUT.cli" )
+        DONE=$( awk '/complete/ { sub( ",", "", $3 ); print $3 }' "$OUT.cli" )
+        CUT=$( awk '/complete/ { print $5 }' "$OUT.cli" )
+        TW=$( awk '/TIME_WAIT/ { sub( ",", "", $7 ); print $7 " / " $NF }' "$OUT.cli" )
+        HOW=$( awk '/closes :/ {
+                       sub( /.*closes : /, "" ); sub( / \( [0-9]+ B discarded \)/, "" )
+                       n = split( $0, kv, ", " )
+                       for( i = 1; i <= n; i++ ) if( kv[ i ] !~ / 0$/ ) printf "%s  ", kv[ i ]
+                   }' "$OUT.srv" )
+
+        printf "%8s  %-9s %8s %9s %9s   %-17s  %s\n" "$S" "$M" "$RATE" "$DONE" "$CUT" "$TW" "${HOW:-plain close()}"
+
+        ip netns del $NS
+    done
+    echo
+done
+
+rm -f "$OUT.srv" "$OUT.cli"
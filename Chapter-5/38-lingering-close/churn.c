@@ -0,0 +1,361 @@
+/*
+    churn.c
+
+    Connection churn against server.c : P connections at a time, each
+    one request, one response, close, next
+
+    Every request carries a body the server never reads ( -b bytes ),
+    the situation that turns a plain close() into RST. Each response is
+    checked to the last byte :
+
+        complete    all size bytes arrived
+        reset       ECONNRESET before the end : the RST won the race
+        short       the connection ended ( FIN ) before the end
+
+    -k plays a client that never closes first : it reads on after the
+    response until the server closes.
+
+    At the end, counts the sockets in TIME_WAIT on each side of the
+    server's port ( /proc/net/tcp, /proc/net/tcp6 ) : which side pays
+    for closing first.
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 churn.c -o churn
+
+    Run:
+        ./churn 127.0.0.1 -P 32 -s 65536 -b 4096 -T 5
+
+    Linux only ( epoll, /proc/net/tcp )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+
+#define PORT "3490"
+#define MAX_PARALLEL 1024
+#define MAX_BODY ( 1 << 20 )
+
+enum { S_CONNECTING, S_SENDING, S_READING };
+
+
+typedef struct {
+
+    int fd;
+    int state;
+    size_t req_len, req_sent;
+    char head[ 32 ];            // response header, "<size>\n"
+    size_t head_len;
+    size_t expect, got;         // response body
+
+} conn_t;
+
+
+struct addrinfo *server;
+char *request;
+size_t request_len;
+size_t resp_size;
+int keep_open;
+int ep;
+
+uint64_t complete, resets, shorts, connect_failed;
+
+
+uint64_t now_ns( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+// TIME_WAIT sockets whose local ( side 0 ) or remote ( side 1 ) port is port
+int time_wait( int side, int port ) {
+
+    const char *files[] = { "/proc/net/tcp", "/proc/net/tcp6" };
+    char line[ 512 ];
+    int count = 0;
+
+    for( int f = 0; f < 2; f++ ) {
+
+        FILE *fp = fopen( files[ f ], "r" );
+
+        if( fp == NULL ) {
+            continue;
+        }
+
+        fgets( line, sizeof line, fp );     // header
+
+        while( fgets( line, sizeof line, fp ) ) {
+
+            char local[ 64 ], remote[ 64 ];
+            unsigned st;
+
+            if( sscanf( line, "%*d: %63s %63s %x", local, remote, &st ) != 3 || st != 0x06 ) {
+                continue;
+            }
+
+            const char *colon = strrchr( side == 0 ? local : remote, ':' );
+
+            if( colon && ( int ) strtol( colon + 1, NULL, 16 ) == port ) {
+                count++;
+            }
+        }
+
+        fclose( fp );
+    }
+
+    return count;
+}
+
+
+// start a connection in slot c; 0 on success
+int start( conn_t *c ) {
+
+    memset( c, 0, sizeof *c );
+
+    c -> fd = socket( server -> ai_family, SOCK_STREAM | SOCK_NONBLOCK, 0 );
+
+    if( c -> fd == -1 ) {
+        return -1;
+    }
+
+    if( connect( c -> fd, server -> ai_addr, server -> ai_addrlen ) == -1 && errno != EINPROGRESS ) {
+        close( c -> fd );
+        c -> fd = -1;
+        return -1;
+    }
+
+    c -> state = S_CONNECTING;
+    c -> req_len = request_len;
+
+    struct epoll_event ev = { .events = EPOLLOUT, .data.ptr = c };
+    epoll_ctl( ep, EPOLL_CTL_ADD, c -> fd, &ev );
+
+    return 0;
+}
+
+
+// the connection is over : count how, and close from our side
+void finish( conn_t *c, uint64_t *outcome ) {
+
+    ( *outcome )++;
+    close( c -> fd );
+    c -> fd = -1;
+}
+
+
+void on_event( conn_t *c ) {
+
+    if( c -> state == S_CONNECTING ) {
+
+        int err = 0;
+        socklen_t len = sizeof err;
+
+        getsockopt( c -> fd, SOL_SOCKET, SO_ERROR, &err, &len );
+
+        if( err ) {
+            finish( c, &connect_failed );
+            return;
+        }
+
+        c -> state = S_SENDING;
+    }
+
+    if( c -> state == S_SENDING ) {
+
+        while( c -> req_sent < c -> req_len ) {
+
+            ssize_t n = send( c -> fd, request + c -> req_sent, c -> req_len - c -> req_sent, MSG_NOSIGNAL );
+
+            if( n == -1 ) {
+
+                if( errno == EAGAIN ) {
+                    return;
+                }
+
+                // the server may answer and close before reading the body
+                break;
+            }
+
+            c -> req_sent += n;
+        }
+
+        c -> state = S_READING;
+
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = c };
+        epoll_ctl( ep, EPOLL_CTL_MOD, c -> fd, &ev );
+    }
+
+    static char buf[ 65536 ];
+
+    for( ;; ) {
+
+        ssize_t n = recv( c -> fd, buf, sizeof buf, 0 );
+
+        if( n == -1 ) {
+
+            if( errno == EAGAIN ) {
+                return;
+            }
+
+            finish( c, errno == ECONNRESET ? &resets : &shorts );
+            return;
+        }
+
+        if( n == 0 ) {
+            finish( c, c -> expect && c -> got >= c -> expect ? &complete : &shorts );
+            return;
+        }
+
+        char *p = buf;
+
+        // header : "<size>\n"
+        while( c -> expect == 0 && n > 0 && c -> head_len < sizeof c -> head - 1 ) {
+
+            c -> head[ c -> head_len++ ] = *p++;
+            n--;
+
+            if( c -> head[ c -> head_len - 1 ] == '\n' ) {
+                c -> expect = strtoul( c -> head, NULL, 10 );
+            }
+        }
+
+        c -> got += n;
+
+        if( c -> expect && c -> got >= c -> expect && !keep_open ) {
+            finish( c, &complete );     // we close first : TIME_WAIT here, unless the server already sent FIN
+            return;
+        }
+    }
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = PORT;
+    int parallel = 32;
+    size_t body = 4096;
+    double secs = 5;
+    int opt;
+
+    resp_size = 65536;
+
+    if( argc < 2 ) {
+        goto usage;
+    }
+
+    optind = 2;
+
+    while( ( opt = getopt( argc, argv, "P:s:b:T:kp:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'P': parallel = atoi( optarg ); break;
+            case 's': resp_size = strtoul( optarg, NULL, 10 ); break;
+            case 'b': body = strtoul( optarg, NULL, 10 ); break;
+            case 'T': secs = atof( optarg ); break;
+            case 'k': keep_open = 1; break;
+            case 'p': port = optarg; break;
+            default: goto usage;
+        }
+    }
+
+    if( optind != argc || parallel < 1 || parallel > MAX_PARALLEL || resp_size < 1 || body > MAX_BODY || secs <= 0 ) {
+    usage:
+        fprintf( stderr, "usage: %s host [-P parallel] [-s response-bytes] [-b body-bytes] [-T seconds] [-k] [-p port]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+
+    /* ================= STEP 1: RESOLVE + REQUEST ================= */
+
+    struct addrinfo hints;
+
+    memset( &hints, 0, sizeof hints );
+    hints.ai_family   = AF_UNSPEC;    // IPv4 or IPv6
+    hints.ai_socktype = SOCK_STREAM;
+
+    int status = getaddrinfo( argv[ 1 ], port, &hints, &server );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    request = malloc( 32 + body );
+    request_len = snprintf( request, 32, "%zu\n", resp_size );
+    memset( request + request_len, 'y', body );
+    request_len += body;
+
+    ep = epoll_create1( 0 );
+
+
+    /* ================= STEP 2: CHURN ================= */
+
+    static conn_t conns[ MAX_PARALLEL ];
+    struct epoll_event events[ MAX_PARALLEL ];
+
+    uint64_t t0 = now_ns(), end = t0 + ( uint64_t ) ( secs * 1e9 );
+    int active = 0;
+
+    for( int i = 0; i < parallel; i++ ) {
+        if( start( &conns[ i ] ) == 0 ) active++; else connect_failed++;
+    }
+
+    while( active > 0 ) {
+
+        int n = epoll_wait( ep, events, MAX_PARALLEL, 1000 );
+        int running = now_ns() < end;
+
+        for( int i = 0; i < n; i++ ) {
+
+            conn_t *c = events[ i ].data.ptr;
+
+            on_event( c );
+
+            if( c -> fd != -1 ) {
+                continue;
+            }
+
+            // this one is done : replace it while time is left
+            active--;
+
+            if( running ) {
+                if( start( c ) == 0 ) active++; else connect_failed++;
+            }
+        }
+    }
+
+    double took = ( now_ns() - t0 ) / 1e9;
+    uint64_t total = complete + resets + shorts;
+
+
+    /* ================= STEP 3: REPORT ================= */
+
+    int p = atoi( port );
+
+    printf( "churn: %llu connections in %.2f s : %.0f / s, response %zu B, unread body %zu B\n",
+            ( unsigned long long ) total, took, total / took, resp_size, body );
+    printf( "churn: complete %llu, truncated %llu ( reset %llu, short %llu ), connect failed %llu\n",
+            ( unsigned long long ) complete, ( unsigned long long ) ( resets + shorts ),
+            ( unsigned long long ) resets, ( unsigned long long ) shorts,
+            ( unsigned long long ) connect_failed );
+    printf( "churn: TIME_WAIT now : server side %d, client side %d\n", time_wait( 0, p ), time_wait( 1, p ) );
+
+    freeaddrinfo( server );
+
+    return 0;
+}
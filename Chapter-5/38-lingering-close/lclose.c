@@ -0,0 +1,287 @@
+/*
+    lclose.c
+
+    Lingering close for epoll servers ( see lclose.h )
+
+    Compile together with the program that uses it:
+        gcc -Wall -Wextra -pedantic -O2 lclose.c your_program.c -o your_program
+*/
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+
+#include "lclose.h"
+
+
+// one lingering connection, indexed by fd
+typedef struct {
+
+    int used;
+    int drained;                // input was discarded
+    uint64_t deadline;          // ms
+    int prev, next;             // deadline order ( = lc_close() order ), -1 = none
+
+} entry_t;
+
+struct lc {
+
+    int epfd;
+    uint64_t deadline_ms;
+
+    entry_t *e;                 // e[ fd ]
+    int cap;
+    int head, tail;             // oldest, newest
+
+    lc_stats_t st;
+};
+
+
+static uint64_t now_ms( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+
+
+/* ================= DEADLINE LIST ================= */
+
+// every connection gets the same timeout, so lc_close() order is
+// deadline order : append at the tail, expire from the head
+
+static void link_tail( lc_t *l, int fd ) {
+
+    l -> e[ fd ].prev = l -> tail;
+    l -> e[ fd ].next = -1;
+
+    if( l -> tail != -1 ) {
+        l -> e[ l -> tail ].next = fd;
+    } else {
+        l -> head = fd;
+    }
+
+    l -> tail = fd;
+}
+
+
+static void unlink_fd( lc_t *l, int fd ) {
+
+    entry_t *x = &l -> e[ fd ];
+
+    if( x -> prev != -1 ) {
+        l -> e[ x -> prev ].next = x -> next;
+    } else {
+        l -> head = x -> next;
+    }
+
+    if( x -> next != -1 ) {
+        l -> e[ x -> next ].prev = x -> prev;
+    } else {
+        l -> tail = x -> prev;
+    }
+}
+
+
+
+/* ================= DRAIN + CLOSE ================= */
+
+// read and discard everything queued : 1 at the peer's FIN, 0 when
+// nothing more is there yet, -1 on error ( errno set )
+static int drain( lc_t *l, int fd ) {
+
+    static char sink[ 65536 ];
+
+    for( ;; ) {
+
+        ssize_t n = recv( fd, sink, sizeof sink, MSG_DONTWAIT );
+
+        if( n > 0 ) {
+            l -> e[ fd ].drained = 1;
+            l -> st.drained_bytes += n;
+            continue;
+        }
+
+        if( n == 0 ) {
+            return 1;
+        }
+
+        if( errno == EINTR ) {
+            continue;
+        }
+
+        return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+    }
+}
+
+
+static void finish( lc_t *l, int fd, uint64_t *outcome ) {
+
+    unlink_fd( l, fd );
+    l -> e[ fd ].used = 0;
+    l -> st.lingering--;
+
+    ( *outcome )++;
+
+    close( fd );        // also leaves epoll
+}
+
+
+// what drain() said → how the connection ends, or 0 if it waits on
+static int settle( lc_t *l, int fd, int r ) {
+
+    if( r == 1 ) {
+        finish( l, fd, l -> e[ fd ].drained ? &l -> st.drained : &l -> st.clean );
+    } else if( r == -1 ) {
+        finish( l, fd, errno == ECONNRESET ? &l -> st.resets : &l -> st.errors );
+    }
+
+    return r != 0;
+}
+
+
+
+/* ================= API ================= */
+
+lc_t *lc_create( int epfd, int deadline_ms ) {
+
+    lc_t *l = calloc( 1, sizeof *l );
+
+    if( l == NULL ) {
+        return NULL;
+    }
+
+    l -> epfd = epfd;
+    l -> deadline_ms = deadline_ms;
+    l -> head = l -> tail = -1;
+
+    return l;
+}
+
+
+void lc_close( lc_t *l, int fd, int how ) {
+
+    l -> st.started++;
+
+    if( how == LC_ABORT ) {
+
+        struct linger lg = { 1, 0 };
+
+        setsockopt( fd, SOL_SOCKET, SO_LINGER, &lg, sizeof lg );
+        close( fd );
+        l -> st.aborts++;
+        return;
+    }
+
+    if( fd >= l -> cap ) {
+
+        int cap = l -> cap ? l -> cap : 1024;
+
+        while( cap <= fd ) {
+            cap *= 2;
+        }
+
+        entry_t *e = realloc( l -> e, cap * sizeof *e );
+
+        if( e == NULL ) {
+            close( fd );            // no memory to linger : plain close
+            l -> st.errors++;
+            return;
+        }
+
+        memset( e + l -> cap, 0, ( cap - l -> cap ) * sizeof *e );
+        l -> e = e;
+        l -> cap = cap;
+    }
+
+    entry_t *x = &l -> e[ fd ];
+
+    x -> used = 1;
+    x -> drained = 0;
+    x -> deadline = now_ms() + l -> deadline_ms;
+
+    link_tail( l, fd );
+    l -> st.lingering++;
+
+    if( how == LC_GRACEFUL && shutdown( fd, SHUT_WR ) == -1 ) {
+        finish( l, fd, errno == ENOTCONN ? &l -> st.resets : &l -> st.errors );
+        return;
+    }
+
+    // the peer may be done already
+    if( settle( l, fd, drain( l, fd ) ) ) {
+        return;
+    }
+
+    // only input matters now ( the server may have been waiting for EPOLLOUT )
+    struct epoll_event ev = { .events = EPOLLIN | EPOLLRDHUP, .data.fd = fd };
+
+    if( epoll_ctl( l -> epfd, EPOLL_CTL_MOD, fd, &ev ) == -1 ) {
+        epoll_ctl( l -> epfd, EPOLL_CTL_ADD, fd, &ev );
+    }
+}
+
+
+int lc_event( lc_t *l, int fd ) {
+
+    if( fd >= l -> cap || !l -> e[ fd ].used ) {
+        return 0;
+    }
+
+    settle( l, fd, drain( l, fd ) );
+
+    return 1;
+}
+
+
+int lc_timeout( lc_t *l ) {
+
+    if( l -> head == -1 ) {
+        return -1;
+    }
+
+    uint64_t now = now_ms(), due = l -> e[ l -> head ].deadline;
+
+    return due > now ? ( int ) ( due - now ) : 0;
+}
+
+
+void lc_tick( lc_t *l ) {
+
+    uint64_t now = now_ms();
+
+    while( l -> head != -1 && l -> e[ l -> head ].deadline <= now ) {
+
+        int fd = l -> head;
+
+        // last chance : unread input would still turn close() into RST
+        if( !settle( l, fd, drain( l, fd ) ) ) {
+            finish( l, fd, &l -> st.timeouts );
+        }
+    }
+}
+
+
+void lc_stats( lc_t *l, lc_stats_t *st ) {
+
+    *st = l -> st;
+}
+
+
+void lc_destroy( lc_t *l ) {
+
+    while( l -> head != -1 ) {
+        finish( l, l -> head, &l -> st.timeouts );
+    }
+
+    free( l -> e );
+    free( l );
+}
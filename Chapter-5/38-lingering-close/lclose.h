@@ -0,0 +1,97 @@
+/*
+    lclose.h
+
+    Closing TCP connections from an epoll server without losing data
+
+    close() on a socket with unread input does not send FIN : the kernel
+    answers with RST and throws away whatever it had not sent yet. The
+    peer's recv() fails with ECONNRESET, often before it has read the
+    whole response.
+
+        server                                  client
+          send( response )  ────────────────▶
+          close()           ── RST ─────────▶   "connection reset by peer",
+          ( request body still unread )         rest of the response gone
+
+    lc_close() takes the connection over from the server instead, and
+    keeps it in the event loop until it can be closed cleanly :
+
+        LC_GRACEFUL     shutdown( SHUT_WR ) : FIN after the response;
+                        read and discard input until the peer's FIN;
+                        close()                     → TIME_WAIT on the server
+        LC_PEER_FIRST   no FIN from us; read and discard input until the
+                        peer's FIN, then close()    → TIME_WAIT on the peer
+        LC_ABORT        SO_LINGER { 1, 0 } + close() : RST now, no
+                        TIME_WAIT anywhere, unsent data lost. For peers
+                        that misbehave, not for normal closes
+
+    Whoever sends the first FIN keeps the connection in TIME_WAIT for
+    60 s. With LC_PEER_FIRST that is the client, whose protocol must
+    close after the response ( HTTP : "Connection: close" + length ).
+
+    Every lingering connection has a deadline. When it passes, input is
+    drained once more and the socket is closed anyway ( a timeout ).
+
+    Usage:
+        lc_t *lc = lc_create( epfd, 2000 );                 // 2 s deadline
+        n = epoll_wait( epfd, events, MAX, lc_timeout( lc ) );
+        for each event :
+            if( lc_event( lc, fd ) ) continue;              // lingering : handled
+            ... server work ...
+            lc_close( lc, fd, LC_GRACEFUL );                // done : hand it over
+        lc_tick( lc );                                      // deadlines
+        lc_stats( lc, &st );
+
+    After lc_close() the fd belongs to lclose.c : the server forgets it.
+*/
+
+#ifndef LCLOSE_H
+#define LCLOSE_H
+
+#include <stdint.h>
+
+#define LC_GRACEFUL     0
+#define LC_PEER_FIRST   1
+#define LC_ABORT        2
+
+
+typedef struct lc lc_t;
+
+// how each close ended
+typedef struct {
+
+    uint64_t started;           // lc_close() calls
+    uint64_t clean;             // peer's FIN, nothing unread
+    uint64_t drained;           // peer's FIN, after discarding unread input
+    uint64_t drained_bytes;
+    uint64_t timeouts;          // no FIN by the deadline, closed anyway
+    uint64_t resets;            // peer sent RST while we waited
+    uint64_t aborts;            // LC_ABORT
+    uint64_t errors;            // other recv() / shutdown() errors
+    int lingering;              // connections waiting now
+
+} lc_stats_t;
+
+
+// epfd : the server's epoll instance; deadline_ms : longest wait for the peer
+lc_t *lc_create( int epfd, int deadline_ms );
+
+// take over fd ( registered in epfd or not ), close it the way 'how' says
+void lc_close( lc_t *l, int fd, int how );
+
+// call for every epoll event : returns 1 if fd is lingering ( event
+// handled here ), 0 if it is one of the server's own
+int lc_event( lc_t *l, int fd );
+
+// ms until the next deadline, -1 if nothing lingers ( epoll_wait timeout )
+int lc_timeout( lc_t *l );
+
+// close connections whose deadline has passed
+void lc_tick( lc_t *l );
+
+void lc_stats( lc_t *l, lc_stats_t *st );
+
+// close everything still lingering, free
+void lc_destroy( lc_t *l );
+
+#endif
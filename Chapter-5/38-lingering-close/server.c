@@ -0,0 +1,391 @@
+/*
+    server.c
+
+    epoll request / response server with a choice of close path
+    ( the shutdown() / close() choices of 6-shutdown-and-close, for a
+      server with many connections )
+
+    Protocol ( one request per connection, like HTTP with "Connection: close" ):
+        client → "<size>\n" [ request body the server ignores ]
+        server → "<size>\n" followed by size bytes
+
+    The server reads the request line and never reads the body. It
+    sends the response, then closes according to -c :
+
+        naive     close() at once : unread body → RST, response may be cut
+        linger    lc_close( LC_GRACEFUL )   : FIN, drain, close
+        client    lc_close( LC_PEER_FIRST ) : wait for the client's FIN
+        abort     lc_close( LC_ABORT )      : RST on purpose
+
+    Ctrl+C prints how the closes ended.
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 server.c lclose.c -o server
+
+    Run:
+        ./server -c linger
+        ./server -c client -t 2000 -p 3490
+
+    Linux only ( epoll )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+
+#include "lclose.h"
+
+#define PORT "3490"
+#define MAX_EVENTS 256
+#define MAX_RESPONSE ( 16 << 20 )
+#define REQ_READ 64             // bytes read of each request : the body stays unread
+
+enum { C_NAIVE, C_LINGER, C_CLIENT, C_ABORT };
+
+static const char *close_name[] = { "naive", "linger", "client", "abort" };
+
+
+// one connection the server is still working on
+typedef struct {
+
+    int fd;
+    char req[ REQ_READ + 1 ];   // request line so far : it may come in pieces
+    size_t req_len;
+    char head[ 32 ];            // "<size>\n"
+    size_t head_len;
+    size_t size, sent;          // response body
+
+} conn_t;
+
+
+volatile sig_atomic_t stop = 0;
+char *body;
+
+
+void on_signal( int sig ) {
+
+    ( void ) sig;
+    stop = 1;
+}
+
+
+int open_listener( const char *port ) {
+
+    struct addrinfo hints, *res, *p;
+    int fd = -1, yes = 1;
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_UNSPEC;    // IPv4 or IPv6
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags    = AI_PASSIVE;
+
+    int status = getaddrinfo( NULL, port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        fd = socket( p -> ai_family, p -> ai_socktype | SOCK_NONBLOCK, p -> ai_protocol );
+
+        if( fd == -1 ) {
+            continue;
+        }
+
+        setsockopt( fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes );
+
+        if( bind( fd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( fd );
+            continue;
+        }
+
+        break;
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL || listen( fd, 1024 ) == -1 ) {
+        fprintf( stderr, "server: failed to bind\n" );
+        exit( 2 );
+    }
+
+    return fd;
+}
+
+
+// send what the socket takes : 1 when the whole response is out
+int send_some( conn_t *c ) {
+
+    while( c -> sent < c -> head_len + c -> size ) {
+
+        const char *p;
+        size_t len;
+
+        if( c -> sent < c -> head_len ) {
+            p = c -> head + c -> sent;
+            len = c -> head_len - c -> sent;
+        } else {
+            p = body + ( c -> sent - c -> head_len );
+            len = c -> size - ( c -> sent - c -> head_len );
+        }
+
+        ssize_t n = send( c -> fd, p, len, MSG_NOSIGNAL );
+
+        if( n == -1 ) {
+            return errno == EAGAIN || errno == EINTR ? 0 : -1;
+        }
+
+        c -> sent += n;
+    }
+
+    return 1;
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = PORT;
+    int mode = C_LINGER, deadline = 2000;
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "c:t:p:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'c':
+                for( mode = C_ABORT; mode >= 0 && strcmp( optarg, close_name[ mode ] ); mode-- ) {
+                }
+                if( mode < 0 ) goto usage;
+                break;
+            case 't': deadline = atoi( optarg ); break;
+            case 'p': port = optarg; break;
+            default: goto usage;
+        }
+    }
+
+    if( optind != argc || deadline <= 0 ) {
+    usage:
+        fprintf( stderr, "usage: %s [-c naive|linger|client|abort] [-t deadline-ms] [-p port]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+
+    /* ================= STEP 1: LISTEN ================= */
+
+    struct rlimit rl;
+    getrlimit( RLIMIT_NOFILE, &rl );
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit( RLIMIT_NOFILE, &rl );
+
+    body = malloc( MAX_RESPONSE );
+
+    if( body == NULL ) {
+        perror( "malloc" );
+        exit( 1 );
+    }
+
+    memset( body, 'x', MAX_RESPONSE );
+
+    int listener = open_listener( port );
+    int ep = epoll_create1( 0 );
+
+    struct epoll_event ev = { .events = EPOLLIN, .data.fd = listener };
+    epoll_ctl( ep, EPOLL_CTL_ADD, listener, &ev );
+
+    lc_t *lc = lc_create( ep, deadline );
+
+    size_t cap = 1024;
+    conn_t **conns = calloc( cap, sizeof *conns );     // by fd
+
+    if( conns == NULL ) {
+        perror( "calloc" );
+        exit( 1 );
+    }
+
+    struct sigaction sa;
+    memset( &sa, 0, sizeof sa );
+    sa.sa_handler = on_signal;
+    sigaction( SIGINT, &sa, NULL );
+    sigaction( SIGTERM, &sa, NULL );
+
+    printf( "server: port %s, close : %s, deadline %d ms\n", port, close_name[ mode ], deadline );
+    fflush( stdout );
+
+
+    /* ================= STEP 2: EVENT LOOP ================= */
+
+    struct epoll_event events[ MAX_EVENTS ];
+    uint64_t served = 0, failed = 0;
+
+    while( !stop ) {
+
+        int n = epoll_wait( ep, events, MAX_EVENTS, lc_timeout( lc ) );
+
+        for( int i = 0; i < n; i++ ) {
+
+            int fd = events[ i ].data.fd;
+
+            /* ---------- new connections ---------- */
+
+            if( fd == listener ) {
+
+                int cfd;
+
+                while( ( cfd = accept4( listener, NULL, NULL, SOCK_NONBLOCK ) ) != -1 ) {
+
+                    if( ( size_t ) cfd >= cap ) {
+
+                        size_t old = cap;
+
+                        while( ( size_t ) cfd >= cap ) {
+                            cap *= 2;
+                        }
+
+                        conns = realloc( conns, cap * sizeof *conns );
+
+                        if( conns == NULL ) {
+                            perror( "realloc" );
+                            exit( 1 );
+                        }
+
+                        memset( conns + old, 0, ( cap - old ) * sizeof *conns );
+                    }
+
+                    conns[ cfd ] = calloc( 1, sizeof( conn_t ) );
+
+                    if( conns[ cfd ] == NULL ) {
+                        perror( "calloc" );
+                        exit( 1 );
+                    }
+
+                    conns[ cfd ] -> fd = cfd;
+
+                    struct epoll_event cev = { .events = EPOLLIN, .data.fd = cfd };
+                    epoll_ctl( ep, EPOLL_CTL_ADD, cfd, &cev );
+                }
+
+                continue;
+            }
+
+            /* ---------- closing : lclose.c's business ---------- */
+
+            if( lc_event( lc, fd ) ) {
+                continue;
+            }
+
+            conn_t *c = conns[ fd ];
+
+            if( c == NULL ) {
+                continue;
+            }
+
+            /* ---------- request line ---------- */
+
+            int done = 0;
+
+            if( c -> head_len == 0 ) {
+
+                // never more than REQ_READ bytes in all : the body stays unread
+                ssize_t r = recv( fd, c -> req + c -> req_len, REQ_READ - c -> req_len, 0 );
+
+                if( r == -1 && ( errno == EAGAIN || errno == EINTR ) ) {
+                    continue;       // epoll reports it again
+                }
+
+                if( r > 0 ) {
+                    c -> req_len += r;
+                    c -> req[ c -> req_len ] = '\0';
+                }
+
+                if( r > 0 && memchr( c -> req, '\n', c -> req_len ) == NULL && c -> req_len < REQ_READ ) {
+                    continue;       // part of the line : wait for the rest
+                }
+
+                if( r <= 0 || memchr( c -> req, '\n', c -> req_len ) == NULL ) {
+                    done = -1;      // gone, or no request line in the first REQ_READ bytes
+                } else {
+
+                    c -> size = strtoul( c -> req, NULL, 10 );
+
+                    if( c -> size > MAX_RESPONSE ) {
+                        c -> size = MAX_RESPONSE;
+                    }
+
+                    c -> head_len = snprintf( c -> head, sizeof c -> head, "%zu\n", c -> size );
+                }
+            }
+
+            /* ---------- response ---------- */
+
+            if( done == 0 ) {
+
+                done = send_some( c );
+
+                if( done == 0 ) {
+                    struct epoll_event wev = { .events = EPOLLOUT, .data.fd = fd };
+                    epoll_ctl( ep, EPOLL_CTL_MOD, fd, &wev );
+                    continue;
+                }
+            }
+
+            /* ---------- close ---------- */
+
+            conns[ fd ] = NULL;
+            free( c );
+
+            if( done == -1 ) {
+                failed++;
+                close( fd );
+                continue;
+            }
+
+            served++;
+
+            switch( mode ) {
+                case C_NAIVE:  close( fd ); break;
+                case C_LINGER: lc_close( lc, fd, LC_GRACEFUL ); break;
+                case C_CLIENT: lc_close( lc, fd, LC_PEER_FIRST ); break;
+                case C_ABORT:  lc_close( lc, fd, LC_ABORT ); break;
+            }
+        }
+
+        lc_tick( lc );
+    }
+
+
+    /* ================= STEP 3: REPORT ================= */
+
+    lc_stats_t st;
+    lc_stats( lc, &st );
+
+    printf( "\nserver: %llu responses sent, %llu connections failed before the response\n",
+            ( unsigned long long ) served, ( unsigned long long ) failed );
+
+    if( mode != C_NAIVE ) {
+        printf( "server: closes : clean %llu, drained %llu ( %llu B discarded ), timeout %llu, reset %llu, abort %llu, error %llu, still lingering %d\n",
+                ( unsigned long long ) st.clean, ( unsigned long long ) st.drained,
+                ( unsigned long long ) st.drained_bytes, ( unsigned long long ) st.timeouts,
+                ( unsigned long long ) st.resets, ( unsigned long long ) st.aborts,
+                ( unsigned long long ) st.errors, st.lingering );
+    }
+
+    lc_destroy( lc );
+    close( listener );
+    close( ep );
+
+    return 0;
+}
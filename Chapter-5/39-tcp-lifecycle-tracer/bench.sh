@@ -0,0 +1,77 @@
+#!/bin/sh
+#
+#   bench.sh
+#
+#   One slow connection per cause, traced, and what tracesum makes of it
+#
+#   Reports for each case : how long the client waited, and tracesum's
+#   split of the server's side between the network, the peer and us.
+#
+#       clean         nothing wrong : a bulk transfer, bound by the link
+#       slow-request  client waits 200 ms before sending its request
+#       slow-reader   client reads at 1 MB/s through a 64 KB buffer
+#       think         server thinks 200 ms before answering
+#       sndbuf        server's send buffer is 16 KB, the path holds 250 KB
+#       lossy         the link drops 2 % of the packets
+#
+#   Needs root, and link_impair from Chapter-6/35-reliable-udp ( built ) :
+#   client and server sit in two network namespaces joined by a 100
+#   Mbit/s link with 10 ms of delay each way.
+#
+#   Usage:
+#       ./bench.sh [response bytes]
+#
+#   Example:
+#       ./bench.sh 1048576
+
+SIZE=${1:-1048576}
+LINK=../../Chapter-6/35-reliable-udp/link_impair
+DIR=/tmp/tt-bench.$$
+
+if [ ! -x $LINK ]; then
+    echo "build $LINK first ( gcc -O2 $LINK.c -o $LINK )"
+    exit 1
+fi
+
+ip netns add tt-cli
+ip netns add tt-srv
+
+echo "link : 10 ms each way, 100 Mbit/s; response $SIZE B, one connection per case"
+echo
+printf "%-13s %9s   %9s %8s %8s %8s %7s %16s   %s\n" "case" "fetch ms" "total ms" "network" "peer" "us" "retrans" "rtt ms ( min )" "verdict"
+
+for C in clean slow-request slow-reader think sndbuf lossy; do
+
+    SRV=; CLI=; LOSS=0
+    case $C in
+        slow-request) CLI="-w 200" ;;
+        slow-reader)  CLI="-r 65536 -R 1000" ;;
+        think)        SRV="-d 200" ;;
+        sndbuf)       SRV="-S 16384" ;;
+        lossy)        LOSS=2 ;;
+    esac
+
+    $LINK tt-cli tt-srv -l $LOSS -d 10 -r 100 -q 500 > /dev/null &
+    LPID=$!
+    sleep 0.5
+
+    rm -rf "$DIR"
+    ip netns exec tt-srv ./server -o "$DIR" $SRV > /dev/null &
+    SPID=$!
+    sleep 0.3
+
+    MS=$( ip netns exec tt-cli ./fetch 10.77.0.2 -s "$SIZE" $CLI | awk '{ print $(NF-1) }' )
+    sleep 0.2           # the server's side closes one trip later
+
+    kill $SPID
+    wait $SPID 2> /dev/null
+    kill -INT $LPID
+    wait $LPID
+
+    printf "%-13s %9s   " "$C" "$MS"
+    ./tracesum "$DIR"/*.tt | tail -1 | cut -c 42-       # without the trace and peer columns
+done
+
+ip netns del tt-cli
+ip netns del tt-srv
+rm -rf "$DIR"
@@ -0,0 +1,186 @@
+/*
+    fetch.c
+
+    Client for server.c : connect, ask for size bytes, read them all,
+    close after the server's FIN. Prints how long each fetch took.
+
+    The peer-side knobs make the client the slow part, for comparing
+    traces :
+
+        -w ms       wait before sending the request ( a slow requester )
+        -R KB/s     read no faster than this ( a slow reader )
+        -r bytes    SO_RCVBUF ( a small receive window )
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 fetch.c -o fetch
+
+    Run:
+        ./fetch 127.0.0.1 -s 4194304 -n 5
+        ./fetch 127.0.0.1 -s 4194304 -r 65536 -R 2000
+
+    Linux only
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+#define PORT "3490"
+#define CHUNK 16384
+
+
+uint64_t now_ns( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+void sleep_ns( uint64_t ns ) {
+
+    struct timespec ts = { ns / 1000000000ull, ns % 1000000000ull };
+    nanosleep( &ts, NULL );
+}
+
+
+// one fetch; returns bytes of response body received, -1 if connect failed
+long long fetch( struct addrinfo *server, size_t size, int wait_ms, int rate_kb, int rcvbuf ) {
+
+    int fd = socket( server -> ai_family, server -> ai_socktype, server -> ai_protocol );
+
+    if( fd == -1 ) {
+        return -1;
+    }
+
+    if( rcvbuf > 0 ) {
+        setsockopt( fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof rcvbuf );
+    }
+
+    if( connect( fd, server -> ai_addr, server -> ai_addrlen ) == -1 ) {
+        close( fd );
+        return -1;
+    }
+
+    if( wait_ms > 0 ) {
+        sleep_ns( wait_ms * 1000000ull );
+    }
+
+    char req[ 32 ];
+    int len = snprintf( req, sizeof req, "%zu\n", size );
+    send( fd, req, len, MSG_NOSIGNAL );
+
+    static char buf[ CHUNK ];
+    long long got = 0;
+    uint64_t t0 = now_ns();
+
+    for( ;; ) {
+
+        ssize_t n = recv( fd, buf, sizeof buf, 0 );
+
+        if( n <= 0 ) {
+            break;          // the server's FIN ( or an error )
+        }
+
+        got += n;
+
+        // slow reader : stay behind got / rate
+        if( rate_kb > 0 ) {
+
+            uint64_t due = t0 + ( uint64_t ) got * 1000000ull / rate_kb;
+            uint64_t now = now_ns();
+
+            if( due > now ) {
+                sleep_ns( due - now );
+            }
+        }
+    }
+
+    close( fd );
+
+    // the first line is the header "<size>\n"
+    return got > len ? got - len : 0;
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = PORT;
+    size_t size = 1 << 20;
+    int count = 1, wait_ms = 0, rate_kb = 0, rcvbuf = 0;
+    int opt;
+
+    if( argc < 2 ) {
+        goto usage;
+    }
+
+    optind = 2;
+
+    while( ( opt = getopt( argc, argv, "s:n:w:R:r:p:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 's': size = strtoul( optarg, NULL, 10 ); break;
+            case 'n': count = atoi( optarg ); break;
+            case 'w': wait_ms = atoi( optarg ); break;
+            case 'R': rate_kb = atoi( optarg ); break;
+            case 'r': rcvbuf = atoi( optarg ); break;
+            case 'p': port = optarg; break;
+            default: goto usage;
+        }
+    }
+
+    if( optind != argc || count < 1 || wait_ms < 0 || rate_kb < 0 || rcvbuf < 0 ) {
+    usage:
+        fprintf( stderr, "usage: %s host [-s bytes] [-n count] [-w wait-ms] [-R read-KB/s] [-r rcvbuf-bytes] [-p port]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+
+    /* ================= STEP 1: RESOLVE ================= */
+
+    struct addrinfo hints, *server;
+
+    memset( &hints, 0, sizeof hints );
+    hints.ai_family   = AF_UNSPEC;    // IPv4 or IPv6
+    hints.ai_socktype = SOCK_STREAM;
+
+    int status = getaddrinfo( argv[ 1 ], port, &hints, &server );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+
+    /* ================= STEP 2: FETCH ================= */
+
+    for( int i = 0; i < count; i++ ) {
+
+        uint64_t t0 = now_ns();
+        long long got = fetch( server, size, wait_ms, rate_kb, rcvbuf );
+        double ms = ( now_ns() - t0 ) / 1e6;
+
+        if( got < 0 ) {
+            perror( "connect" );
+            exit( 1 );
+        }
+
+        printf( "fetch %d : %lld of %zu B in %.1f ms%s\n", i + 1, got, size, ms,
+                ( size_t ) got == size ? "" : "  ( short )" );
+    }
+
+    freeaddrinfo( server );
+
+    return 0;
+}
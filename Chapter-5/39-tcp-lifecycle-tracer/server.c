@@ -0,0 +1,268 @@
+/*
+    server.c
+
+    The request / response life of 6-shutdown-and-close, traced :
+    a TCP_INFO snapshot at every step, one trace file per connection
+
+        accept()                        TT_ACCEPT
+        recv() request "<size>\n"       TT_FIRST_BYTE
+        [ think -d ms ]
+        send() size bytes               TT_LAST_BYTE
+        shutdown( SHUT_WR )             TT_SHUTDOWN
+        recv() until the client's FIN
+        close()                         TT_CLOSE
+
+    One child process per connection ( like 1-TCP-Server ). Traces go
+    to -o dir; read them with tracesum.
+
+    -d ( think time ) and -S ( send buffer ) make the server itself the
+    slow part, for comparing traces.
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 server.c tcptrace.c -o server
+
+    Run:
+        ./server -o traces
+        ./server -o traces -d 200 -S 16384
+
+    Linux only ( TCP_INFO )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+
+#include "tcptrace.h"
+
+#define PORT "3490"
+#define MAX_RESPONSE ( 256 << 20 )
+#define CHUNK 65536
+
+
+void sigchld_handler( int s ) {
+
+    ( void ) s;
+
+    int saved = errno;
+    while( waitpid( -1, NULL, WNOHANG ) > 0 );
+    errno = saved;
+}
+
+
+int open_listener( const char *port ) {
+
+    struct addrinfo hints, *res, *p;
+    int fd = -1, yes = 1;
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_UNSPEC;    // IPv4 or IPv6
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags    = AI_PASSIVE;
+
+    int status = getaddrinfo( NULL, port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        fd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( fd == -1 ) {
+            continue;
+        }
+
+        setsockopt( fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes );
+
+        if( bind( fd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( fd );
+            continue;
+        }
+
+        break;
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL || listen( fd, 128 ) == -1 ) {
+        fprintf( stderr, "server: failed to bind\n" );
+        exit( 2 );
+    }
+
+    return fd;
+}
+
+
+// one connection, start to end : runs in the child
+void serve( int fd, tt_t *t, int think_ms ) {
+
+    char req[ 64 ];
+    size_t got = 0;
+
+    /* ---------- request line ---------- */
+
+    while( got < sizeof req - 1 && memchr( req, '\n', got ) == NULL ) {
+
+        ssize_t n = recv( fd, req + got, sizeof req - 1 - got, 0 );
+
+        if( n <= 0 ) {
+            tt_mark( t, TT_CLOSE );
+            return;
+        }
+
+        if( got == 0 ) {
+            tt_mark( t, TT_FIRST_BYTE );
+        }
+
+        got += n;
+    }
+
+    req[ got ] = '\0';
+
+    size_t size = strtoul( req, NULL, 10 );
+
+    if( size > MAX_RESPONSE ) {
+        size = MAX_RESPONSE;
+    }
+
+    if( think_ms > 0 ) {
+        struct timespec ts = { think_ms / 1000, ( think_ms % 1000 ) * 1000000L };
+        nanosleep( &ts, NULL );
+    }
+
+    /* ---------- response ---------- */
+
+    static char chunk[ CHUNK ];
+    memset( chunk, 'x', sizeof chunk );
+
+    char head[ 32 ];
+    int head_len = snprintf( head, sizeof head, "%zu\n", size );
+
+    if( send( fd, head, head_len, MSG_NOSIGNAL ) != head_len ) {
+        tt_mark( t, TT_CLOSE );
+        return;
+    }
+
+    for( size_t sent = 0; sent < size; ) {
+
+        size_t len = size - sent < CHUNK ? size - sent : CHUNK;
+        ssize_t n = send( fd, chunk, len, MSG_NOSIGNAL );
+
+        if( n == -1 ) {
+            tt_mark( t, TT_CLOSE );
+            return;
+        }
+
+        sent += n;
+    }
+
+    tt_mark( t, TT_LAST_BYTE );
+
+    /* ---------- close : FIN, then wait for the client's ---------- */
+
+    shutdown( fd, SHUT_WR );
+    tt_mark( t, TT_SHUTDOWN );
+
+    while( recv( fd, req, sizeof req, 0 ) > 0 ) {
+    }
+
+    tt_mark( t, TT_CLOSE );
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = PORT, *dir = "traces";
+    int think_ms = 0, sndbuf = 0;
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "o:d:S:p:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'o': dir = optarg; break;
+            case 'd': think_ms = atoi( optarg ); break;
+            case 'S': sndbuf = atoi( optarg ); break;
+            case 'p': port = optarg; break;
+            default: goto usage;
+        }
+    }
+
+    if( optind != argc || think_ms < 0 || sndbuf < 0 ) {
+    usage:
+        fprintf( stderr, "usage: %s [-o trace-dir] [-d think-ms] [-S sndbuf-bytes] [-p port]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+
+    /* ================= STEP 1: LISTEN ================= */
+
+    if( mkdir( dir, 0755 ) == -1 && errno != EEXIST ) {
+        perror( dir );
+        exit( 1 );
+    }
+
+    int listener = open_listener( port );
+
+    struct sigaction sa;
+    memset( &sa, 0, sizeof sa );
+    sa.sa_handler = sigchld_handler;
+    sa.sa_flags = SA_RESTART;
+    sigaction( SIGCHLD, &sa, NULL );
+
+    char buf_desc[ 32 ] = "default";
+
+    if( sndbuf > 0 ) {
+        snprintf( buf_desc, sizeof buf_desc, "%d B", sndbuf );
+    }
+
+    printf( "server: port %s, traces in %s/, think %d ms, sndbuf %s\n", port, dir, think_ms, buf_desc );
+    fflush( stdout );
+
+
+    /* ================= STEP 2: ACCEPT + FORK ================= */
+
+    for( ;; ) {
+
+        int fd = accept( listener, NULL, NULL );
+
+        if( fd == -1 ) {
+            continue;
+        }
+
+        if( sndbuf > 0 ) {
+            setsockopt( fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof sndbuf );
+        }
+
+        // snapshot here, not in the child : the time to fork is ours
+        tt_t *t = tt_open( dir, fd );
+        tt_mark( t, TT_ACCEPT );
+
+        if( fork() == 0 ) {
+
+            close( listener );
+            serve( fd, t, think_ms );
+            close( fd );
+            tt_close( t );
+            exit( 0 );
+        }
+
+        tt_close( t );      // the child has its own copy of the trace file
+        close( fd );
+    }
+}
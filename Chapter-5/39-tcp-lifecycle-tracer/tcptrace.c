@@ -0,0 +1,181 @@
+/*
+    tcptrace.c
+
+    TCP_INFO snapshots to per-connection trace files ( see tcptrace.h )
+
+    Compile together with the program that uses it:
+        gcc -Wall -Wextra -pedantic -O2 tcptrace.c your_program.c -o your_program
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/sockios.h>
+#include <linux/tcp.h>
+
+#include "tcptrace.h"
+
+
+struct tt {
+
+    int sock;                   // the connection
+    int out;                    // its trace file
+};
+
+
+static uint64_t clock_ns( clockid_t id ) {
+
+    struct timespec ts;
+    clock_gettime( id, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+// "addr port" of one end of the connection
+static void name_of( int fd, int peer, char *out, size_t len ) {
+
+    struct sockaddr_storage ss;
+    socklen_t sl = sizeof ss;
+    char host[ 54 ], serv[ 8 ];         // fits tt_header_t's 64
+
+    int r = peer ? getpeername( fd, ( struct sockaddr * ) &ss, &sl )
+                 : getsockname( fd, ( struct sockaddr * ) &ss, &sl );
+
+    if( r == -1 || getnameinfo( ( struct sockaddr * ) &ss, sl, host, sizeof host, serv, sizeof serv,
+                                NI_NUMERICHOST | NI_NUMERICSERV ) != 0 ) {
+        snprintf( out, len, "?" );
+        return;
+    }
+
+    snprintf( out, len, "%s %s", host, serv );
+}
+
+
+int tt_snapshot( int fd, int event, tt_snap_t *s ) {
+
+    struct tcp_info ti;
+    socklen_t len = sizeof ti;
+    int q;
+
+    memset( s, 0, sizeof *s );
+    memset( &ti, 0, sizeof ti );        // fields an older kernel does not fill stay 0
+
+    s -> t_ns = clock_ns( CLOCK_MONOTONIC );
+    s -> event = event;
+
+    if( getsockopt( fd, IPPROTO_TCP, TCP_INFO, &ti, &len ) == -1 ) {
+        return -1;
+    }
+
+    s -> state       = ti.tcpi_state;
+    s -> ca_state    = ti.tcpi_ca_state;
+    s -> app_limited = ti.tcpi_delivery_rate_app_limited;
+
+    s -> rtt_us       = ti.tcpi_rtt;
+    s -> rttvar_us    = ti.tcpi_rttvar;
+    s -> min_rtt_us   = ti.tcpi_min_rtt;
+    s -> snd_cwnd     = ti.tcpi_snd_cwnd;
+    s -> snd_ssthresh = ti.tcpi_snd_ssthresh;
+    s -> snd_mss      = ti.tcpi_snd_mss;
+    s -> snd_wnd      = ti.tcpi_snd_wnd;
+
+    s -> unacked       = ti.tcpi_unacked;
+    s -> sacked        = ti.tcpi_sacked;
+    s -> lost          = ti.tcpi_lost;
+    s -> total_retrans = ti.tcpi_total_retrans;
+
+    s -> notsent = ti.tcpi_notsent_bytes;
+
+    if( ioctl( fd, SIOCINQ, &q ) == 0 ) {
+        s -> inq = q;
+    }
+
+    if( ioctl( fd, SIOCOUTQ, &q ) == 0 ) {
+        s -> outq = q;
+    }
+
+    s -> bytes_sent     = ti.tcpi_bytes_sent;
+    s -> bytes_retrans  = ti.tcpi_bytes_retrans;
+    s -> bytes_acked    = ti.tcpi_bytes_acked;
+    s -> bytes_received = ti.tcpi_bytes_received;
+    s -> delivery_rate  = ti.tcpi_delivery_rate;
+
+    s -> busy_us           = ti.tcpi_busy_time;
+    s -> rwnd_limited_us   = ti.tcpi_rwnd_limited;
+    s -> sndbuf_limited_us = ti.tcpi_sndbuf_limited;
+
+    return 0;
+}
+
+
+tt_t *tt_open( const char *dir, int fd ) {
+
+    static unsigned seq = 0;
+    char path[ 4096 ];
+
+    snprintf( path, sizeof path, "%s/%d-%u.tt", dir, ( int ) getpid(), ++seq );
+
+    int out = open( path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+
+    if( out == -1 ) {
+        return NULL;
+    }
+
+    tt_header_t h;
+
+    memset( &h, 0, sizeof h );
+    memcpy( h.magic, TT_MAGIC, sizeof h.magic );
+    h.snap_size = sizeof( tt_snap_t );
+    h.wall_ns = clock_ns( CLOCK_REALTIME );
+    h.mono_ns = clock_ns( CLOCK_MONOTONIC );
+    name_of( fd, 0, h.local, sizeof h.local );
+    name_of( fd, 1, h.peer, sizeof h.peer );
+
+    tt_t *t = malloc( sizeof *t );
+
+    if( t == NULL || write( out, &h, sizeof h ) != sizeof h ) {
+        free( t );
+        close( out );
+        return NULL;
+    }
+
+    t -> sock = fd;
+    t -> out = out;
+
+    return t;
+}
+
+
+int tt_mark( tt_t *t, int event ) {
+
+    tt_snap_t s;
+
+    if( t == NULL ) {
+        return 0;               // tracing off
+    }
+
+    tt_snapshot( t -> sock, event, &s );    // on error : time and event only
+
+    // one write per snapshot : a crash loses at most the one being written
+    return write( t -> out, &s, sizeof s ) == sizeof s ? 0 : -1;
+}
+
+
+void tt_close( tt_t *t ) {
+
+    if( t == NULL ) {
+        return;
+    }
+
+    close( t -> out );
+    free( t );
+}
@@ -0,0 +1,115 @@
+/*
+    tcptrace.h
+
+    TCP_INFO snapshots at the points of a connection's life, one binary
+    trace file per connection
+
+        accept ──▶ first byte ──────────────▶ last byte ──▶ shutdown ──▶ close
+        │          │                          │             │            │
+        snapshot   first request byte in      last response snapshot     before close()
+                                              byte handed
+                                              to the kernel
+
+    Every snapshot holds what the kernel knows about the connection at
+    that moment : RTT, cwnd, retransmits, unacked bytes, the socket's
+    queues, and the "chrono" counters ( time the connection was busy
+    sending, and how much of it the receiver's window or our send
+    buffer held it back ). tracesum.c reads the files back and splits
+    a connection's time between the network, the peer and us.
+
+    File layout ( host byte order, read back on the same kind of host ):
+
+        tt_header_t     once
+        tt_snap_t       per tt_mark(), in call order
+
+    Usage:
+        tt_t *t = tt_open( "traces", fd );          // after accept()
+        tt_mark( t, TT_ACCEPT );
+        ... tt_mark( t, TT_FIRST_BYTE ); ... tt_mark( t, TT_LAST_BYTE ); ...
+        tt_mark( t, TT_CLOSE );                     // just before close( fd )
+        tt_close( t );                              // the trace file
+
+    tt_mark() and tt_close() on NULL do nothing, so a failed tt_open()
+    only turns tracing off for that connection.
+*/
+
+#ifndef TCPTRACE_H
+#define TCPTRACE_H
+
+#include <stdint.h>
+
+#define TT_MAGIC        "TCPTRC01"
+
+#define TT_ACCEPT       0
+#define TT_FIRST_BYTE   1
+#define TT_LAST_BYTE    2
+#define TT_SHUTDOWN     3
+#define TT_CLOSE        4
+#define TT_EVENTS       5
+
+
+typedef struct {
+
+    char magic[ 8 ];                // TT_MAGIC, no '\0'
+    uint32_t snap_size;             // sizeof( tt_snap_t ) of the writer
+    uint32_t pad;
+    uint64_t wall_ns;               // CLOCK_REALTIME at tt_open()
+    uint64_t mono_ns;               // CLOCK_MONOTONIC at tt_open() : snapshots count from here
+    char local[ 64 ];               // "addr port"
+    char peer[ 64 ];
+
+} tt_header_t;
+
+
+typedef struct {
+
+    uint64_t t_ns;                  // CLOCK_MONOTONIC
+    uint8_t  event;                 // TT_*
+    uint8_t  state;                 // TCP_ESTABLISHED ...
+    uint8_t  ca_state;              // 0 open, 1 disorder, 2 cwr, 3 recovery, 4 loss
+    uint8_t  app_limited;           // the last delivery rate sample was app-limited
+
+    // the path
+    uint32_t rtt_us, rttvar_us, min_rtt_us;
+    uint32_t snd_cwnd, snd_ssthresh, snd_mss;
+    uint32_t snd_wnd;               // peer's advertised window, bytes ( 0 : kernel too old )
+
+    // in flight and lost
+    uint32_t unacked, sacked, lost; // segments
+    uint32_t total_retrans;         // segments, whole connection
+
+    // queues, bytes
+    uint32_t inq;                   // received, not read by us         ( SIOCINQ )
+    uint32_t outq;                  // written by us, not acked yet     ( SIOCOUTQ )
+    uint32_t notsent;               // written by us, not sent yet
+
+    uint32_t pad;
+
+    // totals, bytes
+    uint64_t bytes_sent, bytes_retrans, bytes_acked, bytes_received;
+    uint64_t delivery_rate;         // bytes / s, last sample
+
+    // chrono, µs since the connection started
+    uint64_t busy_us;               // data in flight or queued
+    uint64_t rwnd_limited_us;       // ... and the peer's window was full
+    uint64_t sndbuf_limited_us;     // ... and our send buffer was full
+
+} tt_snap_t;
+
+
+typedef struct tt tt_t;
+
+
+// fill s from fd's TCP_INFO and queues; 0, or -1 with errno set
+int tt_snapshot( int fd, int event, tt_snap_t *s );
+
+// create dir/<pid>-<n>.tt for connection fd ( dir must exist ); NULL on error
+tt_t *tt_open( const char *dir, int fd );
+
+// append a snapshot of the connection; 0, or -1 with errno set
+int tt_mark( tt_t *t, int event );
+
+// close the trace file ( not the socket )
+void tt_close( tt_t *t );
+
+#endif
@@ -0,0 +1,316 @@
+/*
+    tracesum.c
+
+    Reads trace files written by tcptrace.c and says where each
+    connection's time went : the network, the peer, or us
+
+    The time from accept to close is cut up with the snapshots :
+
+        accept → first byte         waiting for the request          peer
+        first byte → last byte      ( server producing the response )
+        last byte → close           ( send queue draining, then the
+                                      client's FIN )
+
+    Inside the last two, the kernel's chrono counters ( busy_us,
+    rwnd_limited_us, sndbuf_limited_us ) tell how the time was spent :
+
+        busy, window full           the peer reads too slowly        peer
+        busy, send buffer full      our buffer is too small          us
+        busy, otherwise             cwnd / RTT / loss                network
+
+    The kernel counts "window full" and "send buffer full" only while
+    sending is stopped dead. A sender that creeps along just below
+    either limit looks "busy, otherwise". So the last byte snapshot is
+    checked too : with less than half the cwnd in flight, the network
+    was not the limit, and the busy time goes to whichever of the two
+    windows was the tight one.
+        not busy, first → last      nothing to send : app is slow    us
+        not busy, last → close      all sent, waiting for the FIN    peer
+
+    The chrono counters tick in jiffies ( 4 ms with HZ = 250 ) : the split
+    of a connection that lasts a few ms is mostly rounding.
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 tracesum.c -o tracesum
+
+    Run:
+        ./tracesum traces/[0-9]*.tt
+        ./tracesum -v traces/4711-3.tt
+
+    Linux only ( reads tcptrace.h files from the same kind of host )
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "tcptrace.h"
+
+#define MAX_SNAPS 64
+
+
+static const char *event_name[ TT_EVENTS ] = { "accept", "first byte", "last byte", "shutdown", "close" };
+
+static const char *state_name[] = {
+    "?", "ESTABLISHED", "SYN_SENT", "SYN_RECV", "FIN_WAIT1", "FIN_WAIT2", "TIME_WAIT",
+    "CLOSE", "CLOSE_WAIT", "LAST_ACK", "LISTEN", "CLOSING"
+};
+
+enum { B_NETWORK, B_PEER, B_US, B_COUNT };
+
+static const char *blame_name[ B_COUNT ] = { "network", "peer", "us" };
+
+
+typedef struct {
+
+    double ms[ B_COUNT ];
+    double request_wait, produce, fin_wait;     // the idle parts, for -v
+    double rwnd, sndbuf, sending;               // the busy parts, for -v
+
+} blame_t;
+
+
+// what held sending back at snapshot x, when it was not the cwnd :
+// B_PEER ( its window ), B_US ( our buffer ), or B_NETWORK ( nothing else )
+int holder( const tt_snap_t *x ) {
+
+    uint64_t in_flight = ( uint64_t ) x -> unacked * x -> snd_mss;
+
+    if( x -> outq == 0 || x -> ca_state != 0 || 2 * x -> unacked >= x -> snd_cwnd || x -> snd_wnd == 0 ) {
+        return B_NETWORK;       // nothing to send, loss recovery, cwnd full, or no window info
+    }
+
+    if( 2 * in_flight >= x -> snd_wnd ) {
+        return B_PEER;
+    }
+
+    return 2 * ( uint64_t ) x -> outq < x -> snd_wnd ? B_US : B_NETWORK;
+}
+
+
+// one stretch between two snapshots; idle time goes to idle_owner,
+// busy time that was not the network's to held_by
+void phase( const tt_snap_t *a, const tt_snap_t *b, int idle_owner, int held_by, blame_t *bl ) {
+
+    double el     = ( b -> t_ns - a -> t_ns ) / 1e6;
+    double busy   = ( double ) ( b -> busy_us - a -> busy_us ) / 1e3;
+    double rwnd   = ( double ) ( b -> rwnd_limited_us - a -> rwnd_limited_us ) / 1e3;
+    double sndbuf = ( double ) ( b -> sndbuf_limited_us - a -> sndbuf_limited_us ) / 1e3;
+
+    // the counters tick in µs on their own clock : keep them inside the stretch
+    if( busy > el ) busy = el;
+    if( busy < 0 ) busy = 0;
+    if( rwnd + sndbuf > busy ) rwnd = busy - sndbuf < 0 ? 0 : busy - sndbuf;
+
+    double sending = busy - rwnd - sndbuf;
+
+    if( held_by == B_PEER ) {
+        rwnd += sending;
+        sending = 0;
+    } else if( held_by == B_US ) {
+        sndbuf += sending;
+        sending = 0;
+    }
+
+    bl -> ms[ B_NETWORK ] += sending;
+    bl -> ms[ B_PEER ] += rwnd;
+    bl -> ms[ B_US ] += sndbuf;
+    bl -> ms[ idle_owner ] += el - busy;
+
+    bl -> rwnd += rwnd;
+    bl -> sndbuf += sndbuf;
+    bl -> sending += sending;
+
+    if( idle_owner == B_US ) {
+        bl -> produce += el - busy;
+    } else {
+        bl -> fin_wait += el - busy;
+    }
+}
+
+
+void timeline( const tt_header_t *h, const tt_snap_t *s, int n ) {
+
+    time_t wall = h -> wall_ns / 1000000000ull;
+    char when[ 32 ];
+
+    strftime( when, sizeof when, "%Y-%m-%d %H:%M:%S", localtime( &wall ) );
+
+    printf( "  %s ← %s, %s\n\n", h -> local, h -> peer, when );
+    printf( "  %-10s %9s  %-11s %7s %6s %7s %7s %8s %8s %8s %8s %10s %8s %8s %8s\n",
+            "event", "+ms", "state", "rtt ms", "cwnd", "unacked", "retrans",
+            "peer wnd", "inq", "outq", "notsent", "sent", "busy ms", "rwnd ms", "sndbuf ms" );
+
+    for( int i = 0; i < n; i++ ) {
+
+        const tt_snap_t *x = &s[ i ];
+
+        printf( "  %-10s %9.2f  %-11s %7.2f %6u %7u %7u %8u %8u %8u %8u %10llu %8.1f %8.1f %8.1f\n",
+                x -> event < TT_EVENTS ? event_name[ x -> event ] : "?",
+                ( x -> t_ns - h -> mono_ns ) / 1e6,
+                x -> state < sizeof state_name / sizeof *state_name ? state_name[ x -> state ] : "?",
+                x -> rtt_us / 1e3, x -> snd_cwnd, x -> unacked, x -> total_retrans,
+                x -> snd_wnd, x -> inq, x -> outq, x -> notsent, ( unsigned long long ) x -> bytes_sent,
+                x -> busy_us / 1e3, x -> rwnd_limited_us / 1e3, x -> sndbuf_limited_us / 1e3 );
+    }
+
+    printf( "\n" );
+}
+
+
+void breakdown( const blame_t *b ) {
+
+    printf( "  %-28s %9.1f ms   peer\n", "waiting for the request", b -> request_wait );
+    printf( "  %-28s %9.1f ms   us\n", "producing the response", b -> produce );
+    printf( "  %-28s %9.1f ms   network\n", "sending : cwnd, RTT, loss", b -> sending );
+    printf( "  %-28s %9.1f ms   peer\n", "sending : peer's window", b -> rwnd );
+    printf( "  %-28s %9.1f ms   us\n", "sending : our send buffer", b -> sndbuf );
+    printf( "  %-28s %9.1f ms   peer\n", "waiting for the client's FIN", b -> fin_wait );
+    printf( "\n" );
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int verbose = 0;
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "v" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'v': verbose = 1; break;
+            default: goto usage;
+        }
+    }
+
+    if( optind == argc ) {
+    usage:
+        fprintf( stderr, "usage: %s [-v] trace-file ...\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+    double total[ B_COUNT ] = { 0 };
+    int verdicts[ B_COUNT ] = { 0 }, conns = 0;
+
+    printf( "%-14s %-26s %9s %8s %8s %8s %7s %16s   %s\n",
+            "trace", "peer", "total ms", "network", "peer", "us", "retrans", "rtt ms ( min )", "verdict" );
+
+    for( int f = optind; f < argc; f++ ) {
+
+        /* ================= STEP 1: READ ================= */
+
+        FILE *fp = fopen( argv[ f ], "rb" );
+        tt_header_t h;
+        tt_snap_t s[ MAX_SNAPS ];
+        int n = 0;
+
+        if( fp == NULL ) {
+            perror( argv[ f ] );
+            continue;
+        }
+
+        if( fread( &h, sizeof h, 1, fp ) != 1 || memcmp( h.magic, TT_MAGIC, sizeof h.magic ) != 0
+                                              || h.snap_size != sizeof( tt_snap_t ) ) {
+            fprintf( stderr, "%s: not a trace file of this version\n", argv[ f ] );
+            fclose( fp );
+            continue;
+        }
+
+        while( n < MAX_SNAPS && fread( &s[ n ], sizeof s[ n ], 1, fp ) == 1 ) {
+            n++;
+        }
+
+        fclose( fp );
+
+        const tt_snap_t *at[ TT_EVENTS ] = { NULL };
+
+        for( int i = n - 1; i >= 0; i-- ) {
+            if( s[ i ].event < TT_EVENTS ) {
+                at[ s[ i ].event ] = &s[ i ];      // the first of each kind
+            }
+        }
+
+        if( at[ TT_ACCEPT ] == NULL ) {
+            fprintf( stderr, "%s: no accept snapshot\n", argv[ f ] );
+            continue;
+        }
+
+
+        /* ================= STEP 2: BLAME ================= */
+
+        const tt_snap_t *acc = at[ TT_ACCEPT ];
+        const tt_snap_t *end = at[ TT_CLOSE ] ? at[ TT_CLOSE ] : &s[ n - 1 ];
+        const tt_snap_t *first = at[ TT_FIRST_BYTE ];
+        const tt_snap_t *last = at[ TT_LAST_BYTE ] ? at[ TT_LAST_BYTE ] : end;
+        blame_t b;
+
+        memset( &b, 0, sizeof b );
+
+        if( first == NULL ) {
+            b.request_wait = ( end -> t_ns - acc -> t_ns ) / 1e6;      // never got one
+            b.ms[ B_PEER ] += b.request_wait;
+        } else {
+            b.request_wait = ( first -> t_ns - acc -> t_ns ) / 1e6;
+            b.ms[ B_PEER ] += b.request_wait;
+            // the last byte snapshot shows how sending went while we were
+            // writing; after it our buffer no longer matters, the peer's window does
+            int held_by = last != end ? holder( last ) : B_NETWORK;
+
+            phase( first, last, B_US, held_by, &b );
+            phase( last, end, B_PEER, held_by == B_PEER ? B_PEER : B_NETWORK, &b );
+        }
+
+        double all = ( end -> t_ns - acc -> t_ns ) / 1e6;
+        int verdict = B_NETWORK;
+
+        for( int k = 0; k < B_COUNT; k++ ) {
+
+            if( b.ms[ k ] > b.ms[ verdict ] ) {
+                verdict = k;
+            }
+
+            total[ k ] += b.ms[ k ];
+        }
+
+        verdicts[ verdict ]++;
+        conns++;
+
+
+        /* ================= STEP 3: REPORT ================= */
+
+        const char *name = strrchr( argv[ f ], '/' );
+        name = name ? name + 1 : argv[ f ];
+
+        if( verbose ) {
+            printf( "\n== %s\n", name );
+            timeline( &h, s, n );
+            breakdown( &b );
+        }
+
+        printf( "%-14s %-26s %9.1f %7.1f%% %7.1f%% %7.1f%% %7u %7.2f ( %5.2f )   %s\n",
+                name, h.peer, all,
+                all > 0 ? 100 * b.ms[ B_NETWORK ] / all : 0,
+                all > 0 ? 100 * b.ms[ B_PEER ] / all : 0,
+                all > 0 ? 100 * b.ms[ B_US ] / all : 0,
+                end -> total_retrans, end -> rtt_us / 1e3, end -> min_rtt_us / 1e3,
+                blame_name[ verdict ] );
+    }
+
+    if( conns > 1 ) {
+
+        double all = total[ B_NETWORK ] + total[ B_PEER ] + total[ B_US ];
+
+        printf( "\n%d connections, %.1f ms : network %.1f%%, peer %.1f%%, us %.1f%%\n", conns, all,
+                all > 0 ? 100 * total[ B_NETWORK ] / all : 0,
+                all > 0 ? 100 * total[ B_PEER ] / all : 0,
+                all > 0 ? 100 * total[ B_US ] / all : 0 );
+        printf( "verdicts : network %d, peer %d, us %d\n", verdicts[ B_NETWORK ], verdicts[ B_PEER ], verdicts[ B_US ] );
+    }
+
+    return 0;
+}
@@ -0,0 +1,461 @@
+/*
+    addrfmt.c
+
+    Socket address ⇄ "ip:port" text ( see addrfmt.h )
+
+    Compile together with the program that uses it:
+        gcc -Wall -Wextra -pedantic -O2 addrfmt.c your_program.c -o your_program
+*/
+
+#include <string.h>
+#include <netinet/in.h>
+
+#include "addrfmt.h"
+
+
+// "00" "01" ... "99" : two decimal digits per lookup
+static const char pairs[ 201 ] =
+    "00010203040506070809" "10111213141516171819" "20212223242526272829"
+    "30313233343536373839" "40414243444546474849" "50515253545556575859"
+    "60616263646566676869" "70717273747576777879" "80818283848586878889"
+    "90919293949596979899";
+
+static const char hex_digit[ 16 ] = "0123456789abcdef";
+
+// character → hex value + 1, 0 = not a hex digit
+static const unsigned char hex_value[ 256 ] = {
+    [ '0' ] = 1,  [ '1' ] = 2,  [ '2' ] = 3,  [ '3' ] = 4,  [ '4' ] = 5,
+    [ '5' ] = 6,  [ '6' ] = 7,  [ '7' ] = 8,  [ '8' ] = 9,  [ '9' ] = 10,
+    [ 'a' ] = 11, [ 'b' ] = 12, [ 'c' ] = 13, [ 'd' ] = 14, [ 'e' ] = 15, [ 'f' ] = 16,
+    [ 'A' ] = 11, [ 'B' ] = 12, [ 'C' ] = 13, [ 'D' ] = 14, [ 'E' ] = 15, [ 'F' ] = 16,
+};
+
+
+
+/* ================= FORMAT ================= */
+
+// 0 ... 255, no leading zeros
+static char *put_octet( char *p, unsigned v ) {
+
+    if( v >= 100 ) {
+        unsigned h = v / 100;
+        *p++ = '0' + h;
+        memcpy( p, pairs + 2 * ( v - 100 * h ), 2 );
+        return p + 2;
+    }
+
+    if( v >= 10 ) {
+        memcpy( p, pairs + 2 * v, 2 );
+        return p + 2;
+    }
+
+    *p++ = '0' + v;
+    return p;
+}
+
+
+static char *put_ipv4( char *p, const unsigned char *b ) {
+
+    p = put_octet( p, b[ 0 ] );  *p++ = '.';
+    p = put_octet( p, b[ 1 ] );  *p++ = '.';
+    p = put_octet( p, b[ 2 ] );  *p++ = '.';
+
+    return put_octet( p, b[ 3 ] );
+}
+
+
+// 0 ... 65535 : pairs from the right, then move into place
+static char *put_port( char *p, unsigned v ) {
+
+    char tmp[ 6 ], *t = tmp + sizeof tmp;
+
+    while( v >= 100 ) {
+        unsigned r = v % 100;
+        v /= 100;
+        t -= 2;
+        memcpy( t, pairs + 2 * r, 2 );
+    }
+
+    if( v >= 10 ) {
+        t -= 2;
+        memcpy( t, pairs + 2 * v, 2 );
+    } else {
+        *--t = '0' + v;
+    }
+
+    size_t n = tmp + sizeof tmp - t;
+    memcpy( p, t, n );
+
+    return p + n;
+}
+
+
+// one group, lowercase, no leading zeros
+static char *put_hex16( char *p, unsigned w ) {
+
+    if( w >= 0x1000 ) *p++ = hex_digit[ w >> 12 ];
+    if( w >= 0x100 )  *p++ = hex_digit[ ( w >> 8 ) & 15 ];
+    if( w >= 0x10 )   *p++ = hex_digit[ ( w >> 4 ) & 15 ];
+
+    *p++ = hex_digit[ w & 15 ];
+    return p;
+}
+
+
+// the same choices as inet_ntop() : longest run of two or more zero
+// groups becomes "::" ( the first one on a tie ); ::a.b.c.d and
+// ::ffff:a.b.c.d keep the IPv4 address dotted
+static char *put_ipv6( char *p, const unsigned char *b ) {
+
+    unsigned w[ 8 ];
+    int best = -1, best_len = 0;
+
+    for( int i = 0; i < 8; i++ ) {
+        w[ i ] = b[ 2 * i ] << 8 | b[ 2 * i + 1 ];
+    }
+
+    for( int i = 0; i < 8; ) {
+
+        if( w[ i ] != 0 ) {
+            i++;
+            continue;
+        }
+
+        int j = i;
+
+        while( j < 8 && w[ j ] == 0 ) {
+            j++;
+        }
+
+        if( j - i > best_len ) {
+            best = i;
+            best_len = j - i;
+        }
+
+        i = j;
+    }
+
+    if( best_len < 2 ) {
+        best = -1;
+    }
+
+    for( int i = 0; i < 8; i++ ) {
+
+        if( best != -1 && i >= best && i < best + best_len ) {
+            if( i == best ) {
+                *p++ = ':';
+            }
+            continue;
+        }
+
+        if( i != 0 ) {
+            *p++ = ':';
+        }
+
+        if( i == 6 && best == 0 && ( best_len == 6 || ( best_len == 5 && w[ 5 ] == 0xffff ) ) ) {
+            return put_ipv4( p, b + 12 );
+        }
+
+        p = put_hex16( p, w[ i ] );
+    }
+
+    if( best != -1 && best + best_len == 8 ) {
+        *p++ = ':';
+    }
+
+    return p;
+}
+
+
+// write into buf if it surely fits, else into tmp and copy what fits
+static int format( const struct sockaddr *sa, char *buf, size_t len, int with_port ) {
+
+    char tmp[ ADDR_STRLEN ];
+    char *start = len >= ADDR_STRLEN ? buf : tmp, *p = start;
+
+    if( sa -> sa_family == AF_INET ) {
+
+        const struct sockaddr_in *in = ( const struct sockaddr_in * ) sa;
+
+        p = put_ipv4( p, ( const unsigned char * ) &in -> sin_addr );
+
+        if( with_port ) {
+            *p++ = ':';
+            p = put_port( p, ntohs( in -> sin_port ) );
+        }
+
+    } else if( sa -> sa_family == AF_INET6 ) {
+
+        const struct sockaddr_in6 *in6 = ( const struct sockaddr_in6 * ) sa;
+
+        if( with_port ) {
+            *p++ = '[';
+        }
+
+        p = put_ipv6( p, in6 -> sin6_addr.s6_addr );
+
+        if( with_port ) {
+            *p++ = ']';
+            *p++ = ':';
+            p = put_port( p, ntohs( in6 -> sin6_port ) );
+        }
+
+    } else {
+        return -1;
+    }
+
+    size_t n = p - start;
+
+    if( start == tmp ) {
+
+        if( n + 1 > len ) {
+            return -1;
+        }
+
+        memcpy( buf, tmp, n );
+    }
+
+    buf[ n ] = '\0';
+
+    return ( int ) n;
+}
+
+
+int addr_format( const struct sockaddr *sa, char *buf, size_t len ) {
+
+    return format( sa, buf, len, 1 );
+}
+
+
+int addr_format_ip( const struct sockaddr *sa, char *buf, size_t len ) {
+
+    return format( sa, buf, len, 0 );
+}
+
+
+
+/* ================= PARSE ================= */
+
+// dotted quad in [ s, end ), the rules of inet_pton() : four decimal
+// octets, each 0 ... 255, no leading zeros; 0 on success
+static int parse_ipv4( const char *s, const char *end, unsigned char *out ) {
+
+    unsigned char b[ 4 ];
+    int octets = 0, digits = 0;
+    unsigned v = 0;
+
+    for( ; s < end; s++ ) {
+
+        unsigned d = ( unsigned char ) *s - '0';
+
+        if( d < 10 ) {
+
+            if( digits > 0 && v == 0 ) {
+                return -1;          // leading zero
+            }
+
+            v = v * 10 + d;
+
+            if( v > 255 ) {
+                return -1;
+            }
+
+            digits++;
+            continue;
+        }
+
+        if( *s == '.' && digits > 0 && octets < 3 ) {
+            b[ octets++ ] = v;
+            v = 0;
+            digits = 0;
+            continue;
+        }
+
+        return -1;
+    }
+
+    if( octets != 3 || digits == 0 ) {
+        return -1;
+    }
+
+    b[ 3 ] = v;
+    memcpy( out, b, 4 );
+
+    return 0;
+}
+
+
+// RFC 4291 text in [ s, end ), the rules of inet_pton() : up to eight
+// groups of 1 ... 4 hex digits, at most one "::", an optional dotted
+// quad for the last 32 bits; 0 on success
+static int parse_ipv6( const char *s, const char *end, unsigned char *out ) {
+
+    unsigned char b[ 16 ], *tp = b, *gap = NULL;
+    const char *group = s;
+    int digits = 0;
+    unsigned v = 0;
+
+    memset( b, 0, sizeof b );
+
+    if( s < end && *s == ':' ) {
+
+        if( ++s == end || *s != ':' ) {
+            return -1;      // one leading ':' alone
+        }
+    }
+
+    while( s < end ) {
+
+        unsigned char ch = *s++;
+        unsigned x = hex_value[ ch ];
+
+        if( x != 0 ) {
+
+            if( ++digits > 4 ) {
+                return -1;
+            }
+
+            v = v << 4 | ( x - 1 );
+            continue;
+        }
+
+        if( ch == ':' ) {
+
+            group = s;
+
+            if( digits == 0 ) {
+
+                if( gap != NULL ) {
+                    return -1;      // a second "::"
+                }
+
+                gap = tp;
+                continue;
+            }
+
+            if( s == end || tp + 2 > b + 16 ) {
+                return -1;          // trailing ':', or too many groups
+            }
+
+            *tp++ = v >> 8;
+            *tp++ = v;
+            digits = 0;
+            v = 0;
+            continue;
+        }
+
+        if( ch == '.' && tp + 4 <= b + 16 && parse_ipv4( group, end, tp ) == 0 ) {
+            tp += 4;
+            digits = 0;
+            break;
+        }
+
+        return -1;
+    }
+
+    if( digits > 0 ) {
+
+        if( tp + 2 > b + 16 ) {
+            return -1;
+        }
+
+        *tp++ = v >> 8;
+        *tp++ = v;
+    }
+
+    if( gap != NULL ) {
+
+        if( tp == b + 16 ) {
+            return -1;              // "::" must stand for at least one group
+        }
+
+        size_t n = tp - gap;
+
+        memmove( b + 16 - n, gap, n );
+        memset( gap, 0, b + 16 - n - gap );
+        tp = b + 16;
+    }
+
+    if( tp != b + 16 ) {
+        return -1;
+    }
+
+    memcpy( out, b, 16 );
+
+    return 0;
+}
+
+
+// 1 ... 5 decimal digits, at most 65535
+static int parse_port( const char *s, const char *end, unsigned *port ) {
+
+    unsigned v = 0;
+
+    if( s == end || end - s > 5 ) {
+        return -1;
+    }
+
+    for( ; s < end; s++ ) {
+
+        unsigned d = ( unsigned char ) *s - '0';
+
+        if( d >= 10 ) {
+            return -1;
+        }
+
+        v = v * 10 + d;
+    }
+
+    if( v > 65535 ) {
+        return -1;
+    }
+
+    *port = v;
+
+    return 0;
+}
+
+
+int addr_parse( const char *s, size_t len, struct sockaddr_storage *ss, socklen_t *sl ) {
+
+    const char *end = s + len;
+    unsigned port;
+
+    memset( ss, 0, sizeof *ss );
+
+    /* ---------- "[ip6]:port" ---------- */
+
+    if( len > 0 && s[ 0 ] == '[' ) {
+
+        const char *close = memchr( s, ']', len );
+        struct sockaddr_in6 *in6 = ( struct sockaddr_in6 * ) ss;
+
+        if( close == NULL || close + 1 == end || close[ 1 ] != ':'
+                          || parse_ipv6( s + 1, close, in6 -> sin6_addr.s6_addr ) != 0
+                          || parse_port( close + 2, end, &port ) != 0 ) {
+            return -1;
+        }
+
+        in6 -> sin6_family = AF_INET6;
+        in6 -> sin6_port = htons( port );
+        *sl = sizeof *in6;
+
+        return 0;
+    }
+
+    /* ---------- "ip:port" ---------- */
+
+    const char *colon = memchr( s, ':', len );
+    struct sockaddr_in *in = ( struct sockaddr_in * ) ss;
+
+    if( colon == NULL || parse_ipv4( s, colon, ( unsigned char * ) &in -> sin_addr ) != 0
+                      || parse_port( colon + 1, end, &port ) != 0 ) {
+        return -1;
+    }
+
+    in -> sin_family = AF_INET;
+    in -> sin_port = htons( port );
+    *sl = sizeof *in;
+
+    return 0;
+}
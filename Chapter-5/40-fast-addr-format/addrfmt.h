@@ -0,0 +1,54 @@
+/*
+    addrfmt.h
+
+    Socket address ⇄ "ip:port" text, without libc's formatting machinery
+
+        struct sockaddr_in   10.0.0.7 : 51234        →   "10.0.0.7:51234"
+        struct sockaddr_in6  2001:db8::1 : 443       →   "[2001:db8::1]:443"
+
+    The usual accept-path log line
+
+        inet_ntop( ss.ss_family, get_in_addr( sa ), ip, sizeof ip );
+        snprintf( line, sizeof line, "%s:%u", ip, ntohs( port ) );
+
+    goes through inet_ntop()'s own sprintf() calls and then snprintf()'s
+    format parser. addr_format() writes the digits straight into the
+    caller's buffer with lookup tables : no allocation, no locale, no
+    format string.
+
+    The text is exactly what inet_ntop() writes ( RFC 5952 : lowercase,
+    longest run of zero groups as "::", IPv4-mapped as ::ffff:a.b.c.d ),
+    plus the port. addr_parse() reads it back, and accepts the same
+    addresses inet_pton() does. check_addr.c holds both to libc.
+
+    Usage:
+        char text[ ADDR_STRLEN ];
+        int n = addr_format( ( struct sockaddr * ) &their_addr, text, sizeof text );
+
+        struct sockaddr_storage ss;
+        socklen_t len;
+        if( addr_parse( "[::1]:3490", 10, &ss, &len ) == 0 ) ...
+*/
+
+#ifndef ADDRFMT_H
+#define ADDRFMT_H
+
+#include <stddef.h>
+#include <sys/socket.h>
+
+// longest text + '\0' : "[ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff]:65535"
+#define ADDR_STRLEN 48
+
+
+// AF_INET or AF_INET6 address → "ip:port" / "[ip6]:port" + '\0'
+// returns the length without the '\0', or -1 ( other family, buffer too small )
+int addr_format( const struct sockaddr *sa, char *buf, size_t len );
+
+// the address alone, as inet_ntop() writes it; same return values
+int addr_format_ip( const struct sockaddr *sa, char *buf, size_t len );
+
+// "ip:port" / "[ip6]:port", exactly len bytes ( no '\0' needed ) → ss, *sl
+// returns 0, or -1 if the text is not one address and port
+int addr_parse( const char *s, size_t len, struct sockaddr_storage *ss, socklen_t *sl );
+
+#endif
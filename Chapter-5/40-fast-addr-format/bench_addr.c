@@ -0,0 +1,336 @@
+/*
+    bench_addr.c
+
+    addrfmt.c against the libc ways of doing the same job
+
+    Format  sockaddr → "ip:port"
+        addr_format               lookup tables, straight into the buffer
+        inet_ntop + snprintf      what most servers log with
+        getnameinfo + snprintf    NI_NUMERICHOST | NI_NUMERICSERV
+
+    Parse  "ip:port" → sockaddr
+        addr_parse                one pass over the text
+        inet_pton + strtoul       split, copy, convert
+        getaddrinfo               AI_NUMERICHOST | AI_NUMERICSERV, + freeaddrinfo
+
+    Each method runs over the same 4096 IPv4 and 4096 IPv6 peers ( the
+    IPv6 ones with zero runs of random length, so "::" lands anywhere ).
+    Every round is timed on its own; the median is reported.
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 bench_addr.c addrfmt.c -o bench_addr
+
+    Run:
+        ./bench_addr                       ( 2M calls per method and family, 7 rounds )
+        ./bench_addr -n 10000000 -r 11
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include "addrfmt.h"
+
+#define PEERS 4096
+#define MAX_ROUNDS 31
+
+
+uint64_t now_ns( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+uint64_t rng_state = 0x2545f4914f6cdd1dull;
+
+uint64_t rng( void ) {
+
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+
+    return rng_state;
+}
+
+
+struct sockaddr_storage peers[ 2 ][ PEERS ];    // [ 0 ] IPv4, [ 1 ] IPv6
+char text[ 2 ][ PEERS ][ ADDR_STRLEN ];
+int text_len[ 2 ][ PEERS ];
+
+volatile unsigned sink;                         // keeps the results alive
+
+
+void make_peers( void ) {
+
+    for( int i = 0; i < PEERS; i++ ) {
+
+        struct sockaddr_in *in = ( struct sockaddr_in * ) &peers[ 0 ][ i ];
+        struct sockaddr_in6 *in6 = ( struct sockaddr_in6 * ) &peers[ 1 ][ i ];
+        uint64_t r = rng();
+
+        in -> sin_family = AF_INET;
+        in -> sin_addr.s_addr = ( uint32_t ) r;
+        in -> sin_port = htons( 1024 + ( r >> 32 ) % 64512 );
+
+        // 2001:db8:<random>, then a zero run of 0 - 4 groups somewhere
+        int zero_at = 2 + rng() % 6, zeros = rng() % 5;
+
+        in6 -> sin6_family = AF_INET6;
+        in6 -> sin6_port = htons( 1024 + ( r >> 48 ) % 64512 );
+        in6 -> sin6_addr.s6_addr[ 0 ] = 0x20;
+        in6 -> sin6_addr.s6_addr[ 1 ] = 0x01;
+        in6 -> sin6_addr.s6_addr[ 2 ] = 0x0d;
+        in6 -> sin6_addr.s6_addr[ 3 ] = 0xb8;
+
+        for( int g = 2; g < 8; g++ ) {
+
+            unsigned w = g >= zero_at && g < zero_at + zeros ? 0 : rng() & 0xffff;
+
+            in6 -> sin6_addr.s6_addr[ 2 * g ] = w >> 8;
+            in6 -> sin6_addr.s6_addr[ 2 * g + 1 ] = w;
+        }
+
+        for( int f = 0; f < 2; f++ ) {
+            text_len[ f ][ i ] = addr_format( ( struct sockaddr * ) &peers[ f ][ i ], text[ f ][ i ], ADDR_STRLEN );
+        }
+    }
+}
+
+
+
+/* ================= THE CONTENDERS ================= */
+
+unsigned fmt_ours( const struct sockaddr_storage *ss ) {
+
+    char buf[ ADDR_STRLEN ];
+
+    return addr_format( ( const struct sockaddr * ) ss, buf, sizeof buf ) + buf[ 0 ];
+}
+
+
+unsigned fmt_ntop( const struct sockaddr_storage *ss ) {
+
+    char ip[ INET6_ADDRSTRLEN ], buf[ ADDR_STRLEN ];
+
+    if( ss -> ss_family == AF_INET ) {
+        const struct sockaddr_in *in = ( const struct sockaddr_in * ) ss;
+        inet_ntop( AF_INET, &in -> sin_addr, ip, sizeof ip );
+        return snprintf( buf, sizeof buf, "%s:%u", ip, ntohs( in -> sin_port ) ) + buf[ 0 ];
+    }
+
+    const struct sockaddr_in6 *in6 = ( const struct sockaddr_in6 * ) ss;
+    inet_ntop( AF_INET6, &in6 -> sin6_addr, ip, sizeof ip );
+    return snprintf( buf, sizeof buf, "[%s]:%u", ip, ntohs( in6 -> sin6_port ) ) + buf[ 0 ];
+}
+
+
+unsigned fmt_nameinfo( const struct sockaddr_storage *ss ) {
+
+    char host[ NI_MAXHOST ], serv[ NI_MAXSERV ], buf[ ADDR_STRLEN ];
+    socklen_t sl = ss -> ss_family == AF_INET ? sizeof( struct sockaddr_in ) : sizeof( struct sockaddr_in6 );
+
+    getnameinfo( ( const struct sockaddr * ) ss, sl, host, sizeof host, serv, sizeof serv,
+                 NI_NUMERICHOST | NI_NUMERICSERV );
+
+    return snprintf( buf, sizeof buf, ss -> ss_family == AF_INET ? "%s:%s" : "[%s]:%s", host, serv ) + buf[ 0 ];
+}
+
+
+unsigned parse_ours( const char *s, int len ) {
+
+    struct sockaddr_storage ss;
+    socklen_t sl;
+
+    return addr_parse( s, len, &ss, &sl ) + ss.ss_family;
+}
+
+
+unsigned parse_pton( const char *s, int len ) {
+
+    struct sockaddr_storage ss;
+    char host[ INET6_ADDRSTRLEN ];
+    const char *colon;
+
+    memset( &ss, 0, sizeof ss );
+
+    if( s[ 0 ] == '[' ) {
+
+        const char *close = memchr( s, ']', len );
+        struct sockaddr_in6 *in6 = ( struct sockaddr_in6 * ) &ss;
+
+        memcpy( host, s + 1, close - s - 1 );
+        host[ close - s - 1 ] = '\0';
+        in6 -> sin6_family = AF_INET6;
+        in6 -> sin6_port = htons( strtoul( close + 2, NULL, 10 ) );
+
+        return inet_pton( AF_INET6, host, &in6 -> sin6_addr ) + ss.ss_family;
+    }
+
+    struct sockaddr_in *in = ( struct sockaddr_in * ) &ss;
+
+    colon = memchr( s, ':', len );
+    memcpy( host, s, colon - s );
+    host[ colon - s ] = '\0';
+    in -> sin_family = AF_INET;
+    in -> sin_port = htons( strtoul( colon + 1, NULL, 10 ) );
+
+    return inet_pton( AF_INET, host, &in -> sin_addr ) + ss.ss_family;
+}
+
+
+unsigned parse_gai( const char *s, int len ) {
+
+    struct addrinfo hints, *res;
+    char host[ INET6_ADDRSTRLEN ];
+    const char *colon, *h = s;
+    int hlen;
+
+    if( s[ 0 ] == '[' ) {
+        colon = ( const char * ) memchr( s, ']', len ) + 1;
+        h = s + 1;
+        hlen = colon - s - 2;
+    } else {
+        colon = memchr( s, ':', len );
+        hlen = colon - s;
+    }
+
+    memcpy( host, h, hlen );
+    host[ hlen ] = '\0';
+
+    memset( &hints, 0, sizeof hints );
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV;
+
+    if( getaddrinfo( host, colon + 1, &hints, &res ) != 0 ) {
+        return 0;
+    }
+
+    unsigned r = res -> ai_family;
+    freeaddrinfo( res );
+
+    return r;
+}
+
+
+
+/* ================= TIMING ================= */
+
+typedef struct {
+
+    const char *name;
+    unsigned ( *format )( const struct sockaddr_storage * );
+    unsigned ( *parse )( const char *, int );
+
+} method_t;
+
+
+int cmp_double( const void *a, const void *b ) {
+
+    double x = *( const double * ) a, y = *( const double * ) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+
+// median ns per call over the rounds
+double run( const method_t *m, int family, long calls, int rounds ) {
+
+    double ns[ MAX_ROUNDS ];
+
+    for( int r = 0; r < rounds; r++ ) {
+
+        uint64_t t0 = now_ns();
+        unsigned acc = 0;
+
+        for( long i = 0; i < calls; i++ ) {
+
+            int k = i & ( PEERS - 1 );
+
+            acc += m -> format ? m -> format( &peers[ family ][ k ] )
+                               : m -> parse( text[ family ][ k ], text_len[ family ][ k ] );
+        }
+
+        ns[ r ] = ( double ) ( now_ns() - t0 ) / calls;
+        sink += acc;
+    }
+
+    qsort( ns, rounds, sizeof *ns, cmp_double );
+
+    return ns[ rounds / 2 ];
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    long calls = 2000000;
+    int rounds = 7;
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:r:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'n': calls = atol( optarg ); break;
+            case 'r': rounds = atoi( optarg ); break;
+            default: goto usage;
+        }
+    }
+
+    if( optind != argc || calls < 1 || rounds < 1 || rounds > MAX_ROUNDS ) {
+    usage:
+        fprintf( stderr, "usage: %s [-n calls] [-r rounds, 1 - %d]\n", argv[ 0 ], MAX_ROUNDS );
+        exit( 1 );
+    }
+
+    make_peers();
+
+    method_t methods[] = {
+        { "addr_format",            fmt_ours,     NULL },
+        { "inet_ntop + snprintf",   fmt_ntop,     NULL },
+        { "getnameinfo + snprintf", fmt_nameinfo, NULL },
+        { "addr_parse",             NULL,         parse_ours },
+        { "inet_pton + strtoul",    NULL,         parse_pton },
+        { "getaddrinfo",            NULL,         parse_gai },
+    };
+
+    printf( "%ld calls per method and family, median of %d rounds\n\n", calls, rounds );
+    printf( "%-24s %12s %8s %12s %8s\n", "method", "ipv4 ns/op", "x", "ipv6 ns/op", "x" );
+
+    double base[ 2 ] = { 0, 0 };
+
+    for( size_t m = 0; m < sizeof methods / sizeof *methods; m++ ) {
+
+        double ns[ 2 ];
+
+        if( m == 3 ) {
+            printf( "\n" );
+        }
+
+        for( int f = 0; f < 2; f++ ) {
+
+            ns[ f ] = run( &methods[ m ], f, calls, rounds );
+
+            if( m % 3 == 0 ) {
+                base[ f ] = ns[ f ];        // ours : the 1.0x of its group
+            }
+        }
+
+        printf( "%-24s %12.1f %7.1fx %12.1f %7.1fx\n", methods[ m ].name,
+                ns[ 0 ], ns[ 0 ] / base[ 0 ], ns[ 1 ], ns[ 1 ] / base[ 1 ] );
+    }
+
+    return 0;
+}
@@ -0,0 +1,483 @@
+/*
+    check_addr.c
+
+    Holds addrfmt.c to libc : every address it formats must match
+    inet_ntop(), every text it parses must match inet_pton()
+
+    Checks:
+        ports      all 65536 ports, IPv4 and IPv6
+        ipv4       every 9973rd address ( -x : all 2^32 )
+        ipv6       every zero / non-zero pattern of the 8 groups, with
+                   1 - 4 digit group values, plus ::, ::1, ::a.b.c.d,
+                   ::ffff:a.b.c.d and random addresses
+        roundtrip  addr_parse( addr_format( x ) ) == x for all of the above
+        fuzz       mutated and random strings : addr_parse() accepts
+                   exactly what inet_pton() + a 1 - 5 digit port accepts,
+                   and gives the same address
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 check_addr.c addrfmt.c -o check_addr
+
+    Run:
+        ./check_addr                        ( a few seconds )
+        ./check_addr -x                     ( all IPv4 addresses, about 40 minutes )
+        ./check_addr -f 10000000            ( more fuzz strings )
+
+    Linux only ( compares with glibc's inet_ntop / inet_pton )
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include "addrfmt.h"
+
+
+long checked = 0, failed = 0;
+
+
+uint64_t rng_state = 0x2545f4914f6cdd1dull;
+
+uint64_t rng( void ) {
+
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+
+    return rng_state;
+}
+
+
+void fail( const char *what, const char *got, const char *want ) {
+
+    if( ++failed <= 10 ) {
+        fprintf( stderr, "MISMATCH %s : got \"%s\", want \"%s\"\n", what, got, want );
+    }
+}
+
+
+// libc's text for ss, the way a server would log it
+void reference( const struct sockaddr_storage *ss, char *ip, char *full ) {
+
+    if( ss -> ss_family == AF_INET ) {
+
+        const struct sockaddr_in *in = ( const struct sockaddr_in * ) ss;
+
+        inet_ntop( AF_INET, &in -> sin_addr, ip, INET6_ADDRSTRLEN );
+        sprintf( full, "%s:%u", ip, ntohs( in -> sin_port ) );
+
+    } else {
+
+        const struct sockaddr_in6 *in6 = ( const struct sockaddr_in6 * ) ss;
+
+        inet_ntop( AF_INET6, &in6 -> sin6_addr, ip, INET6_ADDRSTRLEN );
+        sprintf( full, "[%s]:%u", ip, ntohs( in6 -> sin6_port ) );
+    }
+}
+
+
+int same_addr( const struct sockaddr_storage *a, const struct sockaddr_storage *b ) {
+
+    if( a -> ss_family != b -> ss_family ) {
+        return 0;
+    }
+
+    return a -> ss_family == AF_INET
+         ? memcmp( a, b, sizeof( struct sockaddr_in ) ) == 0
+         : memcmp( a, b, sizeof( struct sockaddr_in6 ) ) == 0;
+}
+
+
+// format ss both ways, compare, parse it back
+void check( const struct sockaddr_storage *ss ) {
+
+    char ip[ INET6_ADDRSTRLEN ], want[ ADDR_STRLEN ], got[ ADDR_STRLEN ];
+    struct sockaddr_storage back;
+    socklen_t sl;
+
+    reference( ss, ip, want );
+    checked++;
+
+    if( addr_format_ip( ( const struct sockaddr * ) ss, got, sizeof got ) < 0 || strcmp( got, ip ) != 0 ) {
+        fail( "addr_format_ip", got, ip );
+        return;
+    }
+
+    int n = addr_format( ( const struct sockaddr * ) ss, got, sizeof got );
+
+    if( n != ( int ) strlen( want ) || strcmp( got, want ) != 0 ) {
+        fail( "addr_format", got, want );
+        return;
+    }
+
+    // a buffer one byte short must be refused, an exact one accepted
+    if( addr_format( ( const struct sockaddr * ) ss, got, n ) != -1
+     || addr_format( ( const struct sockaddr * ) ss, got, n + 1 ) != n || strcmp( got, want ) != 0 ) {
+        fail( "addr_format ( exact buffer )", got, want );
+        return;
+    }
+
+    if( addr_parse( want, n, &back, &sl ) != 0 || !same_addr( &back, ss ) ) {
+        fail( "addr_parse", "( different address )", want );
+    }
+}
+
+
+void make_v4( struct sockaddr_storage *ss, uint32_t addr, unsigned port ) {
+
+    struct sockaddr_in *in = ( struct sockaddr_in * ) ss;
+
+    memset( ss, 0, sizeof *ss );
+    in -> sin_family = AF_INET;
+    in -> sin_addr.s_addr = htonl( addr );
+    in -> sin_port = htons( port );
+}
+
+
+void make_v6( struct sockaddr_storage *ss, const unsigned w[ 8 ], unsigned port ) {
+
+    struct sockaddr_in6 *in6 = ( struct sockaddr_in6 * ) ss;
+
+    memset( ss, 0, sizeof *ss );
+    in6 -> sin6_family = AF_INET6;
+    in6 -> sin6_port = htons( port );
+
+    for( int i = 0; i < 8; i++ ) {
+        in6 -> sin6_addr.s6_addr[ 2 * i ] = w[ i ] >> 8;
+        in6 -> sin6_addr.s6_addr[ 2 * i + 1 ] = w[ i ];
+    }
+}
+
+
+
+/* ================= PARSER FUZZ ================= */
+
+// libc's answer : split the same way, then inet_pton() and a strict port
+int reference_parse( const char *s, size_t len, struct sockaddr_storage *ss ) {
+
+    char host[ 256 ];
+    const char *sep, *port;
+    int family;
+
+    memset( ss, 0, sizeof *ss );
+
+    if( len > 0 && s[ 0 ] == '[' ) {
+
+        const char *close = memchr( s, ']', len );
+
+        if( close == NULL || close + 1 == s + len || close[ 1 ] != ':' ) {
+            return -1;
+        }
+
+        family = AF_INET6;
+        memcpy( host, s + 1, close - s - 1 );
+        host[ close - s - 1 ] = '\0';
+        sep = close + 1;
+
+    } else {
+
+        sep = memchr( s, ':', len );
+
+        if( sep == NULL ) {
+            return -1;
+        }
+
+        family = AF_INET;
+        memcpy( host, s, sep - s );
+        host[ sep - s ] = '\0';
+    }
+
+    port = sep + 1;
+    size_t plen = s + len - port;
+    char digits[ 8 ], *end;
+
+    if( plen == 0 || plen > 5 ) {
+        return -1;
+    }
+
+    memcpy( digits, port, plen );
+    digits[ plen ] = '\0';
+
+    if( strspn( digits, "0123456789" ) < plen ) {
+        return -1;
+    }
+
+    unsigned long p = strtoul( digits, &end, 10 );
+
+    if( p > 65535 ) {
+        return -1;
+    }
+
+    if( family == AF_INET ) {
+
+        struct sockaddr_in *in = ( struct sockaddr_in * ) ss;
+
+        if( inet_pton( AF_INET, host, &in -> sin_addr ) != 1 ) {
+            return -1;
+        }
+
+        in -> sin_family = AF_INET;
+        in -> sin_port = htons( p );
+
+    } else {
+
+        struct sockaddr_in6 *in6 = ( struct sockaddr_in6 * ) ss;
+
+        if( inet_pton( AF_INET6, host, &in6 -> sin6_addr ) != 1 ) {
+            return -1;
+        }
+
+        in6 -> sin6_family = AF_INET6;
+        in6 -> sin6_port = htons( p );
+    }
+
+    return 0;
+}
+
+
+// characters that make up addresses, and a few that must be refused
+const char alphabet[] = "0123456789abcdefABCDEF:::...[]]g% -x";
+
+void mutate( char *s, size_t *len ) {
+
+    int edits = 1 + rng() % 3;
+
+    for( int e = 0; e < edits; e++ ) {
+
+        uint64_t r = rng();
+        size_t at = *len ? r % ( *len + 1 ) : 0;
+        char c = alphabet[ ( r >> 16 ) % ( sizeof alphabet - 1 ) ];
+
+        switch( ( r >> 32 ) % 3 ) {
+
+            case 0:     // replace
+                if( at < *len ) {
+                    s[ at ] = c;
+                }
+                break;
+
+            case 1:     // insert
+                if( *len < 100 ) {
+                    memmove( s + at + 1, s + at, *len - at );
+                    s[ at ] = c;
+                    ( *len )++;
+                }
+                break;
+
+            case 2:     // delete
+                if( at < *len ) {
+                    memmove( s + at, s + at + 1, *len - at - 1 );
+                    ( *len )--;
+                }
+                break;
+        }
+    }
+}
+
+
+void fuzz_one( const char *s, size_t len, long *accepted ) {
+
+    struct sockaddr_storage got, want;
+    socklen_t sl;
+
+    int r = addr_parse( s, len, &got, &sl );
+    int w = reference_parse( s, len, &want );
+
+    checked++;
+
+    if( r != w || ( r == 0 && !same_addr( &got, &want ) ) ) {
+
+        char text[ 128 ];
+
+        snprintf( text, sizeof text, "%.*s", ( int ) len, s );
+        fail( "addr_parse", r == 0 ? "accepted" : "refused", w == 0 ? "accepted" : "refused" );
+        fprintf( stderr, "         input \"%s\"\n", text );
+        return;
+    }
+
+    *accepted += r == 0;
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int all_v4 = 0;
+    long fuzz = 1000000;
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "xf:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'x': all_v4 = 1; break;
+            case 'f': fuzz = atol( optarg ); break;
+            default: goto usage;
+        }
+    }
+
+    if( optind != argc || fuzz < 0 ) {
+    usage:
+        fprintf( stderr, "usage: %s [-x] [-f fuzz-strings]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+    struct sockaddr_storage ss;
+    long before;
+
+
+    /* ================= STEP 1: PORTS ================= */
+
+    before = checked;
+
+    for( unsigned p = 0; p <= 65535; p++ ) {
+
+        unsigned w[ 8 ] = { 0x2001, 0xdb8, 0, 0, 0, 0, 0, 1 };
+
+        make_v4( &ss, 0x0a000007, p );
+        check( &ss );
+        make_v6( &ss, w, p );
+        check( &ss );
+    }
+
+    printf( "%-10s %12ld checked\n", "ports", checked - before );
+
+
+    /* ================= STEP 2: IPV4 ================= */
+
+    before = checked;
+
+    uint32_t stride = all_v4 ? 1 : 9973;
+
+    for( uint64_t a = 0; a <= 0xffffffffull; a += stride ) {
+        make_v4( &ss, ( uint32_t ) a, ( unsigned ) ( a * 2654435761u ) & 0xffff );
+        check( &ss );
+    }
+
+    printf( "%-10s %12ld checked%s\n", "ipv4", checked - before, all_v4 ? " ( all )" : "" );
+
+
+    /* ================= STEP 3: IPV6 ================= */
+
+    before = checked;
+
+    // one value per digit count, plus the edges
+    unsigned values[] = { 1, 0xa, 0xff, 0x100, 0xabc, 0x1000, 0xffff, 0 };
+    int nvalues = sizeof values / sizeof *values;
+
+    for( unsigned mask = 0; mask < 256; mask++ ) {
+
+        for( int v = 0; v < nvalues; v++ ) {
+
+            unsigned w[ 8 ];
+
+            for( int i = 0; i < 8; i++ ) {
+
+                unsigned x = values[ v ] ? values[ v ] : 1 + rng() % 0xffff;   // 0 : random non-zero
+                w[ i ] = mask & ( 1u << i ) ? x : 0;
+            }
+
+            make_v6( &ss, w, 443 );
+            check( &ss );
+        }
+    }
+
+    // the forms inet_ntop() writes with a dotted quad, and their neighbours
+    for( int k = 0; k < 100000; k++ ) {
+
+        uint32_t v4 = k < 1000 ? ( uint32_t ) k : ( uint32_t ) rng();
+        unsigned w[ 8 ] = { 0, 0, 0, 0, 0, 0, v4 >> 16, v4 & 0xffff };
+
+        make_v6( &ss, w, k & 0xffff );              // ::a.b.c.d ( and ::, ::1 )
+        check( &ss );
+
+        w[ 5 ] = 0xffff;
+        make_v6( &ss, w, k & 0xffff );              // ::ffff:a.b.c.d
+        check( &ss );
+
+        w[ 5 ] = 0xfffe;
+        make_v6( &ss, w, k & 0xffff );              // not mapped : hex
+        check( &ss );
+
+        w[ 5 ] = 0;
+        w[ 4 ] = 1;
+        make_v6( &ss, w, k & 0xffff );              // 0:0:0:0:1:0 prefix : hex
+        check( &ss );
+    }
+
+    // random groups, each zero with probability 1/3 so runs of every length show up
+    for( int k = 0; k < 1000000; k++ ) {
+
+        unsigned w[ 8 ];
+        uint64_t r = rng();
+
+        for( int i = 0; i < 8; i++ ) {
+            w[ i ] = ( r >> ( 8 * i ) ) % 3 == 0 ? 0 : ( rng() & ( 0xffff >> ( 4 * ( rng() % 4 ) ) ) );
+        }
+
+        make_v6( &ss, w, r >> 48 );
+        check( &ss );
+    }
+
+    printf( "%-10s %12ld checked\n", "ipv6", checked - before );
+
+
+    /* ================= STEP 4: PARSER FUZZ ================= */
+
+    before = checked;
+
+    long accepted = 0;
+
+    for( long k = 0; k < fuzz; k++ ) {
+
+        char s[ 128 ];
+        size_t len;
+        uint64_t r = rng();
+
+        if( k % 8 == 7 ) {
+
+            // plain random text
+            len = r % 48;
+
+            for( size_t i = 0; i < len; i++ ) {
+                s[ i ] = alphabet[ rng() % ( sizeof alphabet - 1 ) ];
+            }
+
+        } else {
+
+            // a valid text with a few edits
+            if( r & 1 ) {
+                make_v4( &ss, ( uint32_t ) rng(), ( r >> 8 ) & 0xffff );
+            } else {
+                unsigned w[ 8 ];
+
+                for( int i = 0; i < 8; i++ ) {
+                    w[ i ] = ( r >> ( 8 * i ) ) % 3 == 0 ? 0 : rng() & 0xffff;
+                }
+
+                if( ( r >> 60 ) == 0 ) {
+                    w[ 0 ] = w[ 1 ] = w[ 2 ] = w[ 3 ] = w[ 4 ] = 0;     // dotted quad forms
+                    w[ 5 ] = r & 2 ? 0xffff : 0;
+                }
+
+                make_v6( &ss, w, ( r >> 8 ) & 0xffff );
+            }
+
+            len = addr_format( ( struct sockaddr * ) &ss, s, sizeof s );
+            mutate( s, &len );
+        }
+
+        fuzz_one( s, len, &accepted );
+    }
+
+    printf( "%-10s %12ld checked ( %ld accepted )\n", "fuzz", checked - before, accepted );
+
+
+    printf( "\n%ld checks, %ld mismatches\n", checked, failed );
+
+    return failed != 0;
+}
@@ -0,0 +1,34 @@
+#!/bin/sh
+#
+#   bench.sh
+#
+#   CPU per datagram : plain vs GSO talker, plain vs GRO listener ( loopback ::1 )
+#
+#   Usage:
+#       ./bench.sh [datagrams] [segment-bytes] [segments-per-send]
+#
+#   Example:
+#       ./bench.sh 500000 1400 32
+
+COUNT=${1:-500000}
+SEG=${2:-1400}
+PER_SEND=${3:-32}
+
+for L in "" "-G"; do
+    for T in "" "-G"; do
+
+        echo "== listener ${L:-plain}  talker ${T:-plain}"
+
+        ./udp_listener $L -i 1 > /tmp/udp_listener.$$ &
+        LISTENER=$!
+        sleep 0.3
+
+        ./udp_talker ::1 $T -s "$SEG" -k "$PER_SEND" -n "$COUNT" | sed 1d
+
+        wait "$LISTENER"
+        sed 1d /tmp/udp_listener.$$
+        echo
+    done
+done
+
+rm -f /tmp/udp_listener.$$
@@ -0,0 +1,255 @@
+/*
+   udp_listener.c
+
+   Long-running UDP receiver with optional GRO ( UDP_GRO receive coalescing )
+
+   Without -G:
+    one recvmsg() per datagram
+
+   With -G:
+    the kernel may hand us several same-flow datagrams glued together
+    ( a "super-datagram" ), a UDP_GRO cmsg carries the original segment size,
+    we split the buffer back into datagrams ourselves
+
+   Every datagram is checked : the talker puts its sequence number at the
+   start and the complement at the end, so a datagram split at the wrong
+   offset, or cut short, counts as a mismatch
+
+   Stops after -i seconds without traffic and prints the totals
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 udp_listener.c -o udp_listener
+
+   Run:
+    ./udp_listener            ( plain )
+    ./udp_listener -G         ( GRO )
+
+   Linux only ( UDP_GRO, kernel 5.0+ )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <arpa/inet.h>
+
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+#define MYPORT "4950"       // Port we listen on
+#define MAXBUFLEN 65536     // a GRO super-datagram can be up to 64 KiB
+#define RCVBUF ( 8 << 20 )  // deep receive queue for bursts
+
+
+double cpu_seconds( void ) {
+
+    struct rusage ru;
+    getrusage( RUSAGE_SELF, &ru );
+
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6
+         + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+
+// 0 if the datagram carries matching head and tail marks ( see udp_talker.c ),
+// 1 if it was split or truncated wrongly; too short to carry them : 0
+int check_datagram( const char *d, size_t len ) {
+
+    unsigned int head, tail;
+
+    if( len < 8 ) {
+        return 0;
+    }
+
+    memcpy( &head, d, sizeof head );
+    memcpy( &tail, d + len - sizeof tail, sizeof tail );
+
+    return head != ~tail;
+}
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int sockfd;
+    struct addrinfo hints, *servinfo, *p;
+    int rv;
+
+    int gro = 0;            // -G
+    int idle = 2;           // -i : seconds without packets before stopping
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "Gi:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'G': gro = 1; break;
+            case 'i': idle = atoi( optarg ); break;
+            default:
+                fprintf( stderr, "usage: %s [-G] [-i idle-seconds]\n", argv[ 0 ] );
+                exit( 1 );
+        }
+    }
+
+
+    /* STEP 1: SETUP HINTS + BIND */
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_INET6;   // force IPv6
+    hints.ai_socktype = SOCK_DGRAM; // UDP
+    hints.ai_flags    = AI_PASSIVE; // bind to my IP
+
+    rv = getaddrinfo( NULL, MYPORT, &hints, &servinfo );
+
+    if( rv != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( rv ) );
+        exit( 1 );
+    }
+
+    for( p = servinfo; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            perror( "listener: socket" );
+            continue;
+        }
+
+        if( bind( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            perror( "listener: bind" );
+            continue;
+        }
+
+        break;  // success
+    }
+
+    if( p == NULL ) {
+        fprintf( stderr, "listener: failed to bind\n" );
+        exit( 2 );
+    }
+
+    freeaddrinfo( servinfo );
+
+    int rcvbuf = RCVBUF;
+    setsockopt( sockfd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof rcvbuf );
+
+
+    /* STEP 2: ENABLE GRO */
+
+    if( gro ) {
+
+        int one = 1;
+
+        // "I can handle coalesced datagrams" : kernel stops splitting them for us
+        if( setsockopt( sockfd, SOL_UDP, UDP_GRO, &one, sizeof one ) == -1 ) {
+            perror( "listener: UDP_GRO" );
+            exit( 3 );
+        }
+    }
+
+    printf( "listener: waiting for datagrams on %s ( %s )...\n", MYPORT, gro ? "GRO" : "plain" );
+    fflush( stdout );
+
+
+    /* STEP 3: RECEIVE LOOP */
+
+    char *buf = malloc( MAXBUFLEN );
+    char cbuf[ CMSG_SPACE( sizeof( int ) ) ];
+
+    long datagrams = 0, calls = 0, coalesced = 0, mismatches = 0;
+    long long bytes = 0;
+    double cpu0 = 0;
+
+    struct pollfd pfd = { sockfd, POLLIN, 0 };
+
+    while( poll( &pfd, 1, idle * 1000 ) > 0 ) {
+
+        struct sockaddr_storage their_addr;
+        struct iovec iov = { buf, MAXBUFLEN };
+        struct msghdr msg = { 0 };
+
+        msg.msg_name = &their_addr;
+        msg.msg_namelen = sizeof their_addr;
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = cbuf;
+        msg.msg_controllen = sizeof cbuf;
+
+        ssize_t n = recvmsg( sockfd, &msg, 0 );
+
+        if( n == -1 ) {
+            perror( "recvmsg" );
+            continue;
+        }
+
+        // start the CPU clock at the first packet
+        if( calls == 0 ) {
+            cpu0 = cpu_seconds();
+        }
+
+        calls++;
+        bytes += n;
+
+        // segment size from the UDP_GRO cmsg ( absent = ordinary datagram )
+        int seg = 0;
+
+        for( struct cmsghdr *cm = CMSG_FIRSTHDR( &msg ); cm; cm = CMSG_NXTHDR( &msg, cm ) ) {
+
+            if( cm -> cmsg_level == SOL_UDP && cm -> cmsg_type == UDP_GRO ) {
+                memcpy( &seg, CMSG_DATA( cm ), sizeof seg );
+            }
+        }
+
+        if( seg <= 0 || seg >= n ) {
+            mismatches += check_datagram( buf, n );
+            datagrams++;
+            continue;
+        }
+
+        // split : every seg bytes is one original datagram, the last may be shorter
+        coalesced++;
+
+        for( ssize_t off = 0; off < n; off += seg ) {
+
+            size_t len = n - off < seg ? ( size_t ) ( n - off ) : ( size_t ) seg;
+
+            mismatches += check_datagram( buf + off, len );
+            datagrams++;
+        }
+    }
+
+    double cpu = cpu_seconds() - cpu0;
+
+
+    /* STEP 4: PRINT INFO */
+
+    printf( "listener: %ld datagrams ( %lld bytes ) in %ld recvmsg calls, %ld coalesced, %ld mismatched\n",
+            datagrams, bytes, calls, coalesced, mismatches );
+
+    if( datagrams ) {
+        printf( "listener: %.2f datagrams per call | %.3f us CPU per datagram\n",
+                ( double ) datagrams / calls, cpu * 1e6 / datagrams );
+    }
+
+
+    /* STEP 5: CLEANUP */
+
+    close( sockfd );
+
+    return 0;
+}
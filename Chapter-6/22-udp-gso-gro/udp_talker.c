@@ -0,0 +1,243 @@
+/*
+   udp_talker.c
+
+   Bulk UDP sender with optional GSO ( UDP_SEGMENT send offload )
+
+   Without -G:
+    one sendto() per datagram
+
+   With -G:
+    one sendmsg() carries up to K datagrams in ONE buffer,
+    a UDP_SEGMENT cmsg tells the kernel the segment size,
+    the kernel ( or NIC ) cuts it into MTU-sized datagrams
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 udp_talker.c -o udp_talker
+
+   Run:
+    ./udp_talker localhost                     ( 200000 x 1400 B, plain sendto )
+    ./udp_talker localhost -G -k 32            ( GSO, 32 segments per syscall )
+    ./udp_talker localhost -G -s 1200 -n 1000000
+
+   Linux only ( UDP_SEGMENT, kernel 4.18+ )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <arpa/inet.h>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+#define SERVERPORT "4950"
+#define MAX_SEGS 64             // kernel limit per GSO send ( UDP_MAX_SEGMENTS )
+#define MAX_GSO_BYTES 65000     // must stay below the 64 KiB IP datagram limit
+
+
+double cpu_seconds( void ) {
+
+    struct rusage ru;
+    getrusage( RUSAGE_SELF, &ru );
+
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6
+         + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+
+double wall_seconds( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+int main( int argc, char *argv[] ) {
+
+    int sockfd;
+    struct addrinfo hints, *servinfo, *p;
+    int rv;
+
+    int gso = 0;            // -G
+    int seg = 1400;         // -s : datagram ( segment ) payload size
+    int per_send = 32;      // -k : segments per GSO send
+    long total = 200000;    // -n : datagrams to send
+    int opt;
+
+
+    /* STEP 0: ARG CHECK */
+
+    while( ( opt = getopt( argc, argv, "Gs:k:n:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'G': gso = 1; break;
+            case 's': seg = atoi( optarg ); break;
+            case 'k': per_send = atoi( optarg ); break;
+            case 'n': total = atol( optarg ); break;
+            default: goto usage;
+        }
+    }
+
+    if( argc - optind != 1 ) {
+usage:
+        fprintf( stderr, "usage: %s hostname [-G] [-s segment-bytes] [-k segments-per-send] [-n datagrams]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+    if( seg < 1 || seg > MAX_GSO_BYTES || per_send < 1 || per_send > MAX_SEGS || ( gso && ( long ) seg * per_send > MAX_GSO_BYTES ) ) {
+        fprintf( stderr, "talker: need 1 <= k <= %d and s * k <= %d\n", MAX_SEGS, MAX_GSO_BYTES );
+        exit( 1 );
+    }
+
+
+    /* STEP 1: SETUP HINTS */
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_INET6;   // force IPv6
+    hints.ai_socktype = SOCK_DGRAM; // UDP
+
+
+    /* STEP 2: RESOLVE HOST */
+
+    rv = getaddrinfo( argv[ optind ], SERVERPORT, &hints, &servinfo );
+
+    if( rv != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( rv ) );
+        exit( 2 );
+    }
+
+
+    /* STEP 3: CREATE SOCKET */
+
+    for( p = servinfo; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            perror( "talker: socket" );
+            continue;
+        }
+
+        break;
+    }
+
+    if( p == NULL ) {
+        fprintf( stderr, "talker: failed to create socket\n" );
+        exit( 3 );
+    }
+
+
+    /* STEP 4: SEND */
+
+    // one big buffer : each segment starts with its sequence number and
+    // ends with its complement, so the listener can check every split
+    char *buf = calloc( 1, ( size_t ) seg * ( gso ? per_send : 1 ) );
+
+    long sent = 0, calls = 0;
+
+    double cpu0 = cpu_seconds(), wall0 = wall_seconds();
+
+    while( sent < total ) {
+
+        int k = gso ? per_send : 1;
+
+        if( total - sent < k ) {
+            k = total - sent;
+        }
+
+        for( int i = 0; i < k && seg >= 4; i++ ) {
+
+            unsigned int seq = htonl( ( unsigned int ) ( sent + i ) );
+            memcpy( buf + ( size_t ) i * seg, &seq, sizeof seq );
+
+            if( seg >= 8 ) {
+                seq = ~seq;
+                memcpy( buf + ( size_t ) ( i + 1 ) * seg - sizeof seq, &seq, sizeof seq );
+            }
+        }
+
+        ssize_t n;
+
+        if( !gso ) {
+
+            n = sendto( sockfd, buf, seg, 0, p -> ai_addr, p -> ai_addrlen );
+
+        } else {
+
+            /*
+                UDP_SEGMENT as a per-call cmsg :
+                    payload = k * seg bytes
+                    kernel emits k datagrams of seg bytes each
+            */
+            union {
+                char cbuf[ CMSG_SPACE( sizeof( uint16_t ) ) ];
+                struct cmsghdr align;
+            } u;
+
+            struct iovec iov = { buf, ( size_t ) k * seg };
+            struct msghdr msg = { 0 };
+
+            msg.msg_name = p -> ai_addr;
+            msg.msg_namelen = p -> ai_addrlen;
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = u.cbuf;
+            msg.msg_controllen = sizeof u.cbuf;
+
+            struct cmsghdr *cm = CMSG_FIRSTHDR( &msg );
+
+            cm -> cmsg_level = SOL_UDP;
+            cm -> cmsg_type = UDP_SEGMENT;
+            cm -> cmsg_len = CMSG_LEN( sizeof( uint16_t ) );
+
+            uint16_t gso_size = seg;
+            memcpy( CMSG_DATA( cm ), &gso_size, sizeof gso_size );
+
+            n = sendmsg( sockfd, &msg, 0 );
+        }
+
+        if( n == -1 ) {
+
+            // kernel send queue momentarily full : try again
+            if( errno == ENOBUFS || errno == EAGAIN ) {
+                continue;
+            }
+
+            perror( "talker: send" );
+            exit( 4 );
+        }
+
+        sent += k;
+        calls++;
+    }
+
+    double cpu = cpu_seconds() - cpu0, wall = wall_seconds() - wall0;
+
+    printf( "talker: %s sent %ld datagrams x %d B in %ld syscalls\n", gso ? "GSO" : "plain", sent, seg, calls );
+    printf( "talker: %.0f pkt/s | %.3f us CPU per datagram\n", sent / wall, cpu * 1e6 / sent );
+
+
+    /* STEP 5: CLEANUP */
+
+    freeaddrinfo( servinfo );
+
+    close( sockfd );
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+#!/bin/sh
+#
+#   demo.sh
+#
+#   Same bursty traffic, same slow listener, two receive buffer sizes :
+#   shows the drops, and that they are the socket's and not the network's
+#
+#   Usage:
+#       ./demo.sh [datagrams] [rate] [burst] [work-us]
+#
+#   Example:
+#       ./demo.sh 100000 20000 5000 20
+
+COUNT=${1:-100000}
+RATE=${2:-20000}
+BURST=${3:-5000}
+WORK=${4:-20}
+
+# the second size needs -F ( root / CAP_NET_ADMIN ) when it is above net.core.rmem_max
+for B in "-b 65536" "-b 16777216 -F"; do
+
+    echo "== listener $B -w $WORK   talker -r $RATE -B $BURST"
+
+    ./udp_listener $B -w "$WORK" > /tmp/udp_listener.$$ &
+    LISTENER=$!
+    sleep 0.3
+
+    ./udp_talker ::1 -n "$COUNT" -r "$RATE" -B "$BURST"
+
+    wait "$LISTENER"
+    cat /tmp/udp_listener.$$
+    echo
+done
+
+rm -f /tmp/udp_listener.$$
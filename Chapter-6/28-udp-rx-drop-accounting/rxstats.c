@@ -0,0 +1,177 @@
+/*
+    rxstats.c
+
+    Receive-side drop accounting for UDP sockets ( see rxstats.h )
+
+    Compile together with the program that uses it:
+        gcc -Wall -Wextra -pedantic -O2 rxstats.c your_server.c -o your_server
+*/
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+#include <linux/sock_diag.h>
+
+#include "rxstats.h"
+
+#ifndef SO_MEMINFO
+#define SO_MEMINFO 55
+#endif
+
+
+static double now_sec( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+// the kernel counter is 32 bits and only grows : add how far it moved
+static void drops_update( rx_stats_t *st, uint32_t raw ) {
+
+    int32_t moved = ( int32_t ) ( raw - st -> raw_drops );
+
+    // an older value ( cmsg of a datagram queued before the last sample ) : ignore
+    if( moved > 0 ) {
+        st -> drops += ( uint32_t ) moved;
+        st -> raw_drops = raw;
+    }
+}
+
+
+
+/* ================= SETUP ================= */
+
+int rx_setup( int fd, int rcvbuf, int force, rx_stats_t *st ) {
+
+    memset( st, 0, sizeof *st );
+
+    st -> start = st -> last_t = now_sec();
+    st -> rcvbuf_asked = rcvbuf;
+
+    if( rcvbuf > 0 ) {
+
+        // FORCE ignores net.core.rmem_max but needs CAP_NET_ADMIN
+        if( force && setsockopt( fd, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof rcvbuf ) == 0 ) {
+            st -> forced = 1;
+        } else {
+            setsockopt( fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof rcvbuf );
+        }
+    }
+
+    // the kernel doubles the value ( bookkeeping overhead ) and clips it to rmem_max
+    socklen_t len = sizeof st -> rcvbuf;
+    getsockopt( fd, SOL_SOCKET, SO_RCVBUF, &st -> rcvbuf, &len );
+
+    // compare with 2 × asked : a clipped value can still be above 'rcvbuf'
+    st -> capped = rcvbuf > 0 && st -> rcvbuf < 2ll * rcvbuf;
+
+    int one = 1;
+
+    return setsockopt( fd, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof one );
+}
+
+
+
+/* ================= PER DATAGRAM ================= */
+
+void rx_account( rx_stats_t *st, const struct msghdr *msg, ssize_t n ) {
+
+    if( n < 0 ) {
+        return;
+    }
+
+    st -> packets++;
+    st -> bytes += n;
+
+    for( struct cmsghdr *cm = CMSG_FIRSTHDR( msg ); cm; cm = CMSG_NXTHDR( ( struct msghdr * ) msg, cm ) ) {
+
+        if( cm -> cmsg_level == SOL_SOCKET && cm -> cmsg_type == SO_RXQ_OVFL ) {
+
+            uint32_t raw;
+            memcpy( &raw, CMSG_DATA( cm ), sizeof raw );
+            drops_update( st, raw );
+        }
+    }
+}
+
+
+
+/* ================= PERIODIC ================= */
+
+void rx_watch( rx_stats_t *st, int fd ) {
+
+    // SO_MEMINFO : queue bytes, and drops even when no datagram carries a cmsg
+    uint32_t mem[ SK_MEMINFO_VARS ];
+    socklen_t len = sizeof mem;
+
+    memset( mem, 0, sizeof mem );
+
+    if( getsockopt( fd, SOL_SOCKET, SO_MEMINFO, mem, &len ) == -1 ) {
+        return;
+    }
+
+    st -> queued = mem[ SK_MEMINFO_RMEM_ALLOC ];
+
+    if( st -> queued > st -> peak_queued ) {
+        st -> peak_queued = st -> queued;
+    }
+
+    if( len > SK_MEMINFO_DROPS * sizeof( uint32_t ) ) {
+        drops_update( st, mem[ SK_MEMINFO_DROPS ] );
+    }
+}
+
+
+void rx_sample( rx_stats_t *st, int fd ) {
+
+    double now = now_sec();
+    double dt = now - st -> last_t;
+
+    rx_watch( st, fd );
+
+    // SIOCINQ on UDP : length of the datagram at the head of the queue
+    if( ioctl( fd, SIOCINQ, &st -> next ) == -1 ) {
+        st -> next = -1;
+    }
+
+    st -> t = now - st -> start;
+    st -> rate = dt > 0 ? ( st -> packets - st -> last_packets ) / dt : 0;
+    st -> drops_delta = st -> drops - st -> last_drops;
+
+    st -> last_t = now;
+    st -> last_packets = st -> packets;
+    st -> last_drops = st -> drops;
+}
+
+
+void rx_print( const rx_stats_t *st, FILE *out ) {
+
+    double pct = st -> rcvbuf ? 100.0 / st -> rcvbuf : 0.0;
+
+    fprintf( out, "%7.1f s | %9.0f pkt/s | %8llu drops ( +%llu ) | queue %5.1f%% ( peak %5.1f%% ) of %d B | next %d B\n",
+             st -> t, st -> rate, ( unsigned long long ) st -> drops, ( unsigned long long ) st -> drops_delta,
+             pct * st -> queued, pct * st -> peak_queued, st -> rcvbuf, st -> next );
+    fflush( out );
+}
+
+
+void rx_csv_header( FILE *out ) {
+
+    fprintf( out, "t,rate,packets,drops,drops_delta,queued,peak_queued,rcvbuf,next\n" );
+    fflush( out );
+}
+
+
+void rx_csv( const rx_stats_t *st, FILE *out ) {
+
+    fprintf( out, "%.3f,%.0f,%llu,%llu,%llu,%u,%u,%d,%d\n",
+             st -> t, st -> rate, ( unsigned long long ) st -> packets, ( unsigned long long ) st -> drops,
+             ( unsigned long long ) st -> drops_delta, st -> queued, st -> peak_queued, st -> rcvbuf, st -> next );
+    fflush( out );
+}
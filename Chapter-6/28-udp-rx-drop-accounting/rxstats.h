@@ -0,0 +1,100 @@
+/*
+    rxstats.h
+
+    Receive-side drop accounting for UDP sockets
+
+    Where a datagram can be lost on the way to recvmsg():
+
+        network ──▶ NIC / stack ──▶ socket receive queue ──▶ application
+                                     ( SO_RCVBUF bytes )
+                                           │
+                                           └── full : dropped, sk_drops++
+
+    The last hop is the server's fault : it did not read fast enough,
+    or the queue is too small for the bursts it gets. This module makes
+    those drops visible :
+
+        - SO_RXQ_OVFL : every recvmsg() carries a cmsg with the socket's
+          cumulative drop counter ( absent while it is still 0 )
+        - SO_RCVBUF, or SO_RCVBUFFORCE to go past net.core.rmem_max
+        - SO_MEMINFO : bytes currently queued and the drop counter,
+          readable at any time, even when no datagram arrives
+        - SIOCINQ : for UDP the size of the NEXT datagram, 0 = queue empty
+
+    Usage:
+        rx_stats_t st;
+        rx_setup( sockfd, 8 << 20, 0, &st );
+        ...
+        n = recvmsg( sockfd, &msg, 0 );         // msg_control = RX_CMSG_SPACE buffer
+        rx_account( &st, &msg, n );
+        ...
+        rx_watch( &st, sockfd );                // before each drain : peak queue
+        rx_sample( &st, sockfd );               // once per interval
+        rx_print( &st, stdout );
+*/
+
+#ifndef RXSTATS_H
+#define RXSTATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+// control buffer big enough for the SO_RXQ_OVFL cmsg
+#define RX_CMSG_SPACE CMSG_SPACE( sizeof( uint32_t ) )
+
+
+typedef struct {
+
+    // socket setup
+    int rcvbuf_asked;           // bytes requested
+    int rcvbuf;                 // what the kernel granted ( doubled, maybe clipped )
+    int forced;                 // SO_RCVBUFFORCE was used
+    int capped;                 // granted less than 2 × asked : rmem_max clipped it
+
+    // totals, updated per datagram by rx_account()
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t drops;             // socket drops so far ( SO_RXQ_OVFL cmsg or SO_MEMINFO )
+    uint32_t raw_drops;         // kernel counter behind drops : 32 bits, wraps
+
+    // snapshot taken by rx_sample()
+    double   t;                 // seconds since rx_setup()
+    double   rate;              // datagrams per second over the interval
+    uint64_t drops_delta;       // drops during the interval
+    uint32_t queued;            // bytes in the receive queue ( SO_MEMINFO )
+    int      next;              // SIOCINQ : size of the next datagram
+    uint32_t peak_queued;       // highest queued seen by rx_watch() / rx_sample()
+
+    // previous sample
+    double   last_t;
+    uint64_t last_packets;
+    uint64_t last_drops;
+    double   start;
+
+} rx_stats_t;
+
+
+// enable SO_RXQ_OVFL and size the receive buffer ( rcvbuf 0 = leave default )
+// force : SO_RCVBUFFORCE ( needs CAP_NET_ADMIN, falls back to SO_RCVBUF )
+// returns 0, or -1 with errno set when SO_RXQ_OVFL is not supported
+int rx_setup( int fd, int rcvbuf, int force, rx_stats_t *st );
+
+// count one received datagram and pick up the drop counter from its cmsg
+void rx_account( rx_stats_t *st, const struct msghdr *msg, ssize_t n );
+
+// cheap check of queue bytes and drops ( one getsockopt ) : call it before
+// draining the socket, a full queue is only visible right after a burst
+void rx_watch( rx_stats_t *st, int fd );
+
+// take a snapshot : rate, drops, queue occupancy
+void rx_sample( rx_stats_t *st, int fd );
+
+// one line for the last snapshot
+void rx_print( const rx_stats_t *st, FILE *out );
+
+// the same as CSV ( header once with rx_csv_header() )
+void rx_csv_header( FILE *out );
+void rx_csv( const rx_stats_t *st, FILE *out );
+
+#endif
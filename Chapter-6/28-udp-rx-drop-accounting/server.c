@@ -0,0 +1,222 @@
+/*
+    server.c
+
+    UDP echo server with receive drop accounting
+    ( Chapter-5/5-UDP-sendto-recvfrom/server.c, plus rxstats.c )
+
+    What it does :
+        - echoes every datagram back, like the Chapter-5 server
+        - recvmsg() instead of recvfrom() : the SO_RXQ_OVFL cmsg rides along
+        - every -I seconds : receive rate, socket drops, queue occupancy
+        - -b / -F size the receive buffer ( SO_RCVBUF / SO_RCVBUFFORCE )
+
+    Compile:
+        gcc -Wall -Wextra -pedantic -O2 server.c rxstats.c -o server
+
+    Run:
+        ./server                            ( port 3490, default buffer )
+        ./server -b 8388608 -F -o rx.csv    ( 8 MiB forced, CSV export )
+
+    Linux only ( SO_RXQ_OVFL, SO_RCVBUFFORCE, SO_MEMINFO )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+#include "rxstats.h"
+
+#define PORT "3490"   // Port number as string
+
+
+double now_sec( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = PORT;
+    int rcvbuf = 0;                 // -b : bytes, 0 = system default
+    int force = 0;                  // -F
+    double interval = 1.0;          // -I : seconds
+    const char *csv_path = NULL;    // -o
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "p:b:FI:o:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'p': port = optarg; break;
+            case 'b': rcvbuf = atoi( optarg ); break;
+            case 'F': force = 1; break;
+            case 'I': interval = atof( optarg ); break;
+            case 'o': csv_path = optarg; break;
+            default: goto usage;
+        }
+    }
+
+    if( rcvbuf < 0 || interval < 0.01 ) {
+usage:
+        fprintf( stderr, "usage: %s [-p port] [-b rcvbuf] [-F] [-I interval] [-o file.csv]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+    struct addrinfo hints, *res, *p;
+    int sockfd;
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_UNSPEC;     // IPv4 or IPv6
+    hints.ai_socktype = SOCK_DGRAM;    // UDP socket
+    hints.ai_flags    = AI_PASSIVE;    // Use my IP
+
+    int status = getaddrinfo( NULL, port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            continue;
+        }
+
+        if( bind( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            continue;
+        }
+
+        break;   // Successfully bound
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        printf( "Failed to bind\n" );
+        exit( 1 );
+    }
+
+
+    /* ================= DROP ACCOUNTING ================= */
+
+    rx_stats_t st;
+
+    if( rx_setup( sockfd, rcvbuf, force, &st ) == -1 ) {
+        perror( "SO_RXQ_OVFL" );
+        exit( 1 );
+    }
+
+    printf( "UDP Server listening on %s ( receive buffer %d B%s )...\n",
+            port, st.rcvbuf, st.forced ? ", forced" : "" );
+
+    if( st.capped ) {
+        printf( "receive buffer capped by net.core.rmem_max : use -F ( CAP_NET_ADMIN ) or raise the sysctl\n" );
+    }
+
+    fflush( stdout );
+
+    FILE *csv = NULL;
+
+    if( csv_path ) {
+
+        csv = fopen( csv_path, "w" );
+
+        if( csv == NULL ) {
+            perror( csv_path );
+            exit( 1 );
+        }
+
+        rx_csv_header( csv );
+    }
+
+
+    /* ================= ECHO LOOP ================= */
+
+    char buffer[ 2048 ];
+    char cbuf[ RX_CMSG_SPACE ];
+    struct sockaddr_storage client_addr;
+
+    struct pollfd pfd = { sockfd, POLLIN, 0 };
+    double next_report = now_sec() + interval;
+
+    while( 1 ) {
+
+        double now = now_sec();
+
+        if( now >= next_report ) {
+
+            rx_sample( &st, sockfd );
+            rx_print( &st, stdout );
+
+            if( csv ) {
+                rx_csv( &st, csv );
+            }
+
+            next_report += interval;
+
+            if( next_report < now ) {
+                next_report = now + interval;
+            }
+        }
+
+        if( poll( &pfd, 1, ( int ) ( ( next_report - now ) * 1000 ) + 1 ) <= 0 ) {
+            continue;
+        }
+
+        // queue depth now, before we drain it : catches the peak of a burst
+        rx_watch( &st, sockfd );
+
+        // drain up to 256 datagrams, then look at the clock again
+        for( int i = 0; i < 256; i++ ) {
+
+            struct iovec iov = { buffer, sizeof buffer };
+            struct msghdr msg = { 0 };
+
+            msg.msg_name = &client_addr;
+            msg.msg_namelen = sizeof client_addr;
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = cbuf;
+            msg.msg_controllen = sizeof cbuf;
+
+            ssize_t bytes = recvmsg( sockfd, &msg, MSG_DONTWAIT );
+
+            if( bytes == -1 ) {
+
+                if( errno != EAGAIN ) {
+                    perror( "recvmsg" );
+                }
+
+                break;
+            }
+
+            rx_account( &st, &msg, bytes );
+
+            // Send same message back (echo)
+            if( sendto( sockfd, buffer, bytes, 0, ( struct sockaddr * ) &client_addr, msg.msg_namelen ) == -1 ) {
+                perror( "sendto" );
+            }
+        }
+    }
+
+    close( sockfd );   // Close socket
+
+    return 0;
+}
@@ -0,0 +1,320 @@
+/*
+   udp_listener.c
+
+   Long-running UDP receiver that accounts for every lost datagram
+   ( 09-unconnected-UDP-socket/udp_listener.c, plus rxstats.c )
+
+   Every -I seconds it prints :
+    receive rate | socket drops | receive queue occupancy | SIOCINQ
+
+   With udp_talker.c as the sender ( sequence numbers + END marker ),
+   the final report splits the missing datagrams into :
+    - dropped by OUR socket   ( SO_RXQ_OVFL : queue was full, server too slow )
+    - failed in the sender    ( send() errors )
+    - lost elsewhere          ( the network : the rest )
+
+   -w makes the "application" slow on purpose : busy work per datagram
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 udp_listener.c rxstats.c -o udp_listener
+
+   Run:
+    ./udp_listener                          ( default receive buffer )
+    ./udp_listener -w 20 -b 65536           ( slow reader, small queue : drops )
+    ./udp_listener -w 20 -b 33554432 -F     ( same, 32 MiB queue past rmem_max )
+    ./udp_listener -I 0.5 -o rx.csv         ( CSV every 0.5 s )
+
+   Linux only ( SO_RXQ_OVFL, SO_RCVBUFFORCE, SO_MEMINFO )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <poll.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+
+#include "rxstats.h"
+
+#define MYPORT "4950"       // Port we listen on
+#define MAXBUFLEN 2048
+#define SEQ_END UINT64_MAX  // END datagram from udp_talker
+
+
+double now_sec( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+// stand-in for real per-datagram work
+void busy_work( double us ) {
+
+    double until = now_sec() + us / 1e6;
+
+    while( now_sec() < until );
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int sockfd;
+    struct addrinfo hints, *servinfo, *p;
+    int rv;
+
+    int rcvbuf = 0;             // -b : bytes, 0 = system default
+    int force = 0;              // -F : SO_RCVBUFFORCE
+    double interval = 1.0;      // -I : seconds between reports
+    const char *csv_path = NULL;// -o
+    double work_us = 0;         // -w : busy work per datagram
+    int idle = 0;               // -i : stop after seconds without traffic, 0 = never
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "b:FI:o:w:i:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'b': rcvbuf = atoi( optarg ); break;
+            case 'F': force = 1; break;
+            case 'I': interval = atof( optarg ); break;
+            case 'o': csv_path = optarg; break;
+            case 'w': work_us = atof( optarg ); break;
+            case 'i': idle = atoi( optarg ); break;
+            default: goto usage;
+        }
+    }
+
+    if( rcvbuf < 0 || interval < 0.01 || work_us < 0 || idle < 0 ) {
+usage:
+        fprintf( stderr, "usage: %s [-b rcvbuf] [-F] [-I interval] [-o file.csv] [-w work-us] [-i idle-seconds]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+
+    /* STEP 1: SETUP HINTS + BIND */
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_INET6;   // force IPv6
+    hints.ai_socktype = SOCK_DGRAM; // UDP
+    hints.ai_flags    = AI_PASSIVE; // bind to my IP
+
+    rv = getaddrinfo( NULL, MYPORT, &hints, &servinfo );
+
+    if( rv != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( rv ) );
+        exit( 1 );
+    }
+
+    for( p = servinfo; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            perror( "listener: socket" );
+            continue;
+        }
+
+        if( bind( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            perror( "listener: bind" );
+            continue;
+        }
+
+        break;  // success
+    }
+
+    if( p == NULL ) {
+        fprintf( stderr, "listener: failed to bind\n" );
+        exit( 2 );
+    }
+
+    freeaddrinfo( servinfo );
+
+
+    /* STEP 2: DROP ACCOUNTING + BUFFER SIZE */
+
+    rx_stats_t st;
+
+    if( rx_setup( sockfd, rcvbuf, force, &st ) == -1 ) {
+        perror( "listener: SO_RXQ_OVFL" );
+        exit( 3 );
+    }
+
+    printf( "listener: port %s, receive buffer %d B", MYPORT, st.rcvbuf );
+
+    if( rcvbuf ) {
+        printf( " ( asked %d%s )", rcvbuf, st.forced ? ", forced" : "" );
+    }
+
+    printf( "\n" );
+
+    // SO_RCVBUF is capped by net.core.rmem_max : say so instead of silently shrinking
+    if( st.capped ) {
+        printf( "listener: capped by net.core.rmem_max, use -F ( CAP_NET_ADMIN ) or raise the sysctl\n" );
+    }
+
+    fflush( stdout );
+
+    FILE *csv = NULL;
+
+    if( csv_path ) {
+
+        csv = fopen( csv_path, "w" );
+
+        if( csv == NULL ) {
+            perror( csv_path );
+            exit( 1 );
+        }
+
+        rx_csv_header( csv );
+    }
+
+
+    /* STEP 3: RECEIVE LOOP */
+
+    char buf[ MAXBUFLEN ];
+    char cbuf[ RX_CMSG_SPACE ];
+
+    uint64_t sent_total = 0, sent_failed = 0;
+    int ended = 0;
+
+    double next_report = now_sec() + interval;
+    double last_packet = now_sec();
+
+    struct pollfd pfd = { sockfd, POLLIN, 0 };
+
+    while( !ended ) {
+
+        double now = now_sec();
+
+        if( now >= next_report ) {
+
+            rx_sample( &st, sockfd );
+            rx_print( &st, stdout );
+
+            if( csv ) {
+                rx_csv( &st, csv );
+            }
+
+            next_report += interval;
+
+            if( next_report < now ) {
+                next_report = now + interval;   // we were stalled : skip, do not burst
+            }
+
+            if( idle && now - last_packet >= idle ) {
+                break;
+            }
+        }
+
+        if( poll( &pfd, 1, ( int ) ( ( next_report - now ) * 1000 ) + 1 ) <= 0 ) {
+            continue;
+        }
+
+        // queue depth now, before we drain it : catches the peak of a burst
+        rx_watch( &st, sockfd );
+
+        // drain what is queued, then look at the clock again
+        for( int i = 0; i < 256; i++ ) {
+
+            struct sockaddr_storage their_addr;
+            struct iovec iov = { buf, sizeof buf };
+            struct msghdr msg = { 0 };
+
+            msg.msg_name = &their_addr;
+            msg.msg_namelen = sizeof their_addr;
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = cbuf;
+            msg.msg_controllen = sizeof cbuf;
+
+            ssize_t n = recvmsg( sockfd, &msg, MSG_DONTWAIT );
+
+            if( n == -1 ) {
+
+                if( errno != EAGAIN ) {
+                    perror( "recvmsg" );
+                }
+
+                break;
+            }
+
+            uint64_t seq = 0;
+
+            if( n >= ( ssize_t ) sizeof seq ) {
+                memcpy( &seq, buf, sizeof seq );
+            }
+
+            // END from udp_talker : everything it sent is already behind us in the queue
+            if( seq == SEQ_END && n >= 3 * ( ssize_t ) sizeof seq ) {
+
+                memcpy( &sent_total, buf + 8, sizeof sent_total );
+                memcpy( &sent_failed, buf + 16, sizeof sent_failed );
+                ended = 1;
+                break;
+            }
+
+            rx_account( &st, &msg, n );
+
+            if( work_us > 0 ) {
+                busy_work( work_us );
+            }
+        }
+
+        last_packet = now_sec();
+    }
+
+
+    /* STEP 4: FINAL REPORT */
+
+    rx_sample( &st, sockfd );
+
+    printf( "\nlistener: %llu datagrams, %llu bytes, peak queue %u B of %d B\n",
+            ( unsigned long long ) st.packets, ( unsigned long long ) st.bytes, st.peak_queued, st.rcvbuf );
+    printf( "listener: socket drops ( receive queue full ) : %llu\n", ( unsigned long long ) st.drops );
+
+    if( ended ) {
+
+        uint64_t missing = sent_total > st.packets ? sent_total - st.packets : 0;
+        uint64_t ours = st.drops < missing ? st.drops : missing;
+        uint64_t sender = sent_failed < missing - ours ? sent_failed : missing - ours;
+        uint64_t network = missing - ours - sender;
+
+        printf( "\n%-28s %12s %8s\n", "talker sent", "datagrams", "%" );
+        printf( "%-28s %12llu %8s\n", "total", ( unsigned long long ) sent_total, "" );
+        printf( "%-28s %12llu %7.2f%%\n", "received", ( unsigned long long ) st.packets,
+                sent_total ? 100.0 * st.packets / sent_total : 0.0 );
+        printf( "%-28s %12llu %7.2f%%\n", "dropped by this socket", ( unsigned long long ) ours,
+                sent_total ? 100.0 * ours / sent_total : 0.0 );
+        printf( "%-28s %12llu %7.2f%%\n", "failed in the sender", ( unsigned long long ) sender,
+                sent_total ? 100.0 * sender / sent_total : 0.0 );
+        printf( "%-28s %12llu %7.2f%%\n", "lost in the network", ( unsigned long long ) network,
+                sent_total ? 100.0 * network / sent_total : 0.0 );
+    }
+
+
+    /* STEP 5: CLEANUP */
+
+    if( csv ) {
+        fclose( csv );
+    }
+
+    close( sockfd );
+
+    return 0;
+}
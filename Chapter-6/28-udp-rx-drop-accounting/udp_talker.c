@@ -0,0 +1,189 @@
+/*
+   udp_talker.c
+
+   Sequence-numbered UDP sender for udp_listener.c
+
+   Every datagram starts with a 64-bit sequence number, so the listener
+   knows how many were sent and how many never arrived.
+   When done, an END datagram carrying the total and the sends that
+   failed locally is sent 3 times.
+
+   Traffic shape:
+    -r pps     average rate ( 0 = as fast as possible )
+    -B burst   datagrams sent back to back, then a pause :
+               same average rate, much harder on the receive queue
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 udp_talker.c -o udp_talker
+
+   Run:
+    ./udp_talker localhost                         ( 100000 x 200 B, unpaced )
+    ./udp_talker localhost -r 50000 -B 500 -n 500000
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+
+#define SERVERPORT "4950"
+#define MAXSIZE 1472
+#define SEQ_END UINT64_MAX      // END datagram : seq field, then total and failed
+
+
+uint64_t now_ns( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+void sleep_until( uint64_t t ) {
+
+    struct timespec ts = { ( time_t ) ( t / 1000000000ull ), ( long ) ( t % 1000000000ull ) };
+
+    while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL ) == EINTR );
+}
+
+
+int main( int argc, char *argv[] ) {
+
+    int sockfd;
+    struct addrinfo hints, *servinfo, *p;
+    int rv;
+
+    long total = 100000;    // -n
+    long rate = 0;          // -r : datagrams per second, 0 = unpaced
+    long burst = 1;         // -B
+    int size = 200;         // -s : payload bytes
+    int opt;
+
+
+    /* STEP 0: ARGS */
+
+    if( argc < 2 ) {
+        goto usage;
+    }
+
+    const char *host = argv[ 1 ];
+    optind = 2;
+
+    while( ( opt = getopt( argc, argv, "n:r:B:s:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'n': total = atol( optarg ); break;
+            case 'r': rate = atol( optarg ); break;
+            case 'B': burst = atol( optarg ); break;
+            case 's': size = atoi( optarg ); break;
+            default: goto usage;
+        }
+    }
+
+    if( total < 1 || rate < 0 || burst < 1 || size < 16 || size > MAXSIZE ) {
+usage:
+        fprintf( stderr, "usage: %s host [-n count] [-r pps] [-B burst] [-s size 16..%d]\n", argv[ 0 ], MAXSIZE );
+        exit( 1 );
+    }
+
+
+    /* STEP 1: RESOLVE + SOCKET */
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_INET6;   // force IPv6, like udp_listener
+    hints.ai_socktype = SOCK_DGRAM; // UDP
+
+    rv = getaddrinfo( host, SERVERPORT, &hints, &servinfo );
+
+    if( rv != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( rv ) );
+        exit( 2 );
+    }
+
+    for( p = servinfo; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            perror( "talker: socket" );
+            continue;
+        }
+
+        // connected : the kernel resolves the route once, not per datagram
+        if( connect( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            perror( "talker: connect" );
+            continue;
+        }
+
+        break;
+    }
+
+    if( p == NULL ) {
+        fprintf( stderr, "talker: failed to create socket\n" );
+        exit( 2 );
+    }
+
+    freeaddrinfo( servinfo );
+
+
+    /* STEP 2: SEND */
+
+    char buf[ MAXSIZE ];
+    memset( buf, 'x', sizeof buf );
+
+    // one burst every burst / rate seconds, on an absolute schedule
+    uint64_t gap = rate ? 1000000000ull * burst / rate : 0;
+    uint64_t start = now_ns(), next = start;
+    long sent = 0, failed = 0;
+
+    for( uint64_t seq = 0; seq < ( uint64_t ) total; seq++ ) {
+
+        if( gap && seq % burst == 0 ) {
+            sleep_until( next );
+            next += gap;
+        }
+
+        memcpy( buf, &seq, sizeof seq );
+
+        if( send( sockfd, buf, size, 0 ) == -1 ) {
+            failed++;      // e.g. ECONNREFUSED : nobody listening yet
+            continue;
+        }
+
+        sent++;
+    }
+
+    double secs = ( now_ns() - start ) / 1e9;
+
+
+    /* STEP 3: END MARKER */
+
+    // after a pause, so it does not join a full queue
+    usleep( 200000 );
+
+    uint64_t end[ 3 ] = { SEQ_END, ( uint64_t ) total, ( uint64_t ) failed };
+
+    for( int i = 0; i < 3; i++ ) {
+        send( sockfd, end, sizeof end, 0 );
+    }
+
+    printf( "talker: %ld datagrams of %d B in %.2f s ( %.0f pkt/s ), %ld send errors\n",
+            sent, size, secs, secs > 0 ? sent / secs : 0.0, failed );
+
+    close( sockfd );
+
+    return 0;
+}
@@ -0,0 +1,226 @@
+/*
+   ring_reader.c
+
+   Offline reader for ring files written by udp_listener
+
+   No parsing : the file is mapped read-only and the reader hops from
+   fixed record header to fixed record header ( ringlog.c : rl_read ).
+
+   Default : a summary of the whole ring and how fast it was scanned
+   -d      : one line per record ( time, sender, size, first payload bytes )
+   -n N    : with -d, only the first N records
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 ring_reader.c ringlog.c -o ring_reader
+
+   Run:
+    ./ring_reader capture.ring
+    ./ring_reader capture.ring -d -n 20
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "ringlog.h"
+
+#define PREVIEW 16      // payload bytes shown per record with -d
+
+
+double now_sec( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+// "2026-10-18 14:05:01.123456789"
+char *fmt_time( uint64_t ns, char *out, size_t len ) {
+
+    time_t sec = ns / 1000000000ull;
+    struct tm tm;
+    char base[ 32 ];
+
+    localtime_r( &sec, &tm );
+    strftime( base, sizeof base, "%Y-%m-%d %H:%M:%S", &tm );
+    snprintf( out, len, "%s.%09llu", base, ( unsigned long long ) ( ns % 1000000000ull ) );
+
+    return out;
+}
+
+
+// "[::1]:5555" or "127.0.0.1:5555"
+char *fmt_sender( const rl_rec_t *r, char *out, size_t len ) {
+
+    char ip[ INET6_ADDRSTRLEN ];
+
+    if( r -> family == AF_INET6 ) {
+        inet_ntop( AF_INET6, r -> addr, ip, sizeof ip );
+        snprintf( out, len, "[%s]:%u", ip, ntohs( r -> port ) );
+    } else {
+        inet_ntop( AF_INET, r -> addr, ip, sizeof ip );
+        snprintf( out, len, "%s:%u", ip, ntohs( r -> port ) );
+    }
+
+    return out;
+}
+
+
+void dump( const rl_rec_t *r ) {
+
+    char t[ 48 ], who[ 64 ];
+
+    printf( "%10llu  %s  %-28s %6u B%s  |",
+            ( unsigned long long ) r -> seq, fmt_time( r -> ts_ns, t, sizeof t ),
+            fmt_sender( r, who, sizeof who ), r -> origlen, r -> flags & RL_TRUNCATED ? "*" : " " );
+
+    const uint8_t *pl = rl_payload( r );
+
+    for( int i = 0; i < PREVIEW && i < r -> caplen; i++ ) {
+        printf( " %02x", pl[ i ] );
+    }
+
+    printf( "\n" );
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int show = 0;           // -d
+    long limit = -1;        // -n
+    int opt;
+
+    if( argc < 2 ) {
+        goto usage;
+    }
+
+    const char *path = argv[ 1 ];
+    optind = 2;
+
+    while( ( opt = getopt( argc, argv, "dn:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'd': show = 1; break;
+            case 'n': limit = atol( optarg ); break;
+            default:
+usage:
+                fprintf( stderr, "usage: %s file.ring [-d] [-n records]\n", argv[ 0 ] );
+                exit( 1 );
+        }
+    }
+
+    ringlog_t rl;
+
+    if( rl_open_read( &rl, path ) == -1 ) {
+        perror( path );
+        exit( 1 );
+    }
+
+    rl_header_t *h = rl.hdr;
+
+
+    /* ---------- SCAN ---------- */
+
+    uint64_t records = 0, bytes = 0, truncated = 0, v4 = 0, v6 = 0;
+    uint64_t first_ts = 0, last_ts = 0, max_gap = 0, out_of_order = 0;
+    uint64_t first_seq = 0, last_seq = 0, seq_gaps = 0;
+
+    uint64_t pos = rl_begin( &rl );
+    rl_rec_t *r;
+
+    double t0 = now_sec();
+
+    while( ( r = rl_read( &rl, &pos ) ) != NULL ) {
+
+        if( records == 0 ) {
+            first_ts = r -> ts_ns;
+            first_seq = r -> seq;
+        } else {
+
+            if( r -> ts_ns >= last_ts ) {
+                if( r -> ts_ns - last_ts > max_gap ) {
+                    max_gap = r -> ts_ns - last_ts;
+                }
+            } else {
+                out_of_order++;
+            }
+
+            if( r -> seq != last_seq + 1 ) {
+                seq_gaps++;
+            }
+        }
+
+        last_ts = r -> ts_ns;
+        last_seq = r -> seq;
+
+        records++;
+        bytes += r -> origlen;
+        truncated += ( r -> flags & RL_TRUNCATED ) != 0;
+
+        if( r -> family == AF_INET6 ) {
+            v6++;
+        } else {
+            v4++;
+        }
+
+        if( show && ( limit < 0 || ( long ) records <= limit ) ) {
+            dump( r );
+        }
+    }
+
+    double scan = now_sec() - t0;
+
+    // stopped before head : a record header did not make sense
+    int corrupt = pos < h -> head;
+
+
+    /* ---------- SUMMARY ---------- */
+
+    char t[ 48 ];
+    double span = records > 1 ? ( last_ts - first_ts ) / 1e9 : 0;
+
+    if( show ) {
+        printf( "\n" );
+    }
+
+    printf( "ring      : %s, %.1f MiB data, %.1f MiB used\n",
+            path, h -> capacity / 1048576.0, ( h -> head - h -> tail ) / 1048576.0 );
+    printf( "written   : %llu records, %llu overwritten by newer ones\n",
+            ( unsigned long long ) h -> records, ( unsigned long long ) h -> dropped );
+    printf( "in ring   : %llu records ( seq %llu .. %llu ), %llu payload bytes, %llu truncated\n",
+            ( unsigned long long ) records, ( unsigned long long ) first_seq, ( unsigned long long ) last_seq,
+            ( unsigned long long ) bytes, ( unsigned long long ) truncated );
+    printf( "families  : %llu AF_INET, %llu AF_INET6 records\n", ( unsigned long long ) v4, ( unsigned long long ) v6 );
+
+    if( records ) {
+        printf( "first     : %s\n", fmt_time( first_ts, t, sizeof t ) );
+        printf( "last      : %s\n", fmt_time( last_ts, t, sizeof t ) );
+        printf( "span      : %.3f s, %.0f datagrams/s, largest gap %.3f ms, %llu timestamps out of order\n",
+                span, span > 0 ? records / span : 0.0, max_gap / 1e6, ( unsigned long long ) out_of_order );
+    }
+
+    printf( "scan      : %.3f s, %.1f M records/s%s\n",
+            scan, scan > 0 ? records / scan / 1e6 : 0.0, corrupt ? "  ( stopped at a corrupt record )" : "" );
+
+    if( seq_gaps ) {
+        printf( "warning   : %llu gaps in record numbers\n", ( unsigned long long ) seq_gaps );
+    }
+
+    rl_close( &rl );
+
+    return corrupt ? 2 : 0;
+}
@@ -0,0 +1,332 @@
+/*
+    ringlog.c
+
+    Append-only ring log in a memory-mapped file ( see ringlog.h )
+
+    Compile together with the program that uses it:
+        gcc -Wall -Wextra -pedantic -O2 ringlog.c your_program.c -o your_program
+*/
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+
+#include "ringlog.h"
+
+
+static uint32_t rec_size( uint32_t caplen ) {
+
+    return ( sizeof( rl_rec_t ) + caplen + RL_ALIGN - 1 ) & ~( uint32_t ) ( RL_ALIGN - 1 );
+}
+
+
+static int map_file( ringlog_t *rl, size_t size, int prot ) {
+
+    int flags = MAP_SHARED;
+
+    // writer : fault every page in now, not in the middle of the receive loop
+    if( prot & PROT_WRITE ) {
+        flags |= MAP_POPULATE;
+    }
+
+    void *m = mmap( NULL, size, prot, flags, rl -> fd, 0 );
+
+    if( m == MAP_FAILED ) {
+        return -1;
+    }
+
+    rl -> hdr = m;
+    rl -> data = ( uint8_t * ) m + RL_HEADER_SIZE;
+    rl -> map_size = size;
+
+    return 0;
+}
+
+
+
+/* ================= OPEN ================= */
+
+int rl_open( ringlog_t *rl, const char *path, uint64_t capacity, int append ) {
+
+    memset( rl, 0, sizeof *rl );
+
+    // whole pages, so the data area ends exactly at the end of the mapping
+    capacity = ( capacity + 4095 ) & ~4095ull;
+
+    if( capacity < ( 1 << 20 ) ) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    rl -> fd = open( path, O_RDWR | O_CREAT | ( append ? 0 : O_TRUNC ), 0644 );
+
+    if( rl -> fd == -1 ) {
+        return -1;
+    }
+
+    struct stat sb;
+
+    if( fstat( rl -> fd, &sb ) == -1 ) {
+
+        int err = errno;
+        close( rl -> fd );
+        errno = err;
+        return -1;
+    }
+
+    // append to a ring of the same size : keep head, tail and seq
+    if( append && sb.st_size > 0 ) {
+
+        rl_header_t h;
+
+        if( pread( rl -> fd, &h, sizeof h, 0 ) != sizeof h || h.magic != RL_MAGIC
+            || ( uint64_t ) sb.st_size != RL_HEADER_SIZE + h.capacity ) {
+
+            close( rl -> fd );
+            errno = EINVAL;
+            return -1;
+        }
+
+        capacity = h.capacity;
+
+    } else {
+
+        // reserve the blocks now : no allocation, no ENOSPC while capturing
+        int err = posix_fallocate( rl -> fd, 0, RL_HEADER_SIZE + capacity );
+
+        if( err ) {
+            close( rl -> fd );
+            errno = err;
+            return -1;
+        }
+    }
+
+    if( map_file( rl, RL_HEADER_SIZE + capacity, PROT_READ | PROT_WRITE ) == -1 ) {
+
+        int err = errno;
+        close( rl -> fd );
+        errno = err;
+        return -1;
+    }
+
+    rl -> writable = 1;
+
+    if( rl -> hdr -> magic != RL_MAGIC ) {
+
+        struct timespec now;
+        clock_gettime( CLOCK_REALTIME, &now );
+
+        memset( rl -> hdr, 0, sizeof *rl -> hdr );
+        rl -> hdr -> capacity = capacity;
+        rl -> hdr -> created_ns = ( uint64_t ) now.tv_sec * 1000000000ull + now.tv_nsec;
+
+        // magic last : a header without it is not a ring yet
+        __atomic_store_n( &rl -> hdr -> magic, RL_MAGIC, __ATOMIC_RELEASE );
+    }
+
+    return 0;
+}
+
+
+int rl_open_read( ringlog_t *rl, const char *path ) {
+
+    memset( rl, 0, sizeof *rl );
+
+    rl -> fd = open( path, O_RDONLY );
+
+    if( rl -> fd == -1 ) {
+        return -1;
+    }
+
+    struct stat sb;
+    rl_header_t h;
+
+    if( fstat( rl -> fd, &sb ) == -1 || pread( rl -> fd, &h, sizeof h, 0 ) != sizeof h
+        || h.magic != RL_MAGIC || ( uint64_t ) sb.st_size != RL_HEADER_SIZE + h.capacity ) {
+
+        close( rl -> fd );
+        errno = EINVAL;
+        return -1;
+    }
+
+    if( map_file( rl, sb.st_size, PROT_READ ) == -1 ) {
+
+        int err = errno;
+        close( rl -> fd );
+        errno = err;
+        return -1;
+    }
+
+    // the reader walks the file front to back
+    madvise( rl -> hdr, rl -> map_size, MADV_SEQUENTIAL );
+
+    return 0;
+}
+
+
+
+/* ================= APPEND ================= */
+
+void rl_append( ringlog_t *rl, const struct sockaddr *from, const struct timespec *ts,
+                const void *payload, uint32_t caplen, uint32_t len ) {
+
+    rl_header_t *h = rl -> hdr;
+    uint64_t cap = h -> capacity;
+
+    if( caplen > len ) {
+        caplen = len;
+    }
+
+    if( caplen > 65535 ) {
+        caplen = 65535;
+    }
+
+    uint32_t need = rec_size( caplen );
+    uint64_t head = h -> head;
+    uint64_t off = head % cap;
+
+    // a record never wraps : pad to the end of the data area first
+    uint64_t pad = cap - off < need ? cap - off : 0;
+
+
+    /* ---------- MAKE ROOM : drop the oldest records ---------- */
+
+    uint64_t tail = h -> tail;
+
+    while( head + pad + need - tail > cap ) {
+
+        rl_rec_t *old = ( rl_rec_t * ) ( rl -> data + tail % cap );
+
+        if( !( old -> flags & RL_PAD ) ) {
+            h -> dropped++;
+        }
+
+        tail += old -> size;
+    }
+
+    __atomic_store_n( &h -> tail, tail, __ATOMIC_RELEASE );
+
+
+    /* ---------- PAD ---------- */
+
+    if( pad ) {
+
+        // only the first 8 bytes : size + flags are all a reader looks at
+        rl_rec_t *r = ( rl_rec_t * ) ( rl -> data + off );
+
+        r -> size = ( uint32_t ) pad;
+        r -> caplen = 0;
+        r -> family = 0;
+        r -> flags = RL_PAD;
+
+        head += pad;
+        off = 0;
+    }
+
+
+    /* ---------- RECORD ---------- */
+
+    rl_rec_t *r = ( rl_rec_t * ) ( rl -> data + off );
+
+    r -> size = need;
+    r -> caplen = ( uint16_t ) caplen;
+    r -> family = ( uint8_t ) from -> sa_family;
+    r -> flags = caplen < len ? RL_TRUNCATED : 0;
+    r -> origlen = len;
+    r -> reserved = 0;
+    r -> seq = h -> records;
+    r -> ts_ns = ( uint64_t ) ts -> tv_sec * 1000000000ull + ts -> tv_nsec;
+
+    memset( r -> addr, 0, sizeof r -> addr );
+
+    if( from -> sa_family == AF_INET6 ) {
+
+        const struct sockaddr_in6 *s6 = ( const struct sockaddr_in6 * ) from;
+        memcpy( r -> addr, &s6 -> sin6_addr, 16 );
+        r -> port = s6 -> sin6_port;
+
+    } else {
+
+        const struct sockaddr_in *s4 = ( const struct sockaddr_in * ) from;
+        memcpy( r -> addr, &s4 -> sin_addr, 4 );
+        r -> port = s4 -> sin_port;
+    }
+
+    memcpy( r + 1, payload, caplen );
+
+    h -> records++;
+
+    // publish : the record is complete before head moves past it
+    __atomic_store_n( &h -> head, head + need, __ATOMIC_RELEASE );
+}
+
+
+
+/* ================= READ ================= */
+
+uint64_t rl_begin( const ringlog_t *rl ) {
+
+    return __atomic_load_n( &rl -> hdr -> tail, __ATOMIC_ACQUIRE );
+}
+
+
+rl_rec_t *rl_read( const ringlog_t *rl, uint64_t *pos ) {
+
+    uint64_t cap = rl -> hdr -> capacity;
+    uint64_t head = __atomic_load_n( &rl -> hdr -> head, __ATOMIC_ACQUIRE );
+
+    while( *pos < head ) {
+
+        uint64_t off = *pos % cap;
+        rl_rec_t *r = ( rl_rec_t * ) ( rl -> data + off );
+
+        // sanity : aligned, not past the end of the data area
+        if( r -> size < RL_ALIGN || r -> size % RL_ALIGN || r -> size > cap - off ) {
+            return NULL;
+        }
+
+        *pos += r -> size;
+
+        if( r -> flags & RL_PAD ) {
+            continue;
+        }
+
+        if( r -> size < rec_size( r -> caplen ) ) {
+            return NULL;
+        }
+
+        return r;
+    }
+
+    return NULL;
+}
+
+
+
+/* ================= CLOSE ================= */
+
+void rl_close( ringlog_t *rl ) {
+
+    if( rl -> hdr ) {
+
+        // the only blocking call : once, at the end
+        if( rl -> writable ) {
+            msync( rl -> hdr, rl -> map_size, MS_SYNC );
+        }
+
+        munmap( rl -> hdr, rl -> map_size );
+    }
+
+    if( rl -> fd >= 0 ) {
+        close( rl -> fd );
+    }
+
+    memset( rl, 0, sizeof *rl );
+    rl -> fd = -1;
+}
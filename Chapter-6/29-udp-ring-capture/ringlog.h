@@ -0,0 +1,125 @@
+/*
+    ringlog.h
+
+    Append-only ring log of received datagrams, in a memory-mapped file
+
+    File layout:
+
+        ┌──────────────────────┬──────────────────────────────────────────┐
+        │ header ( 4096 B )    │ data area ( capacity bytes, a ring )     │
+        │ magic, capacity,     │ [ rec | payload ][ rec | payload ] ...   │
+        │ head, tail, records  │                                          │
+        └──────────────────────┴──────────────────────────────────────────┘
+
+    - every record = fixed 48-byte header + payload, padded to 8 bytes,
+      so a reader jumps from record to record with one addition
+    - head / tail are byte counters that only grow : position in the
+      data area = counter % capacity
+    - when the ring is full the oldest records are dropped ( tail moves )
+    - a record never wraps : if it does not fit before the end of the
+      data area, a PAD record fills the gap and writing restarts at 0
+    - head is stored last ( release ) : a crash mid-record leaves the
+      half-written record outside the log
+
+    Writing is a memcpy into mapped, preallocated pages : no write(),
+    no fsync(), nothing that can block the receive loop. The kernel
+    writes dirty pages back on its own; rl_close() flushes the rest.
+
+    Usage ( writer ):
+        ringlog_t rl;
+        rl_open( &rl, "capture.ring", 64 << 20, 0 );
+        rl_append( &rl, ( struct sockaddr * ) &from, &ts, buf, n, n );
+        rl_close( &rl );
+
+    Usage ( reader ):
+        rl_open_read( &rl, "capture.ring" );
+        uint64_t pos = rl_begin( &rl );
+        rl_rec_t *r;
+        while( ( r = rl_read( &rl, &pos ) ) ) ...
+*/
+
+#ifndef RINGLOG_H
+#define RINGLOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <sys/socket.h>
+
+#define RL_MAGIC       0x31474e4952504455ull     // "UDPRING1"
+#define RL_HEADER_SIZE 4096
+#define RL_ALIGN       8
+
+// record flags
+#define RL_PAD         0x01     // filler up to the end of the data area, skip it
+#define RL_TRUNCATED   0x02     // payload longer than caplen, only caplen stored
+
+
+// file header : first page of the file
+typedef struct {
+
+    uint64_t magic;
+    uint64_t capacity;          // bytes in the data area
+    uint64_t head;              // bytes ever written ( next record goes here )
+    uint64_t tail;              // oldest record still in the ring
+    uint64_t records;           // records ever written ( = next seq )
+    uint64_t dropped;           // records overwritten by newer ones
+    uint64_t created_ns;        // CLOCK_REALTIME at creation
+
+} rl_header_t;
+
+// one record header : 48 bytes, followed by caplen payload bytes
+typedef struct {
+
+    uint32_t size;              // whole record, header + payload + padding
+    uint16_t caplen;            // payload bytes stored
+    uint8_t  family;            // AF_INET / AF_INET6
+    uint8_t  flags;             // RL_PAD, RL_TRUNCATED
+    uint32_t origlen;           // datagram size on the wire
+    uint16_t port;              // sender port, network byte order
+    uint16_t reserved;
+    uint64_t seq;               // record number, counts from 0
+    uint64_t ts_ns;             // kernel receive time ( SO_TIMESTAMPNS ), Unix ns
+    uint8_t  addr[ 16 ];        // sender : IPv6, or IPv4 in the first 4 bytes
+
+} rl_rec_t;
+
+typedef struct {
+
+    int fd;
+    int writable;
+    rl_header_t *hdr;
+    uint8_t *data;              // data area
+    size_t map_size;
+
+} ringlog_t;
+
+
+// create ( or with append = 1 reopen ) a ring of 'capacity' data bytes
+// returns 0, or -1 with errno set
+int rl_open( ringlog_t *rl, const char *path, uint64_t capacity, int append );
+
+// map an existing ring read-only, returns 0 or -1 ( errno = EINVAL : not a ring )
+int rl_open_read( ringlog_t *rl, const char *path );
+
+// add one datagram, overwriting the oldest records if needed
+// caplen : how much of the payload to keep ( <= len )
+void rl_append( ringlog_t *rl, const struct sockaddr *from, const struct timespec *ts,
+                const void *payload, uint32_t caplen, uint32_t len );
+
+// position of the oldest record
+uint64_t rl_begin( const ringlog_t *rl );
+
+// record at *pos and move *pos past it ( PAD records skipped ),
+// NULL at the end of the log or on a corrupt record
+rl_rec_t *rl_read( const ringlog_t *rl, uint64_t *pos );
+
+// payload bytes that follow a record header
+static inline const uint8_t *rl_payload( const rl_rec_t *r ) {
+    return ( const uint8_t * ) ( r + 1 );
+}
+
+// flush dirty pages ( writer ) and unmap
+void rl_close( ringlog_t *rl );
+
+#endif
@@ -0,0 +1,291 @@
+/*
+   udp_listener.c
+
+   Continuous UDP capture into a memory-mapped ring log
+   ( 09-unconnected-UDP-socket/udp_listener.c, long-running )
+
+   For every datagram the ring gets :
+    - the kernel receive timestamp ( SO_TIMESTAMPNS, taken when the
+      packet reached the socket, not when we got around to reading it )
+    - the sender address and port
+    - the payload, up to -c bytes
+
+   Receive loop:
+    recvmmsg() a batch -> memcpy each datagram into the mapped file
+    No write(), no fsync() : the loop never waits for the disk
+
+   Ctrl+C stops the capture and flushes the file.
+   Read it back with ring_reader.
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 udp_listener.c ringlog.c -o udp_listener
+
+   Run:
+    ./udp_listener                          ( capture.ring, 64 MiB, port 4950 )
+    ./udp_listener -o tlm.ring -m 1024 -c 256 -v
+    ./udp_listener -o tlm.ring -a           ( keep appending to an existing ring )
+
+   Linux only ( recvmmsg, SO_TIMESTAMPNS )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+
+#include "ringlog.h"
+
+#define MYPORT "4950"       // Port we listen on
+#define BATCH 64            // datagrams per recvmmsg()
+#define MAXDGRAM 65536
+#define RCVBUF ( 8 << 20 )  // absorbs bursts while we copy
+
+
+volatile sig_atomic_t stop = 0;
+
+
+void on_signal( int sig ) {
+
+    ( void ) sig;
+    stop = 1;
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int sockfd;
+    struct addrinfo hints, *servinfo, *p;
+    int rv;
+
+    const char *path = "capture.ring";  // -o
+    long mib = 64;                      // -m : data area size
+    int caplen = 2048;                  // -c : payload bytes kept per datagram
+    int append = 0;                     // -a
+    const char *port = MYPORT;          // -p
+    int verbose = 0;                    // -v : rate every second
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "o:m:c:ap:v" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'o': path = optarg; break;
+            case 'm': mib = atol( optarg ); break;
+            case 'c': caplen = atoi( optarg ); break;
+            case 'a': append = 1; break;
+            case 'p': port = optarg; break;
+            case 'v': verbose = 1; break;
+            default: goto usage;
+        }
+    }
+
+    if( mib < 1 || caplen < 0 || caplen > 65535 ) {
+usage:
+        fprintf( stderr, "usage: %s [-o file] [-m MiB] [-c caplen] [-a] [-p port] [-v]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+
+    /* STEP 1: RING FILE */
+
+    ringlog_t rl;
+
+    if( rl_open( &rl, path, ( uint64_t ) mib << 20, append ) == -1 ) {
+        perror( path );
+        exit( 1 );
+    }
+
+
+    /* STEP 2: SETUP HINTS + BIND */
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_INET6;   // force IPv6 ( IPv4 arrives as ::ffff:a.b.c.d )
+    hints.ai_socktype = SOCK_DGRAM; // UDP
+    hints.ai_flags    = AI_PASSIVE; // bind to my IP
+
+    rv = getaddrinfo( NULL, port, &hints, &servinfo );
+
+    if( rv != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( rv ) );
+        exit( 1 );
+    }
+
+    for( p = servinfo; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            perror( "listener: socket" );
+            continue;
+        }
+
+        if( bind( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            perror( "listener: bind" );
+            continue;
+        }
+
+        break;  // success
+    }
+
+    if( p == NULL ) {
+        fprintf( stderr, "listener: failed to bind\n" );
+        exit( 2 );
+    }
+
+    freeaddrinfo( servinfo );
+
+    int one = 1, rcvbuf = RCVBUF;
+
+    // kernel receive time in a cmsg on every datagram
+    if( setsockopt( sockfd, SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof one ) == -1 ) {
+        perror( "listener: SO_TIMESTAMPNS" );
+        exit( 3 );
+    }
+
+    setsockopt( sockfd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof rcvbuf );
+
+    // a timeout so Ctrl+C is noticed even when the socket is idle
+    struct timeval tv = { 1, 0 };
+    setsockopt( sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv );
+
+    struct sigaction sa;
+    memset( &sa, 0, sizeof sa );
+    sa.sa_handler = on_signal;
+    sigaction( SIGINT, &sa, NULL );
+    sigaction( SIGTERM, &sa, NULL );
+
+
+    /* STEP 3: PREALLOCATED BATCH */
+
+    // only caplen bytes are kept, but the full length is needed for origlen :
+    // MSG_TRUNC makes msg_len the real size even when the buffer is smaller
+    size_t slot = caplen > 0 ? ( size_t ) caplen : 1;
+
+    struct mmsghdr msgs[ BATCH ];
+    struct iovec iov[ BATCH ];
+    struct sockaddr_storage addrs[ BATCH ];
+    char ctrl[ BATCH ][ CMSG_SPACE( sizeof( struct timespec ) ) ];
+    char *bufs = malloc( BATCH * slot );
+
+    if( bufs == NULL ) {
+        perror( "malloc" );
+        exit( 1 );
+    }
+
+    memset( msgs, 0, sizeof msgs );
+
+    for( int i = 0; i < BATCH; i++ ) {
+
+        iov[ i ].iov_base = bufs + i * slot;
+        iov[ i ].iov_len = slot;
+
+        msgs[ i ].msg_hdr.msg_iov = &iov[ i ];
+        msgs[ i ].msg_hdr.msg_iovlen = 1;
+        msgs[ i ].msg_hdr.msg_name = &addrs[ i ];
+    }
+
+    printf( "listener: capturing port %s into %s ( %ld MiB ring, %d B per datagram%s, %llu records so far )\n",
+            port, path, mib, caplen, append ? ", append" : "", ( unsigned long long ) rl.hdr -> records );
+    fflush( stdout );
+
+
+    /* STEP 4: CAPTURE LOOP */
+
+    unsigned long long captured = 0, last_captured = 0, no_ts = 0;
+    time_t last = time( NULL );
+
+    while( !stop ) {
+
+        for( int i = 0; i < BATCH; i++ ) {
+            msgs[ i ].msg_hdr.msg_namelen = sizeof addrs[ i ];
+            msgs[ i ].msg_hdr.msg_control = ctrl[ i ];
+            msgs[ i ].msg_hdr.msg_controllen = sizeof ctrl[ i ];
+        }
+
+        // MSG_WAITFORONE : block for the first datagram, then take what is queued
+        int n = recvmmsg( sockfd, msgs, BATCH, MSG_WAITFORONE | MSG_TRUNC, NULL );
+
+        if( n == -1 ) {
+
+            if( errno != EAGAIN && errno != EINTR ) {
+                perror( "recvmmsg" );
+            }
+
+            n = 0;
+        }
+
+        for( int i = 0; i < n; i++ ) {
+
+            struct msghdr *mh = &msgs[ i ].msg_hdr;
+            struct timespec ts = { 0, 0 };
+
+            for( struct cmsghdr *cm = CMSG_FIRSTHDR( mh ); cm; cm = CMSG_NXTHDR( mh, cm ) ) {
+
+                if( cm -> cmsg_level == SOL_SOCKET && cm -> cmsg_type == SCM_TIMESTAMPNS ) {
+                    memcpy( &ts, CMSG_DATA( cm ), sizeof ts );
+                }
+            }
+
+            // no cmsg ( should not happen ) : our own clock, later than the truth
+            if( ts.tv_sec == 0 ) {
+                clock_gettime( CLOCK_REALTIME, &ts );
+                no_ts++;
+            }
+
+            uint32_t len = msgs[ i ].msg_len;
+
+            rl_append( &rl, ( struct sockaddr * ) &addrs[ i ], &ts, iov[ i ].iov_base,
+                       len < ( uint32_t ) caplen ? len : ( uint32_t ) caplen, len );
+        }
+
+        captured += n;
+
+        if( !verbose ) {
+            continue;
+        }
+
+        time_t now = time( NULL );
+
+        if( now != last ) {
+
+            printf( "%llu dgram/s | %llu records in ring file | %llu overwritten\n",
+                    ( captured - last_captured ) / ( now - last ),
+                    ( unsigned long long ) rl.hdr -> records, ( unsigned long long ) rl.hdr -> dropped );
+            fflush( stdout );
+
+            last_captured = captured;
+            last = now;
+        }
+    }
+
+
+    /* STEP 5: CLEANUP */
+
+    printf( "\nlistener: %llu datagrams captured, %llu records in %s ( %llu overwritten )\n",
+            captured, ( unsigned long long ) rl.hdr -> records, path, ( unsigned long long ) rl.hdr -> dropped );
+
+    if( no_ts ) {
+        printf( "listener: %llu datagrams without a kernel timestamp\n", no_ts );
+    }
+
+    rl_close( &rl );
+    close( sockfd );
+    free( bufs );
+
+    return 0;
+}
@@ -0,0 +1,758 @@
+/*
+   udp_talker.c
+
+   Rate-paced bulk UDP sender
+   ( 09-unconnected-UDP-socket/udp_talker.c, streaming instead of one message )
+
+   Messages:
+    -f file   one datagram per line of the file, repeated in a loop
+    default   generator : [ seq | send time | filler ] of -s bytes
+
+   Rate:
+    -r pps    packets per second
+    -R bps    bits per second on the wire ( IP + UDP headers included ),
+              suffix K / M / G allowed : -R 200M
+
+   Pacing, best first ( -m auto picks from the egress qdisc ):
+    fq      SO_MAX_PACING_RATE : the fq qdisc releases packets on time,
+            we just write as fast as the socket accepts
+    txtime  SO_TXTIME : every packet carries its departure time, the qdisc
+            ( etf, or fq ) holds it until then
+    bucket  user-space token bucket : sleep, then spin the last few us
+
+   Report:
+    target vs achieved rate, and the gaps between departures. Departure
+    times come from SO_TIMESTAMPING ( software TX timestamp, taken when
+    the packet leaves the qdisc ) : send() returning says nothing when the
+    kernel does the pacing. Without them, send() times are used.
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 udp_talker.c -o udp_talker -lm
+
+   Run:
+    ./udp_talker localhost                            ( 10000 pkt/s, 100000 x 1000 B )
+    ./udp_talker localhost -R 100M -d 5
+    ./udp_talker 192.0.2.7 -f lines.txt -r 500 -m bucket -b 4
+
+   Linux only ( SO_MAX_PACING_RATE, SO_TXTIME, SO_TIMESTAMPING, rtnetlink )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <net/if.h>
+#include <ifaddrs.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/pkt_sched.h>
+
+#define SERVERPORT "4950"
+#define MAXSIZE 1472                // one Ethernet frame of IPv4 payload
+#define SPIN_NS 60000               // bucket : spin instead of sleeping this close
+#define TXTIME_LEAD_NS 2000000      // txtime : stay at most 2 ms ahead of the schedule
+#define DRAIN_EVERY 16              // read TX timestamps every N packets
+
+enum { MODE_AUTO, MODE_FQ, MODE_TXTIME, MODE_BUCKET };
+
+const char *mode_name[] = { "auto", "fq", "txtime", "bucket" };
+
+
+// growable array of nanosecond values
+typedef struct {
+
+    long long *v;
+    long n, cap;
+
+} samples_t;
+
+// messages to send, cycled through
+typedef struct {
+
+    char **data;
+    size_t *len;
+    long n;
+
+} messages_t;
+
+
+
+/* ================= HELPERS ================= */
+
+uint64_t now_ns( clockid_t clk ) {
+
+    struct timespec ts;
+    clock_gettime( clk, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+void sleep_until( clockid_t clk, uint64_t t ) {
+
+    struct timespec ts = { ( time_t ) ( t / 1000000000ull ), ( long ) ( t % 1000000000ull ) };
+
+    while( clock_nanosleep( clk, TIMER_ABSTIME, &ts, NULL ) == EINTR );
+}
+
+
+void samples_set( samples_t *s, long i, long long x ) {
+
+    while( i >= s -> cap ) {
+
+        long old = s -> cap;
+
+        s -> cap = s -> cap ? s -> cap * 2 : 65536;
+        s -> v = realloc( s -> v, s -> cap * sizeof *s -> v );
+
+        if( s -> v == NULL ) {
+            perror( "realloc" );
+            exit( 1 );
+        }
+
+        memset( s -> v + old, 0, ( s -> cap - old ) * sizeof *s -> v );
+    }
+
+    s -> v[ i ] = x;
+
+    if( i >= s -> n ) {
+        s -> n = i + 1;
+    }
+}
+
+
+int cmp_ll( const void *a, const void *b ) {
+
+    long long x = *( const long long * ) a, y = *( const long long * ) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+
+// "250M" -> 250000000
+double parse_rate( const char *s ) {
+
+    char *end;
+    double v = strtod( s, &end );
+
+    switch( *end ) {
+        case 'k': case 'K': v *= 1e3; break;
+        case 'm': case 'M': v *= 1e6; break;
+        case 'g': case 'G': v *= 1e9; break;
+    }
+
+    return v;
+}
+
+
+messages_t load_file( const char *path ) {
+
+    messages_t m = { NULL, NULL, 0 };
+    FILE *f = fopen( path, "r" );
+
+    if( f == NULL ) {
+        perror( path );
+        exit( 1 );
+    }
+
+    char *line = NULL;
+    size_t cap = 0;
+    ssize_t n;
+
+    while( ( n = getline( &line, &cap, f ) ) != -1 ) {
+
+        while( n > 0 && ( line[ n - 1 ] == '\n' || line[ n - 1 ] == '\r' ) ) {
+            n--;
+        }
+
+        if( n == 0 ) {
+            continue;
+        }
+
+        if( n > MAXSIZE ) {
+            n = MAXSIZE;
+        }
+
+        m.data = realloc( m.data, ( m.n + 1 ) * sizeof *m.data );
+        m.len = realloc( m.len, ( m.n + 1 ) * sizeof *m.len );
+        m.data[ m.n ] = memcpy( malloc( n ), line, n );
+        m.len[ m.n ] = n;
+        m.n++;
+    }
+
+    free( line );
+    fclose( f );
+
+    if( m.n == 0 ) {
+        fprintf( stderr, "%s: no non-empty lines\n", path );
+        exit( 1 );
+    }
+
+    return m;
+}
+
+
+
+/* ================= EGRESS QDISC ( rtnetlink ) ================= */
+
+// interface that owns our local address after connect()
+int egress_ifindex( int sockfd, char *name, size_t len ) {
+
+    struct sockaddr_storage local;
+    socklen_t sl = sizeof local;
+    struct ifaddrs *ifs, *i;
+    int index = 0;
+
+    if( getsockname( sockfd, ( struct sockaddr * ) &local, &sl ) == -1 || getifaddrs( &ifs ) == -1 ) {
+        return 0;
+    }
+
+    for( i = ifs; i && !index; i = i -> ifa_next ) {
+
+        if( i -> ifa_addr == NULL || i -> ifa_addr -> sa_family != local.ss_family ) {
+            continue;
+        }
+
+        int same = local.ss_family == AF_INET
+            ? ( ( struct sockaddr_in * ) i -> ifa_addr ) -> sin_addr.s_addr == ( ( struct sockaddr_in * ) &local ) -> sin_addr.s_addr
+            : !memcmp( &( ( struct sockaddr_in6 * ) i -> ifa_addr ) -> sin6_addr,
+                       &( ( struct sockaddr_in6 * ) &local ) -> sin6_addr, 16 );
+
+        if( same ) {
+            index = if_nametoindex( i -> ifa_name );
+            snprintf( name, len, "%s", i -> ifa_name );
+        }
+    }
+
+    freeifaddrs( ifs );
+
+    return index;
+}
+
+
+// dump the qdiscs of one interface : root kind, and whether fq / etf is anywhere
+// ( a multiqueue NIC has "mq" at the root and the real qdiscs below it )
+int scan_qdiscs( int ifindex, char *root, size_t len, int *has_fq, int *has_etf ) {
+
+    int fd = socket( AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE );
+
+    if( fd == -1 ) {
+        return -1;
+    }
+
+    struct {
+        struct nlmsghdr nh;
+        struct tcmsg tc;
+    } req;
+
+    memset( &req, 0, sizeof req );
+    req.nh.nlmsg_len = sizeof req;
+    req.nh.nlmsg_type = RTM_GETQDISC;
+    req.nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.tc.tcm_family = AF_UNSPEC;
+    req.tc.tcm_ifindex = ifindex;
+
+    if( send( fd, &req, sizeof req, 0 ) == -1 ) {
+        close( fd );
+        return -1;
+    }
+
+    static char buf[ 32768 ];
+    int done = 0;
+
+    snprintf( root, len, "?" );
+    *has_fq = *has_etf = 0;
+
+    while( !done ) {
+
+        ssize_t n = recv( fd, buf, sizeof buf, 0 );
+
+        if( n <= 0 ) {
+            break;
+        }
+
+        for( struct nlmsghdr *nh = ( struct nlmsghdr * ) buf; NLMSG_OK( nh, n ); nh = NLMSG_NEXT( nh, n ) ) {
+
+            if( nh -> nlmsg_type == NLMSG_DONE || nh -> nlmsg_type == NLMSG_ERROR ) {
+                done = 1;
+                break;
+            }
+
+            struct tcmsg *tc = NLMSG_DATA( nh );
+
+            if( nh -> nlmsg_type != RTM_NEWQDISC || tc -> tcm_ifindex != ifindex ) {
+                continue;
+            }
+
+            int alen = nh -> nlmsg_len - NLMSG_LENGTH( sizeof *tc );
+
+            for( struct rtattr *a = TCA_RTA( tc ); RTA_OK( a, alen ); a = RTA_NEXT( a, alen ) ) {
+
+                if( a -> rta_type != TCA_KIND ) {
+                    continue;
+                }
+
+                const char *kind = RTA_DATA( a );
+
+                if( tc -> tcm_parent == TC_H_ROOT ) {
+                    snprintf( root, len, "%s", kind );
+                }
+
+                *has_fq |= !strcmp( kind, "fq" );
+                *has_etf |= !strcmp( kind, "etf" );
+            }
+        }
+    }
+
+    close( fd );
+
+    return 0;
+}
+
+
+
+/* ================= TX TIMESTAMPS ================= */
+
+// read everything on the error queue : TX timestamps ( by packet id ),
+// and SO_TXTIME "missed deadline" reports
+void drain_errqueue( int sockfd, samples_t *tx, long *missed ) {
+
+    char ctrl[ 512 ];
+
+    while( 1 ) {
+
+        struct msghdr msg = { 0 };
+        msg.msg_control = ctrl;
+        msg.msg_controllen = sizeof ctrl;
+
+        if( recvmsg( sockfd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT ) == -1 ) {
+            return;
+        }
+
+        struct timespec ts = { 0, 0 };
+        struct sock_extended_err *ee = NULL;
+
+        for( struct cmsghdr *cm = CMSG_FIRSTHDR( &msg ); cm; cm = CMSG_NXTHDR( &msg, cm ) ) {
+
+            if( cm -> cmsg_level == SOL_SOCKET && cm -> cmsg_type == SCM_TIMESTAMPING ) {
+                memcpy( &ts, CMSG_DATA( cm ), sizeof ts );   // ts[ 0 ] : software
+            } else if( ( cm -> cmsg_level == SOL_IP && cm -> cmsg_type == IP_RECVERR )
+                    || ( cm -> cmsg_level == SOL_IPV6 && cm -> cmsg_type == IPV6_RECVERR ) ) {
+                ee = ( struct sock_extended_err * ) CMSG_DATA( cm );
+            }
+        }
+
+        if( ee == NULL ) {
+            continue;
+        }
+
+        if( ee -> ee_origin == SO_EE_ORIGIN_TXTIME ) {
+            ( *missed )++;
+        } else if( ee -> ee_origin == SO_EE_ORIGIN_TIMESTAMPING && ts.tv_sec ) {
+            samples_set( tx, ee -> ee_data, ( long long ) ts.tv_sec * 1000000000ll + ts.tv_nsec );
+        }
+    }
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int sockfd;
+    struct addrinfo hints, *servinfo, *p;
+    int rv;
+
+    double pps = 0, bps = 0;        // -r / -R
+    long count = 100000;            // -n
+    double duration = 0;            // -d : seconds, overrides -n
+    int size = 1000;                // -s
+    const char *file = NULL;        // -f
+    int mode = MODE_AUTO;           // -m
+    int burst = 1;                  // -b : bucket depth in packets
+    const char *port = SERVERPORT;  // -p
+    int opt;
+
+
+    /* STEP 0: ARGS */
+
+    if( argc < 2 ) {
+        goto usage;
+    }
+
+    const char *host = argv[ 1 ];
+    optind = 2;
+
+    while( ( opt = getopt( argc, argv, "r:R:n:d:s:f:m:b:p:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'r': pps = parse_rate( optarg ); break;
+            case 'R': bps = parse_rate( optarg ); break;
+            case 'n': count = atol( optarg ); break;
+            case 'd': duration = atof( optarg ); break;
+            case 's': size = atoi( optarg ); break;
+            case 'f': file = optarg; break;
+            case 'b': burst = atoi( optarg ); break;
+            case 'p': port = optarg; break;
+            case 'm':
+                for( mode = 0; mode < 4 && strcmp( optarg, mode_name[ mode ] ); mode++ );
+                if( mode == 4 ) goto usage;
+                break;
+            default: goto usage;
+        }
+    }
+
+    if( pps == 0 && bps == 0 ) {
+        pps = 10000;
+    }
+
+    if( pps < 0 || bps < 0 || ( pps && bps ) || count < 1 || duration < 0
+        || size < 16 || size > MAXSIZE || burst < 1 ) {
+usage:
+        fprintf( stderr, "usage: %s host [-r pps | -R bits/s] [-n count | -d seconds] [-s size] [-f file]\n"
+                         "       [-m auto|fq|txtime|bucket] [-b burst] [-p port]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+    messages_t msgs = { NULL, NULL, 0 };
+
+    if( file ) {
+        msgs = load_file( file );
+    }
+
+
+    /* STEP 1: RESOLVE + CONNECTED SOCKET */
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_UNSPEC;  // IPv4 or IPv6
+    hints.ai_socktype = SOCK_DGRAM; // UDP
+
+    rv = getaddrinfo( host, port, &hints, &servinfo );
+
+    if( rv != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( rv ) );
+        exit( 2 );
+    }
+
+    for( p = servinfo; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            perror( "talker: socket" );
+            continue;
+        }
+
+        // connected : the route ( and so the egress interface ) is fixed
+        if( connect( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            perror( "talker: connect" );
+            continue;
+        }
+
+        break;
+    }
+
+    if( p == NULL ) {
+        fprintf( stderr, "talker: failed to create socket\n" );
+        exit( 2 );
+    }
+
+    int family = p -> ai_family;
+    freeaddrinfo( servinfo );
+
+
+    /* STEP 2: RATE IN WIRE BYTES PER SECOND */
+
+    // what the link carries : payload + UDP 8 + IPv4 20 / IPv6 40
+    int overhead = 8 + ( family == AF_INET6 ? 40 : 20 );
+    double avg_payload = size;
+    size_t max_payload = size;
+
+    if( file ) {
+
+        avg_payload = 0;
+        max_payload = 0;
+
+        for( long i = 0; i < msgs.n; i++ ) {
+
+            avg_payload += msgs.len[ i ];
+
+            if( msgs.len[ i ] > max_payload ) {
+                max_payload = msgs.len[ i ];
+            }
+        }
+
+        avg_payload /= msgs.n;
+    }
+
+    double byte_rate = bps ? bps / 8 : pps * ( avg_payload + overhead );
+    double target_pps = byte_rate / ( avg_payload + overhead );
+
+
+    /* STEP 3: PICK THE PACER */
+
+    char ifname[ IF_NAMESIZE ] = "?", qdisc[ 32 ] = "?";
+    int has_fq = 0, has_etf = 0;
+    int ifindex = egress_ifindex( sockfd, ifname, sizeof ifname );
+
+    if( ifindex ) {
+        scan_qdiscs( ifindex, qdisc, sizeof qdisc, &has_fq, &has_etf );
+    }
+
+    if( mode == MODE_AUTO ) {
+        mode = has_fq ? MODE_FQ : has_etf ? MODE_TXTIME : MODE_BUCKET;
+    }
+
+    printf( "talker: egress %s, qdisc %s -> pacing by %s\n", ifname, qdisc, mode_name[ mode ] );
+
+    // etf schedules on CLOCK_TAI, fq on CLOCK_MONOTONIC
+    clockid_t txclock = has_etf ? CLOCK_TAI : CLOCK_MONOTONIC;
+
+    if( mode == MODE_FQ ) {
+
+        if( !has_fq ) {
+            printf( "talker: warning : no fq qdisc on %s, SO_MAX_PACING_RATE will not pace\n", ifname );
+        }
+
+        // bytes per second, enforced by fq per flow ( this socket )
+        unsigned int r = byte_rate > 4e9 ? 0xffffffffu : ( unsigned int ) byte_rate;
+
+        if( setsockopt( sockfd, SOL_SOCKET, SO_MAX_PACING_RATE, &r, sizeof r ) == -1 ) {
+            perror( "talker: SO_MAX_PACING_RATE" );
+            exit( 3 );
+        }
+    }
+
+    if( mode == MODE_TXTIME ) {
+
+        if( !has_fq && !has_etf ) {
+            printf( "talker: warning : no fq / etf qdisc on %s, SO_TXTIME deadlines are ignored\n", ifname );
+        }
+
+        struct sock_txtime st = { txclock, SOF_TXTIME_REPORT_ERRORS };
+
+        if( setsockopt( sockfd, SOL_SOCKET, SO_TXTIME, &st, sizeof st ) == -1 ) {
+            perror( "talker: SO_TXTIME" );
+            exit( 3 );
+        }
+    }
+
+    // software TX timestamp of every packet, tagged with a counter ( OPT_ID )
+    int tsflags = SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE
+                | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+    int have_txts = setsockopt( sockfd, SOL_SOCKET, SO_TIMESTAMPING, &tsflags, sizeof tsflags ) == 0;
+
+
+    /* STEP 4: SEND LOOP */
+
+    char gen[ MAXSIZE ];
+    memset( gen, 'x', sizeof gen );
+
+    samples_t sent_at = { 0 }, tx = { 0 };
+    long missed = 0, errors = 0;
+
+    uint64_t start = now_ns( CLOCK_MONOTONIC );
+    uint64_t stop_at = duration ? start + ( uint64_t ) ( duration * 1e9 ) : 0;
+    uint64_t tx_start = now_ns( txclock );
+
+    double due = 0;                             // txtime : ns after tx_start
+    // bucket : capacity in bytes, the largest message must always fit
+    double depth = burst * ( ( double ) max_payload + overhead );
+    double tokens = depth;
+    uint64_t last_fill = start;
+
+    long i;
+
+    for( i = 0; duration ? now_ns( CLOCK_MONOTONIC ) < stop_at : i < count; i++ ) {
+
+        const char *data = gen;
+        size_t len = size;
+
+        if( file ) {
+            data = msgs.data[ i % msgs.n ];
+            len = msgs.len[ i % msgs.n ];
+        } else {
+            uint64_t seq = i, t = now_ns( CLOCK_REALTIME );
+            memcpy( gen, &seq, 8 );
+            memcpy( gen + 8, &t, 8 );
+        }
+
+        double wire = len + overhead;
+
+
+        /* ---------- BUCKET : wait for enough tokens ---------- */
+
+        if( mode == MODE_BUCKET ) {
+
+            while( 1 ) {
+
+                uint64_t now = now_ns( CLOCK_MONOTONIC );
+
+                tokens += ( now - last_fill ) * byte_rate / 1e9;
+                last_fill = now;
+
+                if( tokens > depth ) {
+                    tokens = depth;
+                }
+
+                if( tokens >= wire ) {
+                    break;
+                }
+
+                // far away : sleep ( wakes up late by tens of us ), close : spin
+                uint64_t wait = ( uint64_t ) ( ( wire - tokens ) * 1e9 / byte_rate );
+
+                if( wait > SPIN_NS ) {
+                    sleep_until( CLOCK_MONOTONIC, now + wait - SPIN_NS );
+                }
+            }
+
+            tokens -= wire;
+        }
+
+
+        /* ---------- SEND ---------- */
+
+        ssize_t r;
+
+        if( mode == MODE_TXTIME ) {
+
+            uint64_t when = tx_start + ( uint64_t ) due;
+            due += wire * 1e9 / byte_rate;
+
+            // do not run ahead : the qdisc would hold thousands of packets
+            if( when > now_ns( txclock ) + TXTIME_LEAD_NS ) {
+                sleep_until( txclock, when - TXTIME_LEAD_NS );
+            }
+
+            char ctrl[ CMSG_SPACE( sizeof( uint64_t ) ) ];
+            struct iovec iov = { ( void * ) data, len };
+            struct msghdr mh = { 0 };
+
+            mh.msg_iov = &iov;
+            mh.msg_iovlen = 1;
+            mh.msg_control = ctrl;
+            mh.msg_controllen = sizeof ctrl;
+
+            struct cmsghdr *cm = CMSG_FIRSTHDR( &mh );
+            cm -> cmsg_level = SOL_SOCKET;
+            cm -> cmsg_type = SCM_TXTIME;
+            cm -> cmsg_len = CMSG_LEN( sizeof when );
+            memcpy( CMSG_DATA( cm ), &when, sizeof when );
+
+            r = sendmsg( sockfd, &mh, 0 );
+
+        } else {
+
+            // fq : blocks when the socket buffer is full of packets fq is holding
+            r = send( sockfd, data, len, 0 );
+        }
+
+        if( r == -1 ) {
+            errors++;     // e.g. ECONNREFUSED : nobody listening
+        }
+
+        samples_set( &sent_at, i, ( long long ) now_ns( CLOCK_MONOTONIC ) );
+
+        if( have_txts && i % DRAIN_EVERY == 0 ) {
+            drain_errqueue( sockfd, &tx, &missed );
+        }
+    }
+
+    long sent = i;
+
+    // the last TX timestamps ( fq may still be holding packets )
+    for( int k = 0; k < 20 && have_txts; k++ ) {
+        usleep( 5000 );
+        drain_errqueue( sockfd, &tx, &missed );
+    }
+
+
+    /* STEP 5: REPORT */
+
+    // departures : TX timestamps when we got them for ( nearly ) every packet
+    samples_t *dep = have_txts && tx.n >= sent * 0.99 ? &tx : &sent_at;
+    long n = 0;
+
+    // gaps between consecutive departures, skipping missing timestamps
+    long long *gaps = malloc( ( dep -> n + 1 ) * sizeof *gaps );
+    long long first = 0, last = 0;
+
+    for( long k = 0; k < dep -> n; k++ ) {
+
+        if( dep -> v[ k ] == 0 ) {
+            continue;
+        }
+
+        if( first == 0 ) {
+            first = dep -> v[ k ];
+        } else if( dep -> v[ k ] > last ) {
+            gaps[ n++ ] = dep -> v[ k ] - last;
+        }
+
+        last = dep -> v[ k ];
+    }
+
+    double span = ( last - first ) / 1e9;
+    double achieved_pps = span > 0 ? n / span : 0;
+    double target_gap = 1e9 / target_pps;
+
+    printf( "talker: %ld datagrams, %ld send errors", sent, errors );
+
+    if( mode == MODE_TXTIME ) {
+        printf( ", %ld missed deadlines", missed );
+    }
+
+    printf( "\n\n%-10s %14s %14s\n", "", "packets/s", "Mbit/s" );
+    printf( "%-10s %14.0f %14.2f\n", "target", target_pps, byte_rate * 8 / 1e6 );
+    printf( "%-10s %14.0f %14.2f   ( %+.2f%% )\n", "achieved", achieved_pps,
+            achieved_pps * ( avg_payload + overhead ) * 8 / 1e6,
+            target_pps ? 100.0 * ( achieved_pps - target_pps ) / target_pps : 0.0 );
+
+    if( n > 0 ) {
+
+        double sum = 0, sq = 0;
+        long tight = 0;
+
+        for( long k = 0; k < n; k++ ) {
+            sum += gaps[ k ];
+            sq += ( double ) gaps[ k ] * gaps[ k ];
+            tight += gaps[ k ] < target_gap / 2;
+        }
+
+        double mean = sum / n;
+        double sd = sqrt( sq / n - mean * mean > 0 ? sq / n - mean * mean : 0 );
+
+        qsort( gaps, n, sizeof *gaps, cmp_ll );
+
+        printf( "\ngap ( %s ) : target %.1f us\n",
+                dep == &tx ? "TX timestamps" : "send() times", target_gap / 1e3 );
+        printf( "  mean %.1f  stddev %.1f  cv %.3f  | min %.1f  p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f us\n",
+                mean / 1e3, sd / 1e3, mean > 0 ? sd / mean : 0.0, gaps[ 0 ] / 1e3, gaps[ n / 2 ] / 1e3,
+                gaps[ ( long ) ( n * 0.99 ) ] / 1e3, gaps[ ( long ) ( n * 0.999 ) ] / 1e3, gaps[ n - 1 ] / 1e3 );
+        printf( "  %ld gaps under half the target ( %.2f%% ) : back-to-back bursts\n",
+                tight, 100.0 * tight / n );
+    }
+
+    free( gaps );
+    close( sockfd );
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#!/bin/sh
+#
+#   bench.sh
+#
+#   Sender CPU for 1 .. 64 listeners : unicast fan-out vs one multicast group
+#
+#   Reports for each K:
+#       sender CPU per datagram ( unicast, multicast ), and copies lost
+#
+#   Usage:
+#       ./bench.sh [datagrams] [rate] [size] [group]
+#
+#   Example:
+#       ./bench.sh 20000 10000 200 239.255.49.50
+
+COUNT=${1:-20000}
+RATE=${2:-10000}
+SIZE=${3:-200}
+GROUP=${4:-239.255.49.50}
+PORT=5000
+OUT=/tmp/multicast-bench.$$
+
+mkdir -p "$OUT"
+
+# start K listeners, run the talker, wait for every listener's summary
+# prints : cpu-us-per-datagram copies-received
+run() {
+
+    K=$1
+    MODE=$2
+
+    rm -f "$OUT"/l.*
+    PIDS=
+
+    for i in $( seq 0 $(( K - 1 )) ); do
+        if [ "$MODE" = multicast ]; then
+            ./udp_listener -g "$GROUP" -p "$PORT" > "$OUT/l.$i" &
+        else
+            ./udp_listener -p $(( PORT + i )) > "$OUT/l.$i" &
+        fi
+        PIDS="$PIDS $!"
+    done
+
+    sleep 0.5
+
+    if [ "$MODE" = multicast ]; then
+        ./udp_talker "$GROUP" -p "$PORT" -n "$COUNT" -r "$RATE" -s "$SIZE" > "$OUT/t"
+    else
+        ./udp_talker ::1 -k "$K" -p "$PORT" -n "$COUNT" -r "$RATE" -s "$SIZE" > "$OUT/t"
+    fi
+
+    # a listener that lost all 3 END datagrams prints its summary on SIGINT
+    sleep 1
+    kill -INT $PIDS 2> /dev/null
+    wait
+
+    CPU=$( awk '/cpu/ { print $6 }' "$OUT/t" )
+    GOT=$( cat "$OUT"/l.* | awk '/received/ { n += $2 } END { print n }' )
+
+    echo "$CPU $GOT"
+}
+
+echo "$COUNT datagrams of $SIZE B at $RATE/s, listeners on this host"
+echo
+printf "%10s | %23s | %25s | %8s\n" "listeners" "unicast us/dgram   lost" "multicast us/dgram   lost" "ratio"
+
+for K in 1 2 4 8 16 32 64; do
+
+    set -- $( run "$K" unicast )
+    U_CPU=$1
+    U_LOST=$(( COUNT * K - $2 ))
+
+    set -- $( run "$K" multicast )
+    M_CPU=$1
+    M_LOST=$(( COUNT * K - $2 ))
+
+    echo "$K $U_CPU $U_LOST $M_CPU $M_LOST" | awk '{
+        printf "%10d | %16.2f %6d | %18.2f %6d | %7.1fx\n", $1, $2, $3, $4, $5, ( $4 > 0 ? $2 / $4 : 0 )
+    }'
+done
+
+rm -rf "$OUT"
@@ -0,0 +1,283 @@
+/*
+   udp_listener.c
+
+   UDP listener that can join a multicast group
+   ( 09-unconnected-UDP-socket/udp_listener.c + IP_ADD_MEMBERSHIP / IPV6_JOIN_GROUP )
+
+   Unicast  : ./udp_listener -p 5000
+   Multicast: ./udp_listener -g 239.255.49.50 -i lo
+              any number of listeners can join the same group and port :
+              each one gets its own copy of every datagram
+
+   Counts the sequence-numbered datagrams of udp_talker.c and prints
+   how many arrived when the END datagram comes ( or on Ctrl+C ).
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 udp_listener.c -o udp_listener
+
+   Run:
+    ./udp_listener -g 239.255.49.50                  ( IPv4 group on lo, port 4950 )
+    ./udp_listener -g ff02::4950 -i eth0 -v          ( IPv6 link-local group )
+
+   Linux only ( ip_mreqn )
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define MYPORT "4950"       // Port we listen on
+#define MAXBUFLEN 2048
+#define SEQ_END UINT64_MAX  // END datagram from udp_talker
+
+
+volatile sig_atomic_t stop = 0;
+
+
+void on_signal( int sig ) {
+
+    ( void ) sig;
+    stop = 1;
+}
+
+
+// Extract IP address (IPv4 or IPv6)
+void *get_in_addr( struct sockaddr *sa ) {
+
+    if( sa -> sa_family == AF_INET ) {
+        return &( ( ( struct sockaddr_in* ) sa ) -> sin_addr );
+    }
+
+    return &( ( ( struct sockaddr_in6* ) sa ) -> sin6_addr );
+}
+
+
+
+/* ================= MULTICAST MEMBERSHIP ================= */
+
+// join group on one interface : the kernel then sends an IGMP / MLD report
+// and starts handing us every datagram sent to that group
+int join_group( int sockfd, struct sockaddr *group, unsigned int ifindex ) {
+
+    if( group -> sa_family == AF_INET ) {
+
+        struct ip_mreqn mr;
+        memset( &mr, 0, sizeof mr );
+
+        mr.imr_multiaddr = ( ( struct sockaddr_in * ) group ) -> sin_addr;
+        mr.imr_ifindex = ifindex;
+
+        return setsockopt( sockfd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mr, sizeof mr );
+    }
+
+    struct ipv6_mreq mr6;
+
+    mr6.ipv6mr_multiaddr = ( ( struct sockaddr_in6 * ) group ) -> sin6_addr;
+    mr6.ipv6mr_interface = ifindex;
+
+    return setsockopt( sockfd, IPPROTO_IPV6, IPV6_JOIN_GROUP, &mr6, sizeof mr6 );
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int sockfd;
+    struct addrinfo hints, *servinfo, *p;
+    int rv;
+
+    const char *group = NULL;       // -g : multicast group, unicast without it
+    const char *ifname = "lo";      // -i : interface to join on
+    const char *port = MYPORT;      // -p
+    int verbose = 0;                // -v : one line per datagram
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "g:i:p:v" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'g': group = optarg; break;
+            case 'i': ifname = optarg; break;
+            case 'p': port = optarg; break;
+            case 'v': verbose = 1; break;
+            default:
+                fprintf( stderr, "usage: %s [-g group] [-i interface] [-p port] [-v]\n", argv[ 0 ] );
+                exit( 1 );
+        }
+    }
+
+    unsigned int ifindex = if_nametoindex( ifname );
+
+    if( group && ifindex == 0 ) {
+        fprintf( stderr, "listener: no interface %s\n", ifname );
+        exit( 1 );
+    }
+
+
+    /* STEP 1: SETUP HINTS */
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_socktype = SOCK_DGRAM; // UDP
+
+    if( group ) {
+        hints.ai_family = AF_UNSPEC;            // family of the group
+        hints.ai_flags  = AI_NUMERICHOST;
+    } else {
+        hints.ai_family = AF_INET6;             // force IPv6, like 09
+        hints.ai_flags  = AI_PASSIVE;
+    }
+
+
+    /* STEP 2: GET ADDRESS INFO */
+
+    // multicast : bind to the group itself, so only its traffic reaches this socket
+    rv = getaddrinfo( group, port, &hints, &servinfo );
+
+    if( rv != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( rv ) );
+        exit( 1 );
+    }
+
+
+    /* STEP 3: CREATE SOCKET + BIND + JOIN */
+
+    for( p = servinfo; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            perror( "listener: socket" );
+            continue;
+        }
+
+        if( group ) {
+
+            // several listeners on the same group and port
+            int yes = 1;
+            setsockopt( sockfd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes );
+
+            // a link-local IPv6 group ( ff02:: ) belongs to one interface
+            if( p -> ai_family == AF_INET6 ) {
+                ( ( struct sockaddr_in6 * ) p -> ai_addr ) -> sin6_scope_id = ifindex;
+            }
+        }
+
+        if( bind( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            perror( "listener: bind" );
+            continue;
+        }
+
+        if( group && join_group( sockfd, p -> ai_addr, ifindex ) == -1 ) {
+            close( sockfd );
+            perror( "listener: join group" );
+            continue;
+        }
+
+        break;  // success
+    }
+
+    if( p == NULL ) {
+        fprintf( stderr, "listener: failed to bind\n" );
+        exit( 2 );
+    }
+
+    freeaddrinfo( servinfo );
+
+    struct sigaction sa;
+    memset( &sa, 0, sizeof sa );
+    sa.sa_handler = on_signal;
+    sigaction( SIGINT, &sa, NULL );
+    sigaction( SIGTERM, &sa, NULL );
+
+    if( group ) {
+        printf( "listener: joined %s on %s, port %s\n", group, ifname, port );
+    } else {
+        printf( "listener: waiting on port %s\n", port );
+    }
+
+    fflush( stdout );
+
+
+    /* STEP 4: RECEIVE UNTIL END */
+
+    char buf[ MAXBUFLEN ];
+    char ipstr[ INET6_ADDRSTRLEN ];
+    struct sockaddr_storage their_addr;
+    socklen_t addr_len;
+
+    unsigned long long received = 0, highest = 0, expected = 0;
+    int got_end = 0;
+
+    while( !stop && !got_end ) {
+
+        addr_len = sizeof their_addr;
+
+        ssize_t n = recvfrom( sockfd, buf, sizeof buf, 0, ( struct sockaddr * ) &their_addr, &addr_len );
+
+        if( n == -1 ) {
+
+            if( errno != EINTR ) {
+                perror( "recvfrom" );
+                break;
+            }
+
+            continue;
+        }
+
+        uint64_t seq = 0;
+
+        if( n >= ( ssize_t ) sizeof seq ) {
+            memcpy( &seq, buf, sizeof seq );
+        }
+
+        // END from udp_talker : seq field, then how many were sent
+        if( seq == SEQ_END && n >= 2 * ( ssize_t ) sizeof seq ) {
+
+            memcpy( &expected, buf + sizeof seq, sizeof expected );
+            got_end = 1;
+            break;
+        }
+
+        received++;
+
+        if( seq + 1 > highest ) {
+            highest = seq + 1;
+        }
+
+        if( verbose ) {
+
+            inet_ntop( their_addr.ss_family, get_in_addr( ( struct sockaddr * ) &their_addr ), ipstr, sizeof ipstr );
+            printf( "listener: %zd bytes from %s, seq %llu\n", n, ipstr, ( unsigned long long ) seq );
+        }
+    }
+
+
+    /* STEP 5: SUMMARY */
+
+    // without END ( Ctrl+C ) the highest sequence number seen is the best guess
+    if( !got_end ) {
+        expected = highest;
+    }
+
+    printf( "listener: %llu of %llu datagrams received, %llu lost\n",
+            received, expected, expected > received ? expected - received : 0 );
+
+    // close() also leaves the group
+    close( sockfd );
+
+    return 0;
+}
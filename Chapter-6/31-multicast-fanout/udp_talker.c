@@ -0,0 +1,325 @@
+/*
+   udp_talker.c
+
+   One datagram to K listeners : unicast fan-out vs multicast
+   ( 09-unconnected-UDP-socket/udp_talker.c, sequence-numbered stream )
+
+   Unicast   : host is a normal address, -k K listeners on ports
+               port, port + 1, ... port + K - 1
+               every datagram costs K sendto() calls
+   Multicast : host is a group ( 224.0.0.0/4 or ff00::/8 )
+               every datagram costs 1 sendto(), the kernel makes the copies
+
+   Every datagram starts with a 64-bit sequence number; an END datagram
+   with the total is sent 3 times at the end ( see udp_listener.c ).
+
+   Prints the CPU time the sender used ( getrusage ), per datagram and
+   per delivered copy.
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 udp_talker.c -o udp_talker
+
+   Run:
+    ./udp_talker 127.0.0.1 -k 8 -p 5000             ( 8 unicast listeners, ports 5000..5007 )
+    ./udp_talker 239.255.49.50 -i lo                ( any number of listeners in the group )
+    ./udp_talker ff02::4950 -i eth0 -t 1
+    ./udp_talker ff02::4950 -i lo                   ( after the route in the README )
+
+   Linux only ( ip_mreqn )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netdb.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define SERVERPORT 4950
+#define MAXSIZE 1472
+#define MAXK 1024               // unicast listeners
+#define SEQ_END UINT64_MAX      // END datagram : seq field, then total
+
+
+uint64_t now_ns( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+void sleep_until( uint64_t t ) {
+
+    struct timespec ts = { ( time_t ) ( t / 1000000000ull ), ( long ) ( t % 1000000000ull ) };
+
+    while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL ) == EINTR );
+}
+
+
+// user + system CPU seconds of this process
+double cpu_sec( void ) {
+
+    struct rusage ru;
+    getrusage( RUSAGE_SELF, &ru );
+
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6
+         + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+
+int is_multicast( const struct sockaddr *sa ) {
+
+    if( sa -> sa_family == AF_INET ) {
+        return IN_MULTICAST( ntohl( ( ( const struct sockaddr_in * ) sa ) -> sin_addr.s_addr ) );
+    }
+
+    return IN6_IS_ADDR_MULTICAST( &( ( const struct sockaddr_in6 * ) sa ) -> sin6_addr );
+}
+
+
+void set_port( struct sockaddr *sa, int port ) {
+
+    if( sa -> sa_family == AF_INET ) {
+        ( ( struct sockaddr_in * ) sa ) -> sin_port = htons( port );
+    } else {
+        ( ( struct sockaddr_in6 * ) sa ) -> sin6_port = htons( port );
+    }
+}
+
+
+
+/* ================= MULTICAST SENDER OPTIONS ================= */
+
+// outgoing interface, hop limit, and loopback : without IP_MULTICAST_LOOP
+// listeners on this host ( the whole point on lo ) would get nothing
+int setup_multicast( int sockfd, int family, unsigned int ifindex, int hops ) {
+
+    int loop = 1;
+
+    if( family == AF_INET ) {
+
+        struct ip_mreqn mr;
+        memset( &mr, 0, sizeof mr );
+        mr.imr_ifindex = ifindex;
+
+        unsigned char ttl = hops, lp = loop;
+
+        if( setsockopt( sockfd, IPPROTO_IP, IP_MULTICAST_IF, &mr, sizeof mr ) == -1
+            || setsockopt( sockfd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof ttl ) == -1
+            || setsockopt( sockfd, IPPROTO_IP, IP_MULTICAST_LOOP, &lp, sizeof lp ) == -1 ) {
+            return -1;
+        }
+
+        return 0;
+    }
+
+    if( setsockopt( sockfd, IPPROTO_IPV6, IPV6_MULTICAST_IF, &ifindex, sizeof ifindex ) == -1
+        || setsockopt( sockfd, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &hops, sizeof hops ) == -1
+        || setsockopt( sockfd, IPPROTO_IPV6, IPV6_MULTICAST_LOOP, &loop, sizeof loop ) == -1 ) {
+        return -1;
+    }
+
+    return 0;
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int sockfd;
+    struct addrinfo hints, *servinfo;
+    int rv;
+
+    long total = 100000;        // -n
+    long rate = 0;              // -r : datagrams per second, 0 = unpaced
+    int size = 200;             // -s
+    int k = 1;                  // -k : unicast listeners
+    int port = SERVERPORT;      // -p : first port
+    const char *ifname = "lo";  // -i : multicast interface
+    int hops = 1;               // -t : multicast TTL / hop limit
+    int opt;
+
+
+    /* STEP 0: ARGS */
+
+    if( argc < 2 ) {
+        goto usage;
+    }
+
+    const char *host = argv[ 1 ];
+    optind = 2;
+
+    while( ( opt = getopt( argc, argv, "n:r:s:k:p:i:t:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'n': total = atol( optarg ); break;
+            case 'r': rate = atol( optarg ); break;
+            case 's': size = atoi( optarg ); break;
+            case 'k': k = atoi( optarg ); break;
+            case 'p': port = atoi( optarg ); break;
+            case 'i': ifname = optarg; break;
+            case 't': hops = atoi( optarg ); break;
+            default: goto usage;
+        }
+    }
+
+    if( total < 1 || rate < 0 || size < 16 || size > MAXSIZE || k < 1 || k > MAXK
+        || port < 1 || port + k > 65536 || hops < 0 || hops > 255 ) {
+usage:
+        fprintf( stderr, "usage: %s host|group [-n count] [-r pps] [-s size] [-k listeners] [-p port]\n"
+                         "       [-i interface] [-t hops]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+
+    /* STEP 1: RESOLVE + SOCKET */
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_UNSPEC;  // IPv4 or IPv6
+    hints.ai_socktype = SOCK_DGRAM; // UDP
+
+    rv = getaddrinfo( host, NULL, &hints, &servinfo );
+
+    if( rv != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( rv ) );
+        exit( 2 );
+    }
+
+    struct sockaddr_storage dest;
+    socklen_t dest_len = servinfo -> ai_addrlen;
+    int family = servinfo -> ai_family;
+
+    memcpy( &dest, servinfo -> ai_addr, dest_len );
+    freeaddrinfo( servinfo );
+
+    sockfd = socket( family, SOCK_DGRAM, 0 );
+
+    if( sockfd == -1 ) {
+        perror( "talker: socket" );
+        exit( 2 );
+    }
+
+    int multicast = is_multicast( ( struct sockaddr * ) &dest );
+    unsigned int ifindex = if_nametoindex( ifname );
+
+    if( multicast ) {
+
+        if( ifindex == 0 ) {
+            fprintf( stderr, "talker: no interface %s\n", ifname );
+            exit( 2 );
+        }
+
+        if( setup_multicast( sockfd, family, ifindex, hops ) == -1 ) {
+            perror( "talker: multicast options" );
+            exit( 3 );
+        }
+
+        if( family == AF_INET6 ) {
+            ( ( struct sockaddr_in6 * ) &dest ) -> sin6_scope_id = ifindex;
+        }
+
+        k = 1;  // one destination : the group
+    }
+
+
+    /* STEP 2: DESTINATIONS */
+
+    // unicast : one address per listener; multicast : just the group
+    struct sockaddr_storage *to = malloc( k * sizeof *to );
+
+    for( int i = 0; i < k; i++ ) {
+        memcpy( &to[ i ], &dest, dest_len );
+        set_port( ( struct sockaddr * ) &to[ i ], port + i );
+    }
+
+
+    /* STEP 3: SEND */
+
+    char buf[ MAXSIZE ];
+    memset( buf, 'x', sizeof buf );
+
+    uint64_t gap = rate ? 1000000000ull / rate : 0;
+    uint64_t start = now_ns(), next = start;
+    long calls = 0, failed = 0;
+
+    double cpu0 = cpu_sec();
+
+    for( uint64_t seq = 0; seq < ( uint64_t ) total; seq++ ) {
+
+        if( gap ) {
+            sleep_until( next );
+            next += gap;
+        }
+
+        memcpy( buf, &seq, sizeof seq );
+
+        // the fan-out : K system calls, K trips through UDP / IP / routing
+        for( int i = 0; i < k; i++ ) {
+
+            calls++;
+
+            if( sendto( sockfd, buf, size, 0, ( struct sockaddr * ) &to[ i ], dest_len ) == -1 ) {
+
+                // IPv6 multicast on lo : no route by default ( see the README )
+                if( failed++ == 0 && errno == ENETUNREACH && multicast && family == AF_INET6 ) {
+                    fprintf( stderr, "talker: no IPv6 multicast route on %s : "
+                                     "ip -6 route add local ff00::/8 dev lo table local, or -i eth0\n", ifname );
+                }
+            }
+        }
+    }
+
+    double cpu = cpu_sec() - cpu0;
+    double secs = ( now_ns() - start ) / 1e9;
+
+
+    /* STEP 4: END MARKER */
+
+    usleep( 200000 );
+
+    uint64_t end[ 2 ] = { SEQ_END, ( uint64_t ) total };
+
+    for( int r = 0; r < 3; r++ ) {
+        for( int i = 0; i < k; i++ ) {
+            sendto( sockfd, end, sizeof end, 0, ( struct sockaddr * ) &to[ i ], dest_len );
+        }
+    }
+
+    char ip[ INET6_ADDRSTRLEN ];
+    void *a = family == AF_INET ? ( void * ) &( ( struct sockaddr_in * ) &dest ) -> sin_addr
+                                : ( void * ) &( ( struct sockaddr_in6 * ) &dest ) -> sin6_addr;
+
+    inet_ntop( family, a, ip, sizeof ip );
+
+    if( multicast ) {
+        printf( "talker: multicast to %s port %d via %s\n", ip, port, ifname );
+    } else {
+        printf( "talker: unicast to %s ports %d..%d ( %d listeners )\n", ip, port, port + k - 1, k );
+    }
+
+    printf( "talker: %ld datagrams of %d B, %ld sendto() calls, %ld failed, %.2f s\n",
+            total, size, calls, failed, secs );
+    printf( "talker: cpu %.3f s = %.2f us per datagram, %.2f us per sendto()\n",
+            cpu, cpu * 1e6 / total, cpu * 1e6 / calls );
+
+    free( to );
+    close( sockfd );
+
+    return 0;
+}
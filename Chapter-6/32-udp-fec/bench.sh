@@ -0,0 +1,50 @@
+#!/bin/sh
+#
+#   bench.sh
+#
+#   Residual loss and bandwidth cost of each FEC setting, under synthetic loss
+#
+#   Reports for each scheme / block size:
+#       extra bytes on the wire, then residual loss at every loss rate
+#
+#   Usage:
+#       ./bench.sh [datagrams] [burst] [loss rates ...]
+#
+#   Example:
+#       ./bench.sh 50000 1 1 5 10
+#       ./bench.sh 50000 4 1 5 10          ( losses in bursts of 4 on average )
+
+COUNT=${1:-50000}
+BURST=${2:-1}
+[ $# -ge 2 ] && shift 2 || set --
+LOSSES=${*:-1 5 10}
+OUT=/tmp/fec-bench.$$
+
+echo "$COUNT datagrams of 200 B, average loss burst $BURST"
+echo
+
+printf "%-14s %8s" "fec" "extra"
+for L in $LOSSES; do printf " %11s" "$L% loss"; done
+echo
+
+for FEC in "none" "xor -k 10" "xor -k 5" "rs -k 10 -m 2" "rs -k 20 -m 4" "rs -k 10 -m 4"; do
+
+    printf "%-14s" "$FEC"
+    EXTRA=
+
+    for L in $LOSSES; do
+
+        ./udp_listener > "$OUT" &
+        sleep 0.3
+        ./udp_talker ::1 -n "$COUNT" -x $FEC -l "$L" -b "$BURST" > /dev/null
+        wait
+
+        # "still missing : N ( residual loss X% )", "+Y% bytes on the wire"
+        [ -z "$EXTRA" ] && EXTRA=$( awk '/on the wire/ { print $8 }' "$OUT" ) && printf " %8s" "$EXTRA"
+        awk '/still missing/ { printf " %10s%%", substr( $8, 1, length( $8 ) - 1 ) }' "$OUT"
+    done
+
+    echo
+done
+
+rm -f "$OUT"
@@ -0,0 +1,414 @@
+/*
+    fec.c
+
+    XOR and Reed-Solomon ( Cauchy, GF(256) ) block codes for UDP ( see fec.h )
+
+    Compile together with the program that uses it:
+        gcc -Wall -Wextra -pedantic -O2 fec.c your_program.c -o your_program
+*/
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "fec.h"
+
+
+/* ================= GF(256) ================= */
+
+// bytes are elements of GF(2^8) modulo x^8 + x^4 + x^3 + x^2 + 1 ( 0x11d ) :
+// addition is XOR, multiplication goes through log / exp tables
+
+static uint8_t gf_exp[ 512 ];
+static uint8_t gf_log[ 256 ];
+static uint8_t gf_inv[ 256 ];
+static uint8_t gf_mul[ 256 ][ 256 ];     // 64 KiB : one lookup per byte when coding
+
+
+void fec_init( void ) {
+
+    int x = 1;
+
+    for( int i = 0; i < 255; i++ ) {
+
+        gf_exp[ i ] = gf_exp[ i + 255 ] = x;
+        gf_log[ x ] = i;
+
+        x <<= 1;
+
+        if( x & 0x100 ) {
+            x ^= 0x11d;
+        }
+    }
+
+    for( int a = 1; a < 256; a++ ) {
+
+        gf_inv[ a ] = gf_exp[ 255 - gf_log[ a ] ];
+
+        for( int b = 1; b < 256; b++ ) {
+            gf_mul[ a ][ b ] = gf_exp[ gf_log[ a ] + gf_log[ b ] ];
+        }
+    }
+}
+
+
+// dst += c * src
+static void gf_addmul( uint8_t *dst, const uint8_t *src, uint8_t c, size_t n ) {
+
+    if( c == 0 ) {
+        return;
+    }
+
+    if( c == 1 ) {
+
+        for( size_t i = 0; i < n; i++ ) {
+            dst[ i ] ^= src[ i ];
+        }
+
+        return;
+    }
+
+    const uint8_t *row = gf_mul[ c ];
+
+    for( size_t i = 0; i < n; i++ ) {
+        dst[ i ] ^= row[ src[ i ] ];
+    }
+}
+
+
+// coefficient of data symbol i in parity symbol j
+// RS : Cauchy matrix 1 / ( x_j + y_i ), x_j = j, y_i = m + i : all distinct,
+// so every square submatrix is invertible and any m losses can be undone
+static uint8_t coef( int scheme, int m, int j, int i ) {
+
+    if( scheme == FEC_XOR ) {
+        return 1;
+    }
+
+    return gf_inv[ j ^ ( m + i ) ];
+}
+
+
+// invert n x n matrix a in place ( Gauss-Jordan ), returns -1 if singular
+static int gf_invert( uint8_t a[ FEC_MAXN ][ FEC_MAXN ], int n ) {
+
+    uint8_t b[ FEC_MAXN ][ FEC_MAXN ];
+
+    memset( b, 0, sizeof b );
+
+    for( int i = 0; i < n; i++ ) {
+        b[ i ][ i ] = 1;
+    }
+
+    for( int col = 0; col < n; col++ ) {
+
+        int piv = col;
+
+        while( piv < n && a[ piv ][ col ] == 0 ) {
+            piv++;
+        }
+
+        if( piv == n ) {
+            return -1;
+        }
+
+        if( piv != col ) {
+
+            uint8_t t[ FEC_MAXN ];
+
+            memcpy( t, a[ piv ], n );  memcpy( a[ piv ], a[ col ], n );  memcpy( a[ col ], t, n );
+            memcpy( t, b[ piv ], n );  memcpy( b[ piv ], b[ col ], n );  memcpy( b[ col ], t, n );
+        }
+
+        uint8_t s = gf_inv[ a[ col ][ col ] ];
+
+        for( int c = 0; c < n; c++ ) {
+            a[ col ][ c ] = gf_mul[ s ][ a[ col ][ c ] ];
+            b[ col ][ c ] = gf_mul[ s ][ b[ col ][ c ] ];
+        }
+
+        for( int r = 0; r < n; r++ ) {
+
+            uint8_t f = a[ r ][ col ];
+
+            if( r == col || f == 0 ) {
+                continue;
+            }
+
+            gf_addmul( a[ r ], a[ col ], f, n );
+            gf_addmul( b[ r ], b[ col ], f, n );
+        }
+    }
+
+    memcpy( a, b, sizeof b );
+
+    return 0;
+}
+
+
+
+/* ================= ENCODE ================= */
+
+void fec_symbol( uint8_t *sym, const void *payload, size_t len, size_t size ) {
+
+    uint16_t l = ( uint16_t ) len;
+
+    memcpy( sym, &l, 2 );
+    memcpy( sym + 2, payload, len );
+    memset( sym + 2 + len, 0, size - 2 - len );
+}
+
+
+void fec_parity( int scheme, int k, int m, const uint8_t *const *data, size_t size, uint8_t **parity ) {
+
+    for( int j = 0; j < m; j++ ) {
+
+        memset( parity[ j ], 0, size );
+
+        for( int i = 0; i < k; i++ ) {
+            gf_addmul( parity[ j ], data[ i ], coef( scheme, m, j, i ), size );
+        }
+    }
+}
+
+
+
+/* ================= DECODE ================= */
+
+int fec_dec_init( fec_dec_t *dec ) {
+
+    memset( dec, 0, sizeof *dec );
+
+    dec -> mem = malloc( ( size_t ) ( FEC_WINDOW + 1 ) * FEC_MAXN * FEC_MAXSYM );
+
+    if( dec -> mem == NULL ) {
+        return -1;
+    }
+
+    for( int b = 0; b < FEC_WINDOW; b++ ) {
+        for( int i = 0; i < FEC_MAXN; i++ ) {
+            dec -> win[ b ].sym[ i ] = dec -> mem + ( ( size_t ) b * FEC_MAXN + i ) * FEC_MAXSYM;
+        }
+    }
+
+    dec -> scratch = dec -> mem + ( size_t ) FEC_WINDOW * FEC_MAXN * FEC_MAXSYM;
+
+    return 0;
+}
+
+
+void fec_dec_free( fec_dec_t *dec ) {
+
+    free( dec -> mem );
+    dec -> mem = NULL;
+}
+
+
+// rebuild the missing data symbols of a block from k received symbols
+static void recover( fec_dec_t *dec, fec_block_t *b, fec_deliver_fn deliver, void *arg ) {
+
+    struct timespec t0, t1;
+    clock_gettime( CLOCK_MONOTONIC, &t0 );
+
+    int lost[ FEC_MAXN ], par[ FEC_MAXN ], nl = 0, np = 0;
+
+    for( int i = 0; i < b -> k; i++ ) {
+        if( !b -> got[ i ] ) {
+            lost[ nl++ ] = i;
+        }
+    }
+
+    for( int j = b -> k; j < b -> k + b -> m && np < nl; j++ ) {
+        if( b -> got[ j ] ) {
+            par[ np++ ] = j;
+        }
+    }
+
+    size_t size = b -> size;
+
+
+    /* ---------- RIGHT-HAND SIDE : parity minus the data we have ---------- */
+
+    // Pj = sum over lost ( C * D ) + sum over received ( C * D )
+    // -> r_j = Pj + sum over received ( C * D ) = sum over lost ( C * D )
+
+    uint8_t *rhs[ FEC_MAXN ];
+
+    for( int r = 0; r < nl; r++ ) {
+
+        rhs[ r ] = dec -> scratch + ( size_t ) r * FEC_MAXSYM;
+        memcpy( rhs[ r ], b -> sym[ par[ r ] ], size );
+
+        for( int i = 0; i < b -> k; i++ ) {
+            if( b -> got[ i ] ) {
+                gf_addmul( rhs[ r ], b -> sym[ i ], coef( b -> scheme, b -> m, par[ r ] - b -> k, i ), size );
+            }
+        }
+    }
+
+
+    /* ---------- SOLVE : nl x nl system, D_lost = A^-1 * r ---------- */
+
+    uint8_t a[ FEC_MAXN ][ FEC_MAXN ];
+
+    for( int r = 0; r < nl; r++ ) {
+        for( int c = 0; c < nl; c++ ) {
+            a[ r ][ c ] = coef( b -> scheme, b -> m, par[ r ] - b -> k, lost[ c ] );
+        }
+    }
+
+    if( gf_invert( a, nl ) == -1 ) {
+        return;     // cannot happen with a Cauchy matrix
+    }
+
+    for( int c = 0; c < nl; c++ ) {
+
+        uint8_t *d = b -> sym[ lost[ c ] ];
+
+        memset( d, 0, size );
+
+        for( int r = 0; r < nl; r++ ) {
+            gf_addmul( d, rhs[ r ], a[ c ][ r ], size );
+        }
+
+        b -> got[ lost[ c ] ] = 1;
+        b -> data++;
+    }
+
+    b -> done = 1;
+
+    clock_gettime( CLOCK_MONOTONIC, &t1 );
+    dec -> decode_ns += ( t1.tv_sec - t0.tv_sec ) * 1000000000ll + ( t1.tv_nsec - t0.tv_nsec );
+
+
+    /* ---------- DELIVER ---------- */
+
+    for( int c = 0; c < nl; c++ ) {
+
+        uint8_t *d = b -> sym[ lost[ c ] ];
+        uint16_t len;
+
+        memcpy( &len, d, 2 );
+
+        if( len + 2u <= size ) {
+            deliver( d + 2, len, 1, arg );
+            dec -> recovered++;
+        }
+    }
+}
+
+
+int fec_dec_input( fec_dec_t *dec, const uint8_t *pkt, size_t n, fec_deliver_fn deliver, void *arg ) {
+
+    fec_hdr_t h;
+
+    if( n < sizeof h ) {
+        return -1;
+    }
+
+    memcpy( &h, pkt, sizeof h );
+
+    if( h.type == FEC_END ) {
+        return FEC_END;
+    }
+
+    if( ( h.type != FEC_DATA && h.type != FEC_PARITY ) || h.k < 1 || h.k + h.m > FEC_MAXN
+        || h.index >= h.k + h.m || ( h.scheme == FEC_NONE && h.m != 0 )
+        || ( h.scheme == FEC_XOR && h.m != 1 ) || ( h.scheme == FEC_RS && h.m < 1 ) || h.scheme > FEC_RS ) {
+        return -1;
+    }
+
+    const uint8_t *body = pkt + sizeof h;
+    size_t len = n - sizeof h;
+    fec_block_t *b = &dec -> win[ h.block % FEC_WINDOW ];
+
+
+    /* ---------- FIND / OPEN THE BLOCK ---------- */
+
+    if( !b -> used || b -> block != h.block ) {
+
+        // from a block already closed ( reordered, very late ) : data is still data
+        if( b -> used && ( int32_t ) ( h.block - b -> block ) < 0 ) {
+
+            if( h.type == FEC_DATA && len <= FEC_MAXPAYLOAD ) {
+                dec -> data_rx++;
+                deliver( body, len, 0, arg );
+            }
+
+            return h.type;
+        }
+
+        // the slot's old block is closed for good : whatever is missing stays missing
+        if( b -> used && !b -> done ) {
+            dec -> unusable++;
+        }
+
+        b -> used = 1;
+        b -> block = h.block;
+        b -> k = h.k;
+        b -> m = h.m;
+        b -> scheme = h.scheme;
+        b -> have = b -> data = b -> done = 0;
+        b -> size = 0;
+        memset( b -> got, 0, sizeof b -> got );
+    }
+
+    if( b -> got[ h.index ] || h.k != b -> k || h.m != b -> m ) {
+        return h.type;      // duplicate, or inconsistent with the rest of the block
+    }
+
+
+    /* ---------- STORE ---------- */
+
+    if( h.type == FEC_DATA ) {
+
+        if( h.index >= h.k || len > FEC_MAXPAYLOAD ) {
+            return -1;
+        }
+
+        // systematic : hand it over now, keep a copy in case a neighbour is lost
+        dec -> data_rx++;
+        deliver( body, len, 0, arg );
+
+        if( b -> done ) {
+            return h.type;
+        }
+
+        fec_symbol( b -> sym[ h.index ], body, len, FEC_MAXSYM );
+        b -> data++;
+
+    } else {
+
+        if( h.index < h.k || h.size < 3 || h.size > FEC_MAXSYM || len != h.size ) {
+            return -1;
+        }
+
+        dec -> parity_rx++;
+
+        if( b -> done ) {
+            return h.type;
+        }
+
+        memcpy( b -> sym[ h.index ], body, len );
+        b -> size = h.size;
+    }
+
+    b -> got[ h.index ] = 1;
+    b -> have++;
+
+    if( b -> data == b -> k ) {
+        b -> done = 1;
+    }
+
+
+    /* ---------- RECOVER ---------- */
+
+    // k symbols of any kind determine the whole block
+    if( !b -> done && b -> size && b -> have >= b -> k ) {
+        recover( dec, b, deliver, arg );
+    }
+
+    return h.type;
+}
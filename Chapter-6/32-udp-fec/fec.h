@@ -0,0 +1,124 @@
+/*
+    fec.h
+
+    Forward error correction for a UDP datagram stream
+
+    The stream is cut into blocks of k data datagrams. After each block
+    the sender adds m parity datagrams. The receiver rebuilds up to m
+    lost datagrams of a block from whatever arrived, without asking the
+    sender for anything.
+
+        block 7 :  D0  D1  D2  D3  D4  D5  D6  D7  | P0  P1       k = 8, m = 2
+                        ✗           ✗               ( any 2 of the 10 may be lost )
+
+    Schemes:
+        FEC_XOR  m = 1, P0 = D0 ^ D1 ^ ... ^ Dk-1  : one loss per block
+        FEC_RS   Reed-Solomon over GF(256), Cauchy matrix :
+                 Pj = sum( C[ j ][ i ] * Di ), any m losses per block
+
+    Data datagrams are sent as they are ( systematic code ) : the receiver
+    uses them immediately, parity is only needed when something is missing.
+
+    Datagrams of different sizes : every datagram is coded as a symbol
+    [ u16 length | payload | zero padding ] as long as the longest in the
+    block, so a rebuilt datagram also gets its length back.
+
+    On the wire every datagram starts with fec_hdr_t ( 12 bytes ).
+
+    Usage ( sender ):
+        fec_init();
+        fec_parity( FEC_RS, k, m, symbols, size, parity );
+
+    Usage ( receiver ):
+        fec_dec_t dec;
+        fec_dec_init( &dec );
+        fec_dec_input( &dec, buf, n, deliver, arg );     // every datagram
+        fec_dec_free( &dec );
+*/
+
+#ifndef FEC_H
+#define FEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FEC_MAXN        64      // k + m per block
+#define FEC_MAXPAYLOAD  1400    // so header + largest symbol fit one Ethernet frame
+#define FEC_MAXSYM      ( 2 + FEC_MAXPAYLOAD )
+#define FEC_WINDOW      16      // blocks the receiver keeps open at once
+
+// schemes
+#define FEC_NONE        0       // m = 0 : plain stream, for comparison
+#define FEC_XOR         1
+#define FEC_RS          2
+
+// datagram types
+#define FEC_DATA        1
+#define FEC_PARITY      2
+#define FEC_END         3       // end of stream, block = data datagrams sent
+
+
+// on the wire, before every payload / parity symbol
+typedef struct {
+
+    uint32_t block;             // block number
+    uint8_t  index;             // 0 .. k-1 data, k .. k+m-1 parity
+    uint8_t  k, m;
+    uint8_t  type;              // FEC_DATA, FEC_PARITY, FEC_END
+    uint8_t  scheme;            // FEC_XOR, FEC_RS
+    uint8_t  reserved;
+    uint16_t size;              // parity : symbol size of the block
+
+} fec_hdr_t;
+
+// one block being collected by the receiver
+typedef struct {
+
+    uint32_t block;
+    int used;
+    int k, m, scheme;
+    int have;                   // symbols received ( data + parity )
+    int data;                   // data symbols received or rebuilt
+    int done;                   // all k data symbols known
+    uint16_t size;              // symbol size, known once a parity arrives
+    uint8_t got[ FEC_MAXN ];
+    uint8_t *sym[ FEC_MAXN ];   // FEC_MAXSYM bytes each
+
+} fec_block_t;
+
+typedef struct {
+
+    fec_block_t win[ FEC_WINDOW ];
+    uint8_t *mem;
+    uint8_t *scratch;           // FEC_MAXN symbols, for decoding
+
+    uint64_t data_rx;           // data datagrams received
+    uint64_t parity_rx;         // parity datagrams received
+    uint64_t recovered;         // data datagrams rebuilt from parity
+    uint64_t unusable;          // blocks closed with data still missing
+    uint64_t decode_ns;         // time spent rebuilding
+
+} fec_dec_t;
+
+// called for every data payload, received ( recovered = 0 ) or rebuilt ( 1 )
+typedef void ( *fec_deliver_fn )( const uint8_t *payload, size_t len, int recovered, void *arg );
+
+
+// build the GF(256) tables, once, before anything else
+void fec_init( void );
+
+// m parity symbols from k data symbols, all 'size' bytes
+void fec_parity( int scheme, int k, int m, const uint8_t *const *data, size_t size, uint8_t **parity );
+
+// data symbol for a payload : [ u16 len | payload | zeros up to size ]
+void fec_symbol( uint8_t *sym, const void *payload, size_t len, size_t size );
+
+// returns 0, or -1 when out of memory
+int fec_dec_init( fec_dec_t *dec );
+void fec_dec_free( fec_dec_t *dec );
+
+// one received datagram ( header included )
+// returns its type, or -1 if it is not a valid FEC datagram
+int fec_dec_input( fec_dec_t *dec, const uint8_t *pkt, size_t n, fec_deliver_fn deliver, void *arg );
+
+#endif
@@ -0,0 +1,265 @@
+/*
+   udp_listener.c
+
+   Receiving end of the FEC stream from udp_talker.c
+   ( 09-unconnected-UDP-socket/udp_listener.c + fec.c decoder )
+
+   Every datagram goes through fec_dec_input() :
+    - data is handed over at once
+    - when a block has lost datagrams and enough parity has arrived,
+      the missing ones are rebuilt and handed over too
+
+   Each delivered payload is checked byte for byte against what the
+   talker generated. At END the listener reports how many datagrams
+   arrived, how many FEC rebuilt, how many are still missing, the
+   bandwidth parity cost, and how late rebuilt datagrams were.
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 udp_listener.c fec.c -o udp_listener
+
+   Run:
+    ./udp_listener
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+
+#include "fec.h"
+
+#define MYPORT "4950"       // Port we listen on
+#define MAXBUFLEN 2048
+#define RCVBUF ( 4 << 20 )  // synthetic loss only : the socket should not add its own
+
+
+// what the listener learned, filled in by the deliver callback
+typedef struct {
+
+    uint8_t *seen;              // one byte per sequence number
+    uint64_t cap;
+
+    uint64_t direct, rebuilt, duplicate, corrupt;
+    uint64_t direct_delay_ns, rebuilt_delay_ns, rebuilt_max_ns;
+
+} stream_t;
+
+
+uint64_t now_ns( clockid_t clk ) {
+
+    struct timespec ts;
+    clock_gettime( clk, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+// fec_deliver_fn : check one payload against the talker's generator
+void deliver( const uint8_t *payload, size_t len, int recovered, void *arg ) {
+
+    stream_t *st = arg;
+    uint64_t seq, sent;
+
+    if( len < 16 ) {
+        st -> corrupt++;
+        return;
+    }
+
+    memcpy( &seq, payload, 8 );
+    memcpy( &sent, payload + 8, 8 );
+
+    for( size_t i = 16; i < len; i++ ) {
+        if( payload[ i ] != ( uint8_t ) ( seq + i ) ) {
+            st -> corrupt++;
+            return;
+        }
+    }
+
+    if( seq >= st -> cap ) {
+
+        uint64_t old = st -> cap;
+
+        while( seq >= st -> cap ) {
+            st -> cap = st -> cap ? st -> cap * 2 : 1 << 20;
+        }
+
+        st -> seen = realloc( st -> seen, st -> cap );
+        memset( st -> seen + old, 0, st -> cap - old );
+    }
+
+    if( st -> seen[ seq ] ) {
+        st -> duplicate++;
+        return;
+    }
+
+    st -> seen[ seq ] = 1;
+
+    // same host : the talker's CLOCK_REALTIME is ours
+    uint64_t delay = now_ns( CLOCK_REALTIME ) - sent;
+
+    if( recovered ) {
+
+        st -> rebuilt++;
+        st -> rebuilt_delay_ns += delay;
+
+        if( delay > st -> rebuilt_max_ns ) {
+            st -> rebuilt_max_ns = delay;
+        }
+
+    } else {
+
+        st -> direct++;
+        st -> direct_delay_ns += delay;
+    }
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( void ) {
+
+    int sockfd;
+    struct addrinfo hints, *servinfo, *p;
+    int rv;
+
+
+    /* STEP 1: SETUP HINTS + BIND */
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_INET6;   // force IPv6 ( IPv4 arrives as ::ffff:a.b.c.d )
+    hints.ai_socktype = SOCK_DGRAM; // UDP
+    hints.ai_flags    = AI_PASSIVE; // bind to my IP
+
+    rv = getaddrinfo( NULL, MYPORT, &hints, &servinfo );
+
+    if( rv != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( rv ) );
+        exit( 1 );
+    }
+
+    for( p = servinfo; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            perror( "listener: socket" );
+            continue;
+        }
+
+        if( bind( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            perror( "listener: bind" );
+            continue;
+        }
+
+        break;  // success
+    }
+
+    if( p == NULL ) {
+        fprintf( stderr, "listener: failed to bind\n" );
+        exit( 2 );
+    }
+
+    freeaddrinfo( servinfo );
+
+    int rcvbuf = RCVBUF;
+    setsockopt( sockfd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof rcvbuf );
+
+
+    /* STEP 2: DECODER */
+
+    fec_dec_t dec;
+    stream_t st;
+
+    fec_init();
+    memset( &st, 0, sizeof st );
+
+    if( fec_dec_init( &dec ) == -1 ) {
+        perror( "fec_dec_init" );
+        exit( 3 );
+    }
+
+    printf( "listener: waiting for an FEC stream on port %s...\n", MYPORT );
+    fflush( stdout );
+
+
+    /* STEP 3: RECEIVE UNTIL END */
+
+    uint8_t buf[ MAXBUFLEN ];
+    uint64_t end[ 4 ] = { 0, 0, 0, 0 };     // data sent, parity sent, data bytes, parity bytes
+    uint64_t invalid = 0;
+
+    while( 1 ) {
+
+        ssize_t n = recv( sockfd, buf, sizeof buf, 0 );
+
+        if( n == -1 ) {
+
+            if( errno == EINTR ) {
+                continue;
+            }
+
+            perror( "recv" );
+            exit( 1 );
+        }
+
+        int type = fec_dec_input( &dec, buf, n, deliver, &st );
+
+        if( type == FEC_END && n >= ( ssize_t ) ( sizeof( fec_hdr_t ) + sizeof end ) ) {
+            memcpy( end, buf + sizeof( fec_hdr_t ), sizeof end );
+            break;
+        }
+
+        if( type == -1 ) {
+            invalid++;
+        }
+    }
+
+
+    /* STEP 4: REPORT */
+
+    uint64_t total = end[ 0 ];
+    uint64_t missing_before = total > dec.data_rx ? total - dec.data_rx : 0;
+    uint64_t missing = total > st.direct + st.rebuilt ? total - st.direct - st.rebuilt : 0;
+
+    printf( "listener: %llu data datagrams sent\n", ( unsigned long long ) total );
+    printf( "  arrived          : %10llu   ( %.2f%% lost on the way )\n",
+            ( unsigned long long ) st.direct, total ? 100.0 * missing_before / total : 0.0 );
+    printf( "  rebuilt by FEC   : %10llu   ( %.1f%% of the lost ones )\n",
+            ( unsigned long long ) st.rebuilt, missing_before ? 100.0 * st.rebuilt / missing_before : 0.0 );
+    printf( "  still missing    : %10llu   ( residual loss %.3f%% )\n",
+            ( unsigned long long ) missing, total ? 100.0 * missing / total : 0.0 );
+    printf( "  parity received  : %10llu   of %llu sent, +%.1f%% bytes on the wire\n",
+            ( unsigned long long ) dec.parity_rx, ( unsigned long long ) end[ 1 ],
+            end[ 2 ] ? 100.0 * end[ 3 ] / end[ 2 ] : 0.0 );
+    printf( "  payload check    : %10llu   corrupt, %llu duplicate, %llu invalid datagrams\n",
+            ( unsigned long long ) st.corrupt, ( unsigned long long ) st.duplicate, ( unsigned long long ) invalid );
+
+    if( st.direct ) {
+        printf( "  delay            : arrived %.0f us, rebuilt %.0f us ( max %.0f us ), mean from send\n",
+                st.direct_delay_ns / 1e3 / st.direct,
+                st.rebuilt ? st.rebuilt_delay_ns / 1e3 / st.rebuilt : 0.0, st.rebuilt_max_ns / 1e3 );
+    }
+
+    if( st.rebuilt ) {
+        printf( "  decode cpu       : %.2f us per rebuilt datagram\n", dec.decode_ns / 1e3 / st.rebuilt );
+    }
+
+    fec_dec_free( &dec );
+    free( st.seen );
+    close( sockfd );
+
+    return 0;
+}
@@ -0,0 +1,358 @@
+/*
+   udp_talker.c
+
+   UDP stream with forward error correction
+   ( 09-unconnected-UDP-socket/udp_talker.c, sequence-numbered stream + FEC )
+
+   Every k data datagrams form a block; after each block m parity
+   datagrams are sent ( fec.h ). The listener rebuilds lost datagrams
+   from them, no retransmission, no round trip.
+
+   Synthetic loss, applied here before sendto() so runs are repeatable:
+    -l pct     average loss rate, data and parity alike
+    -b len     average length of a loss burst ( Gilbert-Elliott model ),
+               1 = independent losses
+
+   Payload of data datagram seq:
+    [ u64 seq | u64 send time ( CLOCK_REALTIME ns ) | bytes ( seq + i ) & 0xff ]
+   so the listener can check every rebuilt datagram byte for byte.
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 udp_talker.c fec.c -o udp_talker
+
+   Run:
+    ./udp_talker localhost                              ( RS k = 10, m = 2, no loss )
+    ./udp_talker localhost -x xor -k 10 -l 5
+    ./udp_talker localhost -x rs -k 20 -m 4 -l 5 -b 3 -V
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+
+#include "fec.h"
+
+#define SERVERPORT "4950"
+
+
+uint64_t now_ns( clockid_t clk ) {
+
+    struct timespec ts;
+    clock_gettime( clk, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+void sleep_until( uint64_t t ) {
+
+    struct timespec ts = { ( time_t ) ( t / 1000000000ull ), ( long ) ( t % 1000000000ull ) };
+
+    while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL ) == EINTR );
+}
+
+
+
+/* ================= SYNTHETIC LOSS ================= */
+
+// two states : good ( nothing lost ) and bad ( everything lost )
+// good -> bad with probability p, bad -> good with probability r = 1 / burst
+// long-run loss = p / ( p + r )
+typedef struct {
+
+    double p, r;
+    int bad;
+
+} loss_t;
+
+
+int lose( loss_t *l ) {
+
+    if( l -> p == 0 ) {
+        return 0;
+    }
+
+    l -> bad = l -> bad ? drand48() >= l -> r : drand48() < l -> p;
+
+    return l -> bad;
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int sockfd;
+    struct addrinfo hints, *servinfo, *p;
+    int rv;
+
+    long total = 100000;        // -n
+    long rate = 20000;          // -r : data datagrams per second, 0 = unpaced
+    int size = 200;             // -s : payload bytes ( largest with -V )
+    int vary = 0;               // -V : sizes 16 .. size
+    int scheme = FEC_RS;        // -x
+    int k = 10, m = 2;          // -k, -m
+    double loss = 0;            // -l : percent
+    double burst = 1;           // -b
+    long seed = 1;              // -S
+    int opt;
+
+
+    /* STEP 0: ARGS */
+
+    if( argc < 2 ) {
+        goto usage;
+    }
+
+    const char *host = argv[ 1 ];
+    optind = 2;
+
+    while( ( opt = getopt( argc, argv, "n:r:s:Vx:k:m:l:b:S:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'n': total = atol( optarg ); break;
+            case 'r': rate = atol( optarg ); break;
+            case 's': size = atoi( optarg ); break;
+            case 'V': vary = 1; break;
+            case 'k': k = atoi( optarg ); break;
+            case 'm': m = atoi( optarg ); break;
+            case 'l': loss = atof( optarg ) / 100; break;
+            case 'b': burst = atof( optarg ); break;
+            case 'S': seed = atol( optarg ); break;
+            case 'x':
+                scheme = !strcmp( optarg, "none" ) ? FEC_NONE : !strcmp( optarg, "xor" ) ? FEC_XOR
+                       : !strcmp( optarg, "rs" ) ? FEC_RS : -1;
+                break;
+            default: goto usage;
+        }
+    }
+
+    // XOR has exactly one parity per block, no FEC has none
+    if( scheme == FEC_XOR ) {
+        m = 1;
+    } else if( scheme == FEC_NONE ) {
+        m = 0;
+    }
+
+    if( total < 1 || rate < 0 || size < 16 || size > FEC_MAXPAYLOAD || scheme < 0 || k < 1 || m < 0
+        || k + m > FEC_MAXN || ( scheme == FEC_RS && m < 1 ) || loss < 0 || loss >= 1 || burst < 1 ) {
+usage:
+        fprintf( stderr, "usage: %s host [-n count] [-r pps] [-s size] [-V] [-x none|xor|rs] [-k data] [-m parity]\n"
+                         "       [-l loss%%] [-b burst] [-S seed]      ( k + m <= %d, size <= %d )\n",
+                 argv[ 0 ], FEC_MAXN, FEC_MAXPAYLOAD );
+        exit( 1 );
+    }
+
+    fec_init();
+    srand48( seed );
+
+    loss_t ls = { 0, 1 / burst, 0 };
+    ls.p = loss * ls.r / ( 1 - loss );
+
+
+    /* STEP 1: RESOLVE + SOCKET */
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_UNSPEC;  // IPv4 or IPv6
+    hints.ai_socktype = SOCK_DGRAM; // UDP
+
+    rv = getaddrinfo( host, SERVERPORT, &hints, &servinfo );
+
+    if( rv != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( rv ) );
+        exit( 2 );
+    }
+
+    for( p = servinfo; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            perror( "talker: socket" );
+            continue;
+        }
+
+        if( connect( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            perror( "talker: connect" );
+            continue;
+        }
+
+        break;
+    }
+
+    if( p == NULL ) {
+        fprintf( stderr, "talker: failed to create socket\n" );
+        exit( 2 );
+    }
+
+    freeaddrinfo( servinfo );
+
+
+    /* STEP 2: BLOCK BUFFERS */
+
+    // symbols of the current block, and one datagram ( header + symbol ) to send
+    uint8_t *syms = malloc( ( size_t ) FEC_MAXN * FEC_MAXSYM );
+    uint8_t pkt[ sizeof( fec_hdr_t ) + FEC_MAXSYM ];
+    const uint8_t *data[ FEC_MAXN ];
+    uint8_t *parity[ FEC_MAXN ];
+
+    for( int i = 0; i < FEC_MAXN; i++ ) {
+        data[ i ] = syms + ( size_t ) i * FEC_MAXSYM;
+    }
+
+
+    /* STEP 3: SEND */
+
+    uint64_t gap = rate ? 1000000000ull / rate : 0;
+    uint64_t start = now_ns( CLOCK_MONOTONIC ), next = start;
+    uint64_t encode_ns = 0, data_bytes = 0, parity_bytes = 0;
+    long parity_sent = 0, data_lost = 0, parity_lost = 0, blocks = 0;
+    int maxlen = 0;
+
+    fec_hdr_t h;
+    memset( &h, 0, sizeof h );
+    h.scheme = scheme;
+    h.m = m;
+
+    for( long seq = 0; seq < total; seq++ ) {
+
+        if( gap ) {
+            sleep_until( next );
+            next += gap;
+        }
+
+        // the last block may be short : its k says so
+        long first = seq - seq % k;
+        int bk = total - first < k ? ( int ) ( total - first ) : k;
+        int idx = seq % k;
+
+        int len = vary ? 16 + ( int ) ( ( uint64_t ) seq * 7919 % ( size - 15 ) ) : size;
+
+        uint8_t *payload = pkt + sizeof h;
+        uint64_t s = seq, t = now_ns( CLOCK_REALTIME );
+
+        memcpy( payload, &s, 8 );
+        memcpy( payload + 8, &t, 8 );
+
+        for( int i = 16; i < len; i++ ) {
+            payload[ i ] = ( uint8_t ) ( seq + i );
+        }
+
+        h.block = seq / k;
+        h.index = idx;
+        h.k = bk;
+        h.type = FEC_DATA;
+        h.size = 0;
+        memcpy( pkt, &h, sizeof h );
+
+        if( lose( &ls ) ) {
+            data_lost++;
+        } else {
+            send( sockfd, pkt, sizeof h + len, 0 );
+        }
+
+        data_bytes += sizeof h + len;
+
+        if( m == 0 ) {
+            continue;
+        }
+
+        // keep the symbol for the parity of this block
+        fec_symbol( syms + ( size_t ) idx * FEC_MAXSYM, payload, len, FEC_MAXSYM );
+
+        if( len > maxlen ) {
+            maxlen = len;
+        }
+
+        if( idx < bk - 1 ) {
+            continue;
+        }
+
+
+        /* ---------- END OF BLOCK : PARITY ---------- */
+
+        // parity of a short block starts right after its last data symbol
+        for( int j = 0; j < m; j++ ) {
+            parity[ j ] = syms + ( size_t ) ( bk + j ) * FEC_MAXSYM;
+        }
+
+        size_t symsize = 2 + maxlen;
+        uint64_t t0 = now_ns( CLOCK_MONOTONIC );
+
+        fec_parity( scheme, bk, m, data, symsize, parity );
+
+        encode_ns += now_ns( CLOCK_MONOTONIC ) - t0;
+        blocks++;
+
+        for( int j = 0; j < m; j++ ) {
+
+            h.index = bk + j;
+            h.type = FEC_PARITY;
+            h.size = symsize;
+            memcpy( pkt, &h, sizeof h );
+            memcpy( pkt + sizeof h, parity[ j ], symsize );
+
+            if( lose( &ls ) ) {
+                parity_lost++;
+            } else {
+                send( sockfd, pkt, sizeof h + symsize, 0 );
+            }
+
+            parity_sent++;
+            parity_bytes += sizeof h + symsize;
+        }
+
+        maxlen = 0;
+    }
+
+    double secs = ( now_ns( CLOCK_MONOTONIC ) - start ) / 1e9;
+
+
+    /* STEP 4: END MARKER */
+
+    usleep( 200000 );
+
+    // header, then what the listener needs for its report
+    uint64_t end[ 4 ] = { ( uint64_t ) total, ( uint64_t ) parity_sent, data_bytes, parity_bytes };
+
+    memset( &h, 0, sizeof h );
+    h.type = FEC_END;
+    memcpy( pkt, &h, sizeof h );
+    memcpy( pkt + sizeof h, end, sizeof end );
+
+    for( int i = 0; i < 3; i++ ) {
+        send( sockfd, pkt, sizeof h + sizeof end, 0 );
+    }
+
+    const char *name[] = { "none", "xor", "rs" };
+
+    printf( "talker: %s k = %d m = %d : %ld data + %ld parity datagrams in %.2f s ( +%.1f%% bytes )\n",
+            name[ scheme ], k, m, total, parity_sent, secs,
+            100.0 * parity_bytes / data_bytes );
+    printf( "talker: synthetic loss dropped %ld data ( %.2f%% ) and %ld parity datagrams\n",
+            data_lost, 100.0 * data_lost / total, parity_lost );
+
+    if( blocks ) {
+        printf( "talker: encode %.2f us per block, %.0f MB/s of data\n",
+                encode_ns / 1e3 / blocks, encode_ns ? data_bytes * 1e3 / encode_ns : 0.0 );
+    }
+
+    free( syms );
+    close( sockfd );
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+#!/bin/sh
+#
+#   bench.sh
+#
+#   Single wildcard socket vs one connected socket per peer, at several
+#   peer counts
+#
+#   Reports for each peer count and mode:
+#       time to set up one peer ( first datagram → first echo ), echoes
+#       per second, round trip p50 / p99, server CPU per echoed datagram
+#       ( without the cost of opening peer sockets )
+#
+#   Usage:
+#       ./bench.sh [host] [seconds] [peer counts ...]
+#
+#   Example:
+#       ./bench.sh ::1 5 100 1000 10000
+
+HOST=${1:-::1}
+SECS=${2:-5}
+[ $# -ge 2 ] && shift 2 || set --
+PEERS=${*:-100 1000 10000}
+SRV=/tmp/accept-bench-srv.$$
+CLI=/tmp/accept-bench-cli.$$
+
+printf "%7s %-10s %12s %10s %9s %9s %14s\n" "peers" "mode" "setup/peer" "echoes/s" "p50" "p99" "srv cpu/dgram"
+
+for P in $PEERS; do
+    for MODE in single connected; do
+
+        ./udp_server -m "$MODE" > "$SRV" &
+        SERVER=$!
+        sleep 0.3
+
+        ./udp_peers "$HOST" -P "$P" -d "$SECS" > "$CLI"
+
+        kill -INT $SERVER
+        wait $SERVER
+
+        # "( Y us each )", "Z per second", "p50 A us, p99 B us", "C us per datagram"
+        SETUP=$( awk '/set up/ { print $10 }' "$CLI" )
+        RATE=$( awk '/echoes in/ { print $8 }' "$CLI" )
+        P50=$( awk '/round trip/ { print $5 }' "$CLI" )
+        P99=$( awk '/round trip/ { print $8 }' "$CLI" )
+
+        if [ "$MODE" = single ]; then
+            CPU=$( awk '/cpu  / { print $5 }' "$SRV" )
+        else
+            CPU=$( awk '/cpu, split/ { print $14 }' "$SRV" )
+        fi
+
+        printf "%7s %-10s %9s us %10s %6s us %6s us %11s us\n" "$P" "$MODE" "$SETUP" "$RATE" "$P50" "$P99" "$CPU"
+    done
+done
+
+rm -f "$SRV" "$CLI"
@@ -0,0 +1,328 @@
+/*
+   udp_peers.c
+
+   Many UDP peers against one server : a load generator for udp_server.c
+   ( 10-connected-UDP-socket/udp_client.c, P times )
+
+   Every peer is its own connected socket, so its own source port :
+   to the server they are P different clients.
+
+   Phase 1, setup    : every peer sends one datagram and waits for the echo
+                       ( in connected mode : the server opens P sockets )
+   Phase 2, measured : -w requests in flight, spread round robin over all
+                       peers, for -d seconds; echoes per second and
+                       round-trip percentiles
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 udp_peers.c -o udp_peers
+
+   Run:
+    ./udp_peers ::1 -P 10000 -d 5
+    ./udp_peers 127.0.0.1 -P 100 -w 16 -s 200
+
+   Linux only ( epoll )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+
+#define PORT "5050"
+#define MAXSIZE 1400
+#define MAX_EVENTS 256
+
+
+// what every request carries, echoed back unchanged
+typedef struct {
+
+    uint64_t sent;      // CLOCK_MONOTONIC ns
+    uint32_t peer;
+    uint32_t round;     // stale echoes ( after a timeout ) are ignored
+
+} req_t;
+
+
+int *fds;
+int npeers, epfd;
+size_t size = 64;
+char out[ MAXSIZE ];
+
+
+uint64_t now_ns( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+int cmp_ll( const void *a, const void *b ) {
+
+    long long x = *( const long long * ) a, y = *( const long long * ) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+
+void send_req( int peer, uint32_t round ) {
+
+    req_t r = { now_ns(), ( uint32_t ) peer, round };
+
+    memcpy( out, &r, sizeof r );
+    send( fds[ peer ], out, size, 0 );
+}
+
+
+// one echo, or -1 : fills in which peer and the round trip
+int recv_echo( int fd, uint32_t round, int *peer, long long *rtt ) {
+
+    char in[ MAXSIZE ];
+    req_t r;
+
+    ssize_t n = recv( fd, in, sizeof in, 0 );
+
+    if( n < ( ssize_t ) sizeof r ) {
+        return -1;
+    }
+
+    memcpy( &r, in, sizeof r );
+
+    if( r.round != round || r.peer >= ( uint32_t ) npeers ) {
+        return -1;
+    }
+
+    *peer = r.peer;
+    *rtt = now_ns() - r.sent;
+
+    return 0;
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = PORT;
+    int window = 64;
+    double duration = 5;
+    int opt;
+
+    npeers = 1000;
+
+    if( argc < 2 ) {
+        goto usage;
+    }
+
+    optind = 2;
+
+    while( ( opt = getopt( argc, argv, "p:P:w:d:s:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'p': port = optarg; break;
+            case 'P': npeers = atoi( optarg ); break;
+            case 'w': window = atoi( optarg ); break;
+            case 'd': duration = atof( optarg ); break;
+            case 's': size = strtoul( optarg, NULL, 10 ); break;
+            default: goto usage;
+        }
+    }
+
+    if( optind != argc || npeers < 1 || window < 1 || window > npeers || duration <= 0
+        || size < sizeof( req_t ) || size > MAXSIZE ) {
+    usage:
+        fprintf( stderr, "usage: %s host [-p port] [-P peers] [-w in-flight] [-d seconds] [-s size]\n", argv[ 0 ] );
+        fprintf( stderr, "       1 <= in-flight <= peers, %zu <= size <= %d\n", sizeof( req_t ), MAXSIZE );
+        exit( 1 );
+    }
+
+    struct rlimit rl;
+    getrlimit( RLIMIT_NOFILE, &rl );
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit( RLIMIT_NOFILE, &rl );
+
+
+    /* ================= STEP 1: ONE CONNECTED SOCKET PER PEER ================= */
+
+    struct addrinfo hints, *res;
+
+    memset( &hints, 0, sizeof hints );
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    int status = getaddrinfo( argv[ 1 ], port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    fds = malloc( npeers * sizeof( int ) );
+    epfd = epoll_create1( 0 );
+
+    for( int i = 0; i < npeers; i++ ) {
+
+        fds[ i ] = socket( res -> ai_family, SOCK_DGRAM | SOCK_NONBLOCK, 0 );
+
+        if( fds[ i ] == -1 || connect( fds[ i ], res -> ai_addr, res -> ai_addrlen ) == -1 ) {
+            perror( "peers: socket / connect" );
+            exit( 1 );
+        }
+
+        struct epoll_event ev = { .events = EPOLLIN, .data.u32 = i };
+        epoll_ctl( epfd, EPOLL_CTL_ADD, fds[ i ], &ev );
+    }
+
+    freeaddrinfo( res );
+
+    struct epoll_event events[ MAX_EVENTS ];
+    uint32_t round = 0;
+
+
+    /* ================= STEP 2: SETUP, EVERY PEER ONCE ================= */
+
+    // window at a time, so the server's queue is not flooded with first datagrams
+    char *done = calloc( npeers, 1 );
+    int answered = 0, next = 0, inflight = 0, retries = 0;
+    uint64_t t0 = now_ns();
+
+    while( answered < npeers ) {
+
+        while( inflight < window && next < npeers ) {
+
+            if( !done[ next ] ) {
+                send_req( next, round );
+                inflight++;
+            }
+
+            next++;
+        }
+
+        int n = epoll_wait( epfd, events, MAX_EVENTS, 200 );
+
+        // nothing for 200 ms : resend to everyone still waiting
+        if( n == 0 ) {
+
+            if( ++retries > 20 ) {
+                fprintf( stderr, "peers: server does not answer ( %d of %d peers set up )\n", answered, npeers );
+                exit( 1 );
+            }
+
+            round++;
+            inflight = 0;
+            next = 0;
+            continue;
+        }
+
+        for( int i = 0; i < n; i++ ) {
+
+            int peer;
+            long long rtt;
+
+            while( recv_echo( fds[ events[ i ].data.u32 ], round, &peer, &rtt ) == 0 ) {
+
+                inflight--;
+
+                if( !done[ peer ] ) {
+                    done[ peer ] = 1;
+                    answered++;
+                }
+            }
+        }
+    }
+
+    double setup = ( now_ns() - t0 ) / 1e9;
+    free( done );
+
+    printf( "peers: %d peers set up in %.3f s ( %.1f us each )\n", npeers, setup, setup * 1e6 / npeers );
+
+
+    /* ================= STEP 3: MEASURED PHASE ================= */
+
+    long cap = 1 << 20, count = 0;
+    long long *rtts = malloc( cap * sizeof( long long ) );
+    long timeouts = 0;
+    int cursor = 0;
+
+    round++;
+    inflight = 0;
+
+    uint64_t start = now_ns(), end = start + ( uint64_t ) ( duration * 1e9 );
+
+    while( now_ns() < end ) {
+
+        while( inflight < window ) {
+            send_req( cursor, round );
+            cursor = ( cursor + 1 ) % npeers;
+            inflight++;
+        }
+
+        int n = epoll_wait( epfd, events, MAX_EVENTS, 200 );
+
+        // every request in flight counts as lost; start a fresh round
+        if( n == 0 ) {
+            timeouts += inflight;
+            inflight = 0;
+            round++;
+            continue;
+        }
+
+        for( int i = 0; i < n; i++ ) {
+
+            int peer;
+            long long rtt;
+
+            while( recv_echo( fds[ events[ i ].data.u32 ], round, &peer, &rtt ) == 0 ) {
+
+                inflight--;
+
+                if( count == cap ) {
+                    cap *= 2;
+                    rtts = realloc( rtts, cap * sizeof( long long ) );
+                }
+
+                rtts[ count++ ] = rtt;
+            }
+        }
+    }
+
+    double secs = ( now_ns() - start ) / 1e9;
+
+
+    /* ================= STEP 4: REPORT ================= */
+
+    printf( "peers: %ld echoes in %.2f s : %.0f per second, %ld timed out\n", count, secs, count / secs, timeouts );
+
+    if( count > 0 ) {
+
+        qsort( rtts, count, sizeof( long long ), cmp_ll );
+
+        printf( "peers: round trip p50 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n",
+                rtts[ count / 2 ] / 1e3, rtts[ ( long ) ( count * 0.99 ) ] / 1e3,
+                rtts[ ( long ) ( count * 0.999 ) ] / 1e3, rtts[ count - 1 ] / 1e3 );
+    }
+
+    for( int i = 0; i < npeers; i++ ) {
+        close( fds[ i ] );
+    }
+
+    free( rtts );
+    free( fds );
+    close( epfd );
+
+    return 0;
+}
@@ -0,0 +1,564 @@
+/*
+   udp_server.c
+
+   "accept()" for UDP : one connected socket per peer
+   ( 10-connected-UDP-socket/udp_server.c, for any number of peers )
+
+   Two ways to serve many UDP peers, same echo work :
+
+   -m single    : one wildcard socket, recvfrom()
+                  every datagram : look the sender up in a hash table,
+                  reply with sendto()
+
+   -m connected : the wildcard socket only sees a peer's FIRST datagram
+                  ( like listen() / accept() ), then :
+                      socket() + SO_REUSEPORT + bind( same port )
+                      + connect( peer )
+                  the kernel now delivers that peer's datagrams to its own
+                  socket ( 4-tuple match beats the wildcard ), so each
+                  session has its own receive queue and fd in epoll,
+                  and needs no lookup at all
+
+   Idle peers expire after -t seconds ( their socket is closed ).
+   Ctrl+C prints peers, datagrams, and CPU time per datagram.
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 udp_server.c -o udp_server
+
+   Run:
+    ./udp_server                    ( single socket )
+    ./udp_server -m connected
+
+   Linux only ( SO_REUSEPORT, epoll, timerfd )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/resource.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define PORT "5050"         // same port as 10-connected-UDP-socket
+#define BUFSIZE 2048
+#define HASH_BITS 16        // 65536 chains
+#define MAX_EVENTS 256
+#define DRAIN 64            // datagrams per socket per wakeup : keeps peers fair
+
+enum { SINGLE, CONNECTED };
+
+
+// one peer : its address, its socket ( connected mode ), its counters
+typedef struct peer {
+
+    struct sockaddr_in6 addr;       // IPv4 peers show up as ::ffff:a.b.c.d
+    int fd;                         // connected socket, -1 in single mode
+
+    uint64_t packets, bytes;
+    time_t last;                    // last datagram, for expiry
+
+    struct peer *next;              // hash chain
+    struct peer *newer, *older;     // LRU list : newest at head
+
+} peer_t;
+
+
+struct {
+
+    int mode;
+    int wild;                       // wildcard socket
+    int epfd;
+    struct sockaddr_in6 local;      // what the wildcard socket is bound to
+
+    peer_t *hash[ 1 << HASH_BITS ];
+    peer_t *head, *tail;            // LRU
+    long active;
+
+    uint64_t datagrams, via_wild, created, expired, lookups;
+    double open_cpu;                // CPU spent opening peer sockets
+
+} srv;
+
+
+volatile sig_atomic_t stop = 0;
+
+
+void on_signal( int sig ) {
+
+    ( void ) sig;
+    stop = 1;
+}
+
+
+// user + system CPU seconds of this process
+double cpu_sec( void ) {
+
+    struct rusage ru;
+    getrusage( RUSAGE_SELF, &ru );
+
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6
+         + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+
+// CPU seconds of this thread, finer than getrusage() for short spans
+double thread_cpu( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts );
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+
+/* ================= PEER TABLE ================= */
+
+unsigned hash_addr( const struct sockaddr_in6 *a ) {
+
+    // FNV-1a over address and port
+    const unsigned char *b = a -> sin6_addr.s6_addr;
+    uint32_t h = 2166136261u;
+
+    for( int i = 0; i < 16; i++ ) {
+        h = ( h ^ b[ i ] ) * 16777619u;
+    }
+
+    h = ( h ^ ( a -> sin6_port & 0xff ) ) * 16777619u;
+    h = ( h ^ ( a -> sin6_port >> 8 ) ) * 16777619u;
+
+    return h >> ( 32 - HASH_BITS );
+}
+
+
+int same_addr( const struct sockaddr_in6 *a, const struct sockaddr_in6 *b ) {
+
+    return a -> sin6_port == b -> sin6_port
+        && !memcmp( &a -> sin6_addr, &b -> sin6_addr, sizeof a -> sin6_addr );
+}
+
+
+peer_t *peer_find( const struct sockaddr_in6 *addr ) {
+
+    srv.lookups++;
+
+    for( peer_t *p = srv.hash[ hash_addr( addr ) ]; p; p = p -> next ) {
+        if( same_addr( &p -> addr, addr ) ) {
+            return p;
+        }
+    }
+
+    return NULL;
+}
+
+
+void lru_unlink( peer_t *p ) {
+
+    if( p -> newer ) p -> newer -> older = p -> older; else srv.head = p -> older;
+    if( p -> older ) p -> older -> newer = p -> newer; else srv.tail = p -> newer;
+}
+
+
+void lru_push( peer_t *p ) {
+
+    p -> newer = NULL;
+    p -> older = srv.head;
+
+    if( srv.head ) srv.head -> newer = p; else srv.tail = p;
+
+    srv.head = p;
+}
+
+
+void peer_drop( peer_t *p ) {
+
+    peer_t **pp = &srv.hash[ hash_addr( &p -> addr ) ];
+
+    while( *pp != p ) {
+        pp = &( *pp ) -> next;
+    }
+
+    *pp = p -> next;
+    lru_unlink( p );
+
+    if( p -> fd != -1 ) {
+        close( p -> fd );       // also leaves epoll
+    }
+
+    srv.active--;
+    free( p );
+}
+
+
+
+/* ================= ECHO ( the per-session work ) ================= */
+
+void serve( peer_t *p, const char *buf, ssize_t n ) {
+
+    p -> packets++;
+    p -> bytes += n;
+    srv.datagrams++;
+
+    if( p -> last != time( NULL ) ) {
+        p -> last = time( NULL );
+        lru_unlink( p );
+        lru_push( p );
+    }
+
+    // connected : no address to pass, no route lookup per send
+    if( p -> fd != -1 ) {
+        send( p -> fd, buf, n, 0 );
+    } else {
+        sendto( srv.wild, buf, n, 0, ( struct sockaddr * ) &p -> addr, sizeof p -> addr );
+    }
+}
+
+
+void dispatch( const struct sockaddr_in6 *from, const char *buf, ssize_t n );
+
+
+/* ================= "ACCEPT" : A SOCKET FOR A NEW PEER ================= */
+
+int open_connected( const struct sockaddr_in6 *peer ) {
+
+    int fd = socket( AF_INET6, SOCK_DGRAM | SOCK_NONBLOCK, 0 );
+    int yes = 1;
+
+    if( fd == -1 ) {
+        perror( "server: socket" );
+        return -1;
+    }
+
+    // same port as the wildcard socket : all of them in one reuseport group
+    setsockopt( fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes );
+    setsockopt( fd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof yes );
+
+    if( bind( fd, ( struct sockaddr * ) &srv.local, sizeof srv.local ) == -1
+        || connect( fd, ( const struct sockaddr * ) peer, sizeof *peer ) == -1 ) {
+        perror( "server: bind / connect" );
+        close( fd );
+        return -1;
+    }
+
+    return fd;
+}
+
+
+peer_t *peer_new( const struct sockaddr_in6 *addr ) {
+
+    peer_t *p = calloc( 1, sizeof *p );
+
+    if( p == NULL ) {
+        return NULL;
+    }
+
+    p -> addr = *addr;
+    p -> fd = -1;
+    p -> last = time( NULL );
+
+    unsigned h = hash_addr( addr );
+    p -> next = srv.hash[ h ];
+    srv.hash[ h ] = p;
+    lru_push( p );
+
+    srv.active++;
+    srv.created++;
+
+    if( srv.mode == SINGLE ) {
+        return p;
+    }
+
+    double t0 = thread_cpu();
+
+    p -> fd = open_connected( addr );
+
+    srv.open_cpu += thread_cpu() - t0;
+
+    // no socket ( out of fds ... ) : this peer is served from the wildcard
+    if( p -> fd == -1 ) {
+        return p;
+    }
+
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = p };
+    epoll_ctl( srv.epfd, EPOLL_CTL_ADD, p -> fd, &ev );
+
+    // between bind() and connect() the socket was an unconnected member of
+    // the group and may have been handed datagrams from OTHER peers :
+    // they are still in its queue, so pass them on by sender
+    char buf[ BUFSIZE ];
+    struct sockaddr_in6 from;
+    socklen_t len = sizeof from;
+    ssize_t n;
+
+    while( ( n = recvfrom( p -> fd, buf, sizeof buf, 0, ( struct sockaddr * ) &from, &len ) ) >= 0 ) {
+        dispatch( &from, buf, n );
+        len = sizeof from;
+    }
+
+    return p;
+}
+
+
+// a datagram that came with a sender address : wildcard socket, or strays
+void dispatch( const struct sockaddr_in6 *from, const char *buf, ssize_t n ) {
+
+    peer_t *p = peer_find( from );
+
+    if( p == NULL ) {
+        p = peer_new( from );
+    } else if( srv.mode == CONNECTED ) {
+        // sent before the peer's socket was connected : still answer it
+        srv.via_wild++;
+    }
+
+    if( p ) {
+        serve( p, buf, n );
+    }
+}
+
+
+
+/* ================= EVENT HANDLERS ================= */
+
+void on_wildcard( void ) {
+
+    char buf[ BUFSIZE ];
+    struct sockaddr_in6 from;
+
+    for( int i = 0; i < DRAIN; i++ ) {
+
+        socklen_t len = sizeof from;
+        ssize_t n = recvfrom( srv.wild, buf, sizeof buf, 0, ( struct sockaddr * ) &from, &len );
+
+        if( n == -1 ) {
+            return;
+        }
+
+        dispatch( &from, buf, n );
+    }
+}
+
+
+void on_peer( peer_t *p ) {
+
+    char buf[ BUFSIZE ];
+
+    for( int i = 0; i < DRAIN; i++ ) {
+
+        ssize_t n = recv( p -> fd, buf, sizeof buf, 0 );
+
+        if( n == -1 ) {
+
+            // ECONNREFUSED : the peer's port is gone ( ICMP unreachable )
+            if( errno == ECONNREFUSED ) {
+                peer_drop( p );
+            }
+
+            return;
+        }
+
+        serve( p, buf, n );
+    }
+}
+
+
+void expire( int idle ) {
+
+    time_t now = time( NULL );
+
+    while( srv.tail && now - srv.tail -> last >= idle ) {
+        peer_drop( srv.tail );
+        srv.expired++;
+    }
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = PORT;
+    int idle = 30;
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "m:p:t:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'm':
+                if( !strcmp( optarg, "single" ) ) srv.mode = SINGLE;
+                else if( !strcmp( optarg, "connected" ) ) srv.mode = CONNECTED;
+                else goto usage;
+                break;
+            case 'p': port = optarg; break;
+            case 't': idle = atoi( optarg ); break;
+            default: goto usage;
+        }
+    }
+
+    if( optind != argc || idle < 1 ) {
+    usage:
+        fprintf( stderr, "usage: %s [-m single|connected] [-p port] [-t idle-seconds]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+
+    /* ================= STEP 1: ONE FD PER PEER NEEDS A HIGH FD LIMIT ================= */
+
+    struct rlimit rl;
+    getrlimit( RLIMIT_NOFILE, &rl );
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit( RLIMIT_NOFILE, &rl );
+
+
+    /* ================= STEP 2: WILDCARD SOCKET ================= */
+
+    struct addrinfo hints, *res, *p;
+    int yes = 1;
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_INET6;     // Force IPv6 ( takes IPv4 too )
+    hints.ai_socktype = SOCK_DGRAM;   // UDP socket
+    hints.ai_flags    = AI_PASSIVE;   // Bind to my local IP
+
+    int status = getaddrinfo( NULL, port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        srv.wild = socket( p -> ai_family, p -> ai_socktype | SOCK_NONBLOCK, p -> ai_protocol );
+
+        if( srv.wild == -1 ) {
+            continue;
+        }
+
+        // connected mode : every peer socket joins this port's reuseport group
+        if( srv.mode == CONNECTED ) {
+            setsockopt( srv.wild, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes );
+            setsockopt( srv.wild, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof yes );
+        }
+
+        if( bind( srv.wild, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( srv.wild );
+            continue;
+        }
+
+        memcpy( &srv.local, p -> ai_addr, sizeof srv.local );
+        break;  // success
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        fprintf( stderr, "server: failed to bind\n" );
+        exit( 2 );
+    }
+
+
+    /* ================= STEP 3: EVENT LOOP ================= */
+
+    srv.epfd = epoll_create1( 0 );
+
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = NULL };
+    epoll_ctl( srv.epfd, EPOLL_CTL_ADD, srv.wild, &ev );
+
+    // expiry tick, once a second
+    int tfd = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK );
+    struct itimerspec its = { { 1, 0 }, { 1, 0 } };
+    timerfd_settime( tfd, 0, &its, NULL );
+
+    ev.data.ptr = &tfd;
+    epoll_ctl( srv.epfd, EPOLL_CTL_ADD, tfd, &ev );
+
+    struct sigaction sa;
+    memset( &sa, 0, sizeof sa );
+    sa.sa_handler = on_signal;
+    sigaction( SIGINT, &sa, NULL );
+    sigaction( SIGTERM, &sa, NULL );
+
+    printf( "server: %s mode on port %s, fd limit %llu\n", srv.mode == SINGLE ? "single socket" : "connected socket per peer",
+            port, ( unsigned long long ) rl.rlim_cur );
+    fflush( stdout );
+
+    double cpu0 = cpu_sec();
+    struct epoll_event events[ MAX_EVENTS ];
+
+    while( !stop ) {
+
+        int n = epoll_wait( srv.epfd, events, MAX_EVENTS, -1 );
+        int tick = 0;
+
+        for( int i = 0; i < n; i++ ) {
+
+            void *ptr = events[ i ].data.ptr;
+
+            if( ptr == NULL ) {
+                on_wildcard();
+            } else if( ptr == &tfd ) {
+                tick = 1;
+            } else {
+                on_peer( ptr );
+            }
+        }
+
+        // after the batch : expiry frees peers that later events may point to
+        uint64_t ticks;
+
+        if( tick && read( tfd, &ticks, sizeof ticks ) > 0 ) {
+            expire( idle );
+        }
+    }
+
+
+    /* ================= STEP 4: REPORT ================= */
+
+    double cpu = cpu_sec() - cpu0;
+
+    printf( "\nserver: %s\n", srv.mode == SINGLE ? "single socket" : "connected socket per peer" );
+    printf( "  peers       : %ld active, %llu created, %llu expired\n", srv.active,
+            ( unsigned long long ) srv.created, ( unsigned long long ) srv.expired );
+    printf( "  datagrams   : %llu echoed", ( unsigned long long ) srv.datagrams );
+
+    if( srv.mode == CONNECTED ) {
+        printf( ", %llu via the wildcard socket", ( unsigned long long ) srv.via_wild );
+    }
+
+    printf( "\n  lookups     : %llu ( %.3f per datagram )\n", ( unsigned long long ) srv.lookups,
+            srv.datagrams ? ( double ) srv.lookups / srv.datagrams : 0.0 );
+    printf( "  cpu         : %.2f s, %.2f us per datagram\n", cpu,
+            srv.datagrams ? cpu * 1e6 / srv.datagrams : 0.0 );
+
+    if( srv.mode == CONNECTED ) {
+        printf( "  cpu, split  : %.2f s opening peer sockets ( %.1f us each ), %.2f us per datagram for the rest\n",
+                srv.open_cpu, srv.created ? srv.open_cpu * 1e6 / srv.created : 0.0,
+                srv.datagrams ? ( cpu - srv.open_cpu ) * 1e6 / srv.datagrams : 0.0 );
+    }
+
+    while( srv.tail ) {
+        peer_drop( srv.tail );
+    }
+
+    close( tfd );
+    close( srv.epfd );
+    close( srv.wild );
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+#!/bin/sh
+#
+#   bench.sh
+#
+#   TCP vs rudp ( ordered, unordered ) across a lossy link
+#
+#   Reports for each loss rate and transport:
+#       bulk   : goodput, talker sending as fast as the transport takes it
+#       paced  : one-way delay percentiles at a fixed message rate
+#
+#   TCP runs twice : reno ( the same AIMD as rudp ) and bbr ( ignores loss ).
+#
+#   Needs root : builds two network namespaces joined by link_impair.
+#
+#   Usage:
+#       ./bench.sh [delay-ms] [Mbit/s] [paced msgs/s] [loss rates ...]
+#
+#   Example:
+#       ./bench.sh 10 50 200 0 1 5
+
+DELAY=${1:-10}
+RATE=${2:-50}
+PACE=${3:-200}
+[ $# -ge 3 ] && shift 3 || set --
+LOSSES=${*:-0 1 5}
+OUT=/tmp/rudp-bench.$$
+
+ip netns add rudp-a 2> /dev/null
+ip netns add rudp-b 2> /dev/null
+
+echo "link : $DELAY ms each way, $RATE Mbit/s, 100 packet queue; paced test at $PACE messages/s"
+echo
+printf "%5s  %-11s %10s   %s\n" "loss" "transport" "bulk" "paced : one-way delay, ms"
+printf "%5s  %-11s %10s   %6s %6s %6s %6s\n" "" "" "Mbit/s" "p50" "p90" "p99" "max"
+
+for L in $LOSSES; do
+
+    ./link_impair rudp-a rudp-b -l "$L" -d "$DELAY" -r "$RATE" -q 100 > /dev/null &
+    LINK=$!
+    sleep 0.5
+
+    for T in tcp-reno tcp-bbr rudp unordered; do
+
+        case $T in
+            tcp-*) MODE=tcp; CC="-c ${T#tcp-}" ;;
+            *)     MODE=$T;  CC= ;;
+        esac
+
+        # bulk
+        ip netns exec rudp-b ./rudp_listener -m "$MODE" > "$OUT" &
+        sleep 0.3
+        ip netns exec rudp-a ./rudp_talker 10.77.0.2 -m "$MODE" $CC -T 5 > /dev/null
+        wait $!
+        BULK=$( awk '/Mbit\/s/ { print $(NF-1) }' "$OUT" )
+
+        # paced
+        ip netns exec rudp-b ./rudp_listener -m "$MODE" > "$OUT" &
+        sleep 0.3
+        ip netns exec rudp-a ./rudp_talker 10.77.0.2 -m "$MODE" $CC -r "$PACE" -T 10 > /dev/null
+        wait $!
+
+        printf "%4s%%  %-11s %10s  " "$L" "$T" "$BULK"
+        awk '/one-way/ { printf " %6s %6s %6s %6s\n", $5, $8, $11, $17 }' "$OUT"
+    done
+
+    kill -INT $LINK
+    wait $LINK
+done
+
+ip netns del rudp-a
+ip netns del rudp-b
+rm -f "$OUT"
@@ -0,0 +1,367 @@
+/*
+   link_impair.c
+
+   A bad network link between two network namespaces, in user space
+
+       namespace A                                         namespace B
+       10.77.0.1  imp0 ◀═▶ [ link_impair : loss, rate, queue, delay ] ◀═▶ imp0  10.77.0.2
+
+   Each side gets a TUN device : every IP packet the namespace routes to
+   the other side comes out of the TUN fd here, and is written into the
+   other side's TUN fd after the impairments. Whatever runs on top
+   ( TCP, UDP, rudp ) crosses the same link, so comparisons are fair.
+
+   Impairments, per direction :
+    - loss    : each packet dropped with probability -l ( seeded, repeatable )
+    - rate    : a bottleneck of -r Mbit/s, packets wait their turn
+    - queue   : at most -q packets waiting at the bottleneck ( drop tail )
+    - delay   : -d ms one way, after the bottleneck
+
+   The namespaces must exist ( ip netns add ... ); the TUN devices and
+   their addresses are set up here. Ctrl+C prints what happened to the
+   packets.
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 link_impair.c -o link_impair
+
+   Run ( as root ):
+    ip netns add rudp-a && ip netns add rudp-b
+    ./link_impair rudp-a rudp-b -l 1 -d 10 -r 50 -q 100
+    ip netns exec rudp-b ./rudp_listener            ( other terminals )
+    ip netns exec rudp-a ./rudp_talker 10.77.0.2
+
+   Linux only ( TUN, setns )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <time.h>
+
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <linux/if_tun.h>
+
+#define IFNAME "imp0"
+#define MAXPKT 2048
+#define RING 8192               // packets held per direction ( queued + delayed )
+
+
+// one direction of the link
+typedef struct {
+
+    int in, out;                // read from in's TUN, write to out's TUN
+    char ( *pkt )[ MAXPKT ];
+    int len[ RING ];
+    uint64_t sent[ RING ];      // leaves the bottleneck
+    uint64_t due[ RING ];       // written to the other side
+    int head, count;
+    uint64_t link_free;         // bottleneck busy until
+
+    uint64_t packets, lost, dropped, delivered;
+
+} dir_t;
+
+
+struct {
+
+    double loss;                // 0 .. 1
+    double mbit;                // 0 = no bottleneck
+    int queue;
+    uint64_t delay;             // ns
+    uint64_t rng;
+
+} cfg = { 0, 0, 100, 0, 1 };
+
+
+volatile sig_atomic_t stop = 0;
+
+
+void on_signal( int sig ) {
+
+    ( void ) sig;
+    stop = 1;
+}
+
+
+uint64_t now_ns( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+// xorshift64* : seeded, so every run loses the same packets
+double random01( void ) {
+
+    cfg.rng ^= cfg.rng >> 12;
+    cfg.rng ^= cfg.rng << 25;
+    cfg.rng ^= cfg.rng >> 27;
+
+    return ( cfg.rng * 2685821657736338717ull >> 11 ) * ( 1.0 / 9007199254740992.0 );
+}
+
+
+
+/* ================= TUN DEVICE INSIDE A NAMESPACE ================= */
+
+int set_addr( int s, unsigned long req, const char *ip ) {
+
+    struct ifreq ifr;
+    struct sockaddr_in *sin = ( struct sockaddr_in * ) &ifr.ifr_addr;
+
+    memset( &ifr, 0, sizeof ifr );
+    strncpy( ifr.ifr_name, IFNAME, IFNAMSIZ - 1 );
+    sin -> sin_family = AF_INET;
+    inet_pton( AF_INET, ip, &sin -> sin_addr );
+
+    return ioctl( s, req, &ifr );
+}
+
+
+int set_up( int s, const char *name ) {
+
+    struct ifreq ifr;
+
+    memset( &ifr, 0, sizeof ifr );
+    strncpy( ifr.ifr_name, name, IFNAMSIZ - 1 );
+
+    if( ioctl( s, SIOCGIFFLAGS, &ifr ) == -1 ) {
+        return -1;
+    }
+
+    ifr.ifr_flags |= IFF_UP | IFF_RUNNING;
+
+    return ioctl( s, SIOCSIFFLAGS, &ifr );
+}
+
+
+// enter the namespace, create its TUN, address it, come back
+int tun_in_netns( const char *ns, const char *local, const char *peer ) {
+
+    char path[ 256 ];
+    snprintf( path, sizeof path, "/var/run/netns/%s", ns );
+
+    int home = open( "/proc/self/ns/net", O_RDONLY );
+    int there = open( path, O_RDONLY );
+
+    if( home == -1 || there == -1 || setns( there, CLONE_NEWNET ) == -1 ) {
+        fprintf( stderr, "link: namespace %s : %s ( ip netns add %s, and run as root )\n", ns, strerror( errno ), ns );
+        exit( 1 );
+    }
+
+    // the TUN device is created in the namespace we are in right now
+    int fd = open( "/dev/net/tun", O_RDWR | O_NONBLOCK );
+
+    struct ifreq ifr;
+    memset( &ifr, 0, sizeof ifr );
+    ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+    strncpy( ifr.ifr_name, IFNAME, IFNAMSIZ - 1 );
+
+    int s = socket( AF_INET, SOCK_DGRAM, 0 );
+
+    if( fd == -1 || ioctl( fd, TUNSETIFF, &ifr ) == -1
+        || set_addr( s, SIOCSIFADDR, local ) == -1
+        || set_addr( s, SIOCSIFDSTADDR, peer ) == -1
+        || set_up( s, IFNAME ) == -1 || set_up( s, "lo" ) == -1 ) {
+        fprintf( stderr, "link: TUN in %s : %s\n", ns, strerror( errno ) );
+        exit( 1 );
+    }
+
+    close( s );
+    setns( home, CLONE_NEWNET );
+    close( home );
+    close( there );
+
+    return fd;
+}
+
+
+
+/* ================= ONE PACKET THROUGH THE LINK ================= */
+
+void enqueue( dir_t *d, const char *pkt, int len, uint64_t now ) {
+
+    d -> packets++;
+
+    if( random01() < cfg.loss ) {
+        d -> lost++;
+        return;
+    }
+
+    // packets still waiting for the bottleneck : the newest ones in the ring
+    int waiting = 0;
+
+    for( int i = d -> count - 1; i >= 0 && d -> sent[ ( d -> head + i ) % RING ] > now; i-- ) {
+        waiting++;
+    }
+
+    if( d -> count == RING || ( cfg.mbit > 0 && waiting >= cfg.queue ) ) {
+        d -> dropped++;
+        return;
+    }
+
+    uint64_t sent = now;
+
+    if( cfg.mbit > 0 ) {
+        uint64_t start = d -> link_free > now ? d -> link_free : now;
+        sent = start + ( uint64_t ) ( len * 8 * 1000.0 / cfg.mbit );
+        d -> link_free = sent;
+    }
+
+    int slot = ( d -> head + d -> count++ ) % RING;
+
+    memcpy( d -> pkt[ slot ], pkt, len );
+    d -> len[ slot ] = len;
+    d -> sent[ slot ] = sent;
+    d -> due[ slot ] = sent + cfg.delay;
+}
+
+
+// write out everything that is due; returns ns until the next one, -1 if none
+int64_t release( dir_t *d, uint64_t now ) {
+
+    while( d -> count && d -> due[ d -> head ] <= now ) {
+
+        if( write( d -> out, d -> pkt[ d -> head ], d -> len[ d -> head ] ) > 0 ) {
+            d -> delivered++;
+        }
+
+        d -> head = ( d -> head + 1 ) % RING;
+        d -> count--;
+    }
+
+    return d -> count ? ( int64_t ) ( d -> due[ d -> head ] - now ) : -1;
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int opt;
+
+    if( argc < 3 ) {
+        goto usage;
+    }
+
+    optind = 3;
+
+    while( ( opt = getopt( argc, argv, "l:d:r:q:S:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'l': cfg.loss = atof( optarg ) / 100; break;
+            case 'd': cfg.delay = ( uint64_t ) ( atof( optarg ) * 1e6 ); break;
+            case 'r': cfg.mbit = atof( optarg ); break;
+            case 'q': cfg.queue = atoi( optarg ); break;
+            case 'S': cfg.rng = strtoull( optarg, NULL, 10 ) | 1; break;
+            default: goto usage;
+        }
+    }
+
+    if( optind != argc || cfg.loss < 0 || cfg.loss > 1 || cfg.mbit < 0 || cfg.queue < 1 ) {
+    usage:
+        fprintf( stderr, "usage: %s netns-A netns-B [-l loss%%] [-d delay-ms] [-r Mbit/s] [-q queue-packets] [-S seed]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+
+    /* ================= STEP 1: BOTH ENDS OF THE LINK ================= */
+
+    int a = tun_in_netns( argv[ 1 ], "10.77.0.1", "10.77.0.2" );
+    int b = tun_in_netns( argv[ 2 ], "10.77.0.2", "10.77.0.1" );
+
+    dir_t dir[ 2 ] = { { .in = a, .out = b }, { .in = b, .out = a } };
+
+    for( int i = 0; i < 2; i++ ) {
+
+        dir[ i ].pkt = malloc( RING * sizeof *dir[ i ].pkt );
+
+        if( dir[ i ].pkt == NULL ) {
+            perror( "link: malloc" );
+            exit( 1 );
+        }
+    }
+
+    struct sigaction sa;
+    memset( &sa, 0, sizeof sa );
+    sa.sa_handler = on_signal;
+    sigaction( SIGINT, &sa, NULL );
+    sigaction( SIGTERM, &sa, NULL );
+
+    char rate[ 32 ] = "unlimited";
+
+    if( cfg.mbit > 0 ) {
+        snprintf( rate, sizeof rate, "%g Mbit/s", cfg.mbit );
+    }
+
+    printf( "link: %s 10.77.0.1 <-> %s 10.77.0.2 : loss %.2f%%, delay %.1f ms, rate %s, queue %d packets\n",
+            argv[ 1 ], argv[ 2 ], cfg.loss * 100, cfg.delay / 1e6, rate, cfg.queue );
+    fflush( stdout );
+
+
+    /* ================= STEP 2: FORWARD ================= */
+
+    struct pollfd pfd[ 2 ] = { { a, POLLIN, 0 }, { b, POLLIN, 0 } };
+    char pkt[ MAXPKT ];
+    int64_t wait = -1;
+
+    while( !stop ) {
+
+        struct timespec ts = { wait / 1000000000, wait % 1000000000 };
+
+        ppoll( pfd, 2, wait < 0 ? NULL : &ts, NULL );
+
+        uint64_t now = now_ns();
+
+        for( int i = 0; i < 2; i++ ) {
+
+            ssize_t n;
+
+            while( ( n = read( dir[ i ].in, pkt, sizeof pkt ) ) > 0 ) {
+                enqueue( &dir[ i ], pkt, n, now );
+            }
+        }
+
+        wait = -1;
+
+        for( int i = 0; i < 2; i++ ) {
+
+            int64_t next = release( &dir[ i ], now_ns() );
+
+            if( next >= 0 && ( wait < 0 || next < wait ) ) {
+                wait = next;
+            }
+        }
+    }
+
+
+    /* ================= STEP 3: REPORT ================= */
+
+    const char *name[ 2 ] = { "A -> B", "B -> A" };
+
+    printf( "\nlink: %-8s %10s %10s %10s %10s\n", "", "packets", "lost", "q-drops", "delivered" );
+
+    for( int i = 0; i < 2; i++ ) {
+        printf( "link: %-8s %10llu %10llu %10llu %10llu\n", name[ i ],
+                ( unsigned long long ) dir[ i ].packets, ( unsigned long long ) dir[ i ].lost,
+                ( unsigned long long ) dir[ i ].dropped, ( unsigned long long ) dir[ i ].delivered );
+    }
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+/*
+    msg.h
+
+    Test message shared by rudp_talker.c and rudp_listener.c
+
+    Every message starts with this header, the rest is filler up to -s
+    bytes. The same bytes go over TCP or rudp, so both carry exactly
+    the same load.
+
+        [ sent | seq | total | len | pad ][ filler ... ]
+          │      │     │       └ whole message, header included
+          │      │     └ 0, or on the END message : messages sent before it
+          │      └ 0, 1, 2 ...
+          └ CLOCK_MONOTONIC ns when the talker handed it to send() :
+            talker and listener share the clock ( one machine,
+            two network namespaces ), so delay is one way
+
+    Usage:
+        #include "msg.h"
+*/
+
+#ifndef MSG_H
+#define MSG_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define SERVERPORT "4950"
+#define MSG_MAX 1200            // = RUDP_MAXMSG : one message, one datagram
+
+
+typedef struct {
+
+    uint64_t sent;
+    uint32_t seq;
+    uint32_t total;
+    uint32_t len;
+    uint32_t pad;
+
+} msg_hdr_t;
+
+
+static inline uint64_t msg_now( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+#endif
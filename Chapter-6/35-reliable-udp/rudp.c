@@ -0,0 +1,657 @@
+/*
+    rudp.c
+
+    Reliable messages over connected UDP ( see rudp.h )
+
+    Compile together with the program that uses it:
+        gcc -Wall -Wextra -pedantic -O2 rudp.c your_program.c -o your_program
+*/
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/socket.h>
+
+#include "rudp.h"
+
+#define T_DATA      1
+#define T_ACK       2
+
+#define RTO_MIN     10000           // us
+#define RTO_MAX     2000000
+#define RTO_INIT    200000
+#define CWND_INIT   4
+#define RETRY_US    1000            // socket buffer full : try sending again this soon
+
+
+/* ================= WIRE FORMAT ================= */
+
+typedef struct {
+
+    uint8_t  type;                  // T_DATA, T_ACK
+    uint8_t  reserved;
+    uint16_t len;                   // DATA : payload bytes
+    uint32_t seq;                   // DATA : message number, ACK : all below are received
+    uint32_t ts;                    // DATA : sender clock ( us ), ACK : echo of the latest DATA ts
+
+} hdr_t;
+
+typedef struct {
+
+    hdr_t    h;
+    uint32_t edge;                  // sender may send seq < edge
+    uint8_t  sack[ RUDP_WINDOW / 8 ];   // bit i : seq + 1 + i received
+
+} ack_t;
+
+
+/* ================= STATE ================= */
+
+enum { S_FREE, S_QUEUED, S_INFLIGHT, S_LOST, S_SACKED };     // sender slot
+enum { R_EMPTY, R_HELD, R_DONE };                            // receiver slot
+
+typedef struct {
+
+    int state;
+    uint16_t len;
+    int tx;                         // transmissions so far
+    uint64_t sent_at;               // last transmission, us
+    char data[ RUDP_MAXMSG ];
+
+} sslot_t;
+
+typedef struct {
+
+    int state;
+    uint32_t seq;
+    uint16_t len;
+    char data[ RUDP_MAXMSG ];
+
+} rslot_t;
+
+struct rudp {
+
+    int fd, mode;
+
+    // sender : snd_una <= snd_sent <= snd_nxt
+    sslot_t snd[ RUDP_WINDOW ];
+    uint32_t snd_una;               // oldest not acknowledged
+    uint32_t snd_sent;              // next never sent
+    uint32_t snd_nxt;               // next to be queued by rudp_send()
+    uint32_t snd_edge;              // receiver's window edge
+    int inflight, lost;             // messages in S_INFLIGHT, S_LOST
+
+    double cwnd, ssthresh;
+    uint32_t recover;               // losses below this belong to the last loss event
+    uint64_t rack_xmit;             // send time of the newest message known delivered
+
+    double srtt, rttvar, min_rtt;   // us
+    uint64_t rto, rto_at;           // rto_at = 0 : timer off
+    uint64_t retry_at;              // a send found the socket buffer full, 0 = none
+
+    // receiver : rcv_read <= rcv_nxt
+    rslot_t rcv[ RUDP_WINDOW ];
+    uint32_t rcv_read;              // next to hand to the app ( ordered )
+    uint32_t rcv_nxt;               // all below are received
+    uint32_t adv_edge;              // edge in the last ACK
+    uint32_t ready[ RUDP_WINDOW ];  // unordered : arrived, not yet delivered
+    int ready_head, ready_count;
+    int ack_due;
+    uint32_t ack_ts;
+
+    rudp_stats_t st;
+};
+
+
+static int seq_lt( uint32_t a, uint32_t b ) {
+
+    return ( int32_t ) ( a - b ) < 0;
+}
+
+
+static uint64_t now_us( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+
+/* ================= SENDER ================= */
+
+static void send_data( rudp_t *r, uint32_t seq ) {
+
+    sslot_t *s = &r -> snd[ seq % RUDP_WINDOW ];
+    char pkt[ sizeof( hdr_t ) + RUDP_MAXMSG ];
+    uint64_t now = now_us();
+
+    hdr_t h = { T_DATA, 0, s -> len, seq, ( uint32_t ) now };
+
+    memcpy( pkt, &h, sizeof h );
+    memcpy( pkt + sizeof h, s -> data, s -> len );
+
+    // a full socket buffer is not a loss : try again soon. With nothing
+    // in flight no ACK will wake us, so the retry needs its own timer
+    if( send( r -> fd, pkt, sizeof h + s -> len, 0 ) == -1 && ( errno == EAGAIN || errno == ENOBUFS ) ) {
+        r -> retry_at = now + RETRY_US;
+        return;
+    }
+
+    if( s -> state == S_LOST ) {
+        r -> lost--;
+    }
+
+    if( s -> tx++ ) {
+        r -> st.resent++;
+    } else {
+        r -> st.sent++;
+    }
+
+    s -> state = S_INFLIGHT;
+    s -> sent_at = now;
+    r -> inflight++;
+
+    if( r -> rto_at == 0 ) {
+        r -> rto_at = now + r -> rto;
+    }
+}
+
+
+// retransmissions first, then new messages, as far as cwnd and the receiver allow
+static void transmit( rudp_t *r ) {
+
+    r -> retry_at = 0;
+
+    if( r -> lost ) {
+
+        for( uint32_t seq = r -> snd_una; seq_lt( seq, r -> snd_sent ) && r -> inflight < r -> cwnd; seq++ ) {
+            if( r -> snd[ seq % RUDP_WINDOW ].state == S_LOST ) {
+                send_data( r, seq );
+            }
+        }
+    }
+
+    while( seq_lt( r -> snd_sent, r -> snd_nxt ) && seq_lt( r -> snd_sent, r -> snd_edge )
+           && r -> inflight < r -> cwnd ) {
+
+        int before = r -> inflight;
+
+        send_data( r, r -> snd_sent );
+
+        if( r -> inflight == before ) {
+            break;      // socket buffer full
+        }
+
+        r -> snd_sent++;
+    }
+}
+
+
+static void rtt_sample( rudp_t *r, double rtt ) {
+
+    // RFC 6298
+    if( r -> srtt == 0 ) {
+        r -> srtt = rtt;
+        r -> rttvar = rtt / 2;
+        r -> min_rtt = rtt;
+    } else {
+        r -> rttvar = 0.75 * r -> rttvar + 0.25 * ( rtt > r -> srtt ? rtt - r -> srtt : r -> srtt - rtt );
+        r -> srtt = 0.875 * r -> srtt + 0.125 * rtt;
+    }
+
+    if( rtt < r -> min_rtt ) {
+        r -> min_rtt = rtt;
+    }
+
+    double rto = r -> srtt + 4 * r -> rttvar;
+
+    r -> rto = rto < RTO_MIN ? RTO_MIN : rto > RTO_MAX ? RTO_MAX : ( uint64_t ) rto;
+}
+
+
+static void loss_event( rudp_t *r, uint32_t seq ) {
+
+    // one window cut per round trip, however many messages it lost
+    if( seq_lt( seq, r -> recover ) ) {
+        return;
+    }
+
+    r -> ssthresh = r -> cwnd / 2 < 2 ? 2 : r -> cwnd / 2;
+    r -> cwnd = r -> ssthresh;
+    r -> recover = r -> snd_sent;
+}
+
+
+// a message reached the receiver ( cumulative or selective ack )
+static int delivered( rudp_t *r, sslot_t *s ) {
+
+    if( s -> state == S_INFLIGHT ) {
+        r -> inflight--;
+    } else if( s -> state == S_LOST ) {
+        r -> lost--;
+    } else {
+        return 0;       // already counted
+    }
+
+    if( s -> sent_at > r -> rack_xmit ) {
+        r -> rack_xmit = s -> sent_at;
+    }
+
+    return 1;
+}
+
+
+static void on_ack( rudp_t *r, const ack_t *a ) {
+
+    uint64_t now = now_us();
+    int newly = 0;
+
+    r -> st.acks_recv++;
+
+    if( seq_lt( r -> snd_edge, a -> edge ) ) {
+        r -> snd_edge = a -> edge;
+    }
+
+    // cumulative part : these slots are free again
+    uint32_t cum = a -> h.seq;
+
+    if( seq_lt( r -> snd_sent, cum ) ) {
+        return;     // acks what was never sent : ignore
+    }
+
+    while( seq_lt( r -> snd_una, cum ) ) {
+
+        sslot_t *s = &r -> snd[ r -> snd_una % RUDP_WINDOW ];
+
+        newly += delivered( r, s );
+        s -> state = S_FREE;
+        r -> snd_una++;
+    }
+
+    // selective part
+    for( int i = 0; i < RUDP_WINDOW; i++ ) {
+
+        uint32_t seq = cum + 1 + i;
+
+        if( !seq_lt( seq, r -> snd_sent ) ) {
+            break;
+        }
+
+        if( a -> sack[ i / 8 ] & ( 1 << ( i % 8 ) ) ) {
+
+            sslot_t *s = &r -> snd[ seq % RUDP_WINDOW ];
+
+            if( delivered( r, s ) ) {
+                s -> state = S_SACKED;
+                newly++;
+            }
+        }
+    }
+
+    // pure window updates echo an old timestamp : no RTT sample from them
+    if( newly == 0 ) {
+        return;
+    }
+
+    rtt_sample( r, ( uint32_t ) ( ( uint32_t ) now - a -> h.ts ) );
+
+    // congestion window : +1 per ack in slow start, +1 per window after,
+    // frozen while the losses of the last cut are being repaired
+    if( !seq_lt( r -> snd_una, r -> recover ) ) {
+
+        for( int i = 0; i < newly; i++ ) {
+            r -> cwnd += r -> cwnd < r -> ssthresh ? 1 : 1 / r -> cwnd;
+        }
+
+        if( r -> cwnd > RUDP_WINDOW ) {
+            r -> cwnd = RUDP_WINDOW;
+        }
+    }
+
+    // RACK : anything sent a reordering window before a delivered
+    // message, and still not delivered, is lost
+    uint64_t reo = ( uint64_t ) ( r -> min_rtt / 4 ) + 1000;
+
+    for( uint32_t seq = r -> snd_una; seq_lt( seq, r -> snd_sent ); seq++ ) {
+
+        sslot_t *s = &r -> snd[ seq % RUDP_WINDOW ];
+
+        if( s -> state == S_INFLIGHT && s -> sent_at + reo < r -> rack_xmit ) {
+            s -> state = S_LOST;
+            r -> inflight--;
+            r -> lost++;
+            r -> st.fast_losses++;
+            loss_event( r, seq );
+        }
+    }
+
+    // progress : restart the retransmission timer
+    r -> rto_at = r -> inflight ? now + r -> rto : 0;
+}
+
+
+static void on_timer( rudp_t *r ) {
+
+    if( r -> rto_at == 0 || now_us() < r -> rto_at ) {
+        return;
+    }
+
+    // nothing heard for a whole RTO : everything in flight is lost
+    for( uint32_t seq = r -> snd_una; seq_lt( seq, r -> snd_sent ); seq++ ) {
+
+        sslot_t *s = &r -> snd[ seq % RUDP_WINDOW ];
+
+        if( s -> state == S_INFLIGHT ) {
+            s -> state = S_LOST;
+            r -> inflight--;
+            r -> lost++;
+        }
+    }
+
+    r -> st.timeouts++;
+    r -> ssthresh = r -> cwnd / 2 < 2 ? 2 : r -> cwnd / 2;
+    r -> cwnd = 1;
+    r -> recover = r -> snd_sent;
+    r -> rto = r -> rto * 2 > RTO_MAX ? RTO_MAX : r -> rto * 2;
+    r -> rto_at = 0;
+}
+
+
+
+/* ================= RECEIVER ================= */
+
+static void send_ack( rudp_t *r ) {
+
+    ack_t a;
+    memset( &a, 0, sizeof a );
+
+    a.h.type = T_ACK;
+    a.h.seq = r -> rcv_nxt;
+    a.h.ts = r -> ack_ts;
+    a.edge = r -> rcv_read + RUDP_WINDOW;
+
+    for( int i = 0; i < RUDP_WINDOW - 1; i++ ) {
+
+        uint32_t seq = r -> rcv_nxt + 1 + i;
+        rslot_t *s = &r -> rcv[ seq % RUDP_WINDOW ];
+
+        if( s -> state != R_EMPTY && s -> seq == seq ) {
+            a.sack[ i / 8 ] |= 1 << ( i % 8 );
+        }
+    }
+
+    send( r -> fd, &a, sizeof a, 0 );
+
+    r -> adv_edge = a.edge;
+    r -> ack_due = 0;
+    r -> st.acks_sent++;
+}
+
+
+static void on_data( rudp_t *r, const hdr_t *h, const char *payload ) {
+
+    r -> ack_due = 1;
+    r -> ack_ts = h -> ts;
+
+    uint32_t seq = h -> seq;
+    rslot_t *s = &r -> rcv[ seq % RUDP_WINDOW ];
+
+    // already have it, or no room : the ACK tells the sender either way
+    if( seq_lt( seq, r -> rcv_nxt ) || ( s -> state != R_EMPTY && s -> seq == seq ) ) {
+        r -> st.dup_recv++;
+        return;
+    }
+
+    if( !seq_lt( seq, r -> rcv_read + RUDP_WINDOW ) || h -> len > RUDP_MAXMSG ) {
+        return;
+    }
+
+    s -> state = R_HELD;
+    s -> seq = seq;
+    s -> len = h -> len;
+    memcpy( s -> data, payload, h -> len );
+
+    if( r -> mode == RUDP_UNORDERED ) {
+        r -> ready[ ( r -> ready_head + r -> ready_count++ ) % RUDP_WINDOW ] = seq;
+    }
+
+    while( r -> rcv[ r -> rcv_nxt % RUDP_WINDOW ].state != R_EMPTY
+           && r -> rcv[ r -> rcv_nxt % RUDP_WINDOW ].seq == r -> rcv_nxt ) {
+        r -> rcv_nxt++;
+    }
+}
+
+
+// hand one message to the app, if the delivery mode allows one
+static ssize_t take( rudp_t *r, void *buf, size_t cap ) {
+
+    rslot_t *s;
+
+    if( r -> mode == RUDP_ORDERED ) {
+
+        s = &r -> rcv[ r -> rcv_read % RUDP_WINDOW ];
+
+        if( s -> state != R_HELD || s -> seq != r -> rcv_read ) {
+            return -1;
+        }
+
+    } else {
+
+        if( r -> ready_count == 0 ) {
+            return -1;
+        }
+
+        s = &r -> rcv[ r -> ready[ r -> ready_head ] % RUDP_WINDOW ];
+        r -> ready_head = ( r -> ready_head + 1 ) % RUDP_WINDOW;
+        r -> ready_count--;
+    }
+
+    size_t n = s -> len < cap ? s -> len : cap;
+    memcpy( buf, s -> data, n );
+    s -> state = R_DONE;
+    r -> st.delivered++;
+
+    // slots below the first undelivered message are free again
+    while( r -> rcv[ r -> rcv_read % RUDP_WINDOW ].state == R_DONE
+           && r -> rcv[ r -> rcv_read % RUDP_WINDOW ].seq == r -> rcv_read ) {
+        r -> rcv[ r -> rcv_read % RUDP_WINDOW ].state = R_EMPTY;
+        r -> rcv_read++;
+    }
+
+    // the sender may be stuck at the old edge : tell it about the room
+    if( seq_lt( r -> adv_edge, r -> rcv_nxt + RUDP_WINDOW / 2 ) ) {
+        r -> ack_due = 1;
+    }
+
+    return n;
+}
+
+
+
+/* ================= ENGINE ================= */
+
+// one round : wait for datagrams or a timer ( up to timeout_us, -1 = no
+// limit ), process them, send what is due
+static void run( rudp_t *r, int64_t timeout_us ) {
+
+    transmit( r );
+
+    if( r -> ack_due ) {
+        send_ack( r );
+    }
+
+    // the earlier of the two timers
+    uint64_t due = r -> rto_at;
+
+    if( r -> retry_at && ( due == 0 || r -> retry_at < due ) ) {
+        due = r -> retry_at;
+    }
+
+    if( due ) {
+
+        uint64_t now = now_us();
+        int64_t until = due > now ? ( int64_t ) ( due - now ) : 0;
+
+        if( timeout_us < 0 || until < timeout_us ) {
+            timeout_us = until;
+        }
+    }
+
+    struct pollfd pfd = { r -> fd, POLLIN, 0 };
+    struct timespec ts = { timeout_us / 1000000, ( timeout_us % 1000000 ) * 1000 };
+
+    ppoll( &pfd, 1, timeout_us < 0 ? NULL : &ts, NULL );
+
+    char pkt[ sizeof( hdr_t ) + RUDP_MAXMSG ];
+    ssize_t n;
+
+    while( ( n = recv( r -> fd, pkt, sizeof pkt, 0 ) ) >= ( ssize_t ) sizeof( hdr_t ) ) {
+
+        hdr_t h;
+        memcpy( &h, pkt, sizeof h );
+
+        if( h.type == T_DATA && n == ( ssize_t ) ( sizeof h + h.len ) ) {
+            on_data( r, &h, pkt + sizeof h );
+        } else if( h.type == T_ACK && n == sizeof( ack_t ) ) {
+            ack_t a;
+            memcpy( &a, pkt, sizeof a );
+            on_ack( r, &a );
+        }
+    }
+
+    // one ACK for everything that arrived in this round
+    if( r -> ack_due ) {
+        send_ack( r );
+    }
+
+    on_timer( r );
+    transmit( r );
+}
+
+
+static int64_t us_left( uint64_t deadline ) {
+
+    uint64_t now = now_us();
+
+    return now >= deadline ? 0 : ( int64_t ) ( deadline - now );
+}
+
+
+
+/* ================= API ================= */
+
+rudp_t *rudp_create( int fd, int mode ) {
+
+    rudp_t *r = calloc( 1, sizeof *r );
+
+    if( r == NULL ) {
+        return NULL;
+    }
+
+    fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+
+    r -> fd = fd;
+    r -> mode = mode;
+    r -> snd_edge = RUDP_WINDOW;
+    r -> adv_edge = RUDP_WINDOW;
+    r -> cwnd = CWND_INIT;
+    r -> ssthresh = RUDP_WINDOW;
+    r -> rto = RTO_INIT;
+
+    return r;
+}
+
+
+int rudp_send( rudp_t *r, const void *msg, size_t len ) {
+
+    if( len == 0 || len > RUDP_MAXMSG ) {
+        return -1;
+    }
+
+    // window full : run the protocol until the oldest message is acked
+    while( r -> snd_nxt - r -> snd_una >= RUDP_WINDOW ) {
+        run( r, -1 );
+    }
+
+    sslot_t *s = &r -> snd[ r -> snd_nxt % RUDP_WINDOW ];
+
+    s -> state = S_QUEUED;
+    s -> len = len;
+    s -> tx = 0;
+    memcpy( s -> data, msg, len );
+    r -> snd_nxt++;
+
+    run( r, 0 );
+
+    return 0;
+}
+
+
+ssize_t rudp_recv( rudp_t *r, void *buf, size_t cap, int timeout_ms ) {
+
+    uint64_t deadline = timeout_ms < 0 ? UINT64_MAX : now_us() + ( uint64_t ) timeout_ms * 1000;
+
+    while( 1 ) {
+
+        ssize_t n = take( r, buf, cap );
+
+        if( n >= 0 ) {
+            return n;
+        }
+
+        if( timeout_ms >= 0 && us_left( deadline ) == 0 ) {
+            return 0;
+        }
+
+        run( r, timeout_ms < 0 ? -1 : us_left( deadline ) );
+    }
+}
+
+
+int rudp_flush( rudp_t *r, int timeout_ms ) {
+
+    uint64_t deadline = now_us() + ( uint64_t ) timeout_ms * 1000;
+
+    while( r -> snd_una != r -> snd_nxt ) {
+
+        if( us_left( deadline ) == 0 ) {
+            return -1;
+        }
+
+        run( r, us_left( deadline ) );
+    }
+
+    return 0;
+}
+
+
+void rudp_poll( rudp_t *r, int timeout_us ) {
+
+    uint64_t deadline = now_us() + timeout_us;
+
+    do {
+        run( r, us_left( deadline ) );
+    } while( us_left( deadline ) > 0 );
+}
+
+
+void rudp_stats( rudp_t *r, rudp_stats_t *st ) {
+
+    *st = r -> st;
+    st -> srtt_ms = r -> srtt / 1000;
+    st -> rto_ms = r -> rto / 1000.0;
+    st -> cwnd = r -> cwnd;
+}
+
+
+void rudp_destroy( rudp_t *r ) {
+
+    free( r );
+}
@@ -0,0 +1,96 @@
+/*
+    rudp.h
+
+    Reliable messages over a connected UDP socket
+
+    The sender numbers every message. The receiver acknowledges what it
+    has, holes included. The sender resends only what is missing and
+    keeps no more in flight than the network seems to carry.
+
+        sender                                            receiver
+          │  DATA seq 7  ─────────────────────────────▶     │
+          │  DATA seq 8  ───────────── ✗                    │
+          │  DATA seq 9  ─────────────────────────────▶     │
+          │  ◀─────────  ACK cum 8, sack { 9 }, edge 264    │   "have < 8, and 9"
+          │  DATA seq 8  ─────────────────────────────▶     │   ( resent : 9 was
+          │  ◀─────────  ACK cum 10, edge 266               │     acked, 8 was not )
+
+    - sequence numbers : one per message, message = one datagram
+    - selective ACKs : cumulative ack + bitmap of the 256 messages after it
+    - sliding window : at most RUDP_WINDOW messages between the oldest
+      unacknowledged one and the newest sent; the receiver advertises
+      how far it has room ( edge )
+    - loss detection : a message is lost when one sent well after it
+      was acknowledged ( RACK ), or after a retransmission timeout
+      ( RTO = srtt + 4 * rttvar, from timestamps echoed in ACKs )
+    - congestion control : AIMD on a window of messages ( slow start,
+      halve on loss, back to 1 on timeout )
+
+    Delivery:
+        RUDP_ORDERED    messages come out of rudp_recv() in send order
+        RUDP_UNORDERED  each message comes out as soon as it arrives :
+                        a lost message delays only itself
+
+    The header is in host byte order ( like fec.h ) : both ends are
+    expected to run on machines of the same byte order.
+
+    Usage:
+        rudp_t *r = rudp_create( connected_udp_fd, RUDP_ORDERED );
+        rudp_send( r, msg, len );                  // blocks while the window is full
+        n = rudp_recv( r, buf, sizeof buf, 1000 ); // 0 on timeout
+        rudp_flush( r, 5000 );                     // until everything is acked
+        rudp_destroy( r );
+*/
+
+#ifndef RUDP_H
+#define RUDP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#define RUDP_MAXMSG     1200        // payload per message ( one datagram )
+#define RUDP_WINDOW     256         // messages in flight / buffered, = SACK bitmap bits
+
+#define RUDP_ORDERED    0
+#define RUDP_UNORDERED  1
+
+
+typedef struct rudp rudp_t;
+
+typedef struct {
+
+    uint64_t sent, resent;          // DATA datagrams : first copies, retransmissions
+    uint64_t acks_sent, acks_recv;
+    uint64_t delivered, dup_recv;   // messages to the app, duplicates dropped
+    uint64_t fast_losses, timeouts; // losses found by ACKs, retransmission timeouts
+    double srtt_ms, rto_ms, cwnd;   // now
+
+} rudp_stats_t;
+
+
+// fd : a connect()ed UDP socket, made non-blocking here
+// mode : RUDP_ORDERED or RUDP_UNORDERED ( receiving side )
+rudp_t *rudp_create( int fd, int mode );
+
+// queue one message ( 1 .. RUDP_MAXMSG bytes ); blocks while the send
+// window is full. Returns 0, or -1 if len is out of range
+int rudp_send( rudp_t *r, const void *msg, size_t len );
+
+// next message, waiting up to timeout_ms ( -1 = forever )
+// returns its length, 0 on timeout
+ssize_t rudp_recv( rudp_t *r, void *buf, size_t cap, int timeout_ms );
+
+// run the protocol ( ACKs, retransmissions ) for up to timeout_ms, or
+// until everything sent is acknowledged. Returns 0 when all is acked
+int rudp_flush( rudp_t *r, int timeout_ms );
+
+// run the protocol for timeout_us : answers a peer that still resends
+// ( after the last rudp_recv() ), or processes ACKs between paced sends
+void rudp_poll( rudp_t *r, int timeout_us );
+
+void rudp_stats( rudp_t *r, rudp_stats_t *st );
+
+void rudp_destroy( rudp_t *r );
+
+#endif
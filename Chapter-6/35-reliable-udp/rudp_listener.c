@@ -0,0 +1,332 @@
+/*
+   rudp_listener.c
+
+   Receives one message stream from rudp_talker and measures it
+   ( 10-connected-UDP-socket/udp_server.c : learn the peer, connect(),
+     then only talk to it )
+
+   -m tcp        : accept() one TCP connection
+   -m rudp       : rudp, messages in order
+   -m unordered  : rudp, each message as soon as it arrives
+
+   Reports :
+    - goodput : message bytes per second, first to last arrival
+    - one-way delay of every message : talker's send() → our recv()
+    - reliability check : missing, duplicate and out-of-order messages
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 rudp_listener.c rudp.c -o rudp_listener
+
+   Run:
+    ./rudp_listener -m unordered
+
+   Linux only ( rudp.c uses ppoll )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <netinet/in.h>
+
+#include "rudp.h"
+#include "msg.h"
+
+enum { M_TCP, M_RUDP, M_UNORDERED };
+
+static const char *mode_name[] = { "tcp", "rudp ( ordered )", "rudp ( unordered )" };
+
+
+int cmp_u64( const void *a, const void *b ) {
+
+    uint64_t x = *( const uint64_t * ) a, y = *( const uint64_t * ) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+
+// exactly len bytes from a TCP stream; 0 at end of stream
+ssize_t recv_all( int fd, char *buf, size_t len ) {
+
+    size_t got = 0;
+
+    while( got < len ) {
+
+        ssize_t n = recv( fd, buf + got, len - got, 0 );
+
+        if( n == 0 ) {
+            return 0;
+        }
+
+        if( n == -1 ) {
+
+            if( errno == EINTR ) {
+                continue;
+            }
+
+            perror( "listener: recv" );
+            exit( 1 );
+        }
+
+        got += n;
+    }
+
+    return got;
+}
+
+
+int open_socket( int socktype, const char *port ) {
+
+    struct addrinfo hints, *res, *p;
+    int fd = -1, yes = 1;
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_INET6;     // IPv6 socket, takes IPv4 too
+    hints.ai_socktype = socktype;
+    hints.ai_flags    = AI_PASSIVE;
+
+    int status = getaddrinfo( NULL, port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        fd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( fd == -1 ) {
+            continue;
+        }
+
+        setsockopt( fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes );
+
+        if( bind( fd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( fd );
+            continue;
+        }
+
+        break;
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        fprintf( stderr, "listener: failed to bind socket\n" );
+        exit( 2 );
+    }
+
+    return fd;
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = SERVERPORT;
+    int mode = M_RUDP;
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "m:p:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'm':
+                if( !strcmp( optarg, "tcp" ) ) mode = M_TCP;
+                else if( !strcmp( optarg, "rudp" ) ) mode = M_RUDP;
+                else if( !strcmp( optarg, "unordered" ) ) mode = M_UNORDERED;
+                else goto usage;
+                break;
+            case 'p': port = optarg; break;
+            default: goto usage;
+        }
+    }
+
+    if( optind != argc ) {
+    usage:
+        fprintf( stderr, "usage: %s [-m tcp|rudp|unordered] [-p port]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+
+    /* ================= STEP 1: ONE PEER ================= */
+
+    int sockfd;
+    rudp_t *rudp = NULL;
+
+    printf( "listener: %s on port %s, waiting for a talker...\n", mode_name[ mode ], port );
+    fflush( stdout );
+
+    if( mode == M_TCP ) {
+
+        int lfd = open_socket( SOCK_STREAM, port );
+
+        listen( lfd, 1 );
+        sockfd = accept( lfd, NULL, NULL );
+        close( lfd );
+
+    } else {
+
+        sockfd = open_socket( SOCK_DGRAM, port );
+
+        // peek at the first datagram for the peer's address : it stays
+        // queued for rudp to read after connect()
+        struct sockaddr_storage peer;
+        socklen_t len = sizeof peer;
+        char b;
+
+        recvfrom( sockfd, &b, 1, MSG_PEEK, ( struct sockaddr * ) &peer, &len );
+        connect( sockfd, ( struct sockaddr * ) &peer, len );
+
+        rudp = rudp_create( sockfd, mode == M_UNORDERED ? RUDP_UNORDERED : RUDP_ORDERED );
+    }
+
+
+    /* ================= STEP 2: RECEIVE UNTIL END + EVERYTHING BEFORE IT ================= */
+
+    size_t cap = 1 << 16;
+    uint64_t *delay = malloc( cap * sizeof( uint64_t ) );
+    unsigned char *seen = calloc( cap, 1 );
+
+    long received = 0, total = -1, dups = 0, out_of_order = 0;
+    uint64_t bytes = 0, first = 0, last = 0;
+    int64_t highest = -1;
+    char buf[ MSG_MAX ];
+
+    while( total < 0 || received < total ) {
+
+        msg_hdr_t h;
+        ssize_t n;
+
+        if( mode == M_TCP ) {
+
+            // header first : it says how long the whole message is
+            n = recv_all( sockfd, buf, sizeof h );
+
+            if( n > 0 ) {
+
+                memcpy( &h, buf, sizeof h );
+
+                if( h.len < sizeof h || h.len > MSG_MAX ) {
+                    fprintf( stderr, "listener: bad message length %u\n", h.len );
+                    exit( 1 );
+                }
+
+                if( h.len > sizeof h && recv_all( sockfd, buf + sizeof h, h.len - sizeof h ) == 0 ) {
+                    n = 0;
+                } else {
+                    n = h.len;
+                }
+            }
+
+        } else {
+
+            n = rudp_recv( rudp, buf, sizeof buf, 10000 );
+        }
+
+        uint64_t now = msg_now();
+
+        if( n <= 0 ) {
+            fprintf( stderr, "listener: stream ended / idle 10 s with %ld of %ld messages\n", received, total );
+            break;
+        }
+
+        memcpy( &h, buf, sizeof h );
+
+        if( h.total ) {
+            total = h.total;
+            continue;
+        }
+
+        if( h.seq >= cap ) {
+
+            size_t old = cap;
+
+            while( h.seq >= cap ) {
+                cap *= 2;
+            }
+
+            delay = realloc( delay, cap * sizeof( uint64_t ) );
+            seen = realloc( seen, cap );
+            memset( seen + old, 0, cap - old );
+        }
+
+        if( seen[ h.seq ] ) {
+            dups++;
+            continue;
+        }
+
+        seen[ h.seq ] = 1;
+
+        if( ( int64_t ) h.seq < highest ) {
+            out_of_order++;
+        } else {
+            highest = h.seq;
+        }
+
+        if( received == 0 ) {
+            first = now;
+        }
+
+        last = now;
+        delay[ received++ ] = now - h.sent;
+        bytes += n;
+    }
+
+
+    /* ================= STEP 3: REPORT ================= */
+
+    long missing = 0;
+
+    for( long i = 0; i < total; i++ ) {
+        missing += ( size_t ) i >= cap || !seen[ i ];
+    }
+
+    double secs = ( last - first ) / 1e9;
+
+    printf( "\nlistener: %s : %ld messages, %.1f MB in %.2f s : %.2f Mbit/s\n", mode_name[ mode ], received,
+            bytes / 1e6, secs, secs > 0 ? bytes * 8 / secs / 1e6 : 0.0 );
+
+    if( received > 0 ) {
+
+        qsort( delay, received, sizeof( uint64_t ), cmp_u64 );
+
+        printf( "  one-way delay : p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, p99.9 %.1f ms, max %.1f ms\n",
+                delay[ received / 2 ] / 1e6, delay[ ( long ) ( received * 0.9 ) ] / 1e6,
+                delay[ ( long ) ( received * 0.99 ) ] / 1e6,
+                delay[ ( long ) ( received * 0.999 ) ] / 1e6, delay[ received - 1 ] / 1e6 );
+    }
+
+    printf( "  check         : %ld missing, %ld duplicate, %ld out of order\n", missing, dups, out_of_order );
+
+    if( rudp ) {
+
+        // the talker may still resend the END if our last ACK was lost
+        rudp_poll( rudp, 500000 );
+
+        rudp_stats_t st;
+        rudp_stats( rudp, &st );
+
+        printf( "  rudp          : %llu duplicates dropped, %llu acks sent\n",
+                ( unsigned long long ) st.dup_recv, ( unsigned long long ) st.acks_sent );
+
+        rudp_destroy( rudp );
+    }
+
+    free( delay );
+    free( seen );
+    close( sockfd );
+
+    return missing || dups ? 1 : 0;
+}
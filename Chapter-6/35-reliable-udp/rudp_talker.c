@@ -0,0 +1,255 @@
+/*
+   rudp_talker.c
+
+   Sends a stream of messages over TCP or rudp
+   ( 10-connected-UDP-socket/udp_client.c, with every message delivered )
+
+   -m tcp   : one TCP connection, TCP_NODELAY, messages back to back;
+              -c picks its congestion control ( reno, cubic, bbr ... )
+   -m rudp  : connected UDP socket + rudp.c
+
+   Either as fast as the transport takes them ( bulk ), or paced at -r
+   messages per second ( latency ). Stops after -n messages or -T
+   seconds, then sends an END message with the total.
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 rudp_talker.c rudp.c -o rudp_talker
+
+   Run:
+    ./rudp_talker 10.77.0.2 -m rudp -T 5                ( bulk for 5 s )
+    ./rudp_talker 10.77.0.2 -m tcp -c reno -r 200 -T 10 ( 200 messages / s )
+
+   Linux only ( rudp.c uses ppoll )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "rudp.h"
+#include "msg.h"
+
+
+int tcp_mode;
+int sockfd;
+rudp_t *rudp;
+
+
+void send_all( const char *buf, size_t len ) {
+
+    if( !tcp_mode ) {
+        rudp_send( rudp, buf, len );
+        return;
+    }
+
+    while( len > 0 ) {
+
+        ssize_t n = send( sockfd, buf, len, 0 );
+
+        if( n == -1 ) {
+
+            if( errno == EINTR ) {
+                continue;
+            }
+
+            perror( "talker: send" );
+            exit( 1 );
+        }
+
+        buf += n;
+        len -= n;
+    }
+}
+
+
+// wait until t; rudp keeps processing ACKs meanwhile
+void wait_until( uint64_t t ) {
+
+    uint64_t now;
+
+    while( ( now = msg_now() ) < t ) {
+
+        if( tcp_mode ) {
+            struct timespec ts = { ( time_t ) ( t / 1000000000ull ), ( long ) ( t % 1000000000ull ) };
+            clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL );
+        } else {
+            rudp_poll( rudp, ( int ) ( ( t - now ) / 1000 ) );
+        }
+    }
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = SERVERPORT;
+    const char *cc = NULL;
+    size_t size = MSG_MAX;
+    double rate = 0, secs = 0;
+    long count = 0;
+    int opt;
+
+    if( argc < 2 ) {
+        goto usage;
+    }
+
+    optind = 2;
+
+    while( ( opt = getopt( argc, argv, "m:c:p:s:r:T:n:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'm':
+                if( !strcmp( optarg, "tcp" ) ) tcp_mode = 1;
+                else if( !strcmp( optarg, "rudp" ) || !strcmp( optarg, "unordered" ) ) tcp_mode = 0;
+                else goto usage;
+                break;
+            case 'c': cc = optarg; break;
+            case 'p': port = optarg; break;
+            case 's': size = strtoul( optarg, NULL, 10 ); break;
+            case 'r': rate = atof( optarg ); break;
+            case 'T': secs = atof( optarg ); break;
+            case 'n': count = atol( optarg ); break;
+            default: goto usage;
+        }
+    }
+
+    if( optind != argc || size < sizeof( msg_hdr_t ) || size > MSG_MAX || rate < 0
+        || ( secs <= 0 && count <= 0 ) ) {
+    usage:
+        fprintf( stderr, "usage: %s host [-m tcp|rudp] [-c tcp-cc] [-p port] [-s size] [-r msgs/s] [-T seconds] [-n messages]\n", argv[ 0 ] );
+        fprintf( stderr, "       %zu <= size <= %d, and -T or -n\n", sizeof( msg_hdr_t ), MSG_MAX );
+        exit( 1 );
+    }
+
+
+    /* ================= STEP 1: CONNECT ================= */
+
+    struct addrinfo hints, *res, *p;
+
+    memset( &hints, 0, sizeof hints );
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = tcp_mode ? SOCK_STREAM : SOCK_DGRAM;
+
+    int status = getaddrinfo( argv[ 1 ], port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            continue;
+        }
+
+        if( connect( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            continue;
+        }
+
+        break;
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        fprintf( stderr, "talker: failed to connect\n" );
+        exit( 2 );
+    }
+
+    if( tcp_mode ) {
+        int one = 1;
+        setsockopt( sockfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one );
+
+        // see /proc/sys/net/ipv4/tcp_available_congestion_control
+        if( cc && setsockopt( sockfd, IPPROTO_TCP, TCP_CONGESTION, cc, strlen( cc ) ) == -1 ) {
+            perror( "talker: TCP_CONGESTION" );
+            exit( 1 );
+        }
+    } else {
+        rudp = rudp_create( sockfd, RUDP_ORDERED );
+    }
+
+
+    /* ================= STEP 2: SEND ================= */
+
+    char buf[ MSG_MAX ];
+    memset( buf, 'x', sizeof buf );
+
+    msg_hdr_t h = { 0, 0, 0, ( uint32_t ) size, 0 };
+    uint64_t start = msg_now();
+    uint64_t end = secs > 0 ? start + ( uint64_t ) ( secs * 1e9 ) : UINT64_MAX;
+    uint64_t gap = rate > 0 ? ( uint64_t ) ( 1e9 / rate ) : 0;
+    long sent = 0;
+
+    while( ( count == 0 || sent < count ) && msg_now() < end ) {
+
+        if( gap ) {
+            wait_until( start + sent * gap );
+        }
+
+        h.sent = msg_now();
+        h.seq = sent++;
+        memcpy( buf, &h, sizeof h );
+
+        send_all( buf, size );
+    }
+
+    // END : the listener knows when it has everything
+    h.sent = msg_now();
+    h.seq = sent;
+    h.total = sent;
+    memcpy( buf, &h, sizeof h );
+    send_all( buf, size );
+
+    double took = ( msg_now() - start ) / 1e9;
+
+    printf( "talker: %s%s%s : %ld messages of %zu B in %.2f s\n", tcp_mode ? "tcp" : "rudp",
+            tcp_mode && cc ? " " : "", tcp_mode && cc ? cc : "", sent, size, took );
+
+
+    /* ================= STEP 3: WAIT UNTIL DELIVERED ================= */
+
+    if( tcp_mode ) {
+
+        // the kernel delivers the rest after close()
+        close( sockfd );
+        return 0;
+    }
+
+    if( rudp_flush( rudp, 30000 ) == -1 ) {
+        fprintf( stderr, "talker: not everything acknowledged after 30 s\n" );
+    }
+
+    rudp_stats_t st;
+    rudp_stats( rudp, &st );
+
+    printf( "talker: rudp : %llu sent, %llu resent ( %.2f%% ), %llu fast losses, %llu timeouts\n",
+            ( unsigned long long ) st.sent, ( unsigned long long ) st.resent,
+            st.sent ? 100.0 * st.resent / st.sent : 0.0,
+            ( unsigned long long ) st.fast_losses, ( unsigned long long ) st.timeouts );
+    printf( "talker: rudp : srtt %.1f ms, rto %.1f ms, cwnd %.1f, %llu acks received\n",
+            st.srtt_ms, st.rto_ms, st.cwnd, ( unsigned long long ) st.acks_recv );
+
+    rudp_destroy( rudp );
+    close( sockfd );
+
+    return 0;
+}
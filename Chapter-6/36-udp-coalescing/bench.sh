@@ -0,0 +1,72 @@
+#!/bin/sh
+#
+#   bench.sh
+#
+#   Datagrams, goodput and added delay of small messages vs flush deadline
+#
+#   Reports for each deadline ( 0 = a datagram per message ):
+#       paced : messages per datagram, datagrams/s, delay, CPU per message
+#               ( client CPU includes one sleep per message, for pacing )
+#       flat out : the most messages/s and goodput client + server reach
+#
+#   Needs root : runs in a network namespace whose loopback has a 1500
+#   byte MTU, like an Ethernet path ( the host's lo has 65536 ).
+#
+#   Usage:
+#       ./bench.sh [msgs/s] [message-bytes] [deadlines-us ...]
+#
+#   Example:
+#       ./bench.sh 50000 16 0 20 100 500 2000
+
+RATE=${1:-50000}
+SIZE=${2:-16}
+[ $# -ge 2 ] && shift 2 || set --
+DEADLINES=${*:-0 20 100 500 2000}
+NS=coal-bench
+OUT=/tmp/coal-bench.$$
+
+ip netns add $NS 2> /dev/null
+ip -n $NS link set lo mtu 1500 up
+
+run() {     # $1 deadline, $2 rate
+
+    ip netns exec $NS ./coal_server > "$OUT.s" &
+    sleep 0.3
+    ip netns exec $NS ./coal_client 127.0.0.1 -d "$1" -r "$2" -s "$SIZE" -T 5 > "$OUT.c"
+    wait
+
+    CCPU=$( awk '/client: cpu/ { print $5 }' "$OUT.c" )
+    awk -v d="$1" -v ccpu="$CCPU" '
+        / per datagram \)/  { per = $7 }
+        /datagrams\/s/      { dps = $2; mps = $4; gp = $7 }
+        /delay/             { p50 = $4; p99 = $7; max = $13 }
+        /lost/              { lost = $3 }
+        /server: cpu/       { scpu = $5 }
+        END { printf "%8s %9s %10s %10s %8s %8s %8s %8s %6s %7s %7s\n",
+                     d, per, dps, mps, gp, p50, p99, max, lost, ccpu, scpu }' "$OUT.s"
+}
+
+header() {
+    printf "%8s %9s %10s %10s %8s %8s %8s %8s %6s %15s\n" \
+           "deadline" "msgs per" "datagrams" "messages" "goodput" "delay" "" "" "lost" "cpu us / msg"
+    printf "%8s %9s %10s %10s %8s %8s %8s %8s %6s %7s %7s\n" \
+           "us" "datagram" "/ s" "/ s" "Mbit/s" "p50 us" "p99" "max" "" "client" "server"
+}
+
+echo "$SIZE B messages, path MTU 1500 ( up to 1472 B per datagram )"
+echo
+echo "== paced : $RATE messages/s"
+header
+for D in $DEADLINES; do
+    run "$D" "$RATE"
+done
+
+echo
+echo "== flat out : as many messages/s as client + server manage on this CPU"
+header
+for D in $DEADLINES; do
+    run "$D" 0
+done
+
+ip netns del $NS
+rm -f "$OUT.s" "$OUT.c"
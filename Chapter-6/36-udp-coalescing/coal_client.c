@@ -0,0 +1,246 @@
+/*
+   coal_client.c
+
+   Connected UDP client sending many small messages
+   ( 10-connected-UDP-socket/udp_client.c, with "Hello server" and
+     "Second message" sharing a datagram )
+
+   Every message goes through coalesce.c : it waits in a batch until the
+   batch is full ( path MTU ) or the oldest message in it is -d µs old.
+   -d 0 sends one datagram per message, the way udp_client.c does.
+
+   Message : [ u64 time handed to coal_send(), ns | u32 seq | filler ]
+   so the server can measure the delay the batching added.
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 coal_client.c coalesce.c -o coal_client
+
+   Run:
+    ./coal_client localhost -d 0                    ( a datagram per message )
+    ./coal_client localhost -d 200 -r 50000 -T 5    ( 50 000 messages / s, 200 µs deadline )
+
+   Linux only ( IP_MTU, IPV6_MTU, PR_SET_TIMERSLACK )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <sys/prctl.h>
+#include <netdb.h>
+
+#include "coalesce.h"
+
+#define PORT "5050"
+#define MSG_MIN 12      // time + seq
+
+
+uint64_t now_ns( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+double cpu_seconds( void ) {
+
+    struct rusage ru;
+    getrusage( RUSAGE_SELF, &ru );
+
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + ( ru.ru_utime.tv_usec + ru.ru_stime.tv_usec ) / 1e6;
+}
+
+
+void sleep_until( uint64_t t ) {
+
+    struct timespec ts = { ( time_t ) ( t / 1000000000ull ), ( long ) ( t % 1000000000ull ) };
+
+    while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL ) == EINTR ) {
+    }
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = PORT;
+    int deadline = 200;
+    size_t size = 16;
+    double rate = 0, secs = 5;
+    int opt;
+
+    if( argc < 2 ) {
+        goto usage;
+    }
+
+    optind = 2;
+
+    while( ( opt = getopt( argc, argv, "d:s:r:T:p:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'd': deadline = atoi( optarg ); break;
+            case 's': size = strtoul( optarg, NULL, 10 ); break;
+            case 'r': rate = atof( optarg ); break;
+            case 'T': secs = atof( optarg ); break;
+            case 'p': port = optarg; break;
+            default: goto usage;
+        }
+    }
+
+    if( optind != argc || deadline < 0 || size < MSG_MIN || size > 1024 || rate < 0 || secs <= 0 ) {
+    usage:
+        fprintf( stderr, "usage: %s host [-d deadline-us] [-s size] [-r msgs/s] [-T seconds] [-p port]\n", argv[ 0 ] );
+        fprintf( stderr, "       %d <= size <= 1024, -r 0 = as fast as possible\n", MSG_MIN );
+        exit( 1 );
+    }
+
+
+    /* ================= STEP 1: CONNECTED UDP SOCKET ================= */
+
+    struct addrinfo hints, *res, *p;
+    int sockfd = -1;
+
+    memset( &hints, 0, sizeof hints );
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    int status = getaddrinfo( argv[ 1 ], port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            continue;
+        }
+
+        if( connect( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            continue;
+        }
+
+        break;
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        fprintf( stderr, "client: failed to connect\n" );
+        exit( 2 );
+    }
+
+    // sleeps end on time, not up to 50 µs late ( default timer slack ) :
+    // otherwise a 20 µs deadline would really be 70 µs
+    prctl( PR_SET_TIMERSLACK, 1 );
+
+    coal_t *coal = coal_create( sockfd, deadline );
+    coal_stats_t st;
+
+    if( coal == NULL ) {
+        perror( "coal_create" );
+        exit( 1 );
+    }
+
+    coal_stats( coal, &st );
+
+    printf( "client: path MTU %d, up to %d B per datagram, deadline %d us\n", st.mtu, st.max_payload, deadline );
+
+
+    /* ================= STEP 2: SEND ================= */
+
+    char msg[ 1024 ];
+    memset( msg, 'x', sizeof msg );
+
+    uint64_t start = now_ns(), end = start + ( uint64_t ) ( secs * 1e9 );
+    uint64_t gap = rate > 0 ? ( uint64_t ) ( 1e9 / rate ) : 0;
+    uint64_t next = start, now;
+    uint32_t seq = 0;
+    double cpu0 = cpu_seconds();
+
+    while( ( now = now_ns() ) < end ) {
+
+        // every message due by now ( all of them if not paced ); a late
+        // wakeup sends the ones it missed in one go, keeping the rate
+        do {
+
+            memcpy( msg, &now, 8 );
+            memcpy( msg + 8, &seq, 4 );
+            seq++;
+
+            if( coal_send( coal, msg, size ) == -1 && errno != ECONNREFUSED ) {
+                perror( "client: send" );
+                exit( 1 );
+            }
+
+            next += gap;
+
+        } while( gap && next <= now );
+
+        if( gap == 0 ) {
+            continue;
+        }
+
+        // sleep until the next message, or until the batch is due
+        int64_t due = coal_timeout_us( coal );
+        uint64_t wake = next;
+
+        if( due >= 0 && now + due * 1000 < wake ) {
+            wake = now + due * 1000;
+        }
+
+        sleep_until( wake );
+        coal_tick( coal );
+    }
+
+    coal_flush( coal );
+
+    double took = ( now_ns() - start ) / 1e9;
+    double cpu = cpu_seconds() - cpu0;
+
+    // end of stream : an empty datagram, never a batch
+    for( int i = 0; i < 3; i++ ) {
+        send( sockfd, "", 0, 0 );
+        usleep( 10000 );
+    }
+
+
+    /* ================= STEP 3: REPORT ================= */
+
+    coal_stats( coal, &st );
+
+    printf( "client: %llu messages of %zu B in %llu datagrams ( %.1f per datagram ) in %.2f s\n",
+            ( unsigned long long ) st.messages, size, ( unsigned long long ) st.datagrams,
+            st.datagrams ? ( double ) st.messages / st.datagrams : 0.0, took );
+    printf( "client: sent because : full %llu, deadline %llu, flush %llu, re-cut for a smaller MTU %llu\n",
+            ( unsigned long long ) st.full, ( unsigned long long ) st.deadline,
+            ( unsigned long long ) st.flushed, ( unsigned long long ) st.splits );
+
+    if( st.oversize ) {
+        printf( "client: %llu messages too big for the path MTU, not sent\n", ( unsigned long long ) st.oversize );
+    }
+
+    printf( "client: cpu %.2f s, %.3f us per message\n", cpu, st.messages ? cpu * 1e6 / st.messages : 0.0 );
+
+    coal_destroy( coal );
+    close( sockfd );
+
+    return 0;
+}
@@ -0,0 +1,256 @@
+/*
+   coal_server.c
+
+   Connected UDP server unpacking coalesced messages
+   ( 10-connected-UDP-socket/udp_server.c : first datagram with
+     recvfrom(), connect(), then recv() )
+
+   Every datagram holds one or more length-prefixed messages from
+   coal_client; coal_next() walks them. Stops at the client's empty
+   end-of-stream datagram, or after 2 idle seconds.
+
+   Reports :
+    - datagrams / s and messages / s
+    - goodput : message bytes, not counting the length prefixes or headers
+    - delay of each message : client's coal_send() → unpacked here
+    - lost messages ( gaps in seq ), server CPU per message
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 coal_server.c coalesce.c -o coal_server
+
+   Run:
+    ./coal_server
+
+   Linux only ( IP_MTU, IPV6_MTU in coalesce.c )
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <netdb.h>
+
+#include "coalesce.h"
+
+#define PORT "5050"
+#define HIST_US 100000      // delay histogram : 1 µs buckets up to 100 ms
+
+
+uint64_t hist[ HIST_US + 1 ];
+
+
+uint64_t now_ns( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+double cpu_seconds( void ) {
+
+    struct rusage ru;
+    getrusage( RUSAGE_SELF, &ru );
+
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + ( ru.ru_utime.tv_usec + ru.ru_stime.tv_usec ) / 1e6;
+}
+
+
+// delay in µs below which a fraction q of the messages arrived
+long percentile( uint64_t total, double q ) {
+
+    uint64_t want = ( uint64_t ) ( total * q ), seen = 0;
+
+    if( want >= total ) {
+        want = total - 1;
+    }
+
+    for( long i = 0; i <= HIST_US; i++ ) {
+
+        seen += hist[ i ];
+
+        if( seen > want ) {
+            return i;
+        }
+    }
+
+    return HIST_US;
+}
+
+
+
+/* ================= MAIN FUNCTION ================= */
+
+int main( int argc, char *argv[] ) {
+
+    const char *port = PORT;
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "p:" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'p': port = optarg; break;
+            default: goto usage;
+        }
+    }
+
+    if( optind != argc ) {
+    usage:
+        fprintf( stderr, "usage: %s [-p port]\n", argv[ 0 ] );
+        exit( 1 );
+    }
+
+
+    /* ================= STEP 1: BIND ================= */
+
+    struct addrinfo hints, *res, *p;
+    int sockfd = -1;
+
+    memset( &hints, 0, sizeof hints );
+
+    hints.ai_family   = AF_INET6;     // IPv6 socket, takes IPv4 too
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags    = AI_PASSIVE;
+
+    int status = getaddrinfo( NULL, port, &hints, &res );
+
+    if( status != 0 ) {
+        fprintf( stderr, "getaddrinfo: %s\n", gai_strerror( status ) );
+        exit( 1 );
+    }
+
+    for( p = res; p != NULL; p = p -> ai_next ) {
+
+        sockfd = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( sockfd == -1 ) {
+            continue;
+        }
+
+        if( bind( sockfd, p -> ai_addr, p -> ai_addrlen ) == -1 ) {
+            close( sockfd );
+            continue;
+        }
+
+        break;
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        fprintf( stderr, "server: failed to bind\n" );
+        exit( 2 );
+    }
+
+    // room for bursts while the client has the CPU
+    int rcvbuf = 8 << 20;
+    setsockopt( sockfd, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof rcvbuf );
+
+    printf( "server: waiting for a client on port %s...\n", port );
+    fflush( stdout );
+
+
+    /* ================= STEP 2: FIRST DATAGRAM, THEN CONNECT ================= */
+
+    static char buf[ COAL_MAXDGRAM ];
+    struct sockaddr_storage peer;
+    socklen_t len = sizeof peer;
+
+    ssize_t n;
+
+    while( ( n = recvfrom( sockfd, buf, sizeof buf, 0, ( struct sockaddr * ) &peer, &len ) ) == -1 ) {
+
+        if( errno != EINTR ) {
+            perror( "recvfrom" );
+            exit( 1 );
+        }
+    }
+
+    connect( sockfd, ( struct sockaddr * ) &peer, len );
+
+    struct timeval idle = { 2, 0 };
+    setsockopt( sockfd, SOL_SOCKET, SO_RCVTIMEO, &idle, sizeof idle );
+
+
+    /* ================= STEP 3: UNPACK EVERY DATAGRAM ================= */
+
+    uint64_t datagrams = 0, messages = 0, bytes = 0, bad = 0;
+    uint64_t first = now_ns(), last = first;
+    int64_t highest = -1;
+    double cpu0 = cpu_seconds();
+
+    while( n > 0 ) {
+
+        last = now_ns();
+        datagrams++;
+
+        const char *pos = buf, *msg;
+        int l;
+
+        while( ( l = coal_next( &pos, buf + n, &msg ) ) > 0 ) {
+
+            uint64_t sent;
+            uint32_t seq;
+
+            memcpy( &sent, msg, 8 );
+            memcpy( &seq, msg + 8, 4 );
+
+            uint64_t us = last > sent ? ( last - sent ) / 1000 : 0;
+            hist[ us > HIST_US ? HIST_US : us ]++;
+
+            if( ( int64_t ) seq > highest ) {
+                highest = seq;
+            }
+
+            messages++;
+            bytes += l;
+        }
+
+        bad += l == -1;
+
+        // EINTR : nothing arrived, ask again ( n = -1 would end the loop )
+        do {
+            n = recv( sockfd, buf, sizeof buf, 0 );
+        } while( n == -1 && errno == EINTR );
+    }
+
+    double cpu = cpu_seconds() - cpu0;
+    double secs = ( last - first ) / 1e9;
+
+
+    /* ================= STEP 4: REPORT ================= */
+
+    printf( "server: %llu datagrams, %llu messages ( %.1f per datagram ) in %.2f s\n",
+            ( unsigned long long ) datagrams, ( unsigned long long ) messages,
+            datagrams ? ( double ) messages / datagrams : 0.0, secs );
+
+    if( secs > 0 ) {
+        printf( "server: %.0f datagrams/s, %.0f messages/s, goodput %.2f Mbit/s\n",
+                datagrams / secs, messages / secs, bytes * 8 / secs / 1e6 );
+    }
+
+    if( messages ) {
+        printf( "server: delay p50 %ld us, p99 %ld us, p99.9 %ld us, max %ld%s us\n",
+                percentile( messages, 0.5 ), percentile( messages, 0.99 ), percentile( messages, 0.999 ),
+                percentile( messages, 1.0 ), hist[ HIST_US ] ? "+" : "" );
+    }
+
+    printf( "server: lost %lld messages, %llu malformed datagrams\n",
+            ( long long ) ( highest + 1 - ( int64_t ) messages ), ( unsigned long long ) bad );
+    printf( "server: cpu %.2f s, %.3f us per message\n", cpu, messages ? cpu * 1e6 / messages : 0.0 );
+
+    close( sockfd );
+
+    return 0;
+}
@@ -0,0 +1,323 @@
+/*
+    coalesce.c
+
+    Small messages packed into path-MTU datagrams ( see coalesce.h )
+
+    Compile together with the program that uses it:
+        gcc -Wall -Wextra -pedantic -O2 coalesce.c your_program.c -o your_program
+*/
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "coalesce.h"
+
+#define MTU_RECHECK     1000000     // us : path MTU may grow back, ask again this often
+
+
+struct coal {
+
+    int fd, v6;
+    uint64_t deadline;              // us
+    uint64_t mtu_at;                // last asked for the path MTU
+
+    char buf[ COAL_MAXDGRAM ];      // the batch
+    size_t used;
+    uint64_t first_at;              // oldest message in the batch arrived, us
+
+    coal_stats_t st;
+};
+
+
+static uint64_t now_us( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+
+/* ================= PATH MTU ================= */
+
+// "don't fragment" : a datagram too big for the path fails with EMSGSIZE
+// instead of going out in fragments, and the kernel remembers the MTU
+// that ICMP "fragmentation needed" / "packet too big" reported
+static void pmtu_on( coal_t *c ) {
+
+    int v4 = IP_PMTUDISC_DO, v6 = IPV6_PMTUDISC_DO;
+
+    if( c -> v6 ) {
+        setsockopt( c -> fd, IPPROTO_IPV6, IPV6_MTU_DISCOVER, &v6, sizeof v6 );
+    }
+
+    // also for an IPv6 socket : covers IPv4-mapped peers
+    setsockopt( c -> fd, IPPROTO_IP, IP_MTU_DISCOVER, &v4, sizeof v4 );
+}
+
+
+static void pmtu_read( coal_t *c ) {
+
+    int mtu = 0;
+    socklen_t len = sizeof mtu;
+
+    if( c -> v6 ) {
+        getsockopt( c -> fd, IPPROTO_IPV6, IPV6_MTU, &mtu, &len );
+    } else {
+        getsockopt( c -> fd, IPPROTO_IP, IP_MTU, &mtu, &len );
+    }
+
+    if( mtu <= 0 ) {
+        mtu = c -> v6 ? 1280 : 576;     // smallest every path must carry
+    }
+
+    int payload = mtu - ( c -> v6 ? 40 : 20 ) - 8;
+
+    c -> st.mtu = mtu;
+    c -> st.max_payload = payload > COAL_MAXDGRAM ? COAL_MAXDGRAM : payload;
+    c -> mtu_at = now_us();
+}
+
+
+
+/* ================= SENDING A BATCH ================= */
+
+static int send_dgram( coal_t *c, const char *p, size_t n ) {
+
+    while( send( c -> fd, p, n, 0 ) == -1 ) {
+
+        if( errno != EINTR ) {
+            return -1;
+        }
+    }
+
+    c -> st.datagrams++;
+
+    return 0;
+}
+
+
+// the path MTU shrank after the batch was built : cut it at message
+// boundaries into datagrams that fit. A single message bigger than the
+// new limit cannot be sent : it is dropped and counted
+static int split( coal_t *c ) {
+
+    const char *pos = c -> buf, *end = c -> buf + c -> used;
+    const char *start = pos, *msg;
+    int rc = 0;
+
+    pmtu_read( c );
+    c -> st.splits++;
+
+    while( pos < end ) {
+
+        const char *here = pos;
+
+        if( coal_next( &pos, end, &msg ) <= 0 ) {
+            break;
+        }
+
+        if( pos - start > c -> st.max_payload && here > start ) {
+
+            rc |= send_dgram( c, start, here - start );
+            start = here;
+        }
+
+        if( pos - start > c -> st.max_payload ) {
+
+            c -> st.oversize++;
+            start = pos;
+        }
+    }
+
+    if( end > start ) {
+        rc |= send_dgram( c, start, end - start );
+    }
+
+    return rc;
+}
+
+
+static int send_batch( coal_t *c, uint64_t *why ) {
+
+    if( c -> used == 0 ) {
+        return 0;
+    }
+
+    int rc = send_dgram( c, c -> buf, c -> used );
+
+    if( rc == -1 && errno == EMSGSIZE ) {
+        rc = split( c );
+    }
+
+    ( *why )++;
+    c -> used = 0;
+
+    return rc;
+}
+
+
+
+/* ================= API ================= */
+
+coal_t *coal_create( int fd, int deadline_us ) {
+
+    coal_t *c = calloc( 1, sizeof *c );
+
+    if( c == NULL ) {
+        return NULL;
+    }
+
+    struct sockaddr_storage ss;
+    socklen_t len = sizeof ss;
+
+    getsockname( fd, ( struct sockaddr * ) &ss, &len );
+
+    c -> fd = fd;
+    c -> v6 = ss.ss_family == AF_INET6;
+    c -> deadline = deadline_us > 0 ? deadline_us : 0;
+
+    pmtu_on( c );
+    pmtu_read( c );
+
+    return c;
+}
+
+
+int coal_send( coal_t *c, const void *msg, size_t len ) {
+
+    if( len == 0 || len + 2 > ( size_t ) c -> st.max_payload ) {
+        c -> st.oversize += len > 0;
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    uint64_t now = now_us();
+    int rc = 0;
+
+    // the app may send without ever calling coal_tick() : the deadline
+    // is checked here too
+    if( c -> used && now >= c -> first_at + c -> deadline ) {
+        rc |= send_batch( c, &c -> st.deadline );
+    }
+
+    if( c -> used + 2 + len > ( size_t ) c -> st.max_payload ) {
+        rc |= send_batch( c, &c -> st.full );
+    }
+
+    if( c -> used == 0 ) {
+
+        c -> first_at = now;
+
+        // the limit may have shrunk : check the message against it again
+        if( now - c -> mtu_at > MTU_RECHECK ) {
+
+            pmtu_read( c );
+
+            if( len + 2 > ( size_t ) c -> st.max_payload ) {
+                c -> st.oversize++;
+                errno = EMSGSIZE;
+                return -1;
+            }
+        }
+    }
+
+    uint16_t l = htons( ( uint16_t ) len );
+
+    memcpy( c -> buf + c -> used, &l, 2 );
+    memcpy( c -> buf + c -> used + 2, msg, len );
+    c -> used += 2 + len;
+
+    c -> st.messages++;
+    c -> st.bytes += len;
+
+    if( c -> deadline == 0 ) {
+        rc |= send_batch( c, &c -> st.deadline );
+    } else if( c -> used + 3 > ( size_t ) c -> st.max_payload ) {
+        rc |= send_batch( c, &c -> st.full );          // not even 1 more byte fits
+    }
+
+    return rc;
+}
+
+
+int coal_flush( coal_t *c ) {
+
+    return send_batch( c, &c -> st.flushed );
+}
+
+
+int coal_tick( coal_t *c ) {
+
+    if( c -> used && now_us() >= c -> first_at + c -> deadline ) {
+        return send_batch( c, &c -> st.deadline );
+    }
+
+    return 0;
+}
+
+
+int64_t coal_timeout_us( coal_t *c ) {
+
+    if( c -> used == 0 ) {
+        return -1;
+    }
+
+    uint64_t now = now_us(), due = c -> first_at + c -> deadline;
+
+    return due > now ? ( int64_t ) ( due - now ) : 0;
+}
+
+
+int coal_timeout( coal_t *c ) {
+
+    int64_t us = coal_timeout_us( c );
+
+    return us < 0 ? -1 : ( int ) ( ( us + 999 ) / 1000 );
+}
+
+
+void coal_stats( coal_t *c, coal_stats_t *st ) {
+
+    *st = c -> st;
+}
+
+
+void coal_destroy( coal_t *c ) {
+
+    coal_flush( c );
+    free( c );
+}
+
+
+int coal_next( const char **pos, const char *end, const char **msg ) {
+
+    if( *pos == end ) {
+        return 0;
+    }
+
+    if( end - *pos < 2 ) {
+        return -1;
+    }
+
+    uint16_t l;
+    memcpy( &l, *pos, 2 );
+    l = ntohs( l );
+
+    if( l == 0 || end - *pos - 2 < l ) {
+        return -1;
+    }
+
+    *msg = *pos + 2;
+    *pos += 2 + l;
+
+    return l;
+}
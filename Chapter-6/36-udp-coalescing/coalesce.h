@@ -0,0 +1,94 @@
+/*
+    coalesce.h
+
+    Packs small messages into MTU-sized datagrams on a connected UDP socket
+
+    Sending a 12 byte message costs a system call, 28 bytes of IPv4 + UDP
+    header ( 48 for IPv6 ) and a trip through the stack on both ends, the
+    same as a full datagram. coal_send() appends the message to a batch
+    instead, and the batch goes out as one datagram when :
+
+        - the next message would not fit the path MTU       ( full )
+        - the oldest message in it has waited deadline µs   ( deadline )
+        - the application calls coal_flush()                ( explicit )
+
+    so no message waits longer than the deadline for company.
+
+    One datagram :
+
+        [ len | message ][ len | message ][ len | message ] ...
+          │
+          └ u16, network byte order
+
+    The largest datagram is the path MTU minus IP and UDP headers. The
+    socket sets "don't fragment" ( IP_PMTUDISC_DO ) and asks the kernel
+    for the path MTU ( IP_MTU / IPV6_MTU ). When a route shrinks it,
+    send() fails with EMSGSIZE, and the batch is split to the new size.
+
+    Usage ( sender ):
+        coal_t *c = coal_create( connected_udp_fd, 200 );  // deadline 200 µs
+        coal_send( c, msg, len );
+        poll( ..., coal_timeout( c ) );                     // sleep no longer than this
+        coal_tick( c );                                     // flushes if the deadline passed
+        coal_flush( c );
+        coal_destroy( c );
+
+    Usage ( receiver ):
+        const char *pos = dgram, *msg;
+        while( ( len = coal_next( &pos, dgram + n, &msg ) ) > 0 ) ...
+*/
+
+#ifndef COALESCE_H
+#define COALESCE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define COAL_MAXDGRAM   65507       // largest UDP payload, IPv4
+
+
+typedef struct coal coal_t;
+
+typedef struct {
+
+    uint64_t messages, bytes;                   // handed to coal_send()
+    uint64_t datagrams;                         // sent
+    uint64_t full, deadline, flushed;           // why each datagram was sent
+    uint64_t splits;                            // batches re-cut after EMSGSIZE
+    uint64_t oversize;                          // messages not sent : too big for the path MTU
+    int mtu, max_payload;                       // now
+
+} coal_stats_t;
+
+
+// fd : a connect()ed UDP socket ( IPv4 or IPv6 )
+// deadline_us : longest a message waits in a batch, 0 = no batching
+coal_t *coal_create( int fd, int deadline_us );
+
+// append one message ( 1 .. max_payload - 2 bytes ), sending the batch
+// first if the message does not fit. Returns 0, or -1 with errno set
+int coal_send( coal_t *c, const void *msg, size_t len );
+
+// send the batch now ( if any ). Returns 0, or -1 with errno set
+int coal_flush( coal_t *c );
+
+// send the batch if its deadline has passed
+int coal_tick( coal_t *c );
+
+// ms until the batch is due, for poll() : -1 if the batch is empty
+// ( rounded up : poll() may wake a little late, never early )
+int coal_timeout( coal_t *c );
+
+// µs until the batch is due, -1 if empty
+int64_t coal_timeout_us( coal_t *c );
+
+void coal_stats( coal_t *c, coal_stats_t *st );
+
+// flushes, then frees; the socket stays open
+void coal_destroy( coal_t *c );
+
+// next message in a received datagram : returns its length and points
+// *msg at it, 0 at the end, -1 if the datagram is malformed
+int coal_next( const char **pos, const char *end, const char **msg );
+
+#endif
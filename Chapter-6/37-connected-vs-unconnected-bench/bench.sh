@@ -0,0 +1,90 @@
+#!/bin/sh
+#
+#   bench.sh
+#
+#   ns per datagram : sendto() with an address vs connect() + send()
+#
+#   Reports:
+#       IPv4 / IPv6 × small / large × one syscall / sendmmsg, three patterns
+#       then the same send with 0 / 100 / 1000 policy routing rules : the
+#       cost of the route lookup an unconnected send makes every time
+#
+#   Needs root : sends into a TUN device nobody reads, in its own network
+#   namespace, so datagrams are dropped right after the send path.
+#
+#   Usage:
+#       ./bench.sh [datagrams-per-pattern] [rule counts ...]
+#
+#   Example:
+#       ./bench.sh 500000 0 100 1000
+
+COUNT=${1:-500000}
+[ $# -ge 1 ] && shift 1 || set --
+RULES=${*:-0 100 1000}
+NS=sendbench
+OUT=/tmp/sendbench.$$
+
+ip netns add $NS 2> /dev/null
+ip -n $NS tuntap add dev sink0 mode tun
+ip -n $NS link set sink0 up
+ip -n $NS addr add 10.88.0.1/24 dev sink0
+ip -n $NS addr add fd88::1/64 dev sink0 nodad
+
+run() {     # $1 host, $2 size, $3 batch : prints the three medians and the saving
+
+    ip netns exec $NS ./udp_sendbench "$1" -s "$2" -b "$3" -n "$COUNT" > "$OUT"
+
+    awk '$1 == "sendto"           { s = $2 }
+         $1 == "connected"        { c = $2 }
+         $1 == "conn+addr"        { a = $2 }
+         /address handling/       { d = $9; p = $NF }
+         END { printf " %9s %10s %10s %9s %7s\n", s, c, a, d, p }' "$OUT"
+}
+
+echo "== ns per datagram, median of 10 rounds"
+echo
+printf "%-6s %6s %6s  %9s %10s %10s %9s %7s\n" "family" "bytes" "batch" "sendto" "connected" "conn+addr" "saved ns" "saved"
+
+for HOST in 10.88.0.2 fd88::2; do
+    case $HOST in *:*) FAM=IPv6 ;; *) FAM=IPv4 ;; esac
+
+    for SIZE in 64 1400; do
+        for BATCH in 1 32; do
+            printf "%-6s %6s %6s " $FAM $SIZE $BATCH
+            run $HOST $SIZE $BATCH
+        done
+    done
+done
+
+echo
+echo "== route lookup : the same 64 B send with N policy routing rules ( none match )"
+echo
+printf "%-6s %6s  %9s %10s %10s %9s %7s\n" "family" "rules" "sendto" "connected" "conn+addr" "saved ns" "saved"
+
+HAVE=0
+
+for N in $RULES; do
+
+    # rules for prefixes never used : every lookup checks them all first
+    i=$HAVE
+    while [ $i -lt "$N" ]; do
+        echo "rule add to 10.$(( 100 + i / 250 )).$(( i % 250 )).0/24 table 100 pref $(( 1000 + i ))"
+        i=$(( i + 1 ))
+    done | ip -n $NS -batch -
+
+    i=$HAVE
+    while [ $i -lt "$N" ]; do
+        echo "rule add to fd99:$i::/32 table 100 pref $(( 1000 + i ))"
+        i=$(( i + 1 ))
+    done | ip -n $NS -6 -batch -
+    HAVE=$N
+
+    for HOST in 10.88.0.2 fd88::2; do
+        case $HOST in *:*) FAM=IPv6 ;; *) FAM=IPv4 ;; esac
+        printf "%-6s %6s " $FAM "$N"
+        run $HOST 64 1
+    done
+done
+
+ip netns del $NS
+rm -f "$OUT"
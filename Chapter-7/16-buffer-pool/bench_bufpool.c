@@ -0,0 +1,273 @@
+/*
+   bench_bufpool.c
+
+   Allocation cost and RSS of the buffer pool versus malloc()
+
+   Two connection models, each run in a fresh child process:
+
+    held  : every connection owns a buffer for its whole life
+            ( what a naive event-driven server does with heap buffers )
+
+    churn : only 'active' connections hold a buffer, it is returned
+            as soon as the connection goes idle ( what bufpool is for )
+
+   For each model and allocator we print:
+    - ns per get+put ( or malloc+free ) pair
+    - resident set size after the run
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 bench_bufpool.c bufpool.c -o bench_bufpool
+
+   Run:
+    ./bench_bufpool                             ( 100k conns, 16 KiB, 1% active )
+    ./bench_bufpool -n 100000 -s 2048 -a 5 -m 512 -o 20000000 -H
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "bufpool.h"
+
+
+typedef struct {
+
+    long conns;         // -n : number of connections
+    size_t size;        // -s : buffer size asked for
+    double active;      // -a : percent of connections active at once
+    size_t msg;         // -m : bytes written per message ( touches pages )
+    long ops;           // -o : churn operations
+    int huge;           // -H : huge pages for the pool
+
+} config_t;
+
+typedef struct {
+
+    const char *name;
+    void *( *get )( size_t size, size_t *cap );
+    void ( *put )( void *buf, size_t cap );
+
+} allocator_t;
+
+
+
+/* ================= ALLOCATORS ================= */
+
+void *malloc_get( size_t size, size_t *cap ) {
+
+    *cap = size;
+    return malloc( size );
+}
+
+void malloc_put( void *buf, size_t cap ) {
+
+    ( void ) cap;
+    free( buf );
+}
+
+allocator_t allocators[] = {
+    { "malloc",  malloc_get, malloc_put },
+    { "bufpool", bp_get,     bp_put     },
+};
+
+
+
+/* ================= HELPERS ================= */
+
+double now_ns( void ) {
+
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+// current resident set size in KiB ( Linux /proc )
+long rss_kib( void ) {
+
+    long pages = 0, resident = 0;
+    FILE *f = fopen( "/proc/self/statm", "r" );
+
+    if( f == NULL ) {
+        return -1;
+    }
+
+    if( fscanf( f, "%ld %ld", &pages, &resident ) != 2 ) {
+        resident = -1;
+    }
+
+    fclose( f );
+
+    return resident * ( sysconf( _SC_PAGESIZE ) / 1024 );
+}
+
+
+// xorshift : cheap deterministic random numbers
+unsigned long long rng_state = 88172645463325252ULL;
+
+unsigned long long next_rand( void ) {
+
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+
+    return rng_state;
+}
+
+
+
+/* ================= MODELS ================= */
+
+// every connection holds a buffer
+void run_held( config_t *cfg, allocator_t *a ) {
+
+    char **bufs = calloc( cfg -> conns, sizeof *bufs );
+    size_t cap = 0;
+
+    long base = rss_kib();
+    double t0 = now_ns();
+
+    for( long i = 0; i < cfg -> conns; i++ ) {
+
+        bufs[ i ] = a -> get( cfg -> size, &cap );
+
+        // a message lands in the buffer
+        memset( bufs[ i ], 'x', cfg -> msg );
+    }
+
+    double t1 = now_ns();
+    long rss = rss_kib() - base;
+
+    for( long i = 0; i < cfg -> conns; i++ ) {
+        a -> put( bufs[ i ], cap );
+    }
+
+    printf( "%-8s held   %8.1f ns/get  %10ld KiB RSS  ( %.2f KiB per connection )\n",
+            a -> name, ( t1 - t0 ) / cfg -> conns, rss, ( double ) rss / cfg -> conns );
+
+    free( bufs );
+}
+
+
+// only the active subset holds a buffer, idle connections hold nothing
+void run_churn( config_t *cfg, allocator_t *a ) {
+
+    long active = ( long ) ( cfg -> conns * cfg -> active / 100.0 );
+
+    if( active < 1 ) {
+        active = 1;
+    }
+
+    // ring of active buffers : the oldest goes idle, a new one wakes up
+    char **ring = calloc( active, sizeof *ring );
+    size_t cap = 0;
+
+    long base = rss_kib();
+
+    for( long i = 0; i < active; i++ ) {
+        ring[ i ] = a -> get( cfg -> size, &cap );
+        memset( ring[ i ], 'x', cfg -> msg );
+    }
+
+    double t0 = now_ns();
+
+    for( long op = 0; op < cfg -> ops; op++ ) {
+
+        long slot = op % active;
+
+        a -> put( ring[ slot ], cap );
+
+        // vary the message length a little, like real traffic
+        size_t len = 1 + next_rand() % cfg -> msg;
+
+        ring[ slot ] = a -> get( cfg -> size, &cap );
+        memset( ring[ slot ], 'x', len );
+    }
+
+    double t1 = now_ns();
+    long rss = rss_kib() - base;
+
+    printf( "%-8s churn  %8.1f ns/pair %10ld KiB RSS  ( %ld active of %ld )\n",
+            a -> name, ( t1 - t0 ) / cfg -> ops, rss, active, cfg -> conns );
+
+    for( long i = 0; i < active; i++ ) {
+        a -> put( ring[ i ], cap );
+    }
+
+    free( ring );
+}
+
+
+// run one measurement in its own process so RSS starts clean
+void in_child( void ( *fn )( config_t *, allocator_t * ), config_t *cfg, allocator_t *a ) {
+
+    fflush( stdout );
+
+    pid_t pid = fork();
+
+    if( pid == 0 ) {
+
+        if( cfg -> huge ) {
+            bp_init( BP_HUGEPAGES );
+        }
+
+        fn( cfg, a );
+        fflush( stdout );
+        _exit( 0 );
+    }
+
+    waitpid( pid, NULL, 0 );
+}
+
+
+
+/* ================= MAIN ================= */
+
+int main( int argc, char *argv[] ) {
+
+    config_t cfg = { 100000, BP_MEDIUM, 1.0, 512, 10000000, 0 };
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:s:a:m:o:H" ) ) != -1 ) {
+
+        switch( opt ) {
+            case 'n': cfg.conns  = atol( optarg ); break;
+            case 's': cfg.size   = strtoul( optarg, NULL, 10 ); break;
+            case 'a': cfg.active = atof( optarg ); break;
+            case 'm': cfg.msg    = strtoul( optarg, NULL, 10 ); break;
+            case 'o': cfg.ops    = atol( optarg ); break;
+            case 'H': cfg.huge   = 1; break;
+            default:
+                fprintf( stderr, "usage: %s [-n conns] [-s size] [-a active%%] [-m msgbytes] [-o ops] [-H]\n", argv[ 0 ] );
+                exit( 1 );
+        }
+    }
+
+    if( cfg.size > BP_LARGE || cfg.msg == 0 || cfg.msg > cfg.size ) {
+        fprintf( stderr, "need 0 < msg <= size <= %d\n", BP_LARGE );
+        exit( 1 );
+    }
+
+    printf( "connections: %ld | buffer: %zu B | message: <= %zu B | active: %.2f%% | huge pages: %s\n\n",
+            cfg.conns, cfg.size, cfg.msg, cfg.active, cfg.huge ? "yes" : "no" );
+
+    for( size_t i = 0; i < sizeof allocators / sizeof allocators[ 0 ]; i++ ) {
+        in_child( run_held, &cfg, &allocators[ i ] );
+    }
+
+    printf( "\n" );
+
+    for( size_t i = 0; i < sizeof allocators / sizeof allocators[ 0 ]; i++ ) {
+        in_child( run_churn, &cfg, &allocators[ i ] );
+    }
+
+    return 0;
+}
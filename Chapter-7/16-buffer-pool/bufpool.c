@@ -0,0 +1,201 @@
+/*
+   bufpool.c
+
+   Per-thread size-class buffer pool ( see bufpool.h )
+
+   Compile together with the program that uses it:
+    gcc -Wall -Wextra -pedantic bufpool.c your_server.c -o your_server
+*/
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "bufpool.h"
+
+
+/* ================= PER-THREAD STATE ================= */
+
+// a free buffer stores the link to the next free buffer in its first bytes
+typedef struct free_node {
+    struct free_node *next;
+} free_node_t;
+
+typedef struct {
+
+    free_node_t *free;      // LIFO free list : hottest buffer comes back first
+    char *bump;             // next never-used byte in the current slab
+    char *end;              // end of the current slab
+
+} bp_class_t;
+
+static const size_t class_size[ BP_NCLASSES ] = { BP_SMALL, BP_MEDIUM, BP_LARGE };
+
+// __thread : each thread gets its own copy, so no locking is needed
+static __thread bp_class_t classes[ BP_NCLASSES ];
+static __thread bp_stats_t stats;
+static __thread int pool_flags;
+
+
+
+/* ================= HELPERS ================= */
+
+static int class_of( size_t size ) {
+
+    if( size <= BP_SMALL ) {
+        return 0;
+    }
+
+    if( size <= BP_MEDIUM ) {
+        return 1;
+    }
+
+    if( size <= BP_LARGE ) {
+        return 2;
+    }
+
+    return -1;
+}
+
+
+// map one 2 MiB slab, aligned to 2 MiB so it can live in a single huge page
+static char *map_slab( void ) {
+
+    void *p;
+
+    if( pool_flags & BP_HUGEPAGES ) {
+
+#ifdef MAP_HUGETLB
+        // explicit huge pages ( needs vm.nr_hugepages > 0 )
+        p = mmap( NULL, BP_SLAB_SIZE, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+
+        if( p != MAP_FAILED ) {
+            return p;
+        }
+#endif
+    }
+
+    // over-allocate, then trim to a 2 MiB boundary
+    size_t len = 2 * BP_SLAB_SIZE;
+
+    p = mmap( NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+    if( p == MAP_FAILED ) {
+        return NULL;
+    }
+
+    uintptr_t start = ( uintptr_t ) p;
+    uintptr_t aligned = ( start + BP_SLAB_SIZE - 1 ) & ~( uintptr_t ) ( BP_SLAB_SIZE - 1 );
+
+    if( aligned > start ) {
+        munmap( p, aligned - start );
+    }
+
+    if( aligned + BP_SLAB_SIZE < start + len ) {
+        munmap( ( void * ) ( aligned + BP_SLAB_SIZE ), start + len - aligned - BP_SLAB_SIZE );
+    }
+
+#ifdef MADV_HUGEPAGE
+    if( pool_flags & BP_HUGEPAGES ) {
+        // transparent huge pages : best effort, ignore failure
+        madvise( ( void * ) aligned, BP_SLAB_SIZE, MADV_HUGEPAGE );
+    }
+#endif
+
+    return ( char * ) aligned;
+}
+
+
+
+/* ================= API ================= */
+
+void bp_init( int flags ) {
+
+    pool_flags = flags;
+}
+
+
+void *bp_get( size_t want, size_t *cap ) {
+
+    int c = class_of( want );
+
+    if( c < 0 ) {
+        return NULL;
+    }
+
+    bp_class_t *cl = &classes[ c ];
+    size_t size = class_size[ c ];
+    void *buf;
+
+    stats.gets++;
+
+    if( cl -> free ) {
+
+        // fast path : pop the free list
+        buf = cl -> free;
+        cl -> free = cl -> free -> next;
+        stats.cached[ c ]--;
+
+    } else {
+
+        // slow path : carve a new buffer, mapping a slab if needed
+        if( cl -> bump == NULL || cl -> bump + size > cl -> end ) {
+
+            char *slab = map_slab();
+
+            if( slab == NULL ) {
+                return NULL;
+            }
+
+            cl -> bump = slab;
+            cl -> end  = slab + BP_SLAB_SIZE;
+
+            stats.slabs++;
+        }
+
+        // pages are only touched ( and counted in RSS ) once the buffer is used
+        buf = cl -> bump;
+        cl -> bump += size;
+
+        stats.refills++;
+    }
+
+    stats.in_use[ c ]++;
+
+    if( cap ) {
+        *cap = size;
+    }
+
+    return buf;
+}
+
+
+void bp_put( void *buf, size_t cap ) {
+
+    if( buf == NULL ) {
+        return;
+    }
+
+    int c = class_of( cap );
+
+    if( c < 0 ) {
+        return;
+    }
+
+    free_node_t *n = buf;
+
+    n -> next = classes[ c ].free;
+    classes[ c ].free = n;
+
+    stats.in_use[ c ]--;
+    stats.cached[ c ]++;
+}
+
+
+void bp_stats( bp_stats_t *out ) {
+
+    memcpy( out, &stats, sizeof *out );
+}
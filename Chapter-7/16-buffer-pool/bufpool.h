@@ -0,0 +1,68 @@
+/*
+   bufpool.h
+
+   Size-class buffer pool for per-connection I/O buffers
+
+   Classes:
+    - 2 KiB   ( small request / chat line )
+    - 16 KiB  ( typical socket read )
+    - 64 KiB  ( bulk transfer )
+
+   Design:
+    - every thread owns its own free lists ( no locks, no shared state )
+    - buffers are carved lazily out of 2 MiB slabs
+    - slabs can be backed by huge pages ( BP_HUGEPAGES )
+    - a connection takes a buffer only while it has data in flight
+      and gives it back the moment it goes idle
+
+   Usage:
+    size_t cap;
+    char *buf = bp_get( 2048, &cap );
+    ...
+    bp_put( buf, cap );
+*/
+
+#ifndef BUFPOOL_H
+#define BUFPOOL_H
+
+#include <stddef.h>
+
+#define BP_SMALL  ( 2 * 1024 )
+#define BP_MEDIUM ( 16 * 1024 )
+#define BP_LARGE  ( 64 * 1024 )
+
+#define BP_NCLASSES 3
+
+#define BP_SLAB_SIZE ( 2 * 1024 * 1024 )    // one huge page on x86-64 / arm64
+
+// flags for bp_init()
+#define BP_HUGEPAGES 0x1    // try MAP_HUGETLB, fall back to MADV_HUGEPAGE
+
+
+// per-thread counters
+typedef struct {
+
+    size_t slabs;                       // slabs mapped by this thread
+    size_t in_use[ BP_NCLASSES ];       // buffers currently handed out
+    size_t cached[ BP_NCLASSES ];       // buffers sitting in the free list
+    size_t gets;                        // total bp_get() calls
+    size_t refills;                     // gets served from a fresh slab
+
+} bp_stats_t;
+
+
+// set pool options for the calling thread ( optional, call before first bp_get )
+void bp_init( int flags );
+
+// buffer of at least 'want' bytes, real capacity returned in *cap
+// returns NULL if want > BP_LARGE or the slab mmap fails
+void *bp_get( size_t want, size_t *cap );
+
+// give a buffer back to the calling thread's free list
+// cap must be the value bp_get() returned
+void bp_put( void *buf, size_t cap );
+
+// snapshot of the calling thread's counters
+void bp_stats( bp_stats_t *out );
+
+#endif
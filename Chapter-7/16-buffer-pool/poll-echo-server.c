@@ -0,0 +1,366 @@
+/*
+   poll-echo-server.c
+
+   poll() echo server with per-connection pooled buffers
+
+   Demonstrates:
+    - one heap buffer per connection, only while data is in flight
+    - buffer returned to the pool the moment the connection goes idle
+    - size class grows when a read fills the buffer, shrinks back after
+    - POLLOUT back-pressure when the peer is not reading
+
+   Compile:
+    gcc -Wall -Wextra -pedantic -O2 poll-echo-server.c bufpool.c -o poll-echo-server
+
+   Run:
+    ./poll-echo-server            ( normal pages )
+    ./poll-echo-server -H         ( huge-page backed slabs )
+
+   Connect:
+    nc localhost 9035
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <poll.h>
+
+#include "bufpool.h"
+
+#define PORT "9035"
+#define BACKLOG 128
+#define STATS_INTERVAL_MS 5000
+
+
+// state kept for every connection, even idle ones : 40 bytes + pollfd
+typedef struct {
+
+    char *buf;          // pooled buffer, NULL while idle
+    size_t cap;         // capacity of buf ( one of the size classes )
+    size_t want;        // size class to ask for on the next read
+    size_t len;         // bytes waiting to be echoed
+    size_t off;         // bytes of buf already echoed
+
+} conn_t;
+
+conn_t *conns = NULL;       // indexed by fd
+int conns_size = 0;
+
+
+
+/* ================= LISTENER ================= */
+
+int get_listener_socket( void ) {
+
+    struct addrinfo hints, *res, *p;
+    int listener;
+    int yes = 1;
+
+    memset( &hints, 0, sizeof hints );
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags    = AI_PASSIVE;
+
+    if( getaddrinfo( NULL, PORT, &hints, &res ) != 0 ) {
+        return -1;
+    }
+
+    for( p = res; p; p = p -> ai_next ) {
+
+        listener = socket( p -> ai_family, p -> ai_socktype, p -> ai_protocol );
+
+        if( listener < 0 ) {
+            continue;
+        }
+
+        setsockopt( listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes );
+
+        if( bind( listener, p -> ai_addr, p -> ai_addrlen ) < 0 ) {
+            close( listener );
+            continue;
+        }
+
+        break;
+    }
+
+    freeaddrinfo( res );
+
+    if( p == NULL ) {
+        return -1;
+    }
+
+    listen( listener, BACKLOG );
+
+    return listener;
+}
+
+
+
+/* ================= CONNECTION HELPERS ================= */
+
+conn_t *get_conn( int fd ) {
+
+    // grow the fd-indexed table on demand
+    if( fd >= conns_size ) {
+
+        int n = conns_size ? conns_size : 64;
+
+        while( n <= fd ) {
+            n *= 2;
+        }
+
+        conns = realloc( conns, sizeof *conns * n );
+
+        if( conns == NULL ) {
+            perror( "realloc" );
+            exit( 1 );
+        }
+
+        memset( conns + conns_size, 0, sizeof *conns * ( n - conns_size ) );
+        conns_size = n;
+    }
+
+    return &conns[ fd ];
+}
+
+
+// give the buffer back : connection is idle again
+void release_buffer( conn_t *c ) {
+
+    bp_put( c -> buf, c -> cap );
+
+    c -> buf = NULL;
+    c -> cap = c -> len = c -> off = 0;
+}
+
+
+void drop_conn( int fd ) {
+
+    conn_t *c = get_conn( fd );
+
+    if( c -> buf ) {
+        release_buffer( c );
+    }
+
+    c -> want = 0;
+    close( fd );
+}
+
+
+// echo pending bytes
+// returns 1 when everything was sent, 0 if the socket is full, -1 on error
+int flush_conn( int fd, conn_t *c ) {
+
+    while( c -> off < c -> len ) {
+
+        ssize_t n = send( fd, c -> buf + c -> off, c -> len - c -> off, MSG_DONTWAIT | MSG_NOSIGNAL );
+
+        if( n < 0 ) {
+
+            if( errno == EAGAIN || errno == EWOULDBLOCK ) {
+                return 0;
+            }
+
+            return -1;
+        }
+
+        c -> off += n;
+    }
+
+    // fully echoed : hand the buffer back immediately
+    release_buffer( c );
+
+    return 1;
+}
+
+
+// read and echo, returns -1 when the connection should be dropped
+int handle_readable( int fd, conn_t *c ) {
+
+    if( c -> want == 0 ) {
+        c -> want = BP_SMALL;
+    }
+
+    c -> buf = bp_get( c -> want, &c -> cap );
+
+    if( c -> buf == NULL ) {
+        return -1;
+    }
+
+    ssize_t n = recv( fd, c -> buf, c -> cap, MSG_DONTWAIT );
+
+    if( n <= 0 ) {
+
+        if( n < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ) ) {
+            release_buffer( c );
+            return 0;
+        }
+
+        return -1;
+    }
+
+    // a full read means the peer is streaming : use a bigger class next time
+    if( ( size_t ) n == c -> cap && c -> cap < BP_LARGE ) {
+        c -> want = c -> cap * 2 > BP_MEDIUM ? BP_LARGE : BP_MEDIUM;
+    } else if( ( size_t ) n <= BP_SMALL ) {
+        c -> want = BP_SMALL;
+    }
+
+    c -> len = n;
+    c -> off = 0;
+
+    return flush_conn( fd, c ) < 0 ? -1 : 0;
+}
+
+
+
+/* ================= STATS ================= */
+
+void print_stats( int fd_count ) {
+
+    bp_stats_t s;
+    bp_stats( &s );
+
+    printf( "connections: %d | buffers in use: %zu/%zu/%zu | cached: %zu/%zu/%zu | slabs: %zu ( %zu KiB )\n",
+            fd_count - 1,
+            s.in_use[ 0 ], s.in_use[ 1 ], s.in_use[ 2 ],
+            s.cached[ 0 ], s.cached[ 1 ], s.cached[ 2 ],
+            s.slabs, s.slabs * ( BP_SLAB_SIZE / 1024 ) );
+}
+
+
+
+/* ================= MAIN ================= */
+
+int main( int argc, char *argv[] ) {
+
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "H" ) ) != -1 ) {
+
+        if( opt == 'H' ) {
+            bp_init( BP_HUGEPAGES );
+        } else {
+            fprintf( stderr, "usage: %s [-H]\n", argv[ 0 ] );
+            exit( 1 );
+        }
+    }
+
+    int listener = get_listener_socket();
+
+    if( listener == -1 ) {
+        perror( "listener" );
+        exit( 1 );
+    }
+
+    int fd_count = 1;
+    int fd_size = 64;
+
+    struct pollfd *pfds = malloc( sizeof *pfds * fd_size );
+
+    if( pfds == NULL ) {
+        perror( "malloc" );
+        exit( 1 );
+    }
+
+    pfds[ 0 ].fd = listener;
+    pfds[ 0 ].events = POLLIN;
+
+    printf( "Echo server running on port %s...\n", PORT );
+
+    while( 1 ) {
+
+        int ready = poll( pfds, fd_count, STATS_INTERVAL_MS );
+
+        if( ready == -1 ) {
+
+            if( errno == EINTR ) {
+                continue;
+            }
+
+            perror( "poll" );
+            exit( 1 );
+        }
+
+        if( ready == 0 ) {
+            print_stats( fd_count );
+            continue;
+        }
+
+        for( int i = 0; i < fd_count; i++ ) {
+
+            if( pfds[ i ].revents == 0 ) {
+                continue;
+            }
+
+            /* NEW CONNECTION */
+            if( pfds[ i ].fd == listener ) {
+
+                int newfd = accept( listener, NULL, NULL );
+
+                if( newfd == -1 ) {
+                    continue;
+                }
+
+                if( fd_count == fd_size ) {
+                    fd_size *= 2;
+                    pfds = realloc( pfds, sizeof *pfds * fd_size );
+
+                    if( pfds == NULL ) {
+                        perror( "realloc" );
+                        exit( 1 );
+                    }
+                }
+
+                get_conn( newfd );
+
+                pfds[ fd_count ].fd = newfd;
+                pfds[ fd_count ].events = POLLIN;
+                pfds[ fd_count ].revents = 0;
+                fd_count++;
+
+                continue;
+            }
+
+            int fd = pfds[ i ].fd;
+            conn_t *c = get_conn( fd );
+            int rc = 0;
+
+            /* PEER CAUGHT UP : finish the pending echo */
+            if( pfds[ i ].revents & POLLOUT ) {
+                rc = flush_conn( fd, c ) < 0 ? -1 : 0;
+            }
+
+            /* HANGUP OR ERROR with an echo still pending : nobody to send it to */
+            else if( c -> buf ) {
+                rc = -1;
+            }
+
+            /* NEW DATA ( only when nothing is pending ) */
+            else if( pfds[ i ].revents & ( POLLIN | POLLHUP | POLLERR ) ) {
+                rc = handle_readable( fd, c );
+            }
+
+            if( rc < 0 ) {
+
+                drop_conn( fd );
+
+                pfds[ i ] = pfds[ fd_count - 1 ];
+                fd_count--;
+                i--;
+
+                continue;
+            }
+
+            // pending bytes : wait for POLLOUT and stop reading ( back-pressure )
+            pfds[ i ].events = c -> buf ? POLLOUT : POLLIN;
+        }
+    }
+}